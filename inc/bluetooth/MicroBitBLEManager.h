@@ -219,6 +219,15 @@ class MicroBitBLEManager : MicroBitComponent
 	*/
     void stopAdvertising();
 
+    /**
+     * Tears down the BLE stack and disables SoftDevice for the remainder of this session.
+     * This allows the radio to be used, and, if the heap allocator is enabled, the SRAM
+     * that was reserved for SoftDevice (including its GATT table) is added to the heap.
+     *
+     * @return MICROBIT_OK on success, or MICROBIT_NOT_SUPPORTED if the BLE stack is not running.
+     */
+    int shutdown();
+
     /**
      * A member function used to defer writes to flash, in order to prevent a write collision with 
      * softdevice.
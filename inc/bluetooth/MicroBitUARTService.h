@@ -177,7 +177,29 @@ class MicroBitUARTService
       * @return the number of characters written, or MICROBIT_NOT_SUPPORTED if there is
       *         no connected device, or the connected device has not enabled indications.
       */
-    int send(ManagedString s, MicroBitSerialMode mode = SYNC_SLEEP);
+    int send(const ManagedString &s, MicroBitSerialMode mode = SYNC_SLEEP);
+
+    /**
+      * Copies the string held by a ManagedStringBuilder into the buffer used for Transmitting to the central device.
+      * The content of the ManagedStringBuilder is not changed.
+      *
+      * @param b the ManagedStringBuilder holding the string to transmit
+      * @param mode the selected mode, one of: ASYNC, SYNC_SPINWAIT, SYNC_SLEEP. Each mode
+      *        gives a different behaviour:
+      *
+      *            ASYNC - Will copy as many characters as it can into the buffer for transmission,
+      *                    and return control to the user.
+      *
+      *            SYNC_SPINWAIT - will return MICROBIT_INVALID_PARAMETER
+      *
+      *            SYNC_SLEEP - Will perform a cooperative blocking wait until all
+      *                         given characters have been received by the connected
+      *                         device.
+      *
+      * @return the number of characters written, or MICROBIT_NOT_SUPPORTED if there is
+      *         no connected device, or the connected device has not enabled indications.
+      */
+    int send(const ManagedStringBuilder &b, MicroBitSerialMode mode = SYNC_SLEEP);
 
     /**
       * Reads a number of characters from the rxBuffer and fills user given buffer.
@@ -104,7 +104,7 @@ class EventModel
       *
       * @return This default implementation simply returns NULL.
       */
-    MicroBitListener *elementAt(int n)
+    virtual MicroBitListener *elementAt(int n)
     {
         (void) n;
         return NULL;
@@ -108,4 +108,17 @@ int string_reverse(char *s);
   */
 int itoa(int n, char *s);
 
+/**
+  * Calculates the CRC16-CCITT of a block of memory.
+  *
+  * @param data The data to checksum.
+  *
+  * @param len The number of bytes of data.
+  *
+  * @param crc The CRC of any preceding data, or 0xFFFF to begin a new checksum.
+  *
+  * @return The CRC of the data.
+  */
+uint16_t crc16(const uint8_t *data, int len, uint16_t crc);
+
 #endif
@@ -67,6 +67,9 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_ID_RADIO_DATA_READY    30
 #define MICROBIT_ID_MULTIBUTTON_ATTACH  31
 #define MICROBIT_ID_SERIAL              32
+#define MICROBIT_ID_LIGHT_SENSOR        33
+#define MICROBIT_ID_FLASH               34
+#define MICROBIT_ID_FILESYSTEM          35
 
 #define MICROBIT_ID_MESSAGE_BUS_LISTENER            1021          // Message bus indication that a handler for a given ID has been registered.
 #define MICROBIT_ID_NOTIFY_ONE                      1022          // Notfication channel, for general purpose synchronisation
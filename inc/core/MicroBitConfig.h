@@ -97,7 +97,7 @@ extern uint32_t Image$$ER_IROM1$$RO$$Limit;
 #define FLASH_PROGRAM_END (uint32_t) (&Image$$ER_IROM1$$RO$$Limit)
 #else
 extern uint32_t __etext;
-#define FLASH_PROGRAM_END (uint32_t) (&__etext)
+#define FLASH_PROGRAM_END (uint32_t)(uintptr_t)(&__etext)
 #endif
 
 
@@ -183,6 +183,24 @@ extern uint32_t __etext;
 #define MICROBIT_IDLE_COMPONENTS                6
 #endif
 
+//
+// Managed type options
+//
+
+// The number of strings that can be held in the ManagedString intern table (see ManagedString::intern()).
+// Interned strings that are equal share a single heap allocation.
+// Set to zero to disable interning.
+#ifndef MICROBIT_STRING_INTERN_TABLE_SIZE
+#define MICROBIT_STRING_INTERN_TABLE_SIZE       8
+#endif
+
+// The number of short strings (of up to 7 characters) that can be held in a pool of fixed size blocks,
+// rather than on the heap. Each uses 12 bytes of RAM. Longer strings, and any created once the pool is full, use the heap.
+// Set to zero to disable the pool.
+#ifndef MICROBIT_STRING_POOL_SIZE
+#define MICROBIT_STRING_POOL_SIZE               16
+#endif
+
 //
 // BLE options
 //
@@ -342,6 +360,12 @@ extern uint32_t __etext;
 #define MICROBIT_DISPLAY_DEFAULT_BRIGHTNESS     MICROBIT_DISPLAY_MAXIMUM_BRIGHTNESS
 #endif
 
+// Selects the default refresh rate of the display, in frames per second.
+// The display is refreshed from its own timer, independently of SYSTEM_TICK_PERIOD_MS.
+#ifndef MICROBIT_DISPLAY_REFRESH_RATE
+#define MICROBIT_DISPLAY_REFRESH_RATE           55
+#endif
+
 // Selects the default scroll speed for the display.
 // The time taken to move a single pixel (ms).
 #ifndef MICROBIT_DEFAULT_SCROLL_SPEED
@@ -364,6 +388,19 @@ extern uint32_t __etext;
 #define MICROBIT_DEFAULT_SERIAL_MODE            SYNC_SLEEP
 #endif
 
+//
+// Flash configuration defaults
+//
+
+//
+// The number of times a flash operation is retried when the SoftDevice reports that it failed,
+// typically because radio activity left no time to complete it. The operation is then abandoned,
+// and an error returned to those waiting for it.
+//
+#ifndef MICROBIT_FLASH_MAX_RETRIES
+#define MICROBIT_FLASH_MAX_RETRIES  8
+#endif
+
 //
 // File System configuration defaults
 //
@@ -377,12 +414,56 @@ extern uint32_t __etext;
 #endif
 
 //
-// FileSystem writeback cache size, in bytes. Defines how many bytes will be stored
-// in RAM before being written back to FLASH. Set to zero to disable this feature.
-// Should be <= MBFS_BLOCK_SIZE.
+// FileSystem writeback cache size, in physical pages. Data written to files is held in RAM
+// a page at a time, and written back to FLASH with a single write operation per page.
+// Each page of cache uses just over PAGE_SIZE bytes of RAM, allocated when a file is first written.
+// Set to zero to disable this feature.
+//
+#ifndef MBFS_CACHE_PAGES
+#define MBFS_CACHE_PAGES    1
+#endif
+
+//
+// The maximum time data may be held in the FileSystem writeback cache, in milliseconds,
+// before it is written back to FLASH.
+//
+#ifndef MBFS_CACHE_TIMEOUT
+#define MBFS_CACHE_TIMEOUT  1000
+#endif
+
+//
+// The number of entries in the FileSystem directory index. Files and directories are located through this index
+// rather than by searching each directory. Each entry uses 8 bytes of RAM, allocated when a file is first opened.
+// The index is kept at most three quarters full - if more files exist, those not indexed are found by searching.
+// Set to zero to disable this feature.
+//
+#ifndef MBFS_DIRECTORY_INDEX_SIZE
+#define MBFS_DIRECTORY_INDEX_SIZE   32
+#endif
+
+//
+// The number of recently used directory paths the FileSystem remembers, to avoid resolving each level of a path in turn.
+// Set to zero to disable this feature.
+//
+#ifndef MBFS_PATH_CACHE_SIZE
+#define MBFS_PATH_CACHE_SIZE        4
+#endif
+
+//
+// The size of a FileSystem journal transaction, in words. Updates to the file table and directories made by each
+// operation are recorded together in a journal before they are made, so they are completed if power is lost.
+// Each word uses 4 bytes of RAM, and must be at least 8. Set to zero to disable this feature.
 //
-#ifndef MBFS_CACHE_SIZE
-#define MBFS_CACHE_SIZE	    0	
+#ifndef MBFS_JOURNAL_SIZE
+#define MBFS_JOURNAL_SIZE           48
+#endif
+
+//
+// The number of physical pages at the end of the FileSystem that the journal rotates between. When the journal fills,
+// it moves on to the next of them, so the erases needed to reuse the journal are shared between these pages.
+//
+#ifndef MBFS_JOURNAL_PAGES
+#define MBFS_JOURNAL_PAGES          2
 #endif
 
 //
@@ -408,6 +489,14 @@ extern uint32_t __etext;
 #define MICROBIT_PANIC_HEAP_FULL                1
 #endif
 
+// Enable this to sanity check the reference count of managed types (ManagedString, MicroBitImage, PacketBuffer)
+// each time a reference is added or removed, and invoke a panic if corruption is detected.
+// Disabling this reduces the cost of copying managed types.
+// Set '1' to enable.
+#ifndef MICROBIT_PANIC_REFCOUNT_ERROR
+#define MICROBIT_PANIC_REFCOUNT_ERROR           1
+#endif
+
 //
 // Debug options
 //
@@ -442,6 +531,12 @@ extern uint32_t __etext;
 #define CONFIG_ENABLED(X) (X == 1)
 #define CONFIG_DISABLED(X) (X != 1)
 
+//
+// Helper macro used by the micro:bit runtime to determine if the compiler supports C++11 language features,
+// such as move semantics.
+//
+#define MICROBIT_CPP11 (__cplusplus >= 201103L)
+
 #if CONFIG_ENABLED(MICROBIT_HEAP_ALLOCATOR)
 #include "MicroBitHeapAllocator.h"
 #endif
@@ -0,0 +1,65 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_FIBER_LOCK_H
+#define MICROBIT_FIBER_LOCK_H
+
+#include "mbed.h"
+#include "MicroBitConfig.h"
+
+/**
+  * Class definition for a MicroBitFiberLock.
+  *
+  * A simple mutual exclusion lock between fibers, for components whose operations may block part way through
+  * (e.g. while waiting for flash to be written), and so would otherwise be entered again by another fiber.
+  * A fiber that finds the lock held sleeps until it is released.
+  *
+  * The lock is not recursive, and must not be taken from interrupt context or the idle thread.
+  */
+class MicroBitFiberLock
+{
+    volatile bool locked;               // true whilst a fiber holds the lock.
+    volatile uint8_t waiting;           // The number of fibers waiting for the lock.
+
+    public:
+
+    /**
+      * Constructor. Creates a lock that is not held.
+      */
+    MicroBitFiberLock();
+
+    /**
+      * Takes the lock, first waiting for it to be released if another fiber holds it.
+      * If the scheduler is not running, no other fiber can hold the lock, so this call returns immediately.
+      */
+    void lock();
+
+    /**
+      * Releases the lock, and wakes any fibers waiting for it.
+      */
+    void unlock();
+};
+
+#endif
@@ -34,6 +34,11 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_FONT_ASCII_START 32
 #define MICROBIT_FONT_ASCII_END 126
 
+// Glyph metrics of proportional fonts: the first column used by the glyph, and its width.
+#define MICROBIT_FONT_METRICS(offset, width)    (((offset) << 4) | (width))
+#define MICROBIT_FONT_METRICS_OFFSET(m)         ((m) >> 4)
+#define MICROBIT_FONT_METRICS_WIDTH(m)          ((m) & 0x0F)
+
 /**
   * Class definition for a MicrobitFont
   * This class represents a font that can be used by the display to render text.
@@ -53,16 +58,35 @@ DEALINGS IN THE SOFTWARE.
   * The above will produce an exclaimation mark on the second column in form the left.
   *
   * We could compress further, but the complexity of decode would likely outweigh the gains.
+  *
+  * A font may also be proportional, in which case it has a metrics table with a byte per character,
+  * holding the first column used by the glyph in its top four bits and its width in its bottom four bits
+  * (see MICROBIT_FONT_METRICS). Characters of a proportional font are drawn from their first used column,
+  * so narrow glyphs take fewer columns when text is scrolled.
+  *
+  * A proportional font may also have a kerning table, of { left character, right character, adjustment }
+  * triples terminated by a zero byte, where the adjustment is a signed number of columns added to the
+  * space between that pair of characters.
+  *
+  * Tables for proportional fonts can be generated from a text description of each glyph using
+  * utils/fontcompiler.py.
   */
 class MicroBitFont
 {
     public:
 
     static const unsigned char* defaultFont;
+    static const unsigned char* defaultMetrics;
     static MicroBitFont systemFont;
 
     const unsigned char* characters;
 
+    // The glyph metrics of each character, or NULL if this font is fixed width.
+    const unsigned char* metrics;
+
+    // The kerning pairs of this font, or NULL if it has none.
+    const unsigned char* kerning;
+
     int asciiEnd;
 
     /**
@@ -76,6 +100,26 @@ class MicroBitFont
       */
     MicroBitFont(const unsigned char* font, int asciiEnd = MICROBIT_FONT_ASCII_END);
 
+    /**
+      * Constructor.
+      *
+      * Sets the proportional font represented by this font object.
+      *
+      * @param font A pointer to the beginning of the new font.
+      *
+      * @param metrics A pointer to the glyph metrics of the new font, or NULL if it is fixed width.
+      *
+      * @param kerning A pointer to the kerning pairs of the new font, or NULL if it has none. Defaults to NULL.
+      *
+      * @param asciiEnd the char value at which this font finishes.
+      *
+      * @code
+      * // Scroll text using the default glyphs, with each character only as wide as it needs to be.
+      * MicroBitFont::setSystemFont(MicroBitFont(MicroBitFont::defaultFont, MicroBitFont::defaultMetrics));
+      * @endcode
+      */
+    MicroBitFont(const unsigned char* font, const unsigned char* metrics, const unsigned char* kerning = NULL, int asciiEnd = MICROBIT_FONT_ASCII_END);
+
     /**
       * Default Constructor.
       *
@@ -83,6 +127,42 @@ class MicroBitFont
       */
     MicroBitFont();
 
+    /**
+      * Determines if this font is proportional.
+      *
+      * @return true if characters of this font have their own widths, false if they are all MICROBIT_FONT_WIDTH wide.
+      */
+    bool isProportional() const;
+
+    /**
+      * Determines the first column of its cell that the given character uses.
+      *
+      * @param c The character.
+      *
+      * @return The first column used, which is always 0 for fixed width fonts.
+      */
+    int getCharOffset(char c) const;
+
+    /**
+      * Determines the number of columns the given character uses.
+      *
+      * @param c The character.
+      *
+      * @return The width of the character, which is always MICROBIT_FONT_WIDTH for fixed width fonts.
+      */
+    int getCharWidth(char c) const;
+
+    /**
+      * Determines the adjustment to the space between the given pair of characters.
+      *
+      * @param left The character on the left.
+      *
+      * @param right The character on the right.
+      *
+      * @return The number of columns to add to the space between the characters, which may be negative.
+      */
+    int getKerning(char left, char right) const;
+
     /**
       * Modifies the current system font to the given instance of MicroBitFont.
       *
@@ -56,11 +56,24 @@ DEALINGS IN THE SOFTWARE.
 #include <new>
 
 // The maximum number of heap segments that can be created.
-#define MICROBIT_MAXIMUM_HEAPS          2
+#ifndef MICROBIT_MAXIMUM_HEAPS
+#define MICROBIT_MAXIMUM_HEAPS          4
+#endif
 
 // Flag to indicate that a given block is FREE/USED
 #define MICROBIT_HEAP_BLOCK_FREE		0x80000000
 
+/**
+  * Usage summary of a single heap region, as reported by microbit_heap_info().
+  */
+struct MicroBitHeapInfo
+{
+    uint32_t start;             // Physical address of the start of the region.
+    uint32_t end;               // Physical address of the end of the region.
+    uint32_t free;              // Total number of bytes currently free in the region.
+    uint32_t largest;           // Size of the largest single allocation the region could currently satisfy (bytes).
+};
+
 /**
   * Create and initialise a given memory region as for heap storage.
   * After this is called, any future calls to malloc, new, free or delete may use the new heap.
@@ -79,6 +92,36 @@ DEALINGS IN THE SOFTWARE.
   */
 int microbit_create_heap(uint32_t start, uint32_t end);
 
+/**
+  * Remove a heap region previously created with microbit_create_heap().
+  * The region is only removed if it currently holds no allocated memory, after which
+  * the memory may be handed back to its original owner (e.g. SoftDevice).
+  *
+  * @param start The start address of the heap region to remove.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if no heap region starts at the given address,
+  *         or MICROBIT_BUSY if the region is still in use.
+  */
+int microbit_remove_heap(uint32_t start);
+
+/**
+  * Determines the number of heap regions currently registered with the allocator.
+  *
+  * @return The number of active heap regions.
+  */
+int microbit_heap_count();
+
+/**
+  * Provides a usage summary of the given heap region.
+  *
+  * @param index The index of the heap region, in the range 0..microbit_heap_count()-1.
+  *
+  * @param info A MicroBitHeapInfo structure to populate.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the index is out of range.
+  */
+int microbit_heap_info(int index, MicroBitHeapInfo &info);
+
 /**
   * Create and initialise a heap region within the current the heap region specified
   * by the linker script.
@@ -102,6 +145,7 @@ int microbit_create_nested_heap(float ratio);
 void *microbit_malloc(size_t size);
 
 
+
 /**
   * Release a given area of memory from the heap.
   *
@@ -29,11 +29,14 @@ DEALINGS IN THE SOFTWARE.
 #include "mbed.h"
 #include "MicroBitConfig.h"
 #include "ManagedString.h"
+#include "ManagedStringBuilder.h"
 #include "MicroBitComponent.h"
 #include "MicroBitImage.h"
+#include "MicroBitAnimation.h"
 #include "MicroBitFont.h"
 #include "MicroBitMatrixMaps.h"
 #include "MicroBitLightSensor.h"
+#include "MicroBitSprite.h"
 
 /**
   * Event codes raised by MicroBitDisplay
@@ -48,6 +51,16 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_DISPLAY_SPACING                1
 #define MICROBIT_DISPLAY_GREYSCALE_BIT_DEPTH    8
 #define MICROBIT_DISPLAY_ANIMATE_DEFAULT_POS    -255
+#define MICROBIT_DISPLAY_PIXEL_NONE             0xFFFF
+#define MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL 30
+#define MICROBIT_DISPLAY_SCROLL_STRIP_WIDTH     64
+
+// The range of supported refresh rates, in frames per second.
+#define MICROBIT_DISPLAY_MINIMUM_REFRESH_RATE   20
+#define MICROBIT_DISPLAY_MAXIMUM_REFRESH_RATE   250
+
+// The proportion of each row period that a row can be lit for, in percent.
+#define MICROBIT_DISPLAY_ROW_DUTY_CYCLE         95
 
 enum AnimationMode {
     ANIMATION_MODE_NONE,
@@ -57,7 +70,9 @@ enum AnimationMode {
     ANIMATION_MODE_SCROLL_IMAGE,
     ANIMATION_MODE_ANIMATE_IMAGE,
     ANIMATION_MODE_ANIMATE_IMAGE_WITH_CLEAR,
-    ANIMATION_MODE_PRINT_CHARACTER
+    ANIMATION_MODE_PRINT_CHARACTER,
+    ANIMATION_MODE_ANIMATE_FRAMES,
+    ANIMATION_MODE_ANIMATE_FRAMES_WITH_CLEAR
 };
 
 enum DisplayMode {
@@ -86,10 +101,24 @@ class MicroBitDisplay : public MicroBitComponent
     uint8_t strobeRow;
     uint8_t rotation;
     uint8_t mode;
-    uint8_t greyscaleBitMsk;
-    uint8_t timingCount;
+    uint8_t greyscaleStep;
+    uint8_t greyscaleSteps;
+    uint8_t refreshRate;
     uint32_t col_mask;
 
+    // The time between rows being strobed, in microseconds.
+    uint16_t rowPeriod;
+
+    // The time each row is lit for in black and white mode at the current brightness, in microseconds.
+    uint16_t renderTime;
+
+    // The factor by which greyscale timings are scaled to fit the row period, in 1/4096ths.
+    uint16_t greyscaleScale;
+
+    // Maps brightness to the proportion of the row period that a row is lit for. NULL if linear.
+    const uint8_t *brightnessCurve;
+
+    Ticker refreshTimer;
     Timeout renderTimer;
     PortOut *LEDMatrix;
 
@@ -116,12 +145,18 @@ class MicroBitDisplay : public MicroBitComponent
     // The text being displayed.
     ManagedString scrollingText;
 
-    // The index of the character currently being displayed.
+    // The index of the next character to be rendered into scrollingStrip.
     uint16_t scrollingChar;
 
-    // The number of pixels the current character has been shifted on the display.
+    // The column of scrollingStrip entering at the right hand edge of the display.
     uint8_t scrollingPosition;
 
+    // The number of columns of scrollingStrip holding rendered text.
+    uint8_t scrollingStripLength;
+
+    // A 1 bit per pixel image holding the next few characters of the text, already rendered.
+    MicroBitImage scrollingStrip;
+
     //
     // State for printString() method.
     //
@@ -152,8 +187,73 @@ class MicroBitDisplay : public MicroBitComponent
     // Flag to indicate if image has been rendered to screen yet (or not)
     bool scrollingImageRendered;
 
+    //
+    // State for animate(MicroBitAnimation) method.
+    //
+    // The animation being played.
+    MicroBitAnimation frameAnimation;
+
+    // The encoded data of the next frame to be shown.
+    const uint8_t *animationFrame;
+
+    // The number of frames still to be shown.
+    uint8_t animationFramesLeft;
+
     const MatrixMap &matrixMap;
 
+    // For each row and column of the matrix, the offset of the pixel it displays in the image bitmap, after rotation.
+    // Offsets are in bytes for 8 bit images, and in bits for packed images.
+    uint16_t *pixelOffsets;
+
+    // The image format and stride pixelOffsets were calculated for.
+    uint8_t pixelFormat;
+    uint16_t pixelStride;
+
+    // When double buffered, the brightness of each pixel of the matrix as of the last commit(), in pixelOffsets order. NULL otherwise.
+    uint8_t *frontBuffer;
+
+    // When double buffered, the black and white column pattern of each row of frontBuffer.
+    uint32_t *rowPatterns;
+
+    // Bit n is set if row n of frontBuffer has changed since its entry in rowPatterns was calculated.
+    volatile uint32_t dirtyRows;
+
+    // The greyscale schedule for the row being strobed: columns in greyscaleMasks[n] are turned off
+    // greyscaleTimes[n] microseconds after the row is lit. Both are sorted by time.
+    uint16_t *greyscaleTimes;
+    uint32_t *greyscaleMasks;
+
+    // The columns currently lit by the greyscale schedule.
+    uint32_t greyscalePattern;
+
+    // The sprites added to this display, in ascending order of depth. NULL if there are none.
+    MicroBitSprite *sprites;
+
+    // Set when a sprite is added or removed, and the image needs to be composited again.
+    volatile bool spritesChanged;
+
+    /**
+      * Recalculates pixelOffsets for the current rotation, matrix map and image geometry.
+      */
+    void updatePixelOffsets();
+
+    /**
+      * Calculates the black and white column pattern for the row currently being strobed.
+      *
+      * @return A bit pattern with bit n set if column n should be lit.
+      */
+    uint32_t getColumnPattern();
+
+    /**
+      * Recalculates renderTime and greyscaleScale for the current refresh rate, brightness and brightness curve.
+      */
+    void updateRenderTimes();
+
+    /**
+      * Refresh timer callback, used to strobe the display.
+      */
+    void refresh();
+
     // Internal methods to handle animation.
 
     /**
@@ -161,6 +261,18 @@ class MicroBitDisplay : public MicroBitComponent
       */
     void animationUpdate();
 
+    /**
+      * Steps any moving sprites, and composites the sprites into the image if any of them have changed.
+      */
+    void updateSprites();
+
+    /**
+      * Inserts the given sprite into the list of sprites, after any sprites of the same or lower depth.
+      *
+      * @param sprite The sprite to insert. Must not already be in the list.
+      */
+    void insertSprite(MicroBitSprite *sprite);
+
     /**
       *  Called by the display in an interval determined by the brightness of the display, to give an impression
       *  of brightness.
@@ -174,22 +286,42 @@ class MicroBitDisplay : public MicroBitComponent
     void render();
 
     /**
-      * Renders the current image, and drops the fourth frame to allow for
-      * sensors that require the display to operate.
+      * Renders the current image, and gives a row period to the light sensor
+      * whenever it is due to take a sample.
       */
     void renderWithLightSense();
 
     /**
-      * Translates a bit mask into a timer interrupt that gives the appearence of greyscale.
+      * Lights the row currently being strobed, and schedules each column to be turned off
+      * after a time proportional to its brightness, to give the appearence of greyscale.
       */
     void renderGreyscale();
 
+    /**
+      * Timer callback that turns off the next group of columns in the greyscale schedule.
+      */
+    void renderGreyscaleStep();
+
     /**
       * Internal scrollText update method.
       * Shift the screen image by one pixel to the left. If necessary, paste in the next char.
       */
     void updateScrollText();
 
+    /**
+      * Discards any columns of scrollingStrip that have scrolled off the display,
+      * and renders as many of the following characters as will fit in their place.
+      */
+    void renderScrollStrip();
+
+    /**
+      * Prints the given character in the middle of the display.
+      * Characters of fixed width fonts fill the display, so are simply printed at the origin.
+      *
+      * @param c The character to print.
+      */
+    void printCentred(char c);
+
     /**
       * Internal printText update method.
       * Paste the next character in the string.
@@ -208,6 +340,12 @@ class MicroBitDisplay : public MicroBitComponent
       */
     void updateAnimateImage();
 
+    /**
+      * Internal animate(MicroBitAnimation) update method.
+      * Decodes the next frame of the animation into the image, and schedules the one after it.
+      */
+    void updateAnimateFrames();
+
     /**
      * Broadcasts an event onto the defult EventModel indicating that the
      * current animation has completed.
@@ -260,7 +398,14 @@ public:
     void stopAnimation();
 
     /**
-      * Frame update method, invoked periodically to strobe the display.
+      * A brightness curve with a gamma of 2.2, for use with setBrightnessCurve().
+      * Gives a perceptually even change in brightness across the range of brightness values.
+      */
+    static const uint8_t gammaCurve[256];
+
+    /**
+      * Periodic callback from the system timer, used to update any animations that are running.
+      * The LED matrix itself is refreshed from the display's own timer.
       */
     virtual void systemTick();
 
@@ -296,7 +441,7 @@ public:
       * display.printAsync("abc123",400);
       * @endcode
       */
-    int printAsync(ManagedString s, int delay = MICROBIT_DEFAULT_PRINT_SPEED);
+    int printAsync(const ManagedString &s, int delay = MICROBIT_DEFAULT_PRINT_SPEED);
 
     /**
       * Prints the given image to the display, if the display is not in use.
@@ -317,7 +462,7 @@ public:
       * display.print(i,400);
       * @endcode
       */
-    int printAsync(MicroBitImage i, int x = 0, int y = 0, int alpha = 0, int delay = 0);
+    int printAsync(const MicroBitImage &i, int x = 0, int y = 0, int alpha = 0, int delay = 0);
 
     /**
       * Prints the given character to the display.
@@ -352,7 +497,7 @@ public:
       * display.print("abc123",400);
       * @endcode
       */
-    int print(ManagedString s, int delay = MICROBIT_DEFAULT_PRINT_SPEED);
+    int print(const ManagedString &s, int delay = MICROBIT_DEFAULT_PRINT_SPEED);
 
     /**
       * Prints the given image to the display.
@@ -375,7 +520,7 @@ public:
       * display.print(i,400);
       * @endcode
       */
-    int print(MicroBitImage i, int x = 0, int y = 0, int alpha = 0, int delay = 0);
+    int print(const MicroBitImage &i, int x = 0, int y = 0, int alpha = 0, int delay = 0);
 
     /**
       * Scrolls the given string to the display, from right to left.
@@ -392,7 +537,29 @@ public:
       * display.scrollAsync("abc123",100);
       * @endcode
       */
-    int scrollAsync(ManagedString s, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
+    int scrollAsync(const ManagedString &s, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
+
+    /**
+      * Scrolls the string held by a ManagedStringBuilder to the display, from right to left.
+      * Returns immediately, and executes the animation asynchronously.
+      *
+      * The builder's buffer is handed over to the display without copying, leaving the builder empty.
+      * If the text is not displayed (e.g. the display is busy), the builder is left unchanged.
+      *
+      * @param b The ManagedStringBuilder holding the string to display.
+      *
+      * @param delay The time to delay between characters, in milliseconds. Defaults
+      *              to: MICROBIT_DEFAULT_SCROLL_SPEED.
+      *
+      * @return MICROBIT_OK, MICROBIT_BUSY if the display is already in use, or MICROBIT_INVALID_PARAMETER.
+      *
+      * @code
+      * ManagedStringBuilder b;
+      * b.append("t=").append(uBit.thermometer.getTemperature());
+      * display.scrollAsync(b, 100);
+      * @endcode
+      */
+    int scrollAsync(ManagedStringBuilder &b, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
 
     /**
       * Scrolls the given image across the display, from right to left.
@@ -412,7 +579,7 @@ public:
       * display.scrollAsync(i,100,1);
       * @endcode
       */
-    int scrollAsync(MicroBitImage image, int delay = MICROBIT_DEFAULT_SCROLL_SPEED, int stride = MICROBIT_DEFAULT_SCROLL_STRIDE);
+    int scrollAsync(const MicroBitImage &image, int delay = MICROBIT_DEFAULT_SCROLL_SPEED, int stride = MICROBIT_DEFAULT_SCROLL_STRIDE);
 
     /**
       * Scrolls the given string across the display, from right to left.
@@ -429,7 +596,29 @@ public:
       * display.scroll("abc123",100);
       * @endcode
       */
-    int scroll(ManagedString s, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
+    int scroll(const ManagedString &s, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
+
+    /**
+      * Scrolls the string held by a ManagedStringBuilder across the display, from right to left.
+      * Blocks the calling thread until all text has been displayed.
+      *
+      * The builder's buffer is handed over to the display without copying, leaving the builder empty.
+      * If the text is not displayed (e.g. the display is busy), the builder is left unchanged.
+      *
+      * @param b The ManagedStringBuilder holding the string to display.
+      *
+      * @param delay The time to delay between characters, in milliseconds. Defaults
+      *              to: MICROBIT_DEFAULT_SCROLL_SPEED.
+      *
+      * @return MICROBIT_OK, MICROBIT_CANCELLED or MICROBIT_INVALID_PARAMETER.
+      *
+      * @code
+      * ManagedStringBuilder b;
+      * b.append("t=").append(uBit.thermometer.getTemperature());
+      * display.scroll(b, 100);
+      * @endcode
+      */
+    int scroll(ManagedStringBuilder &b, int delay = MICROBIT_DEFAULT_SCROLL_SPEED);
 
     /**
       * Scrolls the given image across the display, from right to left.
@@ -449,7 +638,7 @@ public:
       * display.scroll(i,100,1);
       * @endcode
       */
-    int scroll(MicroBitImage image, int delay = MICROBIT_DEFAULT_SCROLL_SPEED, int stride = MICROBIT_DEFAULT_SCROLL_STRIDE);
+    int scroll(const MicroBitImage &image, int delay = MICROBIT_DEFAULT_SCROLL_SPEED, int stride = MICROBIT_DEFAULT_SCROLL_STRIDE);
 
     /**
       * "Animates" the current image across the display with a given stride, finishing on the last frame of the animation.
@@ -477,7 +666,7 @@ public:
       * display.animateAsync(i,100,5);
       * @endcode
       */
-    int animateAsync(MicroBitImage image, int delay, int stride, int startingPosition = MICROBIT_DISPLAY_ANIMATE_DEFAULT_POS, int autoClear = MICROBIT_DISPLAY_DEFAULT_AUTOCLEAR);
+    int animateAsync(const MicroBitImage &image, int delay, int stride, int startingPosition = MICROBIT_DISPLAY_ANIMATE_DEFAULT_POS, int autoClear = MICROBIT_DISPLAY_DEFAULT_AUTOCLEAR);
 
     /**
       * "Animates" the current image across the display with a given stride, finishing on the last frame of the animation.
@@ -504,7 +693,40 @@ public:
       * display.animate(i,100,5);
       * @endcode
       */
-    int animate(MicroBitImage image, int delay, int stride, int startingPosition = MICROBIT_DISPLAY_ANIMATE_DEFAULT_POS, int autoClear = MICROBIT_DISPLAY_DEFAULT_AUTOCLEAR);
+    int animate(const MicroBitImage &image, int delay, int stride, int startingPosition = MICROBIT_DISPLAY_ANIMATE_DEFAULT_POS, int autoClear = MICROBIT_DISPLAY_DEFAULT_AUTOCLEAR);
+
+    /**
+      * Plays a frame sequence animation on the display, showing each frame for its own duration.
+      * Frames are decoded one at a time, directly into the display image, as the animation plays.
+      * Returns immediately.
+      *
+      * @param animation The animation to play. Its encoded data must remain valid until the animation completes.
+      *
+      * @param autoClear defines whether or not the display is automatically cleared once the animation is complete. By default, the display is cleared. Set this parameter to zero to disable the autoClear operation.
+      *
+      * @return MICROBIT_OK, MICROBIT_BUSY if the screen is in use, or MICROBIT_INVALID_PARAMETER if the animation is not valid.
+      *
+      * @code
+      * display.animateAsync(MicroBitAnimation(pulse));
+      * @endcode
+      */
+    int animateAsync(const MicroBitAnimation &animation, int autoClear = MICROBIT_DISPLAY_DEFAULT_AUTOCLEAR);
+
+    /**
+      * Plays a frame sequence animation on the display, showing each frame for its own duration.
+      * Blocks the calling thread until the animation is complete.
+      *
+      * @param animation The animation to play.
+      *
+      * @param autoClear defines whether or not the display is automatically cleared once the animation is complete. By default, the display is cleared. Set this parameter to zero to disable the autoClear operation.
+      *
+      * @return MICROBIT_OK, MICROBIT_CANCELLED or MICROBIT_INVALID_PARAMETER.
+      *
+      * @code
+      * display.animate(MicroBitAnimation(pulse));
+      * @endcode
+      */
+    int animate(const MicroBitAnimation &animation, int autoClear = MICROBIT_DISPLAY_DEFAULT_AUTOCLEAR);
 
     /**
       * Configures the brightness of the display.
@@ -538,6 +760,42 @@ public:
       */
     int getDisplayMode();
 
+    /**
+      * Configures the refresh rate of the display.
+      *
+      * The display is refreshed from its own timer, so its refresh rate and brightness are not
+      * affected by changes to the period of the system timer.
+      *
+      * @param rate The number of times the whole display is refreshed each second, in the range
+      *             MICROBIT_DISPLAY_MINIMUM_REFRESH_RATE - MICROBIT_DISPLAY_MAXIMUM_REFRESH_RATE.
+      *
+      * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER
+      *
+      * @code
+      * display.setRefreshRate(100); // refresh the display 100 times a second
+      * @endcode
+      */
+    int setRefreshRate(int rate);
+
+    /**
+      * Fetches the current refresh rate of this display.
+      *
+      * @return the number of times the whole display is refreshed each second.
+      */
+    int getRefreshRate();
+
+    /**
+      * Configures how brightness values map to the time each row of the display is lit for.
+      *
+      * @param curve A table of 256 entries, where entry n is the proportion of the row period (0 - 255) that
+      *              a row is lit for at brightness n. The table is not copied. NULL selects a linear mapping.
+      *
+      * @code
+      * display.setBrightnessCurve(MicroBitDisplay::gammaCurve);
+      * @endcode
+      */
+    void setBrightnessCurve(const uint8_t *curve);
+
     /**
       * Fetches the current brightness of this display.
       *
@@ -594,6 +852,84 @@ public:
       */
     void clear();
 
+    /**
+      * Enables or disables double buffering of the display.
+      *
+      * When double buffered, the LED matrix shows the state of `image` as of the last call to commit().
+      * User code can therefore draw into `image` over any length of time without partially drawn frames
+      * being seen. The display's own print, scroll and animate operations commit automatically.
+      *
+      * When not double buffered (the default), changes to `image` are shown as soon as they are made.
+      *
+      * @param enable true to double buffer the display, false otherwise.
+      *
+      * @return MICROBIT_OK, or MICROBIT_NO_RESOURCES if there is insufficient memory for the front buffer.
+      *
+      * @code
+      * display.setDoubleBuffering(true);
+      * display.image.clear();
+      * display.image.setPixelValue(2, 2, 255);
+      * display.commit(); // the cleared image and the new pixel appear together
+      * @endcode
+      */
+    int setDoubleBuffering(bool enable);
+
+    /**
+      * Determines if the display is double buffered.
+      *
+      * @return true if the display is double buffered, false otherwise.
+      */
+    bool isDoubleBuffered();
+
+    /**
+      * Atomically shows the current contents of `image` on the LED matrix.
+      *
+      * Only rows of the matrix that have changed since the previous commit are recalculated by the renderer.
+      * This has no effect if the display is not double buffered.
+      *
+      * @return MICROBIT_OK.
+      *
+      * @code
+      * display.image.shiftLeft(1);
+      * display.image.setPixelValue(4, 2, 255);
+      * display.commit();
+      * @endcode
+      */
+    int commit();
+
+    /**
+      * Adds a sprite to the display.
+      *
+      * While any sprites are added, the display composites its image from them: whenever a sprite is
+      * moved, changed, shown or hidden, the image is cleared and every visible sprite is drawn into it,
+      * in ascending order of depth. Sprites with a velocity are moved by the display as time passes.
+      *
+      * The sprite must remain in scope until it is removed from the display.
+      *
+      * @param sprite The sprite to add.
+      *
+      * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER if the sprite has already been added to a display.
+      *
+      * @code
+      * MicroBitSprite player(MicroBitImage("255\n"), 2, 4, 1);
+      * MicroBitSprite ball(MicroBitImage("255\n"), 0, 0);
+      * ball.setVelocity(1, 1, 250);
+      *
+      * display.addSprite(player);
+      * display.addSprite(ball);
+      * @endcode
+      */
+    int addSprite(MicroBitSprite &sprite);
+
+    /**
+      * Removes a sprite from the display.
+      *
+      * @param sprite The sprite to remove.
+      *
+      * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER if the sprite has not been added to this display.
+      */
+    int removeSprite(MicroBitSprite &sprite);
+
     /**
       * Updates the font that will be used for display operations.
 	  *
@@ -624,8 +960,8 @@ public:
       * Internally, it constructs an instance of a MicroBitLightSensor if not already configured
       * and sets the display mode to DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE.
       *
-      * This also changes the tickPeriod to MICROBIT_LIGHT_SENSOR_TICK_SPEED so
-      * that the display does not suffer from artifacts.
+      * The display only stops to sample the light level while it is being read, or while
+      * something is listening for MICROBIT_LIGHT_SENSOR_EVT_UPDATE events.
       *
       * @return an indicative light level in the range 0 - 255.
       *
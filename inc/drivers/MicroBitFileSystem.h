@@ -23,7 +23,10 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_FILE_SYSTEM_H
 
 #include "MicroBitConfig.h"
+#include "MicroBitComponent.h"
+#include "MicroBitEvent.h"
 #include "MicroBitFlash.h"
+#include "MicroBitFiberLock.h"
 
 
 // Configuration options.
@@ -43,11 +46,38 @@ DEALINGS IN THE SOFTWARE.
 
 // Status flags
 #define MBFS_STATUS_INITIALISED           0x01
+#define MBFS_STATUS_FLUSH_PENDING         0x02
+#define MBFS_STATUS_GC_PENDING            0x04
+#define MBFS_STATUS_GC_COMPLETE           0x08
+#define MBFS_STATUS_INDEX_INCOMPLETE      0x10
+#define MBFS_STATUS_JOURNAL_BUSY          0x20
+
+// Event codes raised by MicroBitFileSystem
+#define MBFS_EVT_CACHE_TIMEOUT            1
+#define MBFS_EVT_GC                       2
+
+// MBFSCachePage flags
+#define MBFS_CACHE_PAGE_ERASE             0x01
 
 // FileTable codes
 #define MBFS_UNUSED                       0xFFFF
 #define MBFS_EOF                          0xEFFF
 #define MBFS_DELETED                      0x0000
+#define MBFS_JOURNAL                      0xEFFE
+
+// Journal transaction states. A transaction is applied once it has been committed.
+#define MBFS_JOURNAL_STATE_FREE           0xFFFFFFFF
+#define MBFS_JOURNAL_STATE_COMMITTED      0x0000FFFF
+#define MBFS_JOURNAL_STATE_APPLIED        0x00000000
+
+// Journal operations
+#define MBFS_JOURNAL_OP_WRITE             1
+#define MBFS_JOURNAL_OP_COPY              2
+#define MBFS_JOURNAL_OP_DELETE            3
+
+// Records the erase counts of a run of physical pages, two to each data word, lowest page first in the low half.
+// The address word holds the number of the first page. Nothing is written to FLASH when it is applied.
+#define MBFS_JOURNAL_OP_WEAR              4
 
 // DirectorEntry flags
 #define MBFS_DIRECTORY_ENTRY_FREE         0x8000
@@ -106,12 +136,85 @@ struct FileDescriptor
     // the directory entry of our parent directory. 
     DirectoryEntry *directory;
 
+    // the block holding the current file position, and the position of the start of that block, in bytes.
+    // n.b. a position at the end of a block is held as the end of that block, rather than the start of the next.
+    uint16_t block;
+    uint32_t blockPosition;
+
     // We maintain a chain of open file descriptors. Reference to the next FileDescriptor in the chain.
     FileDescriptor *next;
+};
+
+//
+// A page of the writeback cache. Holds the data written to a physical page of FLASH memory
+// that has yet to be written back.
+//
+struct MBFSCachePage
+{
+    // The physical page held, or NULL if this cache page is unused.
+    uint32_t *page;
+
+    // The system time at which the page was first modified, and at which it was last used.
+    unsigned long dirtyTime;
+    unsigned long lastUsed;
+
+    // MBFS_CACHE_PAGE_* flags.
+    uint16_t flags;
+
+    // The number of modified words.
+    uint16_t dirtyWords;
+
+    // Bitmap of the words in the page that have been modified. Only these words of data are valid.
+    uint32_t dirty[PAGE_SIZE / 128];
+
+    // The content of the page.
+    uint32_t data[PAGE_SIZE / 4];
+};
+
+//
+// The header of a transaction in the metadata journal. The header is followed by the operations of the transaction,
+// each of which is an operation word (the MBFS_JOURNAL_OP_* code in the low byte, and the number of data words
+// in the next byte), an address word, and the data words.
+//
+struct MBFSJournalHeader
+{
+    // The sequence number of the transaction, one greater than that of the transaction before it.
+    uint16_t sequence;
+
+    // The number of words of operations that follow the header.
+    uint16_t length;
+
+    // CRC-16 of the sequence number, length and operations.
+    uint16_t crc;
+
+    uint16_t reserved;
 
-    // Optional writeback cache, to minimise FLASH write operations at the expense of RAM.
-    uint16_t cacheLength;
-    uint8_t cache[MBFS_CACHE_SIZE];
+    // One of the MBFS_JOURNAL_STATE_* values.
+    uint32_t state;
+};
+
+//
+// An entry in the directory index. Locates the DirectoryEntry of a file or directory from its name and parent directory.
+//
+struct MBFSIndexEntry
+{
+    // The indexed DirectoryEntry, or NULL if this entry is unused.
+    DirectoryEntry *dirent;
+
+    // The directory holding the DirectoryEntry.
+    const DirectoryEntry *directory;
+};
+
+//
+// An entry in the path cache. Records the directory named by a path.
+//
+struct MBFSPathCacheEntry
+{
+    // The path of the directory, including the trailing '/', or NULL if this entry is unused.
+    char *path;
+
+    // The DirectoryEntry of the directory.
+    DirectoryEntry *directory;
 };
 
 /**
@@ -126,17 +229,28 @@ struct FileDescriptor
   * - remove()
   *
   * Only a single instance shoud exist at any given time.
+  *
+  * Data written to files is held in a writeback cache of MBFS_CACHE_PAGES physical pages, and
+  * written back to FLASH when its cache page is needed for another page, when the file is
+  * flushed or closed, or once it has been held for MBFS_CACHE_TIMEOUT milliseconds.
+  *
+  * Files are located through a hash index of the directory tree, and a cache of recently used directory paths,
+  * so the time taken to open a file does not depend upon the number of files in its directory.
+  *
+  * Updates to the file table and directories, and the rewriting of physical pages, are recorded in a journal held
+  * in the last MBFS_JOURNAL_PAGES physical pages of the file system before they are made, filling each page in turn. Each operation's updates form a transaction,
+  * which is completed when the file system is next loaded if power is lost part way through.
   */
-class MicroBitFileSystem
+class MicroBitFileSystem : public MicroBitComponent
 {
     private:
 
-    // Status flags
-    uint32_t status;
-
     // The instance of MicroBitFlash - the interface used for all flash writes/erasures
     MicroBitFlash flash;
 
+    // Held by the fiber operating on the file system, as operations may block part way through while FLASH is written.
+    MicroBitFiberLock lock;
+
     // Total Number of logical pages available for file data (including the file table)
     int    fileSystemSize;
 
@@ -155,6 +269,41 @@ class MicroBitFileSystem
     // Chain of open files.
     FileDescriptor *openFiles;
 
+    // The writeback cache, allocated on first use.
+    MBFSCachePage *cache;
+
+    // Bitmap of the blocks that are UNUSED, and so available for allocation, and the number of them.
+    uint32_t *freeMap;
+    uint16_t freeBlocks;
+
+    // Bitmap of the blocks that are DELETED, but whose data has yet to be erased, and the number of DELETED blocks.
+    uint32_t *staleMap;
+    uint16_t deletedBlocks;
+
+    // The number of times each physical page has been erased, restored from the journal when the file system is loaded,
+    // and a bitmap of the pages whose count has changed since it was last recorded there.
+    uint16_t *eraseCounts;
+    uint32_t *wearMap;
+
+    // Hash index of the DirectoryEntries of every file and directory, built on first use, and the number of entries held.
+    MBFSIndexEntry *directoryIndex;
+    uint16_t directoryIndexCount;
+
+    // Cache of recently used directory paths, allocated on first use, and the entry to replace next.
+    MBFSPathCacheEntry *pathCache;
+    uint8_t pathCacheNext;
+
+    // The page holding the metadata journal, the location at which the next transaction will be recorded,
+    // the sequence number of the last transaction recorded, and the number of pages the journal rotates between.
+    uint32_t *journal;
+    uint32_t *journalNext;
+    uint16_t journalSequence;
+    uint16_t journalPages;
+
+    // The operations of the transaction being built, and the number of words of them.
+    uint32_t *journalBuffer;
+    uint16_t journalLength;
+
     /**
       * Initialize the flash storage system
       *
@@ -178,18 +327,117 @@ class MicroBitFileSystem
 
     /**
       * Allocate a free logical block.
-      * A round robin algorithm is used to even out the wear on the physical device.
-      * @return NULL on error, page address on success
+      * Blocks are allocated from the page last allocated from until it is full, then from the least worn
+      * free page, to even out the wear on the physical device.
+      * @return a valid, unused block number on success, or zero if no space is available.
       */
     uint16_t getFreeBlock();
 
     /**
-    * Allocates a free physical block.
-    * A round robin algorithm is used to even out the wear on the physical device.
+    * Allocates a free physical page, for use as a scratch page.
+    * The least worn free page is chosen, to even out the wear on the physical device.
     * @return NULL on error, page address on success
     */
     uint32_t* getFreePage();
 
+    /**
+      * Finds the least worn physical page with the given number of free blocks.
+      * Pages are considered in round robin order from the page last allocated from, so equally worn pages are used in turn.
+      *
+      * @param minimum The minimum number of UNUSED blocks in the page.
+      * @return The first block of the page, or zero if no page has enough free blocks.
+      */
+    uint16_t getLeastWornPage(int minimum);
+
+    /**
+      * Determine the number of blocks in the physical page starting at the given block which are in the given bitmap.
+      *
+      * @param map The bitmap to test: freeMap or staleMap.
+      * @param page The first block of the page.
+      * @return The number of blocks in the page that are in the bitmap.
+      */
+    int countBlocks(uint32_t *map, uint16_t page);
+
+    /**
+      * Determine the number of blocks in the physical page starting at the given block which are neither UNUSED nor DELETED.
+      *
+      * @param page The first block of the page.
+      * @return The number of blocks in the page holding valid data.
+      */
+    int countLiveBlocks(uint16_t page);
+
+    /**
+      * Rebuild the free and stale block bitmaps from the file table.
+      * Any DELETED blocks are assumed to still hold data.
+      */
+    void buildBlockMap();
+
+    /**
+      * Erase a physical page, recording the erase against the wear of the page.
+      * Any DELETED blocks on the page no longer hold data once it has been erased.
+      *
+      * @param page The physical page to erase.
+      */
+    void erasePage(uint32_t *page);
+
+    /**
+      * Performs a step of garbage collection. Pages holding only DELETED or UNUSED blocks are erased ahead of time,
+      * and once free space runs low, the file table is recycled so that DELETED blocks become available for allocation.
+      *
+      * @return MICROBIT_OK if a step was performed, or MICROBIT_NO_DATA if there is nothing to do.
+      */
+    int collectGarbage();
+
+    /**
+      * Event handler, called from the idle thread to perform a step of garbage collection.
+      */
+    void onGarbageCollect(MicroBitEvent);
+
+    /**
+      * Calculate the position in the directory index of the given name in the given directory.
+      *
+      * @param name The name of the file or directory.
+      * @param directory The directory holding the file or directory.
+      * @return The first entry of the directory index to search.
+      */
+    int getIndexSlot(char const *name, const DirectoryEntry *directory);
+
+    /**
+      * Build the directory index, by walking the directory tree from the root directory.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if the index could not be allocated.
+      */
+    int buildDirectoryIndex();
+
+    /**
+      * Add the entries of the given directory, and of any directories within it, to the directory index.
+      *
+      * @param directory The directory to index.
+      */
+    void indexDirectory(DirectoryEntry *directory);
+
+    /**
+      * Add a DirectoryEntry to the directory index.
+      * If the index is full, it is marked as incomplete, and lookups that are not found in it fall back to a search of the directory.
+      *
+      * @param dirent The DirectoryEntry to add.
+      * @param directory The directory holding the DirectoryEntry.
+      */
+    void indexAdd(DirectoryEntry *dirent, const DirectoryEntry *directory);
+
+    /**
+      * Remove a DirectoryEntry from the directory index.
+      *
+      * @param dirent The DirectoryEntry to remove.
+      * @param directory The directory holding the DirectoryEntry.
+      */
+    void indexRemove(DirectoryEntry *dirent, const DirectoryEntry *directory);
+
+    /**
+      * Discard the directory index and the path cache. The index is rebuilt when next used.
+      */
+    void indexReset();
+
     /**
     * Retrieve the DirectoryEntry assoiated with the given file's DIRECTORY (not the file itself).
     *
@@ -290,6 +538,7 @@ class MicroBitFileSystem
 
     /*
     * Update a file table entry to a given value.
+    * The update is added to the current journal transaction.
     *
     * @param block The block to update.
     * @param value The value to store in the file table.
@@ -297,6 +546,121 @@ class MicroBitFileSystem
     */
     int fileTableWrite(uint16_t block, uint16_t value);
 
+    /**
+      * Update the free and stale block bitmaps to reflect a change to a file table entry.
+      *
+      * @param block The block being updated.
+      * @param value The new value of its file table entry.
+      */
+    void updateBlockMap(uint16_t block, uint16_t value);
+
+    /**
+      * Locate the metadata journal, claiming the last MBFS_JOURNAL_PAGES physical pages of the file system for it
+      * if they are free, and complete any transactions that were interrupted by a loss of power.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if no journal is available. Updates are then made directly.
+      */
+    int journalOpen();
+
+    /**
+      * Complete any transactions in the journal held in the last pages of the file system, without reference
+      * to the file table, as power may have been lost while the file table itself was being refreshed.
+      *
+      * @return MICROBIT_OK if a journal was found, or MICROBIT_NO_DATA otherwise.
+      */
+    int journalRecover();
+
+    /**
+      * Find the page of the journal in use: of the given number of pages at the end of the file system,
+      * the one beginning with the most recent valid transaction.
+      *
+      * @param pages The number of pages to search.
+      * @return The page, or NULL if none begins with a valid transaction.
+      */
+    uint32_t *journalFind(int pages);
+
+    /**
+      * Determine if a transaction recorded in the journal is complete and intact.
+      *
+      * @param record The header of the transaction.
+      * @param end The end of the page holding it.
+      * @return true if the transaction is valid.
+      */
+    bool journalValid(uint32_t *record, uint32_t *end);
+
+    /**
+      * Move the journal on to the next of its pages, which is erased. Every transaction recorded
+      * in the current page has been applied, so it is simply left behind.
+      * The new page begins with the erase counts of every page.
+      */
+    void journalSwitch();
+
+    /**
+      * Record a transaction in the journal, moving on to the next page of the journal if there is no room for it.
+      *
+      * @param ops The operations of the transaction.
+      * @param length The number of words of operations.
+      * @param data Further words of the last operation, or NULL.
+      * @param words The number of further words.
+      * @param state The MBFS_JOURNAL_STATE_* value to record the transaction with.
+      * @return The header of the transaction.
+      */
+    MBFSJournalHeader *journalRecord(uint32_t *ops, int length, uint32_t *data, int words, uint32_t state);
+
+    /**
+      * Record the erase counts of any pages erased since they were last recorded in the journal.
+      */
+    void journalRecordWear();
+
+    /**
+      * Complete any transactions in the journal that were committed but not applied,
+      * and find the location at which the next transaction will be recorded.
+      */
+    void journalReplay();
+
+    /**
+      * Add an operation to the current journal transaction.
+      * If the transaction is full, it is committed, and the operation begins a new transaction.
+      *
+      * @param op The MBFS_JOURNAL_OP_* code of the operation.
+      * @param address The address the operation applies to.
+      * @param data The data words of the operation.
+      * @param words The number of data words.
+      */
+    void journalAdd(int op, void *address, uint32_t *data, int words);
+
+    /**
+      * Add a write of metadata to the current journal transaction. The data need not be word aligned.
+      *
+      * @param address The location in FLASH memory to write to.
+      * @param data The data to write.
+      * @param length The number of bytes to write.
+      */
+    void journalWrite(void *address, const void *data, int length);
+
+    /**
+      * Record the current journal transaction in the journal, then apply it.
+      *
+      * @return MICROBIT_OK on success.
+      */
+    int journalCommit();
+
+    /**
+      * Perform the operations of a journal transaction. Each operation can be safely repeated.
+      *
+      * @param ops The operations.
+      * @param length The number of words of operations.
+      */
+    void journalApply(uint32_t *ops, int length);
+
+    /**
+      * Mark each block in a chain as DELETED. Blocks are deleted from the end of the chain, so the chain
+      * can be found from its first block until the whole chain has been deleted.
+      *
+      * @param block The first block of the chain.
+      */
+    void deleteChain(uint16_t block);
+
     /**
     * Searches the list of open files for one with the given identifier.
     *
@@ -306,6 +670,16 @@ class MicroBitFileSystem
     */
     FileDescriptor* getFileDescriptor(int fd, bool remove = false);
 
+    /**
+    * Determine the block holding the current position of the given file.
+    * The walk along the file's chain of blocks starts from the block last used by the file where possible,
+    * so sequential access does not need to walk the chain from the start of the file.
+    *
+    * @param file The file descriptor to locate.
+    * @return The block holding the current file position.
+    */
+    uint16_t getSeekBlock(FileDescriptor *file);
+
     /**
     * Initialises a new file system
     *
@@ -314,13 +688,56 @@ class MicroBitFileSystem
     int format();
 
     /**
-      * Flush a given file's cache back to FLASH memory.
+      * Find the writeback cache page holding the given physical page, optionally claiming one for it.
+      * If no cache page is free, the least recently used page is written back to FLASH and reused.
       *
-      * @param file File descriptor to flush.
-      * @return The number of bytes written.
+      * @param page The physical page to look up.
+      * @param create true to claim a cache page for the physical page if it is not cached.
+      * @return The cache page, or NULL if the page is not cached, or no cache is available.
+      */
+    MBFSCachePage* getCachePage(uint32_t *page, bool create);
+
+    /**
+      * Write data to FLASH memory through the writeback cache.
+      * The data must lie within a single physical page.
       *
+      * @param address The location in FLASH memory to write to.
+      * @param buffer The data to write.
+      * @param length The number of bytes to write.
+      * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if no cache is available.
       */
-    int writeBack(FileDescriptor *file);
+    int cacheWrite(uint8_t *address, uint8_t *buffer, int length);
+
+    /**
+      * Read data from FLASH memory, including any data held in the writeback cache.
+      * The data must lie within a single physical page.
+      *
+      * @param buffer The buffer to read into.
+      * @param address The location in FLASH memory to read from.
+      * @param length The number of bytes to read.
+      */
+    void cacheRead(uint8_t *buffer, uint8_t *address, int length);
+
+    /**
+      * Write back a cache page to FLASH memory.
+      * The modified words are written with a single write operation, preceded by a page erase if necessary.
+      *
+      * @param c The cache page to write back.
+      * @return MICROBIT_OK on success.
+      */
+    int writeBack(MBFSCachePage *c);
+
+    /**
+      * Write back all modified pages in the writeback cache to FLASH memory.
+      *
+      * @return MICROBIT_OK on success.
+      */
+    int writeBack();
+
+    /**
+      * Event handler, called when data has been held in the writeback cache for MBFS_CACHE_TIMEOUT milliseconds.
+      */
+    void onCacheTimeout(MicroBitEvent);
 
     /**
       * Write a given buffer to the file provided.
@@ -332,6 +749,22 @@ class MicroBitFileSystem
       */
     int writeBuffer(FileDescriptor *file, uint8_t* buffer, int length);
 
+    /**
+      * Open a file, as open(). The caller must hold the lock.
+      *
+      * @param filename name of the file to open.
+      * @param flags One or more of MB_READ, MB_WRITE or MB_CREAT.
+      * @return the file handle, or an error code as open().
+      */
+    int openFile(char const * filename, uint32_t flags);
+
+    /**
+      * Write back all state associated with the given file, as flush(). The caller must hold the lock.
+      *
+      * @param fd file descriptor - obtained with open().
+      * @return MICROBIT_OK on success, or an error code as flush().
+      */
+    int flushFile(int fd);
 
     /**
      * Determines if the given filename is a valid filename for use in MicroBitFileSystem. 
@@ -347,6 +780,13 @@ class MicroBitFileSystem
 
     static MicroBitFileSystem *defaultFileSystem;
 
+    /**
+      * Periodic callback from the idle thread.
+      * Requests that the writeback cache is written back to FLASH, once data has been held in it for MBFS_CACHE_TIMEOUT milliseconds,
+      * and that garbage collection is performed while there are DELETED blocks and no open files.
+      */
+    virtual void idleTick();
+
     /**
       * Constructor. Creates an instance of a MicroBitFileSystem.
       */
@@ -490,6 +930,33 @@ class MicroBitFileSystem
       */
     int read(int fd, uint8_t* buffer, int size);
 
+    /**
+      * Obtain direct access to the content of a file, with no copy into RAM.
+      *
+      * Provides the address of the data at the current seek position of the file, and the
+      * number of bytes that can be read from there. Consecutive blocks of the file that are
+      * adjacent in FLASH memory are returned as a single span. The seek position of the file
+      * handle is advanced past the span, so repeated calls visit each span of the file in turn.
+      *
+      * The data is read-only, and remains valid until the file is written to or removed.
+      *
+      * @param fd File handle, obtained with open()
+      * @param data Set to the address of the data at the current seek position.
+      * @return the number of bytes available at data on success, zero at the end of the file,
+      *         MICROBIT_NOT_SUPPORTED if the file system is not initialised, or
+      *         MICROBIT_INVALID_PARAMETER if the given file handle is invalid.
+      *
+      * @code
+      * MicroBitFileSystem f;
+      * const uint8_t *data;
+      * int fd = f.open("table.bin", MB_READ);
+      * int length;
+      * while ((length = f.map(fd, &data)) > 0)
+      *    process(data, length);
+      * @endcode
+      */
+    int map(int fd, const uint8_t **data);
+
     /**
       * Remove a file from the system, and free allocated assets
       * (including assigned blocks which are returned for use by other files).
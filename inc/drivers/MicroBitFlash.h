@@ -23,9 +23,37 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_FLASH_H_
 
 #include <mbed.h>
+#include "MicroBitFlashBackend.h"
 
 #define PAGE_SIZE 1024
 
+// Event codes raised by MicroBitFlash
+#define MICROBIT_FLASH_EVT_COMPLETE         1
+
+// MicroBitFlashRequest flags
+#define MICROBIT_FLASH_REQUEST_ERASE        0x01
+#define MICROBIT_FLASH_REQUEST_OWNED        0x02
+
+/**
+  * An erase or write operation in the flash request queue.
+  */
+struct MicroBitFlashRequest
+{
+    uint32_t *address;                  // The page to erase, or the first word to write.
+    uint32_t *data;                     // The words to write.
+    uint16_t length;                    // The number of words to write.
+    uint16_t ticket;                    // Identifies the request when waiting for it to complete.
+    uint8_t flags;                      // MICROBIT_FLASH_REQUEST_* flags. Owned requests and their data are freed once complete.
+    MicroBitFlashRequest *next;
+};
+
+/**
+  * Class definition for MicroBitFlash.
+  *
+  * Erases and writes the nRF51 flash. While the SoftDevice is running, operations are placed in a queue
+  * for the SoftDevice to perform between radio events, and the calling fiber sleeps until its operation
+  * completes, so other fibers continue to run.
+  */
 class MicroBitFlash
 {
     private:
@@ -42,7 +70,46 @@ class MicroBitFlash
       * @return non-zero if erase required, zero otherwise.
       */
     int need_erase(uint8_t* source, uint8_t* flash_addr, int len);
- 
+
+    // The backend that performs erase and write operations, or NULL to use the nRF51 flash.
+    static MicroBitFlashBackend *backend;
+
+    /**
+      * Performs a request immediately, either through the installed backend or by programming the NVMC directly.
+      * Addresses that the backend does not manage are in the nRF51 flash, and are programmed through the NVMC.
+      * The request must not be queued.
+      *
+      * @param request the request to perform.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_BUSY if the request is in the nRF51 flash and must be queued for the
+      *         SoftDevice, or the error returned by the backend.
+      */
+    int perform(MicroBitFlashRequest *request);
+
+    /**
+      * Submits a request to the flash request queue.
+      *
+      * Without the SoftDevice, or if the request is managed by the installed backend, the request is performed immediately
+      * once any queued requests have completed. Otherwise, it is queued for the SoftDevice to perform. A write that continues
+      * the write at the tail of the queue, within the same page, is merged into it.
+      *
+      * @param request the request to submit. If it is not owned, it must remain valid until it completes.
+      *
+      * @return the ticket of the request, for use with flash_wait().
+      */
+    int submit(MicroBitFlashRequest *request);
+
+    /**
+      * Waits for a queued request, and all those queued before it, to complete.
+      *
+      * @param ticket the ticket returned when the request was queued.
+      *
+      * @param yield true to let other fibers run while waiting, false to perform a spinning wait.
+      *
+      * @return MICROBIT_OK once the request has completed, or MICROBIT_CANCELLED if it failed and was abandoned.
+      */
+    int wait(int ticket, bool yield);
+
     public:
     /**
       * Default constructor.
@@ -72,8 +139,10 @@ class MicroBitFlash
     /**
       * Erase an entire page.
       * @param page_address address of first word of page.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the page could not be erased.
       */
-    void erase_page(uint32_t* page_address);
+    int erase_page(uint32_t* page_address);
 
     /**
       * Write to flash memory, assuming that a write is valid
@@ -83,8 +152,73 @@ class MicroBitFlash
       * 	Must be word aligned.
       * @param buffer address to write from, must be word-aligned.
       * @param len number of uint32_t words to write.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the words could not be written.
+      */
+    int flash_burn(uint32_t* page_address, uint32_t* buffer, int len);
+
+    /**
+      * Queues the erasure of an entire page, without waiting for it to complete.
+      *
+      * @param page_address address of first word of page.
+      *
+      * @return a ticket to pass to flash_wait(), or MICROBIT_NO_RESOURCES if the request could not be queued.
+      */
+    int erase_page_async(uint32_t* page_address);
+
+    /**
+      * Queues a write to flash memory, without waiting for it to complete. The data is copied,
+      * so the buffer may be reused immediately. Consecutive writes within a page are merged into
+      * a single operation.
+      *
+      * @param address address of memory to write to. Must be word aligned.
+      * @param buffer address to write from, must be word-aligned.
+      * @param len number of uint32_t words to write.
+      *
+      * @return a ticket to pass to flash_wait(), or MICROBIT_NO_RESOURCES if the request could not be queued.
+      */
+    int flash_burn_async(uint32_t* address, uint32_t* buffer, int len);
+
+    /**
+      * Waits for a queued request, and all those queued before it, to complete.
+      * The calling fiber sleeps until then, so other fibers continue to run.
+      * If the scheduler is not running, this call performs a spinning wait.
+      *
+      * @param ticket the ticket returned when the request was queued.
+      *
+      * @return MICROBIT_OK once the request has completed, or MICROBIT_CANCELLED if it failed and was abandoned.
+      *
+      * @code
+      * MicroBitFlash flash;
+      *
+      * int ticket = flash.erase_page_async(page);
+      *
+      * // do other work while the page is erased...
+      *
+      * flash.flash_wait(ticket);
+      * @endcode
+      */
+    int flash_wait(int ticket);
+
+    /**
+      * Installs a backend to perform all subsequent erase and write operations,
+      * in place of the nRF51 flash.
+      *
+      * @param backend The backend to use, or NULL to return to the nRF51 flash.
+      *
+      * @code
+      * MicroBitFlashSimulator simulator(region, 2);
+      * MicroBitFlash::setBackend(&simulator);
+      * @endcode
+      */
+    static void setBackend(MicroBitFlashBackend *backend);
+
+    /**
+      * Determines the backend in use.
+      *
+      * @return the backend installed with setBackend(), or NULL if the nRF51 flash is in use.
       */
-    void flash_burn(uint32_t* page_address, uint32_t* buffer, int len);
+    static MicroBitFlashBackend *getBackend();
 
 };
 
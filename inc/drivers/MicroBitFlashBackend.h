@@ -0,0 +1,75 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_FLASH_BACKEND_H
+#define MICROBIT_FLASH_BACKEND_H
+
+#include "mbed.h"
+
+/**
+  * Class definition for a MicroBitFlashBackend.
+  *
+  * A MicroBitFlashBackend performs the page erase and word write operations on behalf of MicroBitFlash.
+  * By default MicroBitFlash programs the nRF51 flash directly, or through the SoftDevice when BLE is running.
+  * A backend installed with MicroBitFlash::setBackend() replaces this for the addresses it manages, for example
+  * to simulate flash in RAM. Operations on any other address are still performed on the nRF51 flash.
+  *
+  * Flash is always read directly from memory, so a backend must leave the result of each operation
+  * visible at the address it was given.
+  */
+class MicroBitFlashBackend
+{
+    public:
+
+    /**
+      * Erase an entire page, setting every bit in it to 1.
+      *
+      * @param page_address address of the first word of the page.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the page is not managed by this backend.
+      */
+    virtual int erasePage(uint32_t *page_address) = 0;
+
+    /**
+      * Program words of flash. Programming can only clear bits, so each word written becomes the logical AND
+      * of its previous and new values.
+      *
+      * @param address address of the first word to write. Must be word aligned.
+      *
+      * @param buffer address to write from. Must be word aligned.
+      *
+      * @param len number of uint32_t words to write.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the words are not managed by this backend.
+      */
+    virtual int write(uint32_t *address, uint32_t *buffer, int len) = 0;
+
+    /**
+      * Destructor.
+      */
+    virtual ~MicroBitFlashBackend() {}
+};
+
+#endif
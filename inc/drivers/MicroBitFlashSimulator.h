@@ -0,0 +1,229 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_FLASH_SIMULATOR_H
+#define MICROBIT_FLASH_SIMULATOR_H
+
+#include "mbed.h"
+#include "MicroBitConfig.h"
+#include "MicroBitFlash.h"
+#include "MicroBitFlashBackend.h"
+
+// Status flags
+#define MICROBIT_FLASH_SIMULATOR_POWERED_DOWN       0x01
+#define MICROBIT_FLASH_SIMULATOR_REAL_TIME          0x02
+
+/**
+  * Class definition for a MicroBitFlashSimulator.
+  *
+  * Simulates flash memory in a region of RAM, so that flash based code such as MicroBitFileSystem can be measured
+  * and tested without wearing the real flash. Like the nRF51 flash, the region is erased a page at a time, and
+  * programming can only clear bits. Writes that would need to set a bit are counted as violations.
+  *
+  * The time taken by each operation can be modelled, and power can be made to fail part way through an operation,
+  * to test recovery after a reset. The number of words written and pages erased are recorded, including the
+  * number of times each page has been erased.
+  *
+  * @code
+  * static uint32_t region[2 * PAGE_SIZE / 4] __attribute__((aligned(PAGE_SIZE)));
+  *
+  * MicroBitFlashSimulator simulator(region, 2);
+  * MicroBitFlash::setBackend(&simulator);
+  *
+  * MicroBitFileSystem fs((uint32_t)region, 2);
+  * @endcode
+  */
+class MicroBitFlashSimulator : public MicroBitFlashBackend
+{
+    // The simulated flash. Must be aligned on a page boundary.
+    uint32_t *base;
+    int pages;
+
+    uint8_t status;
+
+    // The number of operations remaining before power is lost, or -1 if no power loss is scheduled.
+    int powerLossAfter;
+
+    // The modelled time of a page erase and a word write, in microseconds.
+    uint32_t eraseTime;
+    uint32_t writeTime;
+
+    // Statistics.
+    uint32_t busyTime;
+    uint32_t erases;
+    uint32_t wordsWritten;
+    uint32_t violations;
+    uint16_t *eraseCounts;
+
+    /**
+      * Accounts for the time taken by an operation, and blocks for that time if running in real time.
+      *
+      * @param time The time taken, in microseconds.
+      */
+    void busy(uint32_t time);
+
+    /**
+      * Determines if power is lost during the next operation, and updates the scheduled power loss.
+      *
+      * @return true if power is lost during the operation, false otherwise.
+      */
+    bool losePower();
+
+    public:
+
+    /**
+      * Constructor.
+      *
+      * Create a simulated flash over a region of RAM. The content of the region is preserved,
+      * so a region can be reused to simulate a restart.
+      *
+      * @param base The start of the region. Must be aligned on a page boundary.
+      *
+      * @param pages The number of pages in the region.
+      */
+    MicroBitFlashSimulator(uint32_t *base, int pages);
+
+    /**
+      * Erase an entire page, setting every bit in it to 1.
+      *
+      * @param page_address address of the first word of the page.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the page is not in the simulated region.
+      */
+    virtual int erasePage(uint32_t *page_address);
+
+    /**
+      * Program words of flash. Programming can only clear bits, so each word written becomes the logical AND
+      * of its previous and new values.
+      *
+      * @param address address of the first word to write. Must be word aligned.
+      *
+      * @param buffer address to write from. Must be word aligned.
+      *
+      * @param len number of uint32_t words to write.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the words are not in the simulated region.
+      */
+    virtual int write(uint32_t *address, uint32_t *buffer, int len);
+
+    /**
+      * Sets the time modelled for each operation.
+      *
+      * @param eraseTime The time taken to erase a page, in microseconds.
+      *
+      * @param writeTime The time taken to write a word, in microseconds.
+      *
+      * @param realTime If true, each operation blocks for the time modelled. Otherwise, the time is only recorded.
+      *
+      * @code
+      * // The typical timings of the nRF51.
+      * simulator.setLatency(22300, 46);
+      * @endcode
+      */
+    void setLatency(uint32_t eraseTime, uint32_t writeTime, bool realTime = false);
+
+    /**
+      * Schedules a loss of power. Power is lost part way through the given operation: a word being written
+      * has only some of its bits programmed, and a page being erased is only partly erased. No further
+      * operations have any effect until powerUp() is called.
+      *
+      * @param operations The number of page erase or word write operations that complete before power is lost,
+      *                   or -1 to cancel a scheduled power loss.
+      *
+      * @code
+      * simulator.losePowerAfter(10);
+      * fs.write(fd, data, 4);
+      *
+      * if (simulator.isPoweredDown())
+      * {
+      *     simulator.powerUp();
+      *     MicroBitFileSystem recovered((uint32_t)region, 2);
+      * }
+      * @endcode
+      */
+    void losePowerAfter(int operations);
+
+    /**
+      * Determines if a scheduled power loss has occurred.
+      *
+      * @return true if power has been lost, false otherwise.
+      */
+    bool isPoweredDown();
+
+    /**
+      * Restores power after a simulated power loss.
+      */
+    void powerUp();
+
+    /**
+      * Determines the total time modelled for all operations since the statistics were reset.
+      *
+      * @return the time, in microseconds.
+      */
+    uint32_t getBusyTime();
+
+    /**
+      * Determines the number of page erases since the statistics were reset.
+      *
+      * @return the number of erases.
+      */
+    uint32_t getEraseCount();
+
+    /**
+      * Determines the number of times a page has been erased since the statistics were reset.
+      *
+      * @param page The index of the page in the simulated region.
+      *
+      * @return the number of erases, or MICROBIT_INVALID_PARAMETER if the page is not in the simulated region.
+      */
+    int getEraseCount(int page);
+
+    /**
+      * Determines the number of words written since the statistics were reset.
+      *
+      * @return the number of words written.
+      */
+    uint32_t getWordsWritten();
+
+    /**
+      * Determines the number of words written since the statistics were reset that would have needed
+      * a bit to be set from 0 to 1, without the page being erased first.
+      *
+      * @return the number of violations.
+      */
+    uint32_t getViolations();
+
+    /**
+      * Resets all statistics to zero.
+      */
+    void resetStatistics();
+
+    /**
+      * Destructor.
+      */
+    ~MicroBitFlashSimulator();
+};
+
+#endif
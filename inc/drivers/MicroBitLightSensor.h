@@ -39,12 +39,38 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_LIGHT_SENSOR_MAX_VALUE     338
 #define MICROBIT_LIGHT_SENSOR_MIN_VALUE     75
 
+// The default time between samples of each section of the display, in milliseconds.
+#define MICROBIT_LIGHT_SENSOR_DEFAULT_PERIOD 40
+
+// The time after the light level was last read that the sensor continues sampling, in milliseconds.
+#define MICROBIT_LIGHT_SENSOR_ACTIVE_WINDOW 2000
+
+// The weight given to each new reading by the output filter, as a power of two (i.e. 1/4).
+#define MICROBIT_LIGHT_SENSOR_FILTER_SHIFT  2
+
+/**
+  * Status flags
+  */
+#define MICROBIT_LIGHT_SENSOR_SUBSCRIBED    0x01
+#define MICROBIT_LIGHT_SENSOR_HAS_READING   0x02
+#define MICROBIT_LIGHT_SENSOR_CHECK_LISTENERS 0x04
+#define MICROBIT_LIGHT_SENSOR_SENSING       0x08
+
+/**
+  * Event codes raised by MicroBitLightSensor
+  */
+#define MICROBIT_LIGHT_SENSOR_EVT_UPDATE    1
+
 /**
   * Class definition for MicroBitLightSensor.
   *
   * This is an object that interleaves light sensing with MicroBitDisplay.
+  *
+  * Sensing is on demand: the display only gives up a row period to the sensor when a sample is due,
+  * and only while the light level has been read recently, or something is listening for
+  * MICROBIT_LIGHT_SENSOR_EVT_UPDATE events.
   */
-class MicroBitLightSensor
+class MicroBitLightSensor : public MicroBitComponent
 {
 
     //contains the results from each section of the display
@@ -56,8 +82,23 @@ class MicroBitLightSensor
     //a Timeout which triggers our analogReady() call
     Timeout analogTrigger;
 
-    //a pointer the currently sensed pin, represented as an AnalogIn
-    AnalogIn* sensePin;
+    //for each channel, the ADC configuration that selects its column pin as the analog input
+    uint32_t adcConfig[MICROBIT_LIGHT_SENSOR_CHAN_NUM];
+
+    //the GPIO bits of the rows of the display
+    uint32_t rowMask;
+
+    //the filtered light level, in the range 0 - 255, scaled up by MICROBIT_LIGHT_SENSOR_FILTER_SHIFT bits
+    uint16_t level;
+
+    //the time between samples, in milliseconds
+    uint16_t samplePeriod;
+
+    //the time at which the next sample is due
+    uint64_t sampleTime;
+
+    //the time at which sampling stops, unless the light level is read again
+    uint64_t activeUntil;
 
     const MatrixMap &matrixMap;
 
@@ -65,13 +106,13 @@ class MicroBitLightSensor
       * After the startSensing method has been called, this method will be called
       * MICROBIT_LIGHT_SENSOR_AN_SET_TIME after.
       *
-      * It will then read from the currently selected channel using the AnalogIn
-      * that was configured in the startSensing method.
+      * It will then read from the currently selected channel using the ADC
+      * configuration that was selected in the startSensing method.
       */
     void analogReady();
 
     /**
-      * Forcibly disables the AnalogIn, otherwise it will remain in possession
+      * Forcibly disables the ADC, otherwise it will remain in possession
       * of the GPIO channel it is using, meaning that the display will not be
       * able to use a channel (COL).
       *
@@ -81,6 +122,26 @@ class MicroBitLightSensor
       */
     void analogDisable();
 
+    /**
+      * Calculates the light level from the most recent result of each section of the display.
+      *
+      * @return a value in the range 0 - 255 where 0 is dark, and 255 is very bright
+      */
+    int calculateLevel();
+
+    /**
+      * Determines if anything is listening for MICROBIT_LIGHT_SENSOR_EVT_UPDATE events.
+      *
+      * @return true if there is a listener, false otherwise.
+      */
+    bool hasListeners();
+
+    /**
+      * The method that is invoked when a listener is added to the default EventModel.
+      * Starts sampling if the listener is for light sensor events.
+      */
+    void onListenerRegisteredEvent(MicroBitEvent evt);
+
     public:
 
     /**
@@ -94,7 +155,7 @@ class MicroBitLightSensor
     MicroBitLightSensor(const MatrixMap &map);
 
     /**
-      * This method returns a summed average of the three sections of the display.
+      * This method returns a filtered, summed average of the three sections of the display.
       *
       * A section is defined as:
       *  ___________________
@@ -111,11 +172,49 @@ class MicroBitLightSensor
       *
       * Where each number represents a different section on the 5 x 5 matrix display.
       *
+      * Reading the light level keeps the sensor sampling for MICROBIT_LIGHT_SENSOR_ACTIVE_WINDOW milliseconds.
+      *
       * @return returns a value in the range 0 - 255 where 0 is dark, and 255
       * is very bright
+      *
+      * @note this will return 0 until the sensor has sampled every section of the display.
       */
     int read();
 
+    /**
+      * Set the time between samples of each section of the display, in milliseconds.
+      *
+      * Each sample takes a row period from the display, so longer periods give a brighter,
+      * smoother display at the expense of a slower response to changes in light level.
+      *
+      * @param period the requested time between samples, in milliseconds.
+      *
+      * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER if the period is not in the range 1 - 65535.
+      */
+    int setPeriod(int period);
+
+    /**
+      * Reads the currently configured sample period of the light sensor.
+      *
+      * @return The time between samples, in milliseconds.
+      */
+    int getPeriod();
+
+    /**
+      * Determines if the sensor is due to take a sample, and if so, schedules the one after it.
+      * Called by the display at the point in its refresh cycle where a sample could be taken.
+      *
+      * @return true if the display should give the next row period to the sensor, false otherwise.
+      */
+    bool isSampleNeeded();
+
+    /**
+      * Determines if the sensor is taking a sample. The display must not drive the LED matrix until it has finished.
+      *
+      * @return true if a column of the display is being sensed, false otherwise.
+      */
+    bool isSensing();
+
     /**
       * The method that is invoked by sending MICROBIT_DISPLAY_EVT_LIGHT_SENSE
       * using the id MICROBIT_ID_DISPLAY.
@@ -126,10 +225,18 @@ class MicroBitLightSensor
       */
     void startSensing(MicroBitEvent);
 
+    /**
+      * A periodic callback invoked by the fiber scheduler idle thread.
+      *
+      * Checks whether anything is still listening for MICROBIT_LIGHT_SENSOR_EVT_UPDATE events, when
+      * asked to by isSampleNeeded(). The listener list cannot be walked safely from interrupt context.
+      */
+    virtual void idleTick();
+
     /**
       * A destructor for MicroBitLightSensor.
       *
-      * The destructor removes the listener, used by MicroBitLightSensor from the default EventModel.
+      * The destructor removes the listeners, used by MicroBitLightSensor from the default EventModel.
       */
     ~MicroBitLightSensor();
 };
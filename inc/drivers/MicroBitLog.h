@@ -0,0 +1,231 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_LOG_H
+#define MICROBIT_LOG_H
+
+#include "mbed.h"
+#include "MicroBitConfig.h"
+#include "MicroBitFlash.h"
+#include "MicroBitFiberLock.h"
+#include "ErrorNo.h"
+
+#define MICROBIT_LOG_MAGIC                  0x4C47
+
+// Constructor flags
+#define MICROBIT_LOG_RING                   0x01
+
+// The byte at the start of an unwritten record, or of the padding to the next word.
+#define MICROBIT_LOG_UNUSED                 0xFF
+
+// The largest record that can be appended: a page, less the page header, the CRC and a two byte length.
+#define MICROBIT_LOG_MAX_RECORD_SIZE        (PAGE_SIZE - sizeof(MicroBitLogPageHeader) - 4)
+
+/**
+  * The header at the start of each page of the log.
+  */
+struct MicroBitLogPageHeader
+{
+    uint32_t sequence;          // Incremented for each page started, so the newest page has the highest sequence.
+    uint16_t recordSize;        // The size of every record, or zero if records are of variable length.
+    uint16_t magic;             // MICROBIT_LOG_MAGIC once the header has been written.
+};
+
+/**
+  * Class definition for MicroBitLog.
+  *
+  * An append only log of records, held in a region of FLASH memory of its own, for logging data at a high rate.
+  * Unlike a file, appending a record updates no metadata: the end of the log is found when it is loaded, by scanning
+  * its newest page. Records are built up in a page sized buffer in RAM, and written to FLASH when the page is full,
+  * or when flush() is called. Records not yet written to FLASH are lost on a reset.
+  *
+  * Each record is preceded by a CRC, and, if the log was created for variable length records, its length as a varint.
+  * Records torn by a loss of power fail the CRC check, and are skipped. Once full, a log either refuses further
+  * records, or, in ring mode, erases its oldest page to make room.
+  *
+  * |----------8------------|--2--|--1 or 2--|---length---|-----|
+  * | MicroBitLogPageHeader | CRC | (length) |   record   | ... |
+  * |-----------------------|-----|----------|------------|-----|
+  *
+  * The region must not overlap that of any MicroBitFileSystem, which must then be given fewer pages.
+  *
+  * @code
+  * MicroBitLog log(DEFAULT_SCRATCH_PAGE - 16 * PAGE_SIZE, 16, 6, MICROBIT_LOG_RING);
+  *
+  * int16_t sample[3] = { x, y, z };
+  * log.append((uint8_t *)sample, 6);
+  * @endcode
+  */
+class MicroBitLog
+{
+    // The instance of MicroBitFlash - the interface used for all flash writes/erasures
+    MicroBitFlash flash;
+
+    // Held by the fiber appending to or clearing the log, as either may block while FLASH is written.
+    MicroBitFiberLock lock;
+
+    // The region of FLASH memory holding the log. Must be aligned on a page boundary.
+    uint32_t *base;
+    uint16_t pages;
+
+    // The size of every record, or zero for variable length records, and the MICROBIT_LOG_* flags.
+    uint16_t recordSize;
+    uint8_t flags;
+
+    // The sequence of the newest page.
+    uint32_t sequence;
+
+    // The oldest and newest (current) pages of the log, or -1 if the log is empty.
+    int oldest;
+    int current;
+
+    // A copy of the current page, the number of bytes of it written to FLASH, and the number of bytes in use.
+    uint32_t *buffer;
+    uint16_t written;
+    uint16_t end;
+
+    // The position of the next record to be read: its page, the sequence of that page, and the offset within it.
+    int readPage;
+    uint32_t readSequence;
+    uint16_t readOffset;
+
+    /**
+      * Determines the address of a page of the log.
+      *
+      * @param page The page number.
+      *
+      * @return The address of the page.
+      */
+    uint32_t *getPage(int page);
+
+    /**
+      * Locates the oldest and newest pages of the log, and the end of the newest page.
+      * If the log was created with a different record size, it is cleared.
+      */
+    void load();
+
+    /**
+      * Decodes the record at the given offset in a page.
+      *
+      * @param page The content of the page.
+      *
+      * @param offset The offset of the record. Updated to the offset of the next record, skipping any padding.
+      *
+      * @param length Set to the length of the record.
+      *
+      * @return The offset of the data of the record, MICROBIT_NO_DATA if there are no more records in the page,
+      *         or MICROBIT_INVALID_PARAMETER if the record is corrupt. No records follow a corrupt record in its page.
+      */
+    int decode(const uint8_t *page, uint16_t &offset, int &length);
+
+    /**
+      * Writes the buffered records of the current page to FLASH.
+      * The next record begins on a word boundary, so no word is written twice.
+      */
+    void writeBuffer();
+
+    /**
+      * Writes the current page to FLASH, and begins the next page, erasing the oldest page if in ring mode.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if the log is full.
+      */
+    int nextPage();
+
+    public:
+
+    /**
+      * Constructor.
+      *
+      * Creates an instance of MicroBitLog over the given region of FLASH memory, loading the records already there.
+      *
+      * @param flashStart The address of the first page of the region. Must be aligned on a page boundary.
+      *
+      * @param flashPages The number of pages in the region.
+      *
+      * @param recordSize The size of every record, or zero for records of variable length. Defaults to zero.
+      *
+      * @param flags MICROBIT_LOG_RING to erase the oldest records when the log is full. Defaults to zero.
+      */
+    MicroBitLog(uint32_t flashStart, int flashPages, int recordSize = 0, int flags = 0);
+
+    /**
+      * Appends a record to the log. The record is held in RAM until its page is full or flush() is called.
+      *
+      * @param data The record.
+      *
+      * @param length The length of the record, which must be the record size of a log of fixed size records.
+      *
+      * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the length is invalid,
+      *         or MICROBIT_NO_RESOURCES if the log is full and not in ring mode.
+      */
+    int append(const uint8_t *data, int length);
+
+    /**
+      * Writes any records held in RAM to FLASH.
+      *
+      * @return MICROBIT_OK on success.
+      */
+    int flush();
+
+    /**
+      * Moves the read position to the oldest record in the log.
+      *
+      * @return MICROBIT_OK on success.
+      */
+    int rewind();
+
+    /**
+      * Reads the record at the read position, and moves on to the next. If the record being read has been erased
+      * to make room in ring mode, reading continues from the oldest record.
+      *
+      * @param buffer The buffer to read the record into.
+      *
+      * @param size The size of the buffer. Longer records are truncated.
+      *
+      * @return The length of the record, or MICROBIT_NO_DATA if there are no more records.
+      */
+    int read(uint8_t *buffer, int size);
+
+    /**
+      * Erases every record in the log.
+      *
+      * @return MICROBIT_OK on success.
+      */
+    int clear();
+
+    /**
+      * Determines the number of pages of the log holding records.
+      *
+      * @return The number of pages in use.
+      */
+    int getPagesUsed();
+
+    /**
+      * Destructor. Writes any records held in RAM to FLASH.
+      */
+    ~MicroBitLog();
+};
+
+#endif
@@ -109,7 +109,7 @@ class MicroBitRadioDatagram
       * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the buffer is invalid,
       *         or the number of bytes to transmit is greater than `MICROBIT_RADIO_MAX_PACKET_SIZE + MICROBIT_RADIO_HEADER_SIZE`.
       */
-    int send(PacketBuffer data);
+    int send(const PacketBuffer &data);
 
     /**
       * Transmits the given string onto the broadcast radio.
@@ -122,7 +122,7 @@ class MicroBitRadioDatagram
       * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the buffer is invalid,
       *         or the number of bytes to transmit is greater than `MICROBIT_RADIO_MAX_PACKET_SIZE + MICROBIT_RADIO_HEADER_SIZE`.
       */
-    int send(ManagedString data);
+    int send(const ManagedString &data);
 
     /**
       * Protocol handler callback. This is called when the radio receives a packet marked as a datagram.
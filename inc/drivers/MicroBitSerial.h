@@ -28,6 +28,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include "mbed.h"
 #include "ManagedString.h"
+#include "ManagedStringBuilder.h"
 
 #define MICROBIT_SERIAL_DEFAULT_BAUD_RATE   115200
 #define MICROBIT_SERIAL_DEFAULT_BUFFER_SIZE 20
@@ -269,7 +270,34 @@ class MicroBitSerial : public RawSerial
       *         is using the serial instance for transmission, MICROBIT_INVALID_PARAMETER
       *         if buffer is invalid, or the given bufferLen is <= 0.
       */
-    int send(ManagedString s, MicroBitSerialMode mode = MICROBIT_DEFAULT_SERIAL_MODE);
+    int send(const ManagedString &s, MicroBitSerialMode mode = MICROBIT_DEFAULT_SERIAL_MODE);
+
+    /**
+      * Sends the string held by a ManagedStringBuilder over the serial line, directly from its buffer.
+      * The content of the ManagedStringBuilder is not changed.
+      *
+      * @param b the ManagedStringBuilder holding the string to send.
+      *
+      * @param mode the selected mode, one of: ASYNC, SYNC_SPINWAIT, SYNC_SLEEP. Each mode
+      *        gives a different behaviour:
+      *
+      *            ASYNC - bytes are copied into the txBuff and returns immediately.
+      *
+      *            SYNC_SPINWAIT - bytes are copied into the txBuff and this method
+      *                            will spin (lock up the processor) until all bytes
+      *                            have been sent.
+      *
+      *            SYNC_SLEEP - bytes are copied into the txBuff and the fiber sleeps
+      *                         until all bytes have been sent. This allows other fibers
+      *                         to continue execution.
+      *
+      *         Defaults to SYNC_SLEEP.
+      *
+      * @return the number of bytes written, MICROBIT_SERIAL_IN_USE if another fiber
+      *         is using the serial instance for transmission, MICROBIT_INVALID_PARAMETER
+      *         if buffer is invalid, or the given bufferLen is <= 0.
+      */
+    int send(const ManagedStringBuilder &b, MicroBitSerialMode mode = MICROBIT_DEFAULT_SERIAL_MODE);
 
     /**
       * Sends a buffer of known length over the serial line.
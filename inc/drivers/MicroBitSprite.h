@@ -0,0 +1,195 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_SPRITE_H
+#define MICROBIT_SPRITE_H
+
+#include "mbed.h"
+#include "MicroBitConfig.h"
+#include "MicroBitImage.h"
+
+/**
+  * Status flags for MicroBitSprite
+  */
+#define MICROBIT_SPRITE_VISIBLE         0x01
+#define MICROBIT_SPRITE_ALPHA           0x02
+#define MICROBIT_SPRITE_CHANGED         0x04
+#define MICROBIT_SPRITE_REORDER         0x08
+#define MICROBIT_SPRITE_ADDED           0x10
+
+/**
+  * Class definition for a MicroBitSprite.
+  *
+  * A MicroBitSprite is an image placed at a position on the display, at a given depth.
+  * Sprites are added to a MicroBitDisplay, which composites them into its image whenever one of them changes.
+  * Sprites can also be given a velocity, in which case the display moves them as time passes.
+  *
+  * @code
+  * MicroBitSprite ball(MicroBitImage("255\n"), 0, 2);
+  * ball.setVelocity(1, 0, 200); // move one pixel right every 200ms
+  * display.addSprite(ball);
+  * @endcode
+  */
+class MicroBitSprite
+{
+    friend class MicroBitDisplay;
+
+    MicroBitImage image;        // The bitmap of this sprite.
+    int16_t x;                  // The position of the top left of the sprite on the display.
+    int16_t y;
+    int8_t vx;                  // The number of pixels the sprite moves in each step.
+    int8_t vy;
+    uint16_t period;            // The time between steps, in milliseconds. Zero if the sprite is stationary.
+    uint16_t tick;              // The time since the last step, in milliseconds.
+    uint8_t z;                  // The depth of the sprite. Sprites with a higher z are drawn over those with a lower z.
+    volatile uint8_t flags;     // MICROBIT_SPRITE_* flags.
+    MicroBitSprite *next;       // The sprite above this one on the display it is added to.
+
+    /**
+      * Updates the flags of this sprite.
+      *
+      * The display also updates the flags from interrupt context, so this is done with interrupts disabled.
+      *
+      * @param set The flags to set.
+      *
+      * @param clear The flags to clear.
+      */
+    void updateFlags(uint8_t set, uint8_t clear);
+
+    public:
+
+    /**
+      * Constructor.
+      *
+      * Create a sprite from the given image. The sprite is visible, but is not shown until it is added to a display.
+      *
+      * @param image The bitmap of the sprite.
+      *
+      * @param x The horizontal position of the sprite on the display. Defaults to 0.
+      *
+      * @param y The vertical position of the sprite on the display. Defaults to 0.
+      *
+      * @param z The depth of the sprite. Sprites with a higher z are drawn over those with a lower z. Defaults to 0.
+      *
+      * @param alpha true if clear pixels in the image should be treated as transparent, false otherwise. Defaults to true.
+      */
+    MicroBitSprite(const MicroBitImage &image, int16_t x = 0, int16_t y = 0, uint8_t z = 0, bool alpha = true);
+
+    /**
+      * Replaces the bitmap of this sprite.
+      *
+      * @param image The new bitmap of the sprite.
+      */
+    void setImage(const MicroBitImage &image);
+
+    /**
+      * Retrieves the bitmap of this sprite.
+      *
+      * If the bitmap is modified in place, call invalidate() to have the change shown.
+      *
+      * @return the bitmap of this sprite.
+      */
+    MicroBitImage getImage();
+
+    /**
+      * Moves this sprite to the given position.
+      *
+      * @param x The new horizontal position of the sprite on the display.
+      *
+      * @param y The new vertical position of the sprite on the display.
+      */
+    void moveTo(int16_t x, int16_t y);
+
+    /**
+      * Retrieves the horizontal position of this sprite.
+      *
+      * @return the horizontal position of this sprite on the display.
+      */
+    int getX();
+
+    /**
+      * Retrieves the vertical position of this sprite.
+      *
+      * @return the vertical position of this sprite on the display.
+      */
+    int getY();
+
+    /**
+      * Sets the velocity of this sprite. The display moves the sprite by (vx, vy) pixels every period milliseconds.
+      *
+      * @param vx The number of pixels to move right in each step. Negative values move left.
+      *
+      * @param vy The number of pixels to move down in each step. Negative values move up.
+      *
+      * @param period The time between steps, in milliseconds. Zero stops the sprite.
+      *
+      * @code
+      * sprite.setVelocity(-1, 0, 100); // move left ten pixels per second
+      * @endcode
+      */
+    void setVelocity(int8_t vx, int8_t vy, uint16_t period);
+
+    /**
+      * Changes the depth of this sprite.
+      *
+      * @param z The depth of the sprite. Sprites with a higher z are drawn over those with a lower z.
+      */
+    void setZ(uint8_t z);
+
+    /**
+      * Retrieves the depth of this sprite.
+      *
+      * @return the depth of this sprite.
+      */
+    int getZ();
+
+    /**
+      * Shows or hides this sprite.
+      *
+      * @param visible true to show the sprite, false to hide it.
+      */
+    void setVisible(bool visible);
+
+    /**
+      * Determines if this sprite is visible.
+      *
+      * @return true if this sprite is visible, false otherwise.
+      */
+    bool isVisible();
+
+    /**
+      * Determines if clear pixels in this sprite are drawn, or treated as transparent.
+      *
+      * @param alpha true if clear pixels should be treated as transparent, false otherwise.
+      */
+    void setAlpha(bool alpha);
+
+    /**
+      * Indicates that the bitmap of this sprite has been modified in place, and should be redrawn.
+      */
+    void invalidate();
+};
+
+#endif
@@ -32,6 +32,7 @@ DEALINGS IN THE SOFTWARE.
 #include "ErrorNo.h"
 
 #define MICROBIT_STORAGE_MAGIC       0xCAFE
+#define MICROBIT_STORAGE_LOG_MAGIC   0xCAFE0003
 
 #define MICROBIT_STORAGE_BLOCK_SIZE             48
 #define MICROBIT_STORAGE_KEY_SIZE               16
@@ -40,12 +41,25 @@ DEALINGS IN THE SOFTWARE.
 #define MICROBIT_STORAGE_STORE_PAGE_OFFSET      17      //Use the page just above the BLE Bond Data.
 #define MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET    19      //Use the page just below the BLE Bond Data.
 
+// The number of entries in the RAM index of keys. Must be a power of two, larger than the number of keys a page can hold.
+#define MICROBIT_STORAGE_INDEX_SIZE             32
+
+// KeyValueRecord flags
+#define MICROBIT_STORAGE_RECORD_REMOVED         0x0001
+
+// The sequence number of a record that has not been written.
+#define MICROBIT_STORAGE_RECORD_UNUSED          0xFFFFFFFF
+
 struct KeyValuePair
 {
     uint8_t key[MICROBIT_STORAGE_KEY_SIZE];
     uint8_t value[MICROBIT_STORAGE_VALUE_SIZE];
 };
 
+/**
+  * The header of the legacy storage format, where the store page held a KeyValueStore followed by size KeyValuePairs.
+  * Stores in this format are migrated to the log when first loaded.
+  */
 struct KeyValueStore
 {
     uint32_t magic;
@@ -64,6 +78,26 @@ struct KeyValueStore
     }
 };
 
+/**
+  * The header of a log page.
+  */
+struct KeyValueLogHeader
+{
+    uint32_t magic;             // MICROBIT_STORAGE_LOG_MAGIC once the page is complete.
+    uint32_t generation;        // Incremented each time the log is compacted into the other page. The highest generation is current.
+    uint32_t pairs;             // The number of KeyValuePairs compacted into the page, between the header and the first record.
+};
+
+/**
+  * A single version of a KeyValuePair, as appended to the log.
+  */
+struct KeyValueRecord
+{
+    uint32_t sequence;          // Incremented for every record written, so later versions of a key always have higher sequence numbers.
+    uint16_t flags;             // MICROBIT_STORAGE_RECORD_* flags.
+    uint16_t crc;               // CRC16 of the sequence, flags and pair, to detect records torn by a reset or power loss.
+    KeyValuePair pair;
+};
 
 /**
   * Class definition for the MicroBitStorage class.
@@ -72,19 +106,44 @@ struct KeyValueStore
   * This class operates as a key value store, it allows the retrieval, addition
   * and deletion of KeyValuePairs.
   *
-  * The first 8 bytes are reserved for the KeyValueStore struct which gives core
-  * information such as the number of KeyValuePairs in the store, and whether the
-  * store has been initialised.
+  * The store is an append only log, held in one of two flash pages. Each put or remove appends
+  * a new KeyValueRecord to the log, so updating a value costs a single record write rather than
+  * rewriting the page. When the page fills, the latest value of each key, including the update
+  * that did not fit, is compacted into the other page as a plain KeyValuePair, and that page
+  * becomes the log.
   *
-  * After the KeyValueStore struct, KeyValuePairs are arranged contiguously until
-  * the end of the block used as persistent storage.
+  * |---------12--------|------48------|-----|------48------|--------56--------|-----|--------56--------|
+  * | KeyValueLogHeader | KeyValuePair | ... | KeyValuePair | KeyValueRecord 0 | ... | KeyValueRecord N |
+  * |-------------------|--------------|-----|--------------|------------------|-----|------------------|
   *
-  * |-------8-------|--------48-------|-----|---------48--------|
-  * | KeyValueStore | KeyValuePair[0] | ... | KeyValuePair[N-1] |
-  * |---------------|-----------------|-----|-------------------|
+  * A RAM index maps the hash of each key to its latest version, so get() does not scan the log.
+  *
+  * Every instance operates on the same pages, so the state of the store is shared between them.
   */
 class MicroBitStorage
 {
+    // The page holding the log, and the page it is compacted into when full.
+    static uint32_t *logPage;
+    static uint32_t *sparePage;
+
+    // The generation of the log page.
+    static uint32_t generation;
+
+    // The sequence number of the next record to be written.
+    static uint32_t sequence;
+
+    // The byte offsets of the first record, and of the first unused record, in the log page.
+    static uint16_t logStart;
+    static uint16_t logEnd;
+
+    // The number of keys that have not been removed.
+    static uint16_t keys;
+
+    // Open addressed hash table of the keys in the log: the hash of each key, and the byte offset of the KeyValuePair holding its
+    // latest version (0 if unused).
+    static uint16_t indexHash[MICROBIT_STORAGE_INDEX_SIZE];
+    static uint16_t indexOffset[MICROBIT_STORAGE_INDEX_SIZE];
+
     /**
       * Function for copying words from one location to another.
       *
@@ -93,26 +152,84 @@ class MicroBitStorage
       * @param to the address to copy the data to.
       *
       * @param sizeInWords the number of words to copy
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the words could not be written.
+      */
+    int flashCopy(uint32_t* from, uint32_t* to, int sizeInWords);
+
+    /**
+      * Locates the log page, migrating a store in the legacy format or creating an empty log if there is none,
+      * and builds the index of the keys in it.
+      */
+    void load();
+
+    /**
+      * Writes the header of a log page. The magic is written last, so the page only becomes a log once it is complete.
+      *
+      * @param page The page to write the header of.
+      *
+      * @param generation The generation of the log.
+      *
+      * @param pairs The number of KeyValuePairs compacted into the page.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the header could not be written.
+      */
+    int writeHeader(uint32_t *page, uint32_t generation, uint32_t pairs);
+
+    /**
+      * Rebuilds the index, the number of keys, and the end of the log by scanning the log page.
+      * Records that fail their CRC check are skipped.
+      */
+    void buildIndex();
+
+    /**
+      * Determines the latest version of a key from its offset in the log page.
+      *
+      * @param offset The byte offset of a KeyValuePair in the log page, as held in the index.
+      *
+      * @return The KeyValuePair at that offset, or NULL if the offset is unused or records the removal of the key.
+      */
+    KeyValuePair* pairAt(uint16_t offset);
+
+    /**
+      * Finds the entry in the index for the given key.
+      *
+      * @param key The key to look up. The key is presumed to be null terminated.
+      *
+      * @param hash The hash of the key.
+      *
+      * @return The position of the entry for the key in the index, or of the unused entry where it should be added.
       */
-    void flashCopy(uint32_t* from, uint32_t* to, int sizeInWords);
+    int findEntry(const char *key, uint16_t hash);
 
     /**
-      * Function for populating the scratch page with a KeyValueStore.
+      * Appends a record to the log, and updates the index. If the log is full, it is compacted instead, with the record applied.
       *
-      * @param store the KeyValueStore struct to write to the scratch page.
+      * @param pair The KeyValuePair to record.
+      *
+      * @param flags MICROBIT_STORAGE_RECORD_* flags for the record.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the record could not be written.
       */
-    void scratchKeyValueStore(KeyValueStore store);
+    int append(KeyValuePair &pair, uint16_t flags);
 
     /**
-      * Function for populating the scratch page with a KeyValuePair.
+      * Copies the latest value of each key that has not been removed into the spare page, and makes it the log page.
+      *
+      * @param pair A change to apply to the store as it is compacted, or NULL.
       *
-      * @param pair the KeyValuePair struct to write to the scratch page.
+      * @param flags MICROBIT_STORAGE_RECORD_* flags for the change.
       *
-      * @param flashPointer the pointer in flash where this KeyValuePair resides. This pointer
-      * is used to determine the offset into the scratch page, where the KeyValuePair should
-      * be written.
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the spare page could not be written, leaving the log unchanged.
       */
-    void scratchKeyValuePair(KeyValuePair pair, uint32_t* flashPointer);
+    int compact(KeyValuePair *pair, uint16_t flags);
+
+    /**
+      * Determines the number of keys that fit into a page.
+      *
+      * @return the maximum number of keys in the store.
+      */
+    int capacity();
 
     public:
 
@@ -121,6 +238,8 @@ class MicroBitStorage
       *
       * Creates an instance of MicroBitStorage which acts like a KeyValueStore
       * that allows the retrieval, addition and deletion of KeyValuePairs.
+      *
+      * The state of the store is shared by every instance, and is reloaded from FLASH whenever an instance is created.
       */
     MicroBitStorage();
 
@@ -128,8 +247,10 @@ class MicroBitStorage
       * Method for erasing a page in flash.
       *
       * @param page_address Address of the first word in the page to be erased.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the page could not be erased.
       */
-    void flashPageErase(uint32_t * page_address);
+    int flashPageErase(uint32_t * page_address);
 
     /**
       * Method for writing a word of data in flash with a value.
@@ -137,8 +258,10 @@ class MicroBitStorage
       * @param address Address of the word to change.
       *
       * @param value Value to be written to flash.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the word could not be written.
       */
-    void flashWordWrite(uint32_t * address, uint32_t value);
+    int flashWordWrite(uint32_t * address, uint32_t value);
 
     /**
       * Places a given key, and it's corresponding value into flash at the earliest
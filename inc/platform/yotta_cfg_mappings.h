@@ -35,6 +35,10 @@
     #define MICROBIT_IDLE_COMPONENTS YOTTA_CFG_MICROBIT_DAL_IDLE_COMPONENTS
 #endif
 
+#ifdef YOTTA_CFG_MICROBIT_DAL_STRING_INTERN_TABLE_SIZE
+    #define MICROBIT_STRING_INTERN_TABLE_SIZE YOTTA_CFG_MICROBIT_DAL_STRING_INTERN_TABLE_SIZE
+#endif
+
 #ifdef YOTTA_CFG_MICROBIT_DAL_BLUETOOTH_ENABLED
     #define MICROBIT_BLE_ENABLED YOTTA_CFG_MICROBIT_DAL_BLUETOOTH_ENABLED
 #endif
@@ -51,6 +55,10 @@
     #define MICROBIT_DISPLAY_MAXIMUM_BRIGHTNESS YOTTA_CFG_MICROBIT_DAL_MAX_DISPLAY_BRIGHTNESS
 #endif
 
+#ifdef YOTTA_CFG_MICROBIT_DAL_DISPLAY_REFRESH_RATE
+    #define MICROBIT_DISPLAY_REFRESH_RATE YOTTA_CFG_MICROBIT_DAL_DISPLAY_REFRESH_RATE
+#endif
+
 #ifdef YOTTA_CFG_MICROBIT_DAL_DISPLAY_SCROLL_SPEED
     #define MICROBIT_DEFAULT_SCROLL_SPEED YOTTA_CFG_MICROBIT_DAL_DISPLAY_SCROLL_SPEED
 #endif
@@ -71,6 +79,10 @@
     #define MICROBIT_PANIC_HEAP_FULL YOTTA_CFG_MICROBIT_DAL_PANIC_ON_HEAP_FULL
 #endif
 
+#ifdef YOTTA_CFG_MICROBIT_DAL_PANIC_ON_REFCOUNT_ERROR
+    #define MICROBIT_PANIC_REFCOUNT_ERROR YOTTA_CFG_MICROBIT_DAL_PANIC_ON_REFCOUNT_ERROR
+#endif
+
 #ifdef YOTTA_CFG_MICROBIT_DAL_DEBUG
     #define MICROBIT_DBG YOTTA_CFG_MICROBIT_DAL_DEBUG
 #endif
@@ -64,6 +64,9 @@ class ManagedString
     // We control access to this to proide immutability and reference counting.
     StringData *ptr;
 
+    // ManagedStringBuilder hands its buffer directly to a ManagedString when complete.
+    friend class ManagedStringBuilder;
+
     public:
 
     /**
@@ -173,6 +176,21 @@ class ManagedString
       */
     ManagedString(const ManagedString &s);
 
+#if MICROBIT_CPP11
+    /**
+      * Move constructor.
+      * Takes over the character buffer of the supplied ManagedString, without changing its reference count.
+      *
+      * @param s The ManagedString to move from. This is left as an empty string.
+      *
+      * @code
+      * ManagedString s("abcdefg");
+      * ManagedString p(std::move(s));
+      * @endcode
+      */
+    ManagedString(ManagedString &&s);
+#endif
+
     /**
       * Default constructor.
       *
@@ -215,6 +233,25 @@ class ManagedString
       */
     ManagedString& operator = (const ManagedString& s);
 
+#if MICROBIT_CPP11
+    /**
+      * Move assign operation.
+      *
+      * Called when a ManagedString is assigned the value of a temporary (e.g. the result of a concatenation).
+      *
+      * Our existing character buffer is swapped with that of the supplied ManagedString, so no
+      * reference counts are changed here. Our old buffer is released when the temporary is destroyed.
+      *
+      * @param s The ManagedString to move from.
+      *
+      * @code
+      * ManagedString s("abcd");
+      * s = s + "efgh";   // no reference counting is needed to hold the new string
+      * @endcode
+      */
+    ManagedString& operator = (ManagedString&& s);
+#endif
+
     /**
       * Equality operation.
       *
@@ -331,7 +368,25 @@ class ManagedString
       * display.scroll(s.charAt(1)) // scrolls "b"
       * @endcode
       */
-    char charAt(int16_t index);
+    char charAt(int16_t index) const;
+
+    /**
+      * Provides a shared instance of this string from the intern table.
+      *
+      * Strings that are repeatedly created with the same content (e.g. file names or storage keys) can be
+      * interned so that all equal copies share a single heap allocation. The table holds a reference to
+      * each entry, and evicts the oldest entry when full.
+      *
+      * @return a ManagedString equal to this one, sharing its buffer with any previously interned equal string.
+      *
+      * @code
+      * ManagedString a = ManagedString("log.txt").intern();
+      * ManagedString b = ManagedString("log.txt").intern(); // a and b share the same buffer
+      * @endcode
+      *
+      * @note If MICROBIT_STRING_INTERN_TABLE_SIZE is zero, a copy of this string is returned.
+      */
+    ManagedString intern() const;
 
 
     /**
@@ -382,6 +437,14 @@ class ManagedString
       */
     void initString(const char *str);
 
+    /**
+      * Internal constructor helper.
+      *
+      * Creates this ManagedString based on a given char array of a given length.
+      * Single printable characters refer to a read-only, flash resident string rather than using the heap.
+      */
+    void initString(const char *str, int len);
+
     /**
       * Private Constructor.
       *
@@ -0,0 +1,290 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MANAGED_STRING_BUILDER_H
+#define MANAGED_STRING_BUILDER_H
+
+#include "MicroBitConfig.h"
+#include "ManagedString.h"
+
+// The initial capacity of a ManagedStringBuilder, in characters.
+#define MANAGED_STRING_BUILDER_DEFAULT_CAPACITY     16
+
+// The largest number of characters a ManagedStringBuilder can hold. ManagedStrings are limited to 16 bit signed lengths.
+#define MANAGED_STRING_BUILDER_MAX_CAPACITY         0x7FFF
+
+// The largest field width, and number of decimal places, of a formatted number.
+#define MANAGED_STRING_BUILDER_MAX_WIDTH            16
+#define MANAGED_STRING_BUILDER_MAX_DECIMALS         9
+
+/**
+  * Class definition for a ManagedStringBuilder.
+  *
+  * Joining ManagedStrings with operator+ allocates and copies a new string for every step, which
+  * becomes expensive when building up longer strings (e.g. a line of telemetry) piece by piece.
+  *
+  * A ManagedStringBuilder instead appends into a single growable buffer, which is handed over to
+  * a ManagedString when complete, without any further allocation or copying.
+  *
+  * @code
+  * ManagedStringBuilder b;
+  * b.append("x=").append(x).append(",t=").appendFixed(t, 2).append(",id=").appendHex(id, 8);
+  * if (b.isValid())
+  *     uBit.serial.send(b);
+  * @endcode
+  */
+class ManagedStringBuilder
+{
+    StringData *ptr;        // The string being built. The buffer may be larger than ptr->len.
+    uint16_t capacity;      // The number of characters ptr can hold, excluding the NULL terminator. Zero if ptr is read-only.
+    bool truncated;         // true if anything appended has been dropped since the string was last emptied.
+
+    /**
+      * Ensures the buffer can hold at least the given number of additional characters,
+      * growing it if necessary.
+      *
+      * @param n The number of characters to make room for.
+      *
+      * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if the string would become too long.
+      */
+    int reserve(int n);
+
+    /**
+      * Appends a number, formatted in the given base.
+      *
+      * @param value The magnitude of the number.
+      *
+      * @param negative true if the number is negative.
+      *
+      * @param base The base to format the number in: 10 or 16.
+      *
+      * @param width The minimum number of characters to append. Shorter numbers are padded on the left.
+      *
+      * @param pad The character to pad with. Zero padding is placed after any sign.
+      *
+      * @param decimals The number of digits to place after a decimal point.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      */
+    ManagedStringBuilder& appendNumber(uint32_t value, bool negative, int base, int width, char pad, int decimals);
+
+    public:
+
+    /**
+      * Constructor.
+      *
+      * Create an empty ManagedStringBuilder.
+      *
+      * @param capacity The number of characters to allocate space for initially. Defaults to MANAGED_STRING_BUILDER_DEFAULT_CAPACITY.
+      *                 Values above MANAGED_STRING_BUILDER_MAX_CAPACITY are clamped to it.
+      *
+      * @code
+      * ManagedStringBuilder b(32);
+      * @endcode
+      */
+    explicit ManagedStringBuilder(int capacity = MANAGED_STRING_BUILDER_DEFAULT_CAPACITY);
+
+    /**
+      * Destructor.
+      *
+      * Releases the buffer, if it has not been handed over to a ManagedString.
+      */
+    ~ManagedStringBuilder();
+
+    /**
+      * Appends the given character array to the end of the string being built.
+      *
+      * @param str A pointer to the characters to append.
+      *
+      * @param len The number of characters to append.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      */
+    ManagedStringBuilder& append(const char *str, int len);
+
+    /**
+      * Appends the given NULL terminated string to the end of the string being built.
+      *
+      * @param str The string to append.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      */
+    ManagedStringBuilder& append(const char *str);
+
+    /**
+      * Appends the given ManagedString to the end of the string being built.
+      *
+      * @param s The ManagedString to append.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      */
+    ManagedStringBuilder& append(const ManagedString &s);
+
+    /**
+      * Appends a single character to the end of the string being built.
+      *
+      * @param c The character to append.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      */
+    ManagedStringBuilder& append(char c);
+
+    /**
+      * Appends the decimal representation of the given integer to the end of the string being built.
+      *
+      * @param value The integer to append.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      */
+    ManagedStringBuilder& append(int value);
+
+    /**
+      * Appends the decimal representation of the given integer, padded on the left to a minimum width.
+      *
+      * @param value The integer to append.
+      *
+      * @param width The minimum number of characters to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH.
+      *
+      * @param pad The character to pad with. Defaults to ' '. With '0', the padding is placed after any sign.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      *
+      * @code
+      * b.append(-42, 5, '0'); // "-0042"
+      * @endcode
+      */
+    ManagedStringBuilder& append(int value, int width, char pad = ' ');
+
+    /**
+      * Appends the decimal representation of the given unsigned integer, padded on the left to a minimum width.
+      *
+      * @param value The unsigned integer to append.
+      *
+      * @param width The minimum number of characters to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH. Defaults to 0.
+      *
+      * @param pad The character to pad with. Defaults to ' '.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      *
+      * @code
+      * b.appendUnsigned(system_timer_current_time(), 10, '0');
+      * @endcode
+      */
+    ManagedStringBuilder& appendUnsigned(uint32_t value, int width = 0, char pad = ' ');
+
+    /**
+      * Appends the upper case hexadecimal representation of the given unsigned integer, zero padded
+      * on the left to a minimum number of digits.
+      *
+      * @param value The unsigned integer to append.
+      *
+      * @param width The minimum number of digits to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH. Defaults to 0.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      *
+      * @code
+      * b.appendHex(0x2a, 4); // "002A"
+      * @endcode
+      */
+    ManagedStringBuilder& appendHex(uint32_t value, int width = 0);
+
+    /**
+      * Appends a fixed point number, held as an integer scaled by a power of ten, with the given number
+      * of digits after the decimal point.
+      *
+      * @param value The number, multiplied by 10 to the power of decimals.
+      *
+      * @param decimals The number of digits after the decimal point, up to MANAGED_STRING_BUILDER_MAX_DECIMALS.
+      *
+      * @param width The minimum number of characters to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH. Defaults to 0.
+      *
+      * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+      *
+      * @code
+      * b.appendFixed(-1250, 3); // a reading in milli-g: "-1.250"
+      * @endcode
+      */
+    ManagedStringBuilder& appendFixed(int value, int decimals, int width = 0);
+
+    /**
+      * Discards the content of the string being built, retaining the buffer for reuse.
+      * The ManagedStringBuilder is then valid.
+      */
+    void clear();
+
+    /**
+      * Determines whether everything appended since the string was last emptied is held in it.
+      * Appends are dropped if the string would exceed MANAGED_STRING_BUILDER_MAX_CAPACITY, if there is
+      * insufficient memory to grow the buffer, or if a number is given an invalid format.
+      *
+      * @return true if no append has been dropped, false otherwise.
+      */
+    bool isValid() const
+    {
+        return !truncated;
+    }
+
+    /**
+      * Provides an immutable 8 bit wide character buffer representing the string built so far.
+      *
+      * @return a pointer to the NULL terminated character buffer.
+      */
+    const char *toCharArray() const
+    {
+        return ptr->data;
+    }
+
+    /**
+      * Determines the length of the string built so far, in characters.
+      *
+      * @return the length of the string in characters.
+      */
+    int16_t length() const
+    {
+        return ptr->len;
+    }
+
+    /**
+      * Hands the buffer over to a new ManagedString, without copying.
+      * The ManagedStringBuilder is then empty and valid, and may be reused.
+      *
+      * @return a ManagedString holding the string that has been built.
+      *
+      * @code
+      * ManagedStringBuilder b;
+      * b.append("score: ").append(score);
+      * ManagedString s = b.toManagedString();
+      * @endcode
+      */
+    ManagedString toManagedString();
+
+    private:
+
+    // ManagedStringBuilder is neither copyable nor assignable, as it holds a single, unshared buffer.
+    ManagedStringBuilder(const ManagedStringBuilder &);
+    ManagedStringBuilder& operator = (const ManagedStringBuilder &);
+};
+
+#endif
@@ -0,0 +1,150 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MICROBIT_ANIMATION_H
+#define MICROBIT_ANIMATION_H
+
+#include "mbed.h"
+#include "MicroBitConfig.h"
+#include "MicroBitImage.h"
+
+/**
+  * Frame encodings supported by MicroBitAnimation.
+  *
+  * RLE frames replace the whole frame, and are a list of (run length, brightness) pairs that together cover
+  * every pixel, row by row.
+  *
+  * DELTA frames modify the previous frame, and are a list of (pixel index, brightness) pairs, where the
+  * index of the pixel at (x, y) is y * width + x.
+  */
+#define MICROBIT_ANIMATION_FRAME_RLE        0
+#define MICROBIT_ANIMATION_FRAME_DELTA      1
+
+// The size of the animation header, and of the header of each frame, in bytes.
+#define MICROBIT_ANIMATION_HEADER_SIZE      4
+#define MICROBIT_ANIMATION_FRAME_HEADER_SIZE 4
+
+/**
+  * Class definition for a MicroBitAnimation.
+  *
+  * A MicroBitAnimation is a sequence of frames of the same size, each shown for its own duration.
+  * The first frame is run length encoded, and subsequent frames are typically encoded as the pixels that
+  * differ from the frame before, so a multi-frame animation is usually a small fraction of the size of the
+  * equivalent MicroBitImage with every frame side by side.
+  *
+  * The encoded data is not copied, and is expected to be held in flash. It is decoded one frame at a time,
+  * directly into the image being animated, so playing an animation needs no additional RAM.
+  *
+  * The encoded format is a header of { width, height, frame count, 0 }, followed by each frame, as
+  * { duration in milliseconds (low byte, high byte), encoding, pair count }, and then that many pairs.
+  * The number of pixels in each frame (width * height) may be at most 256.
+  *
+  * @code
+  * const uint8_t pulse[] = {
+  *     5, 5, 2, 0,                                         // 5x5 pixels, 2 frames
+  *     0xF4, 0x01, MICROBIT_ANIMATION_FRAME_RLE, 3,        // 500ms, three runs:
+  *     12, 0, 1, 255, 12, 0,                               // a single lit pixel in the centre
+  *     0xF4, 0x01, MICROBIT_ANIMATION_FRAME_DELTA, 4,      // 500ms, four changed pixels:
+  *     7, 255, 11, 255, 13, 255, 17, 255                   // light the pixels around the centre
+  * };
+  *
+  * display.animate(MicroBitAnimation(pulse));
+  * @endcode
+  */
+class MicroBitAnimation
+{
+    const uint8_t *data;        // The encoded animation.
+
+    public:
+
+    /**
+      * Default constructor. Creates an empty animation, with no frames.
+      */
+    MicroBitAnimation();
+
+    /**
+      * Constructor. Creates an animation from encoded data.
+      *
+      * @param data The encoded animation. This is not copied, so must remain valid for the lifetime of the animation.
+      */
+    explicit MicroBitAnimation(const uint8_t *data);
+
+    /**
+      * Gets the width of each frame of this animation.
+      *
+      * @return The width of each frame, in pixels.
+      */
+    int getWidth() const;
+
+    /**
+      * Gets the height of each frame of this animation.
+      *
+      * @return The height of each frame, in pixels.
+      */
+    int getHeight() const;
+
+    /**
+      * Gets the number of frames in this animation.
+      *
+      * @return The number of frames.
+      */
+    int getFrameCount() const;
+
+    /**
+      * Determines if this animation can be played.
+      *
+      * @return true if this animation has at least one frame of no more than 256 pixels, false otherwise.
+      */
+    bool isValid() const;
+
+    /**
+      * Gets the encoded data of the first frame of this animation.
+      *
+      * @return A pointer to the first frame, suitable for decodeFrame(), or NULL if the animation is not valid.
+      */
+    const uint8_t *getFirstFrame() const;
+
+    /**
+      * Decodes a frame of this animation into the given image.
+      *
+      * The frame is drawn with its top left corner at (x, y). DELTA frames only modify the pixels
+      * that have changed, so the image is expected to still hold the previous frame.
+      *
+      * @param frame The encoded frame, as returned by getFirstFrame() or a previous call to decodeFrame().
+      *
+      * @param image The image to decode the frame into.
+      *
+      * @param x The horizontal position at which to draw the frame.
+      *
+      * @param y The vertical position at which to draw the frame.
+      *
+      * @param duration Set to the time the frame should be shown for, in milliseconds.
+      *
+      * @return A pointer to the next frame.
+      */
+    const uint8_t *decodeFrame(const uint8_t *frame, MicroBitImage &image, int16_t x, int16_t y, uint16_t &duration) const;
+};
+
+#endif
@@ -31,9 +31,29 @@ DEALINGS IN THE SOFTWARE.
 #include "ManagedString.h"
 #include "RefCounted.h"
 
+/**
+  * Pixel formats supported by MicroBitImage.
+  *
+  * 8BPP images hold one byte per pixel, row by row, with no padding.
+  *
+  * 4BPP and 1BPP images are packed: each row is a whole number of 32 bit words, with the leftmost
+  * pixel held in the least significant bits of the first word. Packed pixel data starts at the first
+  * word aligned address after the ImageData header (i.e. two bytes after it).
+  */
+enum MicroBitImageFormat
+{
+    MICROBIT_IMAGE_FORMAT_8BPP = 0,
+    MICROBIT_IMAGE_FORMAT_4BPP = 1,
+    MICROBIT_IMAGE_FORMAT_1BPP = 2
+};
+
+// The format of an image is held in the top two bits of its width field.
+#define MICROBIT_IMAGE_FORMAT_SHIFT     14
+#define MICROBIT_IMAGE_WIDTH_MASK       0x3FFF
+
 struct ImageData : RefCounted
 {
-    uint16_t width;     // Width in pixels
+    uint16_t width;     // Width in pixels, and the MicroBitImageFormat of the bitmap in the top two bits
     uint16_t height;    // Height in pixels
     uint8_t data[0];    // 2D array representing the bitmap image
 };
@@ -57,8 +77,10 @@ class MicroBitImage
       * @param y the height of the image
       *
       * @param bitmap an array of integers that make up an image.
+      *
+      * @param format the pixel format of the image. Defaults to MICROBIT_IMAGE_FORMAT_8BPP.
       */
-    void init(const int16_t x, const int16_t y, const uint8_t *bitmap);
+    void init(const int16_t x, const int16_t y, const uint8_t *bitmap, MicroBitImageFormat format = MICROBIT_IMAGE_FORMAT_8BPP);
 
     /**
       * Internal constructor which defaults to the Empty Image instance variable
@@ -77,12 +99,27 @@ class MicroBitImage
 
     /**
       * Return a 2D array representing the bitmap image.
+      *
+      * The layout of the array depends on the format of the image. See MicroBitImageFormat.
       */
     uint8_t *getBitmap()
     {
+        if (ptr->width >> MICROBIT_IMAGE_FORMAT_SHIFT)
+            return (uint8_t *)(((uintptr_t)ptr->data + 3) & ~(uintptr_t)3);
+
         return ptr->data;
     }
 
+    /**
+      * Return a 2D array representing the bitmap image.
+      *
+      * The layout of the array depends on the format of the image. See MicroBitImageFormat.
+      */
+    const uint8_t *getBitmap() const
+    {
+        return ((MicroBitImage *)this)->getBitmap();
+    }
+
     /**
       * Constructor.
       * Create an image from a specially prepared constant array, with no copying. Will call ptr->incr().
@@ -96,6 +133,26 @@ class MicroBitImage
       */
     MicroBitImage(ImageData *ptr);
 
+    /**
+      * Constructor.
+      * Create a read-only image from image data held in FLASH memory, with no copying. This allows images stored
+      * in files to be used in place, using the data returned by MicroBitFileSystem::map().
+      *
+      * @param data The image data, laid out as for MicroBitImage(ImageData *): the first two bytes should be 0xff,
+      *             then width, height and the bitmap. The data has to be 4-byte aligned.
+      *
+      * @param length The number of bytes available at data. If the data is not laid out as above, or is too short
+      *               to hold the bitmap, the empty image is created.
+      *
+      * @code
+      * const uint8_t *data;
+      * int fd = fs.open("heart.img", MB_READ);
+      * int length = fs.map(fd, &data);
+      * MicroBitImage i(data, length);
+      * @endcode
+      */
+    MicroBitImage(const uint8_t *data, int length);
+
     /**
       * Default Constructor.
       * Creates a new reference to the empty MicroBitImage bitmap
@@ -120,6 +177,21 @@ class MicroBitImage
       */
     MicroBitImage(const MicroBitImage &image);
 
+#if MICROBIT_CPP11
+    /**
+      * Move Constructor.
+      * Takes over the bitmap of the supplied MicroBitImage, without changing its reference count.
+      *
+      * @param image The MicroBitImage to move from. This is left referencing the EmptyImage.
+      *
+      * @code
+      * MicroBitImage i(10,5);
+      * MicroBitImage i2(std::move(i)); // i2 now holds the bitmap, i is empty
+      * @endcode
+      */
+    MicroBitImage(MicroBitImage &&image);
+#endif
+
     /**
       * Constructor.
       * Create a blank bitmap representation of a given size.
@@ -167,6 +239,23 @@ class MicroBitImage
       */
     MicroBitImage(const int16_t x, const int16_t y, const uint8_t *bitmap);
 
+    /**
+      * Constructor.
+      * Create a blank bitmap representation of a given size and pixel format.
+      *
+      * @param x the width of the image.
+      *
+      * @param y the height of the image.
+      *
+      * @param format the pixel format of the image. MICROBIT_IMAGE_FORMAT_1BPP images use an eighth
+      *               of the RAM of the default 8 bit format, and are shifted and pasted a word at a time.
+      *
+      * @code
+      * MicroBitImage banner(200, 5, MICROBIT_IMAGE_FORMAT_1BPP); // 160 bytes of pixel data, rather than 1000.
+      * @endcode
+      */
+    MicroBitImage(const int16_t x, const int16_t y, MicroBitImageFormat format);
+
     /**
       * Destructor.
       *
@@ -195,6 +284,25 @@ class MicroBitImage
       */
     MicroBitImage& operator = (const MicroBitImage& i);
 
+#if MICROBIT_CPP11
+    /**
+      * Move assign operation.
+      *
+      * Called when a MicroBitImage is assigned the value of a temporary (e.g. the result of crop()).
+      *
+      * Our existing buffer is swapped with that of the supplied MicroBitImage, so no
+      * reference counts are changed here. Our old buffer is released when the temporary is destroyed.
+      *
+      * @param i The MicroBitImage to move from.
+      *
+      * @code
+      * MicroBitImage i(10,5);
+      * i = i.crop(0,0,5,5); // no reference counting is needed to hold the cropped image
+      * @endcode
+      */
+    MicroBitImage& operator = (MicroBitImage&& i);
+#endif
+
 
     /**
       * Equality operation.
@@ -233,7 +341,8 @@ class MicroBitImage
       *
       * @param y The co-ordinate of the pixel to change.
       *
-      * @param value The new value of the pixel (the brightness level 0-255)
+      * @param value The new value of the pixel (the brightness level 0-255). Packed images store this
+      *              at reduced precision, but any non-zero value is always stored as non-zero.
       *
       * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER.
       *
@@ -260,7 +369,7 @@ class MicroBitImage
       * i.getPixelValue(0,0); //should be 0;
       * @endcode
       */
-    int getPixelValue(int16_t x , int16_t y);
+    int getPixelValue(int16_t x , int16_t y) const;
 
     /**
       * Replaces the content of this image with that of a given 2D array representing
@@ -307,6 +416,38 @@ class MicroBitImage
       */
     int paste(const MicroBitImage &image, int16_t x = 0, int16_t y = 0, uint8_t alpha = 0);
 
+    /**
+      * Pastes a region of a given bitmap at the given co-ordinates.
+      *
+      * This is equivalent to pasting image.crop(sx, sy, sw, sh), without creating the cropped image.
+      * Any pixels in the relevant area of this image are replaced.
+      *
+      * @param image The MicroBitImage to paste from.
+      *
+      * @param x The leftmost X co-ordinate in this image where the region should be pasted.
+      *
+      * @param y The uppermost Y co-ordinate in this image where the region should be pasted.
+      *
+      * @param sx The leftmost X co-ordinate of the region in the given image.
+      *
+      * @param sy The uppermost Y co-ordinate of the region in the given image.
+      *
+      * @param sw The width of the region.
+      *
+      * @param sh The height of the region.
+      *
+      * @param alpha set to 1 if transparency clear pixels in given image should be treated as transparent. Set to 0 otherwise.  Defaults to 0.
+      *
+      * @return The number of pixels written.
+      *
+      * @code
+      * MicroBitImage sheet(50,5);
+      * MicroBitImage i(5,5);
+      * i.paste(sheet, 0, 0, 10, 0, 5, 5); // the third 5x5 frame of the sheet
+      * @endcode
+      */
+    int paste(const MicroBitImage &image, int16_t x, int16_t y, int16_t sx, int16_t sy, int16_t sw, int16_t sh, uint8_t alpha = 0);
+
      /**
        * Prints a character to the display at the given location
        *
@@ -318,6 +459,9 @@ class MicroBitImage
        *
        * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER.
        *
+       * @note If the system font is proportional, x is the position of the first column the character uses,
+       * and only the columns the character uses are drawn.
+       *
        * @code
        * MicroBitImage i(5,5);
        * i.print('a');
@@ -399,7 +543,7 @@ class MicroBitImage
       */
     int getWidth() const
     {
-        return ptr->width;
+        return ptr->width & MICROBIT_IMAGE_WIDTH_MASK;
     }
 
     /**
@@ -419,7 +563,40 @@ class MicroBitImage
     }
 
     /**
-      * Gets number of bytes in the bitmap, ie., width * height.
+      * Gets the pixel format of this image.
+      *
+      * @return The MicroBitImageFormat of this image.
+      */
+    MicroBitImageFormat getFormat() const
+    {
+        return (MicroBitImageFormat)(ptr->width >> MICROBIT_IMAGE_FORMAT_SHIFT);
+    }
+
+    /**
+      * Gets the number of bits used to store each pixel of this image.
+      *
+      * @return 8, 4 or 1.
+      */
+    int getBitsPerPixel() const
+    {
+        return getFormat() == MICROBIT_IMAGE_FORMAT_1BPP ? 1 : getFormat() == MICROBIT_IMAGE_FORMAT_4BPP ? 4 : 8;
+    }
+
+    /**
+      * Gets the number of bytes between the start of one row of the bitmap and the next.
+      *
+      * @return The width of the image for 8 bit images, or the width of a row in bytes rounded up to a whole word for packed images.
+      */
+    int getStride() const
+    {
+        if (getFormat() == MICROBIT_IMAGE_FORMAT_8BPP)
+            return getWidth();
+
+        return ((getWidth() * getBitsPerPixel() + 31) >> 5) << 2;
+    }
+
+    /**
+      * Gets number of bytes in the bitmap, ie., stride * height. For 8 bit images this is width * height.
       *
       * @return The size of the bitmap.
       *
@@ -431,7 +608,7 @@ class MicroBitImage
       */
     int getSize() const
     {
-        return ptr->width * ptr->height;
+        return getStride() * ptr->height;
     }
 
     /**
@@ -475,6 +652,20 @@ class MicroBitImage
       * @return an instance of MicroBitImage which can be modified independently of the current instance
       */
     MicroBitImage clone();
+
+    /**
+      * Create a copy of the image in the given pixel format.
+      *
+      * @param format The MicroBitImageFormat of the new image.
+      *
+      * @return an instance of MicroBitImage holding the same picture in the given format.
+      *
+      * @code
+      * MicroBitImage i("0,1,0,1,0\n1,0,1,0,1\n0,1,0,1,0\n1,0,1,0,1\n0,1,0,1,0\n");
+      * MicroBitImage packed = i.convert(MICROBIT_IMAGE_FORMAT_1BPP);
+      * @endcode
+      */
+    MicroBitImage convert(MicroBitImageFormat format);
 };
 
 #endif
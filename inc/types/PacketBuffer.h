@@ -56,6 +56,13 @@ class PacketBuffer
       */
     uint8_t *getBytes();
 
+    /**
+      * Provide a read only pointer to a memory location containing the packet data.
+      *
+      * @return The contents of this packet, as an array of bytes.
+      */
+    const uint8_t *getBytes() const;
+
     /**
       * Default Constructor.
       * Creates an empty Packet Buffer.
@@ -109,6 +116,21 @@ class PacketBuffer
       */
     PacketBuffer(const PacketBuffer &buffer);
 
+#if MICROBIT_CPP11
+    /**
+      * Move Constructor.
+      * Takes over the packet of the supplied PacketBuffer, without changing its reference count.
+      *
+      * @param buffer The PacketBuffer to move from. This is left as an empty, zero length packet.
+      *
+      * @code
+      * PacketBuffer p(16);
+      * PacketBuffer p2(std::move(p)); // p2 now holds the packet, p is empty.
+      * @endcode
+      */
+    PacketBuffer(PacketBuffer &&buffer);
+#endif
+
     /**
       * Internal constructor-initialiser.
       *
@@ -149,6 +171,25 @@ class PacketBuffer
       */
     PacketBuffer& operator = (const PacketBuffer& p);
 
+#if MICROBIT_CPP11
+    /**
+      * Move assign operation.
+      *
+      * Called when a PacketBuffer is assigned the value of a temporary (e.g. the result of recv()).
+      *
+      * Our existing packet is swapped with that of the supplied PacketBuffer, so no
+      * reference counts are changed here. Our old packet is released when the temporary is destroyed.
+      *
+      * @param p The PacketBuffer to move from.
+      *
+      * @code
+      * PacketBuffer p;
+      * p = uBit.radio.datagram.recv();
+      * @endcode
+      */
+    PacketBuffer& operator = (PacketBuffer&& p);
+#endif
+
     /**
       * Array access operation (read).
       *
@@ -239,7 +280,7 @@ class PacketBuffer
       * p1.length(); // Returns 16.
       * @endcode
       */
-    int length();
+    int length() const;
 
     /**
       * Retrieves the received signal strength of this packet.
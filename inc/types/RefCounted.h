@@ -30,6 +30,10 @@ DEALINGS IN THE SOFTWARE.
 #include "MicroBitConfig.h"
 #include "MicroBitDevice.h"
 
+// The size of each block in the pool of small payloads, which holds the header, up to 7 characters
+// and the terminator of a short ManagedString.
+#define REF_COUNTED_POOL_BLOCK_SIZE     12
+
 /**
   * Base class for payload for ref-counted objects. Used by ManagedString and MicroBitImage.
   * There is no constructor, as this struct is typically malloc()ed.
@@ -67,6 +71,17 @@ public:
       * @return true if the object resides in flash memory, false otherwise.
       */
     bool isReadOnly();
+
+    /**
+      * Allocates the memory for a new payload. Payloads of up to REF_COUNTED_POOL_BLOCK_SIZE bytes are taken
+      * from a pool of MICROBIT_STRING_POOL_SIZE fixed size blocks while any are free, avoiding the heap.
+      * The memory is released by decr() when the last reference is removed.
+      *
+      * @param size the size of the payload in bytes.
+      *
+      * @return the memory allocated, or NULL if there is insufficient memory.
+      */
+    static RefCounted *allocate(int size);
 };
 
 #endif
@@ -530,6 +530,34 @@ void MicroBitBLEManager::stopAdvertising()
     ble->gap().stopAdvertising();
 }
 
+/**
+ * Tears down the BLE stack and disables SoftDevice for the remainder of this session.
+ * This allows the radio to be used, and, if the heap allocator is enabled, the SRAM
+ * that was reserved for SoftDevice (including its GATT table) is added to the heap.
+ *
+ * @return MICROBIT_OK on success, or MICROBIT_NOT_SUPPORTED if the BLE stack is not running.
+ */
+int MicroBitBLEManager::shutdown()
+{
+    if (ble == NULL || !ble_running())
+        return MICROBIT_NOT_SUPPORTED;
+
+    ble->gap().stopAdvertising();
+    ble->shutdown();
+
+#if CONFIG_ENABLED(MICROBIT_HEAP_ALLOCATOR)
+    // Any SoftDevice memory above the GATT table may already be in use as heap storage,
+    // so only reclaim the region that SoftDevice was actually using.
+#if CONFIG_ENABLED(MICROBIT_HEAP_REUSE_SD)
+    microbit_create_heap(MICROBIT_SRAM_BASE, MICROBIT_SD_GATT_TABLE_START + MICROBIT_SD_GATT_TABLE_SIZE);
+#else
+    microbit_create_heap(MICROBIT_SRAM_BASE, MICROBIT_SD_LIMIT);
+#endif
+#endif
+
+    return MICROBIT_OK;
+}
+
 #if CONFIG_ENABLED(MICROBIT_BLE_EDDYSTONE_URL)
 /**
   * Set the content of Eddystone URL frames
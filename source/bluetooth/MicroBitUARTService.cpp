@@ -321,11 +321,36 @@ int MicroBitUARTService::send(const uint8_t *buf, int length, MicroBitSerialMode
   * @return the number of characters written, or MICROBIT_NOT_SUPPORTED if there is
   *         no connected device, or the connected device has not enabled indications.
   */
-int MicroBitUARTService::send(ManagedString s, MicroBitSerialMode mode)
+int MicroBitUARTService::send(const ManagedString &s, MicroBitSerialMode mode)
 {
     return send((uint8_t *)s.toCharArray(), s.length(), mode);
 }
 
+/**
+  * Copies the string held by a ManagedStringBuilder into the buffer used for Transmitting to the central device.
+  * The content of the ManagedStringBuilder is not changed.
+  *
+  * @param b the ManagedStringBuilder holding the string to transmit
+  * @param mode the selected mode, one of: ASYNC, SYNC_SPINWAIT, SYNC_SLEEP. Each mode
+  *        gives a different behaviour:
+  *
+  *            ASYNC - Will copy as many characters as it can into the buffer for transmission,
+  *                    and return control to the user.
+  *
+  *            SYNC_SPINWAIT - will return MICROBIT_INVALID_PARAMETER
+  *
+  *            SYNC_SLEEP - Will perform a cooperative blocking wait until all
+  *                         given characters have been received by the connected
+  *                         device.
+  *
+  * @return the number of characters written, or MICROBIT_NOT_SUPPORTED if there is
+  *         no connected device, or the connected device has not enabled indications.
+  */
+int MicroBitUARTService::send(const ManagedStringBuilder &b, MicroBitSerialMode mode)
+{
+    return send((uint8_t *)b.toCharArray(), b.length(), mode);
+}
+
 /**
   * Reads a number of characters from the rxBuffer and fills user given buffer.
   *
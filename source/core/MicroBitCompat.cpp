@@ -99,3 +99,27 @@ int itoa(int n, char *s)
 
     return MICROBIT_OK;
 }
+
+/**
+  * Calculates the CRC16-CCITT of a block of memory.
+  *
+  * @param data The data to checksum.
+  *
+  * @param len The number of bytes of data.
+  *
+  * @param crc The CRC of any preceding data, or 0xFFFF to begin a new checksum.
+  *
+  * @return The CRC of the data.
+  */
+uint16_t crc16(const uint8_t *data, int len, uint16_t crc)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)*data++ << 8;
+
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
@@ -0,0 +1,77 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for a MicroBitFiberLock.
+  *
+  * A simple mutual exclusion lock between fibers, for components whose operations may block part way through
+  * (e.g. while waiting for flash to be written), and so would otherwise be entered again by another fiber.
+  */
+#include "MicroBitConfig.h"
+#include "MicroBitFiberLock.h"
+#include "MicroBitFiber.h"
+#include "MicroBitEvent.h"
+#include "NotifyEvents.h"
+#include "ErrorNo.h"
+
+/**
+  * Constructor. Creates a lock that is not held.
+  */
+MicroBitFiberLock::MicroBitFiberLock()
+{
+    locked = false;
+    waiting = 0;
+}
+
+/**
+  * Takes the lock, first waiting for it to be released if another fiber holds it.
+  * If the scheduler is not running, no other fiber can hold the lock, so this call returns immediately.
+  */
+void MicroBitFiberLock::lock()
+{
+    while (locked)
+    {
+        waiting++;
+        int result = fiber_wait_for_event(MICROBIT_ID_NOTIFY, MICROBIT_FIBER_LOCK_EVT_FREE);
+        waiting--;
+
+        if (result == MICROBIT_NOT_SUPPORTED)
+            break;
+    }
+
+    locked = true;
+}
+
+/**
+  * Releases the lock, and wakes any fibers waiting for it.
+  */
+void MicroBitFiberLock::unlock()
+{
+    locked = false;
+
+    // All locks share the same event, so each waiting fiber checks its own lock again when woken.
+    if (waiting)
+        MicroBitEvent(MICROBIT_ID_NOTIFY, MICROBIT_FIBER_LOCK_EVT_FREE);
+}
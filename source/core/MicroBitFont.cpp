@@ -42,6 +42,8 @@ DEALINGS IN THE SOFTWARE.
   * The above will produce an exclaimation mark on the second column in form the left.
   *
   * We could compress further, but the complexity of decode would likely outweigh the gains.
+  *
+  * Proportional fonts also have a metrics table, and optionally a kerning table. See MicroBitFont.h.
   */
 
 #include "MicroBitConfig.h"
@@ -51,7 +53,18 @@ const unsigned char pendolino3[475] = {
 0x0, 0x0, 0x0, 0x0, 0x0, 0x8, 0x8, 0x8, 0x0, 0x8, 0xa, 0x4a, 0x40, 0x0, 0x0, 0xa, 0x5f, 0xea, 0x5f, 0xea, 0xe, 0xd9, 0x2e, 0xd3, 0x6e, 0x19, 0x32, 0x44, 0x89, 0x33, 0xc, 0x92, 0x4c, 0x92, 0x4d, 0x8, 0x8, 0x0, 0x0, 0x0, 0x4, 0x88, 0x8, 0x8, 0x4, 0x8, 0x4, 0x84, 0x84, 0x88, 0x0, 0xa, 0x44, 0x8a, 0x40, 0x0, 0x4, 0x8e, 0xc4, 0x80, 0x0, 0x0, 0x0, 0x4, 0x88, 0x0, 0x0, 0xe, 0xc0, 0x0, 0x0, 0x0, 0x0, 0x8, 0x0, 0x1, 0x22, 0x44, 0x88, 0x10, 0xc, 0x92, 0x52, 0x52, 0x4c, 0x4, 0x8c, 0x84, 0x84, 0x8e, 0x1c, 0x82, 0x4c, 0x90, 0x1e, 0x1e, 0xc2, 0x44, 0x92, 0x4c, 0x6, 0xca, 0x52, 0x5f, 0xe2, 0x1f, 0xf0, 0x1e, 0xc1, 0x3e, 0x2, 0x44, 0x8e, 0xd1, 0x2e, 0x1f, 0xe2, 0x44, 0x88, 0x10, 0xe, 0xd1, 0x2e, 0xd1, 0x2e, 0xe, 0xd1, 0x2e, 0xc4, 0x88, 0x0, 0x8, 0x0, 0x8, 0x0, 0x0, 0x4, 0x80, 0x4, 0x88, 0x2, 0x44, 0x88, 0x4, 0x82, 0x0, 0xe, 0xc0, 0xe, 0xc0, 0x8, 0x4, 0x82, 0x44, 0x88, 0xe, 0xd1, 0x26, 0xc0, 0x4, 0xe, 0xd1, 0x35, 0xb3, 0x6c, 0xc, 0x92, 0x5e, 0xd2, 0x52, 0x1c, 0x92, 0x5c, 0x92, 0x5c, 0xe, 0xd0, 0x10, 0x10, 0xe, 0x1c, 0x92, 0x52, 0x52, 0x5c, 0x1e, 0xd0, 0x1c, 0x90, 0x1e, 0x1e, 0xd0, 0x1c, 0x90, 0x10, 0xe, 0xd0, 0x13, 0x71, 0x2e, 0x12, 0x52, 0x5e, 0xd2, 0x52, 0x1c, 0x88, 0x8, 0x8, 0x1c, 0x1f, 0xe2, 0x42, 0x52, 0x4c, 0x12, 0x54, 0x98, 0x14, 0x92, 0x10, 0x10, 0x10, 0x10, 0x1e, 0x11, 0x3b, 0x75, 0xb1, 0x31, 0x11, 0x39, 0x35, 0xb3, 0x71, 0xc, 0x92, 0x52, 0x52, 0x4c, 0x1c, 0x92, 0x5c, 0x90, 0x10, 0xc, 0x92, 0x52, 0x4c, 0x86, 0x1c, 0x92, 0x5c, 0x92, 0x51, 0xe, 0xd0, 0xc, 0x82, 0x5c, 0x1f, 0xe4, 0x84, 0x84, 0x84, 0x12, 0x52, 0x52, 0x52, 0x4c, 0x11, 0x31, 0x31, 0x2a, 0x44, 0x11, 0x31, 0x35, 0xbb, 0x71, 0x12, 0x52, 0x4c, 0x92, 0x52, 0x11, 0x2a, 0x44, 0x84, 0x84, 0x1e, 0xc4, 0x88, 0x10, 0x1e, 0xe, 0xc8, 0x8, 0x8, 0xe, 0x10, 0x8, 0x4, 0x82, 0x41, 0xe, 0xc2, 0x42, 0x42, 0x4e, 0x4, 0x8a, 0x40, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x1f, 0x8, 0x4, 0x80, 0x0, 0x0, 0x0, 0xe, 0xd2, 0x52, 0x4f, 0x10, 0x10, 0x1c, 0x92, 0x5c, 0x0, 0xe, 0xd0, 0x10, 0xe, 0x2, 0x42, 0x4e, 0xd2, 0x4e, 0xc, 0x92, 0x5c, 0x90, 0xe, 0x6, 0xc8, 0x1c, 0x88, 0x8, 0xe, 0xd2, 0x4e, 0xc2, 0x4c, 0x10, 0x10, 0x1c, 0x92, 0x52, 0x8, 0x0, 0x8, 0x8, 0x8, 0x2, 0x40, 0x2, 0x42, 0x4c, 0x10, 0x14, 0x98, 0x14, 0x92, 0x8, 0x8, 0x8, 0x8, 0x6, 0x0, 0x1b, 0x75, 0xb1, 0x31, 0x0, 0x1c, 0x92, 0x52, 0x52, 0x0, 0xc, 0x92, 0x52, 0x4c, 0x0, 0x1c, 0x92, 0x5c, 0x90, 0x0, 0xe, 0xd2, 0x4e, 0xc2, 0x0, 0xe, 0xd0, 0x10, 0x10, 0x0, 0x6, 0xc8, 0x4, 0x98, 0x8, 0x8, 0xe, 0xc8, 0x7, 0x0, 0x12, 0x52, 0x52, 0x4f, 0x0, 0x11, 0x31, 0x2a, 0x44, 0x0, 0x11, 0x31, 0x35, 0xbb, 0x0, 0x12, 0x4c, 0x8c, 0x92, 0x0, 0x11, 0x2a, 0x44, 0x98, 0x0, 0x1e, 0xc4, 0x88, 0x1e, 0x6, 0xc4, 0x8c, 0x84, 0x86, 0x8, 0x8, 0x8, 0x8, 0x8, 0x18, 0x8, 0xc, 0x88, 0x18, 0x0, 0x0, 0xc, 0x83, 0x60};
 
 
+// The first column used by, and the width of, each glyph of pendolino3. Spaces are two columns wide.
+const unsigned char pendolino3Metrics[95] = {
+    0x02, 0x11, 0x13, 0x05, 0x05, 0x05, 0x05, 0x11, 0x12, 0x12, 0x13, 0x13, 0x12, 0x13, 0x11, 0x05,
+    0x04, 0x13, 0x04, 0x04, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x11, 0x12, 0x13, 0x13, 0x13, 0x05,
+    0x05, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x05, 0x04, 0x03, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04,
+    0x04, 0x04, 0x05, 0x04, 0x05, 0x04, 0x05, 0x05, 0x04, 0x05, 0x04, 0x13, 0x05, 0x13, 0x13, 0x05,
+    0x12, 0x05, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x11, 0x13, 0x04, 0x13, 0x05, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0x04, 0x14, 0x05, 0x05, 0x05, 0x04, 0x05, 0x04, 0x13, 0x11, 0x03, 0x14
+};
+
 const unsigned char* MicroBitFont::defaultFont = pendolino3;
+const unsigned char* MicroBitFont::defaultMetrics = pendolino3Metrics;
 MicroBitFont MicroBitFont::systemFont = MicroBitFont(defaultFont, MICROBIT_FONT_ASCII_END);
 
 /**
@@ -66,6 +79,34 @@ MicroBitFont MicroBitFont::systemFont = MicroBitFont(defaultFont, MICROBIT_FONT_
 MicroBitFont::MicroBitFont(const unsigned char* characters, int asciiEnd)
 {
     this->characters = characters;
+    this->metrics = NULL;
+    this->kerning = NULL;
+    this->asciiEnd = asciiEnd;
+}
+
+/**
+  * Constructor.
+  *
+  * Sets the proportional font represented by this font object.
+  *
+  * @param font A pointer to the beginning of the new font.
+  *
+  * @param metrics A pointer to the glyph metrics of the new font, or NULL if it is fixed width.
+  *
+  * @param kerning A pointer to the kerning pairs of the new font, or NULL if it has none. Defaults to NULL.
+  *
+  * @param asciiEnd the char value at which this font finishes.
+  *
+  * @code
+  * // Scroll text using the default glyphs, with each character only as wide as it needs to be.
+  * MicroBitFont::setSystemFont(MicroBitFont(MicroBitFont::defaultFont, MicroBitFont::defaultMetrics));
+  * @endcode
+  */
+MicroBitFont::MicroBitFont(const unsigned char* characters, const unsigned char* metrics, const unsigned char* kerning, int asciiEnd)
+{
+    this->characters = characters;
+    this->metrics = metrics;
+    this->kerning = kerning;
     this->asciiEnd = asciiEnd;
 }
 
@@ -77,9 +118,72 @@ MicroBitFont::MicroBitFont(const unsigned char* characters, int asciiEnd)
 MicroBitFont::MicroBitFont()
 {
     this->characters = defaultFont;
+    this->metrics = NULL;
+    this->kerning = NULL;
     this->asciiEnd = MICROBIT_FONT_ASCII_END;
 }
 
+/**
+  * Determines if this font is proportional.
+  *
+  * @return true if characters of this font have their own widths, false if they are all MICROBIT_FONT_WIDTH wide.
+  */
+bool MicroBitFont::isProportional() const
+{
+    return metrics != NULL;
+}
+
+/**
+  * Determines the first column of its cell that the given character uses.
+  *
+  * @param c The character.
+  *
+  * @return The first column used, which is always 0 for fixed width fonts.
+  */
+int MicroBitFont::getCharOffset(char c) const
+{
+    if (metrics == NULL || c < MICROBIT_FONT_ASCII_START || c > asciiEnd)
+        return 0;
+
+    return MICROBIT_FONT_METRICS_OFFSET(metrics[c - MICROBIT_FONT_ASCII_START]);
+}
+
+/**
+  * Determines the number of columns the given character uses.
+  *
+  * @param c The character.
+  *
+  * @return The width of the character, which is always MICROBIT_FONT_WIDTH for fixed width fonts.
+  */
+int MicroBitFont::getCharWidth(char c) const
+{
+    if (metrics == NULL || c < MICROBIT_FONT_ASCII_START || c > asciiEnd)
+        return MICROBIT_FONT_WIDTH;
+
+    return MICROBIT_FONT_METRICS_WIDTH(metrics[c - MICROBIT_FONT_ASCII_START]);
+}
+
+/**
+  * Determines the adjustment to the space between the given pair of characters.
+  *
+  * @param left The character on the left.
+  *
+  * @param right The character on the right.
+  *
+  * @return The number of columns to add to the space between the characters, which may be negative.
+  */
+int MicroBitFont::getKerning(char left, char right) const
+{
+    if (kerning == NULL)
+        return 0;
+
+    for (const unsigned char *k = kerning; *k; k += 3)
+        if (k[0] == (unsigned char)left && k[1] == (unsigned char)right)
+            return (int8_t)k[2];
+
+    return 0;
+}
+
 /**
   * Modifies the current system font to the given instance of MicroBitFont.
   *
@@ -129,7 +129,7 @@ void microbit_heap_print()
 void microbit_initialise_heap(HeapDefinition &heap)
 {
     // Simply mark the entire heap as free.
-    *heap.heap_start = ((uint32_t) heap.heap_end - (uint32_t) heap.heap_start) / MICROBIT_HEAP_BLOCK_SIZE;
+    *heap.heap_start = ((uint32_t)(uintptr_t) heap.heap_end - (uint32_t)(uintptr_t) heap.heap_start) / MICROBIT_HEAP_BLOCK_SIZE;
     *heap.heap_start |= MICROBIT_HEAP_BLOCK_FREE;
 }
 
@@ -203,7 +203,7 @@ int microbit_create_nested_heap(float ratio)
     p = native_malloc(sizeof(uint32_t));
 
     // Estimate the size left in our heap, taking care to ensure it lands on a word boundary.
-    length = (uint32_t) (((float)(MICROBIT_HEAP_END - (uint32_t)p)) * ratio);
+    length = (uint32_t) (((float)(MICROBIT_HEAP_END - (uint32_t)(uintptr_t)p)) * ratio);
     length &= 0xFFFFFFFC;
 
     // Release our reference pointer.
@@ -211,20 +211,165 @@ int microbit_create_nested_heap(float ratio)
     p = NULL;
 
     // Allocate memory for our heap.
-    // We iteratively reduce the size of memory are allocate until it fits within available space.
-    while (p == NULL)
+    // If our estimate doesn't fit (e.g. the native heap is fragmented), binary search for the largest
+    // block that does, rather than probing downwards a few bytes at a time.
+    p = native_malloc(length);
+
+    if (p == NULL)
     {
+        uint32_t low = 0;
+        uint32_t high = length;
+
+        while (high - low > 32)
+        {
+            uint32_t mid = ((low + high) / 2) & 0xFFFFFFFC;
+
+            p = native_malloc(mid);
+            if (p != NULL)
+            {
+                native_free(p);
+                low = mid;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        length = low;
+        if (length < MICROBIT_HEAP_BLOCK_SIZE*2)
+            return MICROBIT_NO_RESOURCES;
+
         p = native_malloc(length);
         if (p == NULL)
+            return MICROBIT_NO_RESOURCES;
+    }
+
+    uint32_t start = (uint32_t)(uintptr_t) p;
+    return microbit_create_heap(start, start + length);
+}
+
+/**
+  * Remove a heap region previously created with microbit_create_heap().
+  * The region is only removed if it currently holds no allocated memory, after which
+  * the memory may be handed back to its original owner (e.g. SoftDevice).
+  *
+  * @param start The start address of the heap region to remove.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if no heap region starts at the given address,
+  *         or MICROBIT_BUSY if the region is still in use.
+  */
+int microbit_remove_heap(uint32_t start)
+{
+    uint32_t *block;
+    int i;
+
+	// Disable IRQ temporarily to ensure no race conditions!
+    __disable_irq();
+
+    for (i=0; i < heap_count; i++)
+        if (heap[i].heap_start == (uint32_t *)start)
+            break;
+
+    if (i == heap_count)
+    {
+        __enable_irq();
+        return MICROBIT_INVALID_PARAMETER;
+    }
+
+    // Ensure nothing is still allocated from this region.
+    block = heap[i].heap_start;
+    while (block < heap[i].heap_end)
+    {
+        if (!(*block & MICROBIT_HEAP_BLOCK_FREE))
         {
-            length -= 32;
-            if (length <= 0)
-                return MICROBIT_NO_RESOURCES;
+            __enable_irq();
+            return MICROBIT_BUSY;
         }
+
+        block += *block & ~MICROBIT_HEAP_BLOCK_FREE;
     }
 
-    uint32_t start = (uint32_t) p;
-    microbit_create_heap(start, start + length);
+    // Remove the region, preserving the order in which the remaining heaps were created.
+    for (; i < heap_count - 1; i++)
+        heap[i] = heap[i+1];
+
+    heap_count--;
+
+	// Enable Interrupts
+    __enable_irq();
+
+#if CONFIG_ENABLED(MICROBIT_DBG) && CONFIG_ENABLED(MICROBIT_HEAP_DBG)
+    microbit_heap_print();
+#endif
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Determines the number of heap regions currently registered with the allocator.
+  *
+  * @return The number of active heap regions.
+  */
+int microbit_heap_count()
+{
+    return heap_count;
+}
+
+/**
+  * Provides a usage summary of the given heap region.
+  *
+  * @param index The index of the heap region, in the range 0..microbit_heap_count()-1.
+  *
+  * @param info A MicroBitHeapInfo structure to populate.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the index is out of range.
+  */
+int microbit_heap_info(int index, MicroBitHeapInfo &info)
+{
+	uint32_t	blockSize;
+	uint32_t	*block;
+    uint32_t    totalFree = 0;
+    uint32_t    run = 0;
+    uint32_t    largest = 0;
+
+    if (index < 0 || index >= heap_count)
+        return MICROBIT_INVALID_PARAMETER;
+
+	// Disable IRQ temporarily to ensure no race conditions!
+    __disable_irq();
+
+    // Adjacent free blocks are merged lazily by microbit_malloc, so treat each run of free blocks as one.
+	block = heap[index].heap_start;
+	while (block < heap[index].heap_end)
+	{
+		blockSize = *block & ~MICROBIT_HEAP_BLOCK_FREE;
+
+        if (*block & MICROBIT_HEAP_BLOCK_FREE)
+        {
+            totalFree += blockSize;
+            run += blockSize;
+
+            if (run > largest)
+                largest = run;
+        }
+        else
+        {
+            run = 0;
+        }
+
+		block += blockSize;
+    }
+
+    info.start = (uint32_t)(uintptr_t) heap[index].heap_start;
+    info.end = (uint32_t)(uintptr_t) heap[index].heap_end;
+
+	// Enable Interrupts
+    __enable_irq();
+
+    // One block of each allocation is consumed by its index block.
+    info.free = totalFree * MICROBIT_HEAP_BLOCK_SIZE;
+    info.largest = largest > 1 ? (largest - 1) * MICROBIT_HEAP_BLOCK_SIZE : 0;
 
     return MICROBIT_OK;
 }
@@ -37,6 +37,34 @@ DEALINGS IN THE SOFTWARE.
 
 const int greyScaleTimings[MICROBIT_DISPLAY_GREYSCALE_BIT_DEPTH] = {1, 23, 70, 163, 351, 726, 1476, 2976};
 
+// The time in microseconds a pixel is lit for in greyscale mode, indexed by the low and high nibble of its brightness.
+// Each bit of the brightness contributes the duration given for it in greyScaleTimings.
+static const uint16_t greyScaleTimingsLow[16] = {0, 1, 23, 24, 70, 71, 93, 94, 163, 164, 186, 187, 233, 234, 256, 257};
+static const uint16_t greyScaleTimingsHigh[16] = {0, 351, 726, 1077, 1476, 1827, 2202, 2553, 2976, 3327, 3702, 4053, 4452, 4803, 5178, 5529};
+
+/**
+  * A brightness curve with a gamma of 2.2, for use with setBrightnessCurve().
+  * Gives a perceptually even change in brightness across the range of brightness values.
+  */
+const uint8_t MicroBitDisplay::gammaCurve[256] = {
+      0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
 /**
   * Constructor.
   *
@@ -76,25 +104,47 @@ MicroBitDisplay::MicroBitDisplay(uint16_t id, const MatrixMap &map) :
 
     LEDMatrix = new PortOut(Port0, row_mask | col_mask);
 
-    this->greyscaleBitMsk = 0x01;
-    this->timingCount = 0;
+    this->greyscaleStep = 0;
+    this->greyscaleSteps = 0;
+    this->greyscalePattern = 0;
+    this->brightnessCurve = NULL;
+    this->refreshRate = MICROBIT_DISPLAY_REFRESH_RATE;
+    this->rowPeriod = 1000000 / (MICROBIT_DISPLAY_REFRESH_RATE * matrixMap.rows);
     this->setBrightness(MICROBIT_DISPLAY_DEFAULT_BRIGHTNESS);
     this->mode = DISPLAY_MODE_BLACK_AND_WHITE;
     this->animationMode = ANIMATION_MODE_NONE;
     this->lightSensor = NULL;
 
+    this->pixelOffsets = new uint16_t[matrixMap.rows * matrixMap.columns];
+    this->updatePixelOffsets();
+
+    this->frontBuffer = NULL;
+    this->rowPatterns = NULL;
+    this->dirtyRows = 0;
+
+    this->greyscaleTimes = new uint16_t[matrixMap.columns];
+    this->greyscaleMasks = new uint32_t[matrixMap.columns];
+
+    this->animationFrame = NULL;
+    this->animationFramesLeft = 0;
+
+    this->sprites = NULL;
+    this->spritesChanged = false;
+
 	system_timer_add_component(this);
 
     status |= MICROBIT_COMPONENT_RUNNING;
+
+    refreshTimer.attach_us(this, &MicroBitDisplay::refresh, rowPeriod);
 }
 
 /**
-  * Internal frame update method, used to strobe the display.
+  * Refresh timer callback, used to strobe the display.
   *
   * TODO: Write a more efficient, complementary variation of this method for the case where
   * MICROBIT_DISPLAY_ROW_COUNT > MICROBIT_DISPLAY_COLUMN_COUNT.
   */
-void MicroBitDisplay::systemTick()
+void MicroBitDisplay::refresh()
 {
     if(!(status & MICROBIT_COMPONENT_RUNNING))
         return;
@@ -109,72 +159,174 @@ void MicroBitDisplay::systemTick()
     strobeRow++;
 
     //reset the row counts and bit mask when we have hit the max.
-    if(strobeRow == matrixMap.rows)
+    if(strobeRow >= matrixMap.rows)
         strobeRow = 0;
 
     if(mode == DISPLAY_MODE_BLACK_AND_WHITE)
         render();
 
     if(mode == DISPLAY_MODE_GREYSCALE)
-    {
-        greyscaleBitMsk = 0x01;
-        timingCount = 0;
         renderGreyscale();
-    }
+}
+
+/**
+  * Periodic callback from the system timer, used to update any animations that are running.
+  * The LED matrix itself is refreshed from the display's own timer.
+  */
+void MicroBitDisplay::systemTick()
+{
+    if(!(status & MICROBIT_COMPONENT_RUNNING))
+        return;
 
     // Update text and image animations if we need to.
     this->animationUpdate();
 }
 
+/**
+  * Recalculates renderTime and greyscaleScale for the current refresh rate, brightness and brightness curve.
+  */
+void MicroBitDisplay::updateRenderTimes()
+{
+    int onTime = rowPeriod * MICROBIT_DISPLAY_ROW_DUTY_CYCLE / 100;
+    int duty = brightnessCurve ? brightnessCurve[brightness] : brightness;
+
+    renderTime = duty * onTime / 255;
+    greyscaleScale = (onTime << 12) / (greyScaleTimingsLow[15] + greyScaleTimingsHigh[15]);
+}
 void MicroBitDisplay::renderFinish()
 {
     *LEDMatrix = 0;
 }
 
-void MicroBitDisplay::render()
+/**
+  * Reads the brightness of a pixel, given its entry in pixelOffsets.
+  */
+static inline int readPixel(const uint8_t *bitmap, uint16_t offset, uint8_t format)
 {
-    // Simple optimisation.
-    // If display is at zero brightness, there's nothing to do.
-    if(brightness == 0)
+    if (offset == MICROBIT_DISPLAY_PIXEL_NONE)
+        return 0;
+
+    if (format == MICROBIT_IMAGE_FORMAT_8BPP)
+        return bitmap[offset];
+
+    if (format == MICROBIT_IMAGE_FORMAT_1BPP)
+        return (bitmap[offset >> 3] & (1 << (offset & 7))) ? 255 : 0;
+
+    return ((bitmap[offset >> 3] >> (offset & 4)) & 0x0F) * 0x11;
+}
+
+/**
+  * Recalculates pixelOffsets for the current rotation, matrix map and image geometry.
+  *
+  * This moves the matrix map lookup and rotation out of the render path, which runs in interrupt context.
+  */
+void MicroBitDisplay::updatePixelOffsets()
+{
+    pixelFormat = image.getFormat();
+    pixelStride = image.getStride();
+
+    for (int row = 0; row < matrixMap.rows; row++)
     {
-        renderFinish();
-        return;
+        for (int i = 0; i < matrixMap.columns; i++)
+        {
+            int index = (i * matrixMap.rows) + row;
+
+            int x = matrixMap.map[index].x;
+            int y = matrixMap.map[index].y;
+            int t = x;
+
+            if(rotation == MICROBIT_DISPLAY_ROTATION_90)
+            {
+                    x = width - 1 - y;
+                    y = t;
+            }
+
+            if(rotation == MICROBIT_DISPLAY_ROTATION_180)
+            {
+                    x = width - 1 - x;
+                    y = height - 1 - y;
+            }
+
+            if(rotation == MICROBIT_DISPLAY_ROTATION_270)
+            {
+                    x = y;
+                    y = height - 1 - t;
+            }
+
+            uint16_t offset = MICROBIT_DISPLAY_PIXEL_NONE;
+
+            if (x < image.getWidth() && y < image.getHeight())
+            {
+                if (pixelFormat == MICROBIT_IMAGE_FORMAT_8BPP)
+                    offset = y * pixelStride + x;
+                else
+                    offset = y * pixelStride * 8 + x * image.getBitsPerPixel();
+            }
+
+            pixelOffsets[row * matrixMap.columns + i] = offset;
+        }
     }
+}
+
+/**
+  * Calculates the black and white column pattern for the row currently being strobed.
+  *
+  * @return A bit pattern with bit n set if column n should be lit.
+  */
+uint32_t MicroBitDisplay::getColumnPattern()
+{
+    // The light sensing mode strobes one row beyond the matrix, which has nothing to display.
+    if (strobeRow >= matrixMap.rows)
+        return 0;
 
-    // Calculate the bitpattern to write.
-    uint32_t row_data = 0x01 << (matrixMap.rowStart + strobeRow);
     uint32_t col_data = 0;
 
-    for (int i = 0; i < matrixMap.columns; i++)
+    if (frontBuffer)
     {
-        int index = (i * matrixMap.rows) + strobeRow;
+        const uint8_t *values = frontBuffer + strobeRow * matrixMap.columns;
 
-        int x = matrixMap.map[index].x;
-        int y = matrixMap.map[index].y;
-        int t = x;
-
-        if(rotation == MICROBIT_DISPLAY_ROTATION_90)
+        // Patterns are cached, and only recalculated for rows changed by a commit.
+        if (dirtyRows & (1 << strobeRow))
         {
-                x = width - 1 - y;
-                y = t;
-        }
+            for (int i = 0; i < matrixMap.columns; i++)
+                if (values[i])
+                    col_data |= (1 << i);
 
-        if(rotation == MICROBIT_DISPLAY_ROTATION_180)
-        {
-                x = width - 1 - x;
-                y = height - 1 - y;
+            rowPatterns[strobeRow] = col_data;
+            dirtyRows &= ~(1 << strobeRow);
         }
 
-        if(rotation == MICROBIT_DISPLAY_ROTATION_270)
-        {
-                x = y;
-                y = height - 1 - t;
-        }
+        return rowPatterns[strobeRow];
+    }
+
+    // If the image has been replaced by one of a different geometry, our offsets are stale.
+    if (image.getFormat() != pixelFormat || image.getStride() != pixelStride)
+        updatePixelOffsets();
 
-        if(image.getBitmap()[y*(width*2)+x])
+    const uint16_t *offsets = pixelOffsets + strobeRow * matrixMap.columns;
+    const uint8_t *bitmap = image.getBitmap();
+
+    for (int i = 0; i < matrixMap.columns; i++)
+        if (readPixel(bitmap, offsets[i], pixelFormat))
             col_data |= (1 << i);
+
+    return col_data;
+}
+
+void MicroBitDisplay::render()
+{
+    // Simple optimisation.
+    // If display is at zero brightness, there's nothing to do.
+    if(brightness == 0)
+    {
+        renderFinish();
+        return;
     }
 
+    // Calculate the bitpattern to write.
+    uint32_t row_data = 0x01 << (matrixMap.rowStart + strobeRow);
+    uint32_t col_data = getColumnPattern();
+
     // Invert column bits (as we're sinking not sourcing power), and mask off any unused bits.
     col_data = ~col_data << matrixMap.columnStart & col_mask;
 
@@ -182,95 +334,118 @@ void MicroBitDisplay::render()
     *LEDMatrix = col_data | row_data;
 
     //timer does not have enough resolution for brightness of 1. 23.53 us
-    if(brightness != MICROBIT_DISPLAY_MAXIMUM_BRIGHTNESS && brightness > MICROBIT_DISPLAY_MINIMUM_BRIGHTNESS)
-        renderTimer.attach_us(this, &MicroBitDisplay::renderFinish, (((brightness * 950) / (MICROBIT_DISPLAY_MAXIMUM_BRIGHTNESS)) * system_timer_get_period()));
+    if(brightness != MICROBIT_DISPLAY_MAXIMUM_BRIGHTNESS && brightness > MICROBIT_DISPLAY_MINIMUM_BRIGHTNESS && renderTime > 0)
+        renderTimer.attach_us(this, &MicroBitDisplay::renderFinish, renderTime);
 
     //this will take around 23us to execute
-    if(brightness <= MICROBIT_DISPLAY_MINIMUM_BRIGHTNESS)
+    if(brightness <= MICROBIT_DISPLAY_MINIMUM_BRIGHTNESS || renderTime == 0)
         renderFinish();
 }
 
 void MicroBitDisplay::renderWithLightSense()
 {
+    // Leave the matrix dark while the light sensor settles and samples a column. This takes
+    // MICROBIT_LIGHT_SENSOR_AN_SET_TIME, which spans several row periods at higher refresh rates.
+    if (lightSensor != NULL && lightSensor->isSensing())
+        return;
+
     //reset the row counts and bit mask when we have hit the max.
-    if(strobeRow == matrixMap.rows + 1)
+    if(strobeRow >= matrixMap.rows)
     {
-        MicroBitEvent(id, MICROBIT_DISPLAY_EVT_LIGHT_SENSE);
         strobeRow = 0;
-    }
-    else
-    {
-        render();
-        this->animationUpdate();
 
-        // Move on to the next row.
-        strobeRow++;
+        // Only give up a row period to the light sensor when it is due to take a sample.
+        if (lightSensor != NULL && lightSensor->isSampleNeeded())
+        {
+            MicroBitEvent(id, MICROBIT_DISPLAY_EVT_LIGHT_SENSE);
+            return;
+        }
     }
 
+    render();
+
+    // Move on to the next row.
+    strobeRow++;
 }
 
 void MicroBitDisplay::renderGreyscale()
 {
     // Simple optimisation.
     // If display is at zero brightness, there's nothing to do.
-    if(brightness == 0)
+    if(brightness == 0 || strobeRow >= matrixMap.rows)
     {
         renderFinish();
         return;
     }
 
-    uint32_t row_data = 0x01 << (matrixMap.rowStart + strobeRow);
-    uint32_t col_data = 0;
+    if (frontBuffer == NULL && (image.getFormat() != pixelFormat || image.getStride() != pixelStride))
+        updatePixelOffsets();
+
+    const uint8_t *values = frontBuffer ? frontBuffer + strobeRow * matrixMap.columns : NULL;
+    const uint16_t *offsets = pixelOffsets + strobeRow * matrixMap.columns;
+    const uint8_t *bitmap = image.getBitmap();
+
+    // Build the schedule for this row: the time at which each lit column is turned off, in ascending order.
+    // Columns due to be turned off within MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL of each other share a single timer event.
+    greyscalePattern = 0;
+    greyscaleSteps = 0;
+    greyscaleStep = 0;
 
-    // Calculate the bitpattern to write.
     for (int i = 0; i < matrixMap.columns; i++)
     {
-        int index = (i * matrixMap.rows) + strobeRow;
+        int v = min(values ? values[i] : readPixel(bitmap, offsets[i], pixelFormat), brightness);
 
-        int x = matrixMap.map[index].x;
-        int y = matrixMap.map[index].y;
-        int t = x;
+        if (v == 0)
+            continue;
 
-        if(rotation == MICROBIT_DISPLAY_ROTATION_90)
-        {
-                x = width - 1 - y;
-                y = t;
-        }
+        int t = max(((greyScaleTimingsLow[v & 0x0F] + greyScaleTimingsHigh[v >> 4]) * greyscaleScale) >> 12, MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL);
+        int n = 0;
+
+        greyscalePattern |= (1 << i);
 
-        if(rotation == MICROBIT_DISPLAY_ROTATION_180)
+        while (n < greyscaleSteps && greyscaleTimes[n] + MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL <= t)
+            n++;
+
+        if (n < greyscaleSteps && greyscaleTimes[n] < t + MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL)
         {
-                x = width - 1 - x;
-                y = height - 1 - y;
+            greyscaleMasks[n] |= (1 << i);
+            continue;
         }
 
-        if(rotation == MICROBIT_DISPLAY_ROTATION_270)
+        for (int k = greyscaleSteps; k > n; k--)
         {
-                x = y;
-                y = height - 1 - t;
+            greyscaleTimes[k] = greyscaleTimes[k-1];
+            greyscaleMasks[k] = greyscaleMasks[k-1];
         }
 
-        if(min(image.getBitmap()[y * (width * 2) + x],brightness) & greyscaleBitMsk)
-            col_data |= (1 << i);
+        greyscaleTimes[n] = t;
+        greyscaleMasks[n] = (1 << i);
+        greyscaleSteps++;
     }
 
-    // Invert column bits (as we're sinking not sourcing power), and mask off any unused bits.
-    col_data = ~col_data << matrixMap.columnStart & col_mask;
-
-    // Write the new bit pattern
-    *LEDMatrix = col_data | row_data;
+    // Write the new bit pattern, inverting column bits (as we're sinking not sourcing power).
+    *LEDMatrix = (~greyscalePattern << matrixMap.columnStart & col_mask) | (0x01 << (matrixMap.rowStart + strobeRow));
 
-    if(timingCount > MICROBIT_DISPLAY_GREYSCALE_BIT_DEPTH-1)
-        return;
+    if (greyscaleSteps)
+        renderTimer.attach_us(this, &MicroBitDisplay::renderGreyscaleStep, greyscaleTimes[0]);
+}
 
-    greyscaleBitMsk <<= 1;
+void MicroBitDisplay::renderGreyscaleStep()
+{
+    greyscalePattern &= ~greyscaleMasks[greyscaleStep];
 
-    if(timingCount < 3)
+    if (greyscalePattern == 0)
     {
-        wait_us(greyScaleTimings[timingCount++]);
-        renderGreyscale();
+        renderFinish();
         return;
     }
-    renderTimer.attach_us(this,&MicroBitDisplay::renderGreyscale, greyScaleTimings[timingCount++]);
+
+    *LEDMatrix = (~greyscalePattern << matrixMap.columnStart & col_mask) | (0x01 << (matrixMap.rowStart + strobeRow));
+
+    greyscaleStep++;
+
+    if (greyscaleStep < greyscaleSteps)
+        renderTimer.attach_us(this, &MicroBitDisplay::renderGreyscaleStep, greyscaleTimes[greyscaleStep] - greyscaleTimes[greyscaleStep - 1]);
 }
 
 /**
@@ -279,6 +454,9 @@ void MicroBitDisplay::renderGreyscale()
 void
 MicroBitDisplay::animationUpdate()
 {
+    if (sprites != NULL || spritesChanged)
+        this->updateSprites();
+
     // If there's no ongoing animation, then nothing to do.
     if (animationMode == ANIMATION_MODE_NONE)
         return;
@@ -301,14 +479,98 @@ MicroBitDisplay::animationUpdate()
         if (animationMode == ANIMATION_MODE_ANIMATE_IMAGE || animationMode == ANIMATION_MODE_ANIMATE_IMAGE_WITH_CLEAR)
             this->updateAnimateImage();
 
+        if (animationMode == ANIMATION_MODE_ANIMATE_FRAMES || animationMode == ANIMATION_MODE_ANIMATE_FRAMES_WITH_CLEAR)
+            this->updateAnimateFrames();
+
         if(animationMode == ANIMATION_MODE_PRINT_CHARACTER)
         {
             animationMode = ANIMATION_MODE_NONE;
             this->sendAnimationCompleteEvent();
         }
+
+        this->commit();
     }
 }
 
+/**
+  * Steps any moving sprites, and composites the sprites into the image if any of them have changed.
+  */
+void MicroBitDisplay::updateSprites()
+{
+    bool changed = spritesChanged;
+    bool reorder = false;
+    int elapsed = system_timer_get_period();
+
+    spritesChanged = false;
+
+    for (MicroBitSprite *s = sprites; s != NULL; s = s->next)
+    {
+        if (s->period)
+        {
+            s->tick += elapsed;
+
+            while (s->tick >= s->period)
+            {
+                s->tick -= s->period;
+                s->x += s->vx;
+                s->y += s->vy;
+                s->flags |= MICROBIT_SPRITE_CHANGED;
+            }
+        }
+
+        if (s->flags & MICROBIT_SPRITE_REORDER)
+            reorder = true;
+
+        if (s->flags & MICROBIT_SPRITE_CHANGED)
+            changed = true;
+    }
+
+    if (!changed)
+        return;
+
+    // Restore depth order if any sprite has changed its depth, by reinserting every sprite.
+    if (reorder)
+    {
+        MicroBitSprite *s = sprites;
+        sprites = NULL;
+
+        while (s != NULL)
+        {
+            MicroBitSprite *next = s->next;
+            insertSprite(s);
+            s = next;
+        }
+    }
+
+    image.clear();
+
+    for (MicroBitSprite *s = sprites; s != NULL; s = s->next)
+    {
+        s->flags &= ~(MICROBIT_SPRITE_CHANGED | MICROBIT_SPRITE_REORDER);
+
+        if (s->flags & MICROBIT_SPRITE_VISIBLE)
+            image.paste(s->image, s->x, s->y, (s->flags & MICROBIT_SPRITE_ALPHA) ? 1 : 0);
+    }
+
+    this->commit();
+}
+
+/**
+  * Inserts the given sprite into the list of sprites, after any sprites of the same or lower depth.
+  *
+  * @param sprite The sprite to insert. Must not already be in the list.
+  */
+void MicroBitDisplay::insertSprite(MicroBitSprite *sprite)
+{
+    MicroBitSprite **p = &sprites;
+
+    while (*p != NULL && (*p)->z <= sprite->z)
+        p = &(*p)->next;
+
+    sprite->next = *p;
+    *p = sprite;
+}
+
 /**
   * Broadcasts an event onto the defult EventModel indicating that the
   * current animation has completed.
@@ -322,29 +584,85 @@ void MicroBitDisplay::sendAnimationCompleteEvent()
     MicroBitEvent(MICROBIT_ID_NOTIFY_ONE, MICROBIT_DISPLAY_EVT_FREE);
 }
 
+/**
+  * Discards any columns of scrollingStrip that have scrolled off the display,
+  * and renders as many of the following characters as will fit in their place.
+  */
+void MicroBitDisplay::renderScrollStrip()
+{
+    int discard = scrollingPosition - (width - 1);
+
+    if (discard > 0)
+    {
+        scrollingStrip.shiftLeft(discard);
+        scrollingStripLength -= discard;
+        scrollingPosition -= discard;
+    }
+
+    MicroBitFont font = MicroBitFont::getSystemFont();
+
+    // Characters of proportional fonts take only as many columns as they use, plus any kerning with the next character.
+    while (scrollingChar < scrollingText.length() && scrollingStripLength + MICROBIT_FONT_WIDTH + MICROBIT_DISPLAY_SPACING <= scrollingStrip.getWidth())
+    {
+        char c = scrollingText.charAt(scrollingChar);
+        int spacing = MICROBIT_DISPLAY_SPACING;
+
+        if (scrollingChar + 1 < scrollingText.length())
+            spacing = max(spacing + font.getKerning(c, scrollingText.charAt(scrollingChar + 1)), 0);
+
+        scrollingStrip.print(c, scrollingStripLength, 0);
+        scrollingStripLength += font.getCharWidth(c) + spacing;
+        scrollingChar++;
+    }
+}
+
 /**
   * Internal scrollText update method.
-  * Shift the screen image by one pixel to the left. If necessary, paste in the next char.
+  * Shift the screen image by one pixel to the left, and copy in the visible window of the pre-rendered text.
   */
 void MicroBitDisplay::updateScrollText()
 {
-    image.shiftLeft(1);
-    scrollingPosition++;
+    // Render more of the text once we reach the end of what has been rendered so far.
+    if (scrollingPosition >= scrollingStripLength && scrollingChar < scrollingText.length())
+        renderScrollStrip();
 
-    if (scrollingPosition == width + MICROBIT_DISPLAY_SPACING)
+    // Stop once the last of the text has scrolled off the display.
+    if (scrollingPosition >= scrollingStripLength + width)
     {
-        scrollingPosition = 0;
+        animationMode = ANIMATION_MODE_NONE;
+        this->sendAnimationCompleteEvent();
+        return;
+    }
 
-        image.print(scrollingChar < scrollingText.length() ? scrollingText.charAt(scrollingChar) : ' ',width,0);
+    int x = width - 1 - scrollingPosition;
 
-        if (scrollingChar > scrollingText.length())
-        {
-            animationMode = ANIMATION_MODE_NONE;
-            this->sendAnimationCompleteEvent();
-            return;
-        }
-        scrollingChar++;
-   }
+    // Whatever was on the display before the text scrolls out to the left, until the text covers the whole display.
+    if (x > 0)
+        image.shiftLeft(1);
+
+    image.paste(scrollingStrip, x, 0);
+    scrollingPosition++;
+}
+
+/**
+  * Prints the given character in the middle of the display.
+  * Characters of fixed width fonts fill the display, so are simply printed at the origin.
+  *
+  * @param c The character to print.
+  */
+void MicroBitDisplay::printCentred(char c)
+{
+    MicroBitFont font = MicroBitFont::getSystemFont();
+
+    if (!font.isProportional())
+    {
+        image.print(c, 0, 0);
+        return;
+    }
+
+    // Proportional characters only draw the columns they use, so clear whatever was there before.
+    image.clear();
+    image.print(c, (width - font.getCharWidth(c)) / 2, 0);
 }
 
 /**
@@ -353,7 +671,7 @@ void MicroBitDisplay::updateScrollText()
   */
 void MicroBitDisplay::updatePrintText()
 {
-    image.print(printingChar < printingText.length() ? printingText.charAt(printingChar) : ' ',0,0);
+    this->printCentred(printingChar < printingText.length() ? printingText.charAt(printingChar) : ' ');
 
     if (printingChar > printingText.length())
     {
@@ -420,6 +738,31 @@ void MicroBitDisplay::updateAnimateImage()
     scrollingImagePosition += scrollingImageStride;
 }
 
+/**
+  * Internal animate(MicroBitAnimation) update method.
+  * Decodes the next frame of the animation into the image, and schedules the one after it.
+  */
+void MicroBitDisplay::updateAnimateFrames()
+{
+    // The last frame has been shown for its full duration.
+    if (animationFramesLeft == 0)
+    {
+        if (animationMode == ANIMATION_MODE_ANIMATE_FRAMES_WITH_CLEAR)
+            this->image.clear();
+
+        animationMode = ANIMATION_MODE_NONE;
+
+        this->sendAnimationCompleteEvent();
+        return;
+    }
+
+    uint16_t duration;
+
+    animationFrame = frameAnimation.decodeFrame(animationFrame, image, 0, 0, duration);
+    animationFramesLeft--;
+    animationDelay = duration;
+}
+
 /**
   * Resets the current given animation.
   */
@@ -439,6 +782,7 @@ void MicroBitDisplay::stopAnimation()
 
     // Clear the display and setup the animation timers.
     this->image.clear();
+    this->commit();
 }
 
 /**
@@ -487,7 +831,8 @@ int MicroBitDisplay::printCharAsync(char c, int delay)
     // If the display is free, it's our turn to display.
     if (animationMode == ANIMATION_MODE_NONE || animationMode == ANIMATION_MODE_STOPPED)
     {
-        image.print(c, 0, 0);
+        this->printCentred(c);
+        commit();
 
         if (delay > 0)
         {
@@ -519,7 +864,7 @@ int MicroBitDisplay::printCharAsync(char c, int delay)
   * display.printAsync("abc123",400);
   * @endcode
   */
-int MicroBitDisplay::printAsync(ManagedString s, int delay)
+int MicroBitDisplay::printAsync(const ManagedString &s, int delay)
 {
     if (s.length() == 1)
         return printCharAsync(s.charAt(0));
@@ -564,7 +909,7 @@ int MicroBitDisplay::printAsync(ManagedString s, int delay)
   * display.print(i,400);
   * @endcode
   */
-int MicroBitDisplay::printAsync(MicroBitImage i, int x, int y, int alpha, int delay)
+int MicroBitDisplay::printAsync(const MicroBitImage &i, int x, int y, int alpha, int delay)
 {
     if(delay < 0)
         return MICROBIT_INVALID_PARAMETER;
@@ -572,6 +917,7 @@ int MicroBitDisplay::printAsync(MicroBitImage i, int x, int y, int alpha, int de
     if (animationMode == ANIMATION_MODE_NONE || animationMode == ANIMATION_MODE_STOPPED)
     {
         image.paste(i, x, y, alpha);
+        commit();
 
         if(delay > 0)
         {
@@ -644,7 +990,7 @@ int MicroBitDisplay::printChar(char c, int delay)
   * display.print("abc123",400);
   * @endcode
   */
-int MicroBitDisplay::print(ManagedString s, int delay)
+int MicroBitDisplay::print(const ManagedString &s, int delay)
 {
     //sanitise this value
     if(delay <= 0 )
@@ -696,7 +1042,7 @@ int MicroBitDisplay::print(ManagedString s, int delay)
   * display.print(i,400);
   * @endcode
   */
-int MicroBitDisplay::print(MicroBitImage i, int x, int y, int alpha, int delay)
+int MicroBitDisplay::print(const MicroBitImage &i, int x, int y, int alpha, int delay)
 {
     if(delay < 0)
         return MICROBIT_INVALID_PARAMETER;
@@ -736,7 +1082,7 @@ int MicroBitDisplay::print(MicroBitImage i, int x, int y, int alpha, int delay)
   * display.scrollAsync("abc123",100);
   * @endcode
   */
-int MicroBitDisplay::scrollAsync(ManagedString s, int delay)
+int MicroBitDisplay::scrollAsync(const ManagedString &s, int delay)
 {
     //sanitise this value
     if(delay <= 0)
@@ -745,10 +1091,18 @@ int MicroBitDisplay::scrollAsync(ManagedString s, int delay)
     // If the display is free, it's our turn to display.
     if (animationMode == ANIMATION_MODE_NONE || animationMode == ANIMATION_MODE_STOPPED)
     {
-        scrollingPosition = width-1;
+        if (scrollingStrip.getWidth() != MICROBIT_DISPLAY_SCROLL_STRIP_WIDTH)
+            scrollingStrip = MicroBitImage(MICROBIT_DISPLAY_SCROLL_STRIP_WIDTH, MICROBIT_FONT_HEIGHT, MICROBIT_IMAGE_FORMAT_1BPP);
+        else
+            scrollingStrip.clear();
+
+        scrollingPosition = 0;
+        scrollingStripLength = 0;
         scrollingChar = 0;
         scrollingText = s;
 
+        renderScrollStrip();
+
         animationDelay = delay;
         animationTick = 0;
         animationMode = ANIMATION_MODE_SCROLL_TEXT;
@@ -761,6 +1115,39 @@ int MicroBitDisplay::scrollAsync(ManagedString s, int delay)
     return MICROBIT_OK;
 }
 
+/**
+  * Scrolls the string held by a ManagedStringBuilder to the display, from right to left.
+  * Returns immediately, and executes the animation asynchronously.
+  *
+  * The builder's buffer is handed over to the display without copying, leaving the builder empty.
+  * If the text is not displayed (e.g. the display is busy), the builder is left unchanged.
+  *
+  * @param b The ManagedStringBuilder holding the string to display.
+  *
+  * @param delay The time to delay between characters, in milliseconds. Defaults
+  *              to: MICROBIT_DEFAULT_SCROLL_SPEED.
+  *
+  * @return MICROBIT_OK, MICROBIT_BUSY if the display is already in use, or MICROBIT_INVALID_PARAMETER.
+  *
+  * @code
+  * ManagedStringBuilder b;
+  * b.append("t=").append(uBit.thermometer.getTemperature());
+  * display.scrollAsync(b, 100);
+  * @endcode
+  */
+int MicroBitDisplay::scrollAsync(ManagedStringBuilder &b, int delay)
+{
+    //sanitise this value
+    if(delay <= 0)
+        return MICROBIT_INVALID_PARAMETER;
+
+    // Only take the builder's buffer once we know the display will accept it.
+    if (animationMode != ANIMATION_MODE_NONE && animationMode != ANIMATION_MODE_STOPPED)
+        return MICROBIT_BUSY;
+
+    return scrollAsync(b.toManagedString(), delay);
+}
+
 /**
   * Scrolls the given image across the display, from right to left.
   * Returns immediately, and executes the animation asynchronously.
@@ -779,7 +1166,7 @@ int MicroBitDisplay::scrollAsync(ManagedString s, int delay)
   * display.scrollAsync(i,100,1);
   * @endcode
   */
-int MicroBitDisplay::scrollAsync(MicroBitImage image, int delay, int stride)
+int MicroBitDisplay::scrollAsync(const MicroBitImage &image, int delay, int stride)
 {
     //sanitise the delay value
     if(delay <= 0)
@@ -820,7 +1207,7 @@ int MicroBitDisplay::scrollAsync(MicroBitImage image, int delay, int stride)
   * display.scroll("abc123",100);
   * @endcode
   */
-int MicroBitDisplay::scroll(ManagedString s, int delay)
+int MicroBitDisplay::scroll(const ManagedString &s, int delay)
 {
     //sanitise this value
     if(delay <= 0)
@@ -847,6 +1234,53 @@ int MicroBitDisplay::scroll(ManagedString s, int delay)
     return MICROBIT_OK;
 }
 
+/**
+  * Scrolls the string held by a ManagedStringBuilder across the display, from right to left.
+  * Blocks the calling thread until all text has been displayed.
+  *
+  * The builder's buffer is handed over to the display without copying, leaving the builder empty.
+  * If the text is not displayed (e.g. the display is busy), the builder is left unchanged.
+  *
+  * @param b The ManagedStringBuilder holding the string to display.
+  *
+  * @param delay The time to delay between characters, in milliseconds. Defaults
+  *              to: MICROBIT_DEFAULT_SCROLL_SPEED.
+  *
+  * @return MICROBIT_OK, MICROBIT_CANCELLED or MICROBIT_INVALID_PARAMETER.
+  *
+  * @code
+  * ManagedStringBuilder b;
+  * b.append("t=").append(uBit.thermometer.getTemperature());
+  * display.scroll(b, 100);
+  * @endcode
+  */
+int MicroBitDisplay::scroll(ManagedStringBuilder &b, int delay)
+{
+    //sanitise this value
+    if(delay <= 0)
+        return MICROBIT_INVALID_PARAMETER;
+
+    // If there's an ongoing animation, wait for our turn to display.
+    this->waitForFreeDisplay();
+
+    // If the display is free, it's our turn to display.
+    // If someone called stopAnimation(), then we simply skip, leaving the builder unchanged...
+    if (animationMode == ANIMATION_MODE_NONE)
+    {
+        // Start the effect.
+        this->scrollAsync(b.toManagedString(), delay);
+
+        // Wait for completion.
+        fiberWait();
+    }
+    else
+    {
+        return MICROBIT_CANCELLED;
+    }
+
+    return MICROBIT_OK;
+}
+
 /**
   * Scrolls the given image across the display, from right to left.
   * Blocks the calling thread until all the text has been displayed.
@@ -865,7 +1299,7 @@ int MicroBitDisplay::scroll(ManagedString s, int delay)
   * display.scroll(i,100,1);
   * @endcode
   */
-int MicroBitDisplay::scroll(MicroBitImage image, int delay, int stride)
+int MicroBitDisplay::scroll(const MicroBitImage &image, int delay, int stride)
 {
     //sanitise the delay value
     if(delay <= 0)
@@ -918,7 +1352,7 @@ int MicroBitDisplay::scroll(MicroBitImage image, int delay, int stride)
   * display.animateAsync(i,100,5);
   * @endcode
   */
-int MicroBitDisplay::animateAsync(MicroBitImage image, int delay, int stride, int startingPosition, int autoClear)
+int MicroBitDisplay::animateAsync(const MicroBitImage &image, int delay, int stride, int startingPosition, int autoClear)
 {
     //sanitise the delay value
     if(delay <= 0)
@@ -973,7 +1407,7 @@ int MicroBitDisplay::animateAsync(MicroBitImage image, int delay, int stride, in
   * display.animate(i,100,5);
   * @endcode
   */
-int MicroBitDisplay::animate(MicroBitImage image, int delay, int stride, int startingPosition, int autoClear)
+int MicroBitDisplay::animate(const MicroBitImage &image, int delay, int stride, int startingPosition, int autoClear)
 {
     //sanitise the delay value
     if(delay <= 0)
@@ -1002,6 +1436,83 @@ int MicroBitDisplay::animate(MicroBitImage image, int delay, int stride, int sta
     return MICROBIT_OK;
 }
 
+/**
+  * Plays a frame sequence animation on the display, showing each frame for its own duration.
+  * Frames are decoded one at a time, directly into the display image, as the animation plays.
+  * Returns immediately.
+  *
+  * @param animation The animation to play. Its encoded data must remain valid until the animation completes.
+  *
+  * @param autoClear defines whether or not the display is automatically cleared once the animation is complete. By default, the display is cleared. Set this parameter to zero to disable the autoClear operation.
+  *
+  * @return MICROBIT_OK, MICROBIT_BUSY if the screen is in use, or MICROBIT_INVALID_PARAMETER if the animation is not valid.
+  *
+  * @code
+  * display.animateAsync(MicroBitAnimation(pulse));
+  * @endcode
+  */
+int MicroBitDisplay::animateAsync(const MicroBitAnimation &animation, int autoClear)
+{
+    if (!animation.isValid())
+        return MICROBIT_INVALID_PARAMETER;
+
+    // If the display is free, we can display.
+    if (animationMode == ANIMATION_MODE_NONE || animationMode == ANIMATION_MODE_STOPPED)
+    {
+        frameAnimation = animation;
+        animationFrame = animation.getFirstFrame();
+        animationFramesLeft = animation.getFrameCount();
+
+        // Show the first frame on the next tick.
+        animationDelay = 0;
+        animationTick = 0;
+        animationMode = autoClear ? ANIMATION_MODE_ANIMATE_FRAMES_WITH_CLEAR : ANIMATION_MODE_ANIMATE_FRAMES;
+    }
+    else
+    {
+        return MICROBIT_BUSY;
+    }
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Plays a frame sequence animation on the display, showing each frame for its own duration.
+  * Blocks the calling thread until the animation is complete.
+  *
+  * @param animation The animation to play.
+  *
+  * @param autoClear defines whether or not the display is automatically cleared once the animation is complete. By default, the display is cleared. Set this parameter to zero to disable the autoClear operation.
+  *
+  * @return MICROBIT_OK, MICROBIT_CANCELLED or MICROBIT_INVALID_PARAMETER.
+  *
+  * @code
+  * display.animate(MicroBitAnimation(pulse));
+  * @endcode
+  */
+int MicroBitDisplay::animate(const MicroBitAnimation &animation, int autoClear)
+{
+    if (!animation.isValid())
+        return MICROBIT_INVALID_PARAMETER;
+
+    // If there's an ongoing animation, wait for our turn to display.
+    this->waitForFreeDisplay();
+
+    // If the display is free, it's our turn to display.
+    // If someone called stopAnimation(), then we simply skip...
+    if (animationMode == ANIMATION_MODE_NONE)
+    {
+        this->animateAsync(animation, autoClear);
+        fiberWait();
+    }
+    else
+    {
+        return MICROBIT_CANCELLED;
+    }
+
+    return MICROBIT_OK;
+}
+
 
 /**
   * Configures the brightness of the display.
@@ -1021,6 +1532,7 @@ int MicroBitDisplay::setBrightness(int b)
         return MICROBIT_INVALID_PARAMETER;
 
     this->brightness = b;
+    this->updateRenderTimes();
 
     return MICROBIT_OK;
 }
@@ -1037,13 +1549,6 @@ int MicroBitDisplay::setBrightness(int b)
   */
 void MicroBitDisplay::setDisplayMode(DisplayMode mode)
 {
-    if(mode == DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE)
-    {
-        //to reduce the artifacts on the display - increase the tick
-        if(system_timer_get_period() != MICROBIT_LIGHT_SENSOR_TICK_PERIOD)
-            system_timer_set_period(MICROBIT_LIGHT_SENSOR_TICK_PERIOD);
-    }
-
     if(this->mode == DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE && mode != DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE)
     {
         delete this->lightSensor;
@@ -1064,6 +1569,62 @@ int MicroBitDisplay::getDisplayMode()
     return this->mode;
 }
 
+/**
+  * Configures the refresh rate of the display.
+  *
+  * The display is refreshed from its own timer, so its refresh rate and brightness are not
+  * affected by changes to the period of the system timer.
+  *
+  * @param rate The number of times the whole display is refreshed each second, in the range
+  *             MICROBIT_DISPLAY_MINIMUM_REFRESH_RATE - MICROBIT_DISPLAY_MAXIMUM_REFRESH_RATE.
+  *
+  * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER
+  *
+  * @code
+  * display.setRefreshRate(100); // refresh the display 100 times a second
+  * @endcode
+  */
+int MicroBitDisplay::setRefreshRate(int rate)
+{
+    if (rate < MICROBIT_DISPLAY_MINIMUM_REFRESH_RATE || rate > MICROBIT_DISPLAY_MAXIMUM_REFRESH_RATE)
+        return MICROBIT_INVALID_PARAMETER;
+
+    refreshRate = rate;
+    rowPeriod = 1000000 / (rate * matrixMap.rows);
+    updateRenderTimes();
+
+    if (status & MICROBIT_COMPONENT_RUNNING)
+        refreshTimer.attach_us(this, &MicroBitDisplay::refresh, rowPeriod);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Fetches the current refresh rate of this display.
+  *
+  * @return the number of times the whole display is refreshed each second.
+  */
+int MicroBitDisplay::getRefreshRate()
+{
+    return refreshRate;
+}
+
+/**
+  * Configures how brightness values map to the time each row of the display is lit for.
+  *
+  * @param curve A table of 256 entries, where entry n is the proportion of the row period (0 - 255) that
+  *              a row is lit for at brightness n. The table is not copied. NULL selects a linear mapping.
+  *
+  * @code
+  * display.setBrightnessCurve(MicroBitDisplay::gammaCurve);
+  * @endcode
+  */
+void MicroBitDisplay::setBrightnessCurve(const uint8_t *curve)
+{
+    brightnessCurve = curve;
+    updateRenderTimes();
+}
+
 /**
   * Fetches the current brightness of this display.
   *
@@ -1090,6 +1651,8 @@ int MicroBitDisplay::getBrightness()
 void MicroBitDisplay::rotateTo(DisplayRotation rotation)
 {
     this->rotation = rotation;
+    this->updatePixelOffsets();
+    this->commit();
 }
 
 /**
@@ -1116,9 +1679,11 @@ void MicroBitDisplay::setEnable(bool enableDisplay)
     {
         PortOut p(Port0, rmask | cmask);
         status |= MICROBIT_COMPONENT_RUNNING;
+        refreshTimer.attach_us(this, &MicroBitDisplay::refresh, rowPeriod);
     }
     else
     {
+        refreshTimer.detach();
         PortIn p(Port0, rmask | cmask);
         p.mode(PullNone);
         status &= ~MICROBIT_COMPONENT_RUNNING;
@@ -1166,6 +1731,205 @@ void MicroBitDisplay::disable()
 void MicroBitDisplay::clear()
 {
     image.clear();
+    commit();
+}
+
+/**
+  * Enables or disables double buffering of the display.
+  *
+  * When double buffered, the LED matrix shows the state of `image` as of the last call to commit().
+  * User code can therefore draw into `image` over any length of time without partially drawn frames
+  * being seen. The display's own print, scroll and animate operations commit automatically.
+  *
+  * When not double buffered (the default), changes to `image` are shown as soon as they are made.
+  *
+  * @param enable true to double buffer the display, false otherwise.
+  *
+  * @return MICROBIT_OK, or MICROBIT_NO_RESOURCES if there is insufficient memory for the front buffer.
+  *
+  * @code
+  * display.setDoubleBuffering(true);
+  * display.image.clear();
+  * display.image.setPixelValue(2, 2, 255);
+  * display.commit(); // the cleared image and the new pixel appear together
+  * @endcode
+  */
+int MicroBitDisplay::setDoubleBuffering(bool enable)
+{
+    if (enable == isDoubleBuffered())
+        return MICROBIT_OK;
+
+    if (enable)
+    {
+        uint8_t *values = (uint8_t *)malloc(matrixMap.rows * matrixMap.columns);
+        uint32_t *patterns = (uint32_t *)malloc(matrixMap.rows * sizeof(uint32_t));
+
+        if (values == NULL || patterns == NULL)
+        {
+            free(values);
+            free(patterns);
+            return MICROBIT_NO_RESOURCES;
+        }
+
+        memclr(values, matrixMap.rows * matrixMap.columns);
+        memclr(patterns, matrixMap.rows * sizeof(uint32_t));
+
+        rowPatterns = patterns;
+        dirtyRows = 0;
+        frontBuffer = values;
+
+        // Show whatever is currently in the image.
+        commit();
+    }
+    else
+    {
+        uint8_t *values = frontBuffer;
+        uint32_t *patterns = rowPatterns;
+
+        __disable_irq();
+        frontBuffer = NULL;
+        rowPatterns = NULL;
+        __enable_irq();
+
+        free(values);
+        free(patterns);
+    }
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Determines if the display is double buffered.
+  *
+  * @return true if the display is double buffered, false otherwise.
+  */
+bool MicroBitDisplay::isDoubleBuffered()
+{
+    return frontBuffer != NULL;
+}
+
+/**
+  * Atomically shows the current contents of `image` on the LED matrix.
+  *
+  * Only rows of the matrix that have changed since the previous commit are recalculated by the renderer.
+  * This has no effect if the display is not double buffered.
+  *
+  * @return MICROBIT_OK.
+  *
+  * @code
+  * display.image.shiftLeft(1);
+  * display.image.setPixelValue(4, 2, 255);
+  * display.commit();
+  * @endcode
+  */
+int MicroBitDisplay::commit()
+{
+    if (frontBuffer == NULL)
+        return MICROBIT_OK;
+
+    if (image.getFormat() != pixelFormat || image.getStride() != pixelStride)
+        updatePixelOffsets();
+
+    const uint8_t *bitmap = image.getBitmap();
+    int columns = matrixMap.columns;
+
+    // Take a snapshot of the pixels on the matrix, so that a frame is never rendered from two different commits.
+    __disable_irq();
+
+    for (int row = 0; row < matrixMap.rows; row++)
+    {
+        uint8_t *values = frontBuffer + row * columns;
+        const uint16_t *offsets = pixelOffsets + row * columns;
+        bool changed = false;
+
+        for (int i = 0; i < columns; i++)
+        {
+            uint8_t value = readPixel(bitmap, offsets[i], pixelFormat);
+
+            if (values[i] != value)
+            {
+                values[i] = value;
+                changed = true;
+            }
+        }
+
+        if (changed)
+            dirtyRows |= (1 << row);
+    }
+
+    __enable_irq();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Adds a sprite to the display.
+  *
+  * While any sprites are added, the display composites its image from them: whenever a sprite is
+  * moved, changed, shown or hidden, the image is cleared and every visible sprite is drawn into it,
+  * in ascending order of depth. Sprites with a velocity are moved by the display as time passes.
+  *
+  * The sprite must remain in scope until it is removed from the display.
+  *
+  * @param sprite The sprite to add.
+  *
+  * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER if the sprite has already been added to a display.
+  *
+  * @code
+  * MicroBitSprite player(MicroBitImage("255\n"), 2, 4, 1);
+  * MicroBitSprite ball(MicroBitImage("255\n"), 0, 0);
+  * ball.setVelocity(1, 1, 250);
+  *
+  * display.addSprite(player);
+  * display.addSprite(ball);
+  * @endcode
+  */
+int MicroBitDisplay::addSprite(MicroBitSprite &sprite)
+{
+    if (sprite.flags & MICROBIT_SPRITE_ADDED)
+        return MICROBIT_INVALID_PARAMETER;
+
+    // The sprite list is walked by the display from interrupt context.
+    __disable_irq();
+
+    sprite.flags |= MICROBIT_SPRITE_ADDED;
+    insertSprite(&sprite);
+    spritesChanged = true;
+
+    __enable_irq();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Removes a sprite from the display.
+  *
+  * @param sprite The sprite to remove.
+  *
+  * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER if the sprite has not been added to this display.
+  */
+int MicroBitDisplay::removeSprite(MicroBitSprite &sprite)
+{
+    int result = MICROBIT_INVALID_PARAMETER;
+
+    __disable_irq();
+
+    for (MicroBitSprite **p = &sprites; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == &sprite)
+        {
+            *p = sprite.next;
+            sprite.next = NULL;
+            sprite.flags &= ~MICROBIT_SPRITE_ADDED;
+            spritesChanged = true;
+            result = MICROBIT_OK;
+            break;
+        }
+    }
+
+    __enable_irq();
+
+    return result;
 }
 
 /**
@@ -1207,8 +1971,8 @@ MicroBitImage MicroBitDisplay::screenShot()
   * Internally, it constructs an instance of a MicroBitLightSensor if not already configured
   * and sets the display mode to DISPLAY_MODE_BLACK_AND_WHITE_LIGHT_SENSE.
   *
-  * This also changes the tickPeriod to MICROBIT_LIGHT_SENSOR_TICK_SPEED so
-  * that the display does not suffer from artifacts.
+  * The display only stops to sample the light level while it is being read, or while
+  * something is listening for MICROBIT_LIGHT_SENSOR_EVT_UPDATE events.
   *
   * @return an indicative light level in the range 0 - 255.
   *
@@ -1233,4 +1997,13 @@ int MicroBitDisplay::readLightLevel()
 MicroBitDisplay::~MicroBitDisplay()
 {
     system_timer_remove_component(this);
+    refreshTimer.detach();
+
+    while (sprites != NULL)
+        removeSprite(*sprites);
+
+    setDoubleBuffering(false);
+    delete[] pixelOffsets;
+    delete[] greyscaleTimes;
+    delete[] greyscaleMasks;
 }
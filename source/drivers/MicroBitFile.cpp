@@ -31,7 +31,7 @@ DEALINGS IN THE SOFTWARE.
   */
 MicroBitFile::MicroBitFile(ManagedString fileName, int mode)
 {
-    this->fileName = fileName;
+    this->fileName = fileName.intern();
 
     MicroBitFileSystem* fs;
 
@@ -24,6 +24,9 @@ DEALINGS IN THE SOFTWARE.
 #include "MicroBitFlash.h"
 #include "MicroBitStorage.h"        
 #include "MicroBitCompat.h"
+#include "MicroBitFiber.h"
+#include "MicroBitSystemTimer.h"
+#include "EventModel.h"
 #include "ErrorNo.h"
 
 static uint32_t *defaultScratchPage = (uint32_t *)DEFAULT_SCRATCH_PAGE;
@@ -32,106 +35,215 @@ MicroBitFileSystem* MicroBitFileSystem::defaultFileSystem = NULL;
 
 /**
   * Allocate a free logical block.
-  * This is chosen at random from the blocks available, to even out the wear on the physical device.
-  * @return a valid, unused block address on success, or zero if no space is available.
+  * Blocks are allocated from the page last allocated from until it is full, then from the least worn
+  * free page, to even out the wear on the physical device.
+  * @return a valid, unused block number on success, or zero if no space is available.
   */
 uint16_t MicroBitFileSystem::getFreeBlock()
 {
-    // Walk the File Table and allocate the first free block - starting immediately after the last block allocated,
-    // and wrapping around the filesystem space if we reach the end.
-    uint16_t block;
-    uint16_t deletedBlock = 0;
+    int blocksPerPage = (PAGE_SIZE / MBFS_BLOCK_SIZE);
+    uint16_t page = lastBlockAllocated - (lastBlockAllocated % blocksPerPage);
 
-    for (block = (lastBlockAllocated + 1) % fileSystemSize; block != lastBlockAllocated; block++)
+    // Keep filling the page we last allocated from, so that data written together is recycled together.
+    if (countBlocks(freeMap, page) == 0)
     {
-        if (fileSystemTable[block] == MBFS_UNUSED)
+        // Otherwise, prefer the least worn empty page, then the least worn page with any space at all.
+        page = getLeastWornPage(blocksPerPage);
+
+        if (page == 0)
+            page = getLeastWornPage(1);
+
+        // If no UNUSED blocks are available, recycle the FileTable, such that we can mark all previously deleted blocks as re-usable.
+        // Better to do this in bulk, rather than on a block by block basis to improve efficiency.
+        if (page == 0 && deletedBlocks > 0)
         {
-            lastBlockAllocated = block;
-            return block;
+            recycleFileTable();
+            page = getLeastWornPage(1);
         }
 
-        if (fileSystemTable[block] == MBFS_DELETED)
-            deletedBlock = block;
+        // If no blocks are available - either UNUSED or marked as DELETED, then we're out of space and there's nothing we can do.
+        if (page == 0)
+            return 0;
     }
 
-    // if no UNUSED blocks are available, try to recycle one marked as DELETED.
-    block = deletedBlock;
-
-    // If no blocks are available - either UNUSED or marked as DELETED, then we're out of space and there's nothing we can do.
-    if (block)
+    for (uint16_t block = page; block < page + blocksPerPage; block++)
     {
-        // recycle the FileTable, such that we can mark all previously deleted blocks as re-usable.
-        // Better to do this in bulk, rather than on a block by block basis to improve efficiency. 
-        recycleFileTable();
-
-        // Record the block we just allocated, so we can round-robin around blocks for load balancing.
-        lastBlockAllocated = block;
+        if (freeMap[block / 32] & (1UL << (block % 32)))
+        {
+            // Record the block we just allocated, so we can continue to allocate from the same page.
+            lastBlockAllocated = block;
+            return block;
+        }
     }
 
-    return block;
+    return 0;
 }
 
 /**
-  * Allocates a free physical page of memory.
-  * This is chosen using a round robin algorithm, to even out the wear on the physical device.
+  * Allocates a free physical page, for use as a scratch page.
+  * The least worn free page is chosen, to even out the wear on the physical device.
   * @return NULL on error, page address on success
   */
 uint32_t* MicroBitFileSystem::getFreePage()
 {
-    // Walk the file table, starting at the last allocated block, looking for an unused page.
     int blocksPerPage = (PAGE_SIZE / MBFS_BLOCK_SIZE);
 
-    // get a handle on the next physical page.
-    uint16_t currentPage = getBlockNumber(getPage(lastBlockAllocated));
-    uint16_t page = (currentPage + blocksPerPage) % fileSystemSize;
-    uint16_t recyclablePage = 0;
+    // The file table in FLASH must reflect any pending updates before pages are chosen from it.
+    journalCommit();
+
+    // Ideally, use an empty page. These are normally already erased, but a write interrupted by a reset
+    // may have left data in blocks that were never allocated.
+    uint16_t page = getLeastWornPage(blocksPerPage);
 
-    // Walk around the file table, looking for a free page.
-    while (page != currentPage)
+    if (page)
     {
-        bool empty = true;
-        bool deleted = false;
-        uint16_t next;
+        uint32_t *address = getBlock(page);
 
-        for (int i = 0; i < blocksPerPage; i++)
+        for (int word = 0; word < PAGE_SIZE / 4; word++)
         {
-            next = getNextFileBlock(page + i);
-            
-            if (next == MBFS_DELETED)
-                deleted = true;
-            
-            else if (next != MBFS_UNUSED)
+            if (address[word] != 0xFFFFFFFF)
             {
-                empty = false;
+                erasePage(address);
                 break;
             }
         }
 
-        // See if we found one...
-        if (empty)
+        return address;
+    }
+
+    // No empty pages are available, but we may be able to recycle one holding only deleted data.
+    for (page = 0; page < fileSystemSize; page += blocksPerPage)
+    {
+        if (countLiveBlocks(page) == 0)
         {
-            lastBlockAllocated = page;
-            return getBlock(page);
+            uint32_t *address = getBlock(page);
+            erasePage(address);
+            return address;
         }
+    }
 
-        // make note of the first unused but un-erased page we find (if any).
-        if (deleted && !recyclablePage)
-            recyclablePage = page;
+    // Nothing available at all. Use the default.
+    erasePage(defaultScratchPage);
+    return defaultScratchPage;
+}
 
-        page = (page + blocksPerPage) % fileSystemSize;
+/**
+  * Finds the least worn physical page with the given number of free blocks.
+  * Pages are considered in round robin order from the page last allocated from, so equally worn pages are used in turn.
+  *
+  * @param minimum The minimum number of UNUSED blocks in the page.
+  * @return The first block of the page, or zero if no page has enough free blocks.
+  */
+uint16_t MicroBitFileSystem::getLeastWornPage(int minimum)
+{
+    int blocksPerPage = (PAGE_SIZE / MBFS_BLOCK_SIZE);
+    uint16_t pages = fileSystemSize / blocksPerPage;
+    uint16_t currentPage = lastBlockAllocated / blocksPerPage;
+    uint16_t best = 0;
+
+    for (uint16_t i = 1; i <= pages; i++)
+    {
+        uint16_t page = (currentPage + i) % pages;
+
+        if (countBlocks(freeMap, page * blocksPerPage) >= minimum && (best == 0 || eraseCounts[page] < eraseCounts[best / blocksPerPage]))
+            best = page * blocksPerPage;
     }
 
-    // No empty pages are available, but we may be able to recycle one.
-    if (recyclablePage)
+    return best;
+}
+
+/**
+  * Determine the number of blocks in the physical page starting at the given block which are in the given bitmap.
+  *
+  * @param map The bitmap to test: freeMap or staleMap.
+  * @param page The first block of the page.
+  * @return The number of blocks in the page that are in the bitmap.
+  */
+int MicroBitFileSystem::countBlocks(uint32_t *map, uint16_t page)
+{
+    int count = 0;
+
+    for (uint16_t block = page; block < page + (PAGE_SIZE / MBFS_BLOCK_SIZE); block++)
     {
-        uint32_t *address = getBlock(recyclablePage);
-        flash.erase_page(address);
-        return address;
+        if (map[block / 32] & (1UL << (block % 32)))
+            count++;
     }
 
-    // Nothing available at all. Use the default.
-    flash.erase_page(defaultScratchPage);
-    return defaultScratchPage;
+    return count;
+}
+
+/**
+  * Determine the number of blocks in the physical page starting at the given block which are neither UNUSED nor DELETED.
+  *
+  * @param page The first block of the page.
+  * @return The number of blocks in the page holding valid data.
+  */
+int MicroBitFileSystem::countLiveBlocks(uint16_t page)
+{
+    int count = 0;
+
+    for (uint16_t block = page; block < page + (PAGE_SIZE / MBFS_BLOCK_SIZE); block++)
+    {
+        if (fileSystemTable[block] != MBFS_UNUSED && fileSystemTable[block] != MBFS_DELETED)
+            count++;
+    }
+
+    return count;
+}
+
+/**
+  * Rebuild the free and stale block bitmaps from the file table.
+  * Any DELETED blocks are assumed to still hold data.
+  */
+void MicroBitFileSystem::buildBlockMap()
+{
+    memset(freeMap, 0, ((fileSystemSize + 31) / 32) * 4);
+    memset(staleMap, 0, ((fileSystemSize + 31) / 32) * 4);
+    freeBlocks = 0;
+    deletedBlocks = 0;
+
+    for (uint16_t block = 0; block < fileSystemSize; block++)
+    {
+        if (fileSystemTable[block] == MBFS_UNUSED)
+        {
+            freeMap[block / 32] |= 1UL << (block % 32);
+            freeBlocks++;
+        }
+
+        if (fileSystemTable[block] == MBFS_DELETED)
+        {
+            staleMap[block / 32] |= 1UL << (block % 32);
+            deletedBlocks++;
+        }
+    }
+}
+
+/**
+  * Erase a physical page, recording the erase against the wear of the page.
+  * Any DELETED blocks on the page no longer hold data once it has been erased.
+  *
+  * @param page The physical page to erase.
+  */
+void MicroBitFileSystem::erasePage(uint32_t *page)
+{
+    flash.erase_page(page);
+
+    // The default scratch page lies outside of the file system, and pages erased while the file system is loaded are not tracked.
+    if (page < (uint32_t *)fileSystemTable || page >= getBlock(fileSystemSize) || eraseCounts == NULL)
+        return;
+
+    uint16_t block = getBlockNumber(page);
+    uint16_t index = block / (PAGE_SIZE / MBFS_BLOCK_SIZE);
+
+    eraseCounts[index]++;
+    wearMap[index / 32] |= 1UL << (index % 32);
+
+    for (int i = 0; i < PAGE_SIZE / MBFS_BLOCK_SIZE; i++, block++)
+        staleMap[block / 32] &= ~(1UL << (block % 32));
+
+    // Keep the count in the journal, so it survives a reset. Erases made while the journal is being updated are recorded once it is done.
+    if (!(status & MBFS_STATUS_JOURNAL_BUSY))
+        journalRecordWear();
 }
 
 
@@ -141,11 +253,23 @@ uint32_t* MicroBitFileSystem::getFreePage()
 MicroBitFileSystem::MicroBitFileSystem(uint32_t flashStart, int flashPages)
 {
     // Initialise status flags to default value
+    this->id = MICROBIT_ID_FILESYSTEM;
     this->status = 0;
 
     // Attempt tp load an existing filesystem, if it exisits
     init(flashStart, flashPages);
 
+    // Write back cached data once it has been held for MBFS_CACHE_TIMEOUT, and collect garbage, in the background.
+    fiber_add_idle_component(this);
+
+    if (EventModel::defaultEventBus)
+    {
+        if (MBFS_CACHE_PAGES > 0)
+            EventModel::defaultEventBus->listen(MICROBIT_ID_FILESYSTEM, MBFS_EVT_CACHE_TIMEOUT, this, &MicroBitFileSystem::onCacheTimeout);
+
+        EventModel::defaultEventBus->listen(MICROBIT_ID_FILESYSTEM, MBFS_EVT_GC, this, &MicroBitFileSystem::onGarbageCollect);
+    }
+
     // If this is the first FileSystem created, so it as the default.
     if(MicroBitFileSystem::defaultFileSystem == NULL)
         MicroBitFileSystem::defaultFileSystem = this;
@@ -178,6 +302,21 @@ int MicroBitFileSystem::init(uint32_t flashStart, int flashPages)
     lastBlockAllocated = 0;
     rootDirectory = NULL;
     openFiles = NULL;
+    cache = NULL;
+    directoryIndex = NULL;
+    directoryIndexCount = 0;
+    pathCache = NULL;
+    pathCacheNext = 0;
+    freeMap = NULL;
+    staleMap = NULL;
+    eraseCounts = NULL;
+    wearMap = NULL;
+    journal = NULL;
+    journalNext = NULL;
+    journalSequence = 0;
+    journalPages = 0;
+    journalBuffer = NULL;
+    journalLength = 0;
 
     // If we have a zero length, then dynamically determine our geometry.
     if (flashStart == 0)
@@ -197,19 +336,41 @@ int MicroBitFileSystem::init(uint32_t flashStart, int flashPages)
     // The FileTable alays resides at the start of the file system.
     fileSystemTable = (uint16_t *)flashStart;
 
+    // Assume the geometry of a freshly formatted file system. An existing file system records its own.
+    fileSystemSize = flashPages * (PAGE_SIZE / MBFS_BLOCK_SIZE);
+    fileSystemTableSize = calculateFileTableSize();
+
     // First, try to load an existing file system at this location.
     if (load() != MICROBIT_OK)
     {
         // No file system was found, so format a fresh one.
         // Bring up a freshly formatted file system here.
-        fileSystemSize = flashPages * (PAGE_SIZE / MBFS_BLOCK_SIZE);
-        fileSystemTableSize = calculateFileTableSize();
-
         format();
     }
 
+    // Track the state of each block and the wear of each page in RAM, so space can be allocated without searching the file table.
+    // Erase counts are held in whole words, as they are recorded in the journal.
+    int pages = fileSystemSize / (PAGE_SIZE / MBFS_BLOCK_SIZE);
+
+    freeMap = new uint32_t[(fileSystemSize + 31) / 32];
+    staleMap = new uint32_t[(fileSystemSize + 31) / 32];
+    eraseCounts = new uint16_t[(pages + 1) & ~1];
+    wearMap = new uint32_t[(pages + 31) / 32];
+    memset(eraseCounts, 0, ((pages + 1) & ~1) * 2);
+    memset(wearMap, 0, ((pages + 31) / 32) * 4);
+
+    // Locate the metadata journal, completing any metadata updates interrupted by a loss of power,
+    // and restore the wear of each page recorded in it.
+    journalOpen();
+
+    buildBlockMap();
+
+    // Gather metadata updates into transactions, so they can be made atomically.
+    if (MBFS_JOURNAL_SIZE > 0)
+        journalBuffer = new uint32_t[MBFS_JOURNAL_SIZE];
+
     // indicate that we have a valid FileSystem
-    status = MBFS_STATUS_INITIALISED;
+    status |= MBFS_STATUS_INITIALISED;
     return MICROBIT_OK;
 }
 
@@ -220,6 +381,10 @@ int MicroBitFileSystem::init(uint32_t flashStart, int flashPages)
   */
 int MicroBitFileSystem::load()
 {
+    // Power may have been lost while the page holding the file table was being refreshed, so complete any
+    // interrupted transactions before the file table is examined.
+    journalRecover();
+
     uint16_t rootOffset = fileSystemTable[0];
 
     // A valid MBFS has the first 'N' blocks set to the value 'N' followed by a valid root directory block with magic signature.
@@ -300,6 +465,20 @@ DirectoryEntry* MicroBitFileSystem::getDirectoryEntry(char const * filename, con
     if (directory == NULL)
         directory = rootDirectory;
 
+    // Look the file up in the directory index, building it if necessary.
+    if (directoryIndex || buildDirectoryIndex() == MICROBIT_OK)
+    {
+        for (int i = getIndexSlot(file, directory); directoryIndex[i].dirent; i = (i + 1) % MBFS_DIRECTORY_INDEX_SIZE)
+        {
+            if (directoryIndex[i].directory == directory && strcmp(directoryIndex[i].dirent->file_name, file) == 0)
+                return directoryIndex[i].dirent;
+        }
+
+        // If every file is in the index, there's no need to search the directory.
+        if (!(status & MBFS_STATUS_INDEX_INCOMPLETE))
+            return NULL;
+    }
+
     block = directory->first_block;
     dir = (Directory *) getBlock(block);
     dirent = &dir->entry[0];
@@ -307,7 +486,7 @@ DirectoryEntry* MicroBitFileSystem::getDirectoryEntry(char const * filename, con
     // Iterate through the directory entries until we find our file, or run out of space.
     while (1)
     {
-        if ((uint32_t)(dirent + 1) > (uint32_t)dir + MBFS_BLOCK_SIZE)
+        if ((uint32_t)(uintptr_t)(dirent + 1) > (uint32_t)(uintptr_t)dir + MBFS_BLOCK_SIZE)
         {
             block = getNextFileBlock(block);
             if (block == MBFS_EOF)
@@ -351,7 +530,7 @@ uint16_t MicroBitFileSystem::calculateFileTableSize()
   */
 uint32_t *MicroBitFileSystem::getPage(uint16_t block)
 {
-    uint32_t address = (uint32_t) getBlock(block);
+    uint32_t address = (uint32_t)(uintptr_t) getBlock(block);
     return (uint32_t *) (address - address % PAGE_SIZE);
 }
 
@@ -364,7 +543,7 @@ uint32_t *MicroBitFileSystem::getPage(uint16_t block)
   */
 uint32_t *MicroBitFileSystem::getBlock(uint16_t block)
 {
-    return (uint32_t *)((uint32_t)fileSystemTable + block * MBFS_BLOCK_SIZE);
+    return (uint32_t *)((uint32_t)(uintptr_t)fileSystemTable + block * MBFS_BLOCK_SIZE);
 }
 
 /**
@@ -388,7 +567,34 @@ uint16_t MicroBitFileSystem::getNextFileBlock(uint16_t block)
   */
 uint16_t MicroBitFileSystem::getBlockNumber(void *address)
 {
-    return (((uint32_t) address - (uint32_t) fileSystemTable) / MBFS_BLOCK_SIZE);
+    return (((uint32_t)(uintptr_t) address - (uint32_t)(uintptr_t) fileSystemTable) / MBFS_BLOCK_SIZE);
+}
+
+/**
+  * Determine the block holding the current position of the given file.
+  * The walk along the file's chain of blocks starts from the block last used by the file where possible,
+  * so sequential access does not need to walk the chain from the start of the file.
+  *
+  * @param file The file descriptor to locate.
+  * @return The block holding the current file position.
+  */
+uint16_t MicroBitFileSystem::getSeekBlock(FileDescriptor *file)
+{
+    // We can only walk forwards along the chain. If the position is before the block last used, start again.
+    if (file->seek < file->blockPosition)
+    {
+        file->block = file->dirent->first_block;
+        file->blockPosition = 0;
+    }
+
+    // Walk the file table until we reach the block holding the file position.
+    while (file->seek - file->blockPosition > MBFS_BLOCK_SIZE)
+    {
+        file->block = getNextFileBlock(file->block);
+        file->blockPosition += MBFS_BLOCK_SIZE;
+    }
+
+    return file->block;
 }
 
 /**
@@ -400,11 +606,680 @@ uint16_t MicroBitFileSystem::getBlockNumber(void *address)
   */
 int MicroBitFileSystem::fileTableWrite(uint16_t block, uint16_t value)
 {
-    flash.flash_write(&fileSystemTable[block], &value, 2);
+    // Keep the block bitmaps in step with the file table.
+    updateBlockMap(block, value);
+
+    journalWrite(&fileSystemTable[block], &value, 2);
+    return MICROBIT_OK;
+}
+
+/**
+  * Update the free and stale block bitmaps to reflect a change to a file table entry.
+  *
+  * @param block The block being updated.
+  * @param value The new value of its file table entry.
+  */
+void MicroBitFileSystem::updateBlockMap(uint16_t block, uint16_t value)
+{
+    uint32_t mask = 1UL << (block % 32);
+
+    if (freeMap == NULL)
+        return;
+
+    // The bitmaps are consulted rather than the file table, as earlier updates may still be pending in the journal.
+    if ((freeMap[block / 32] & mask) && value != MBFS_UNUSED)
+    {
+        freeMap[block / 32] &= ~mask;
+        freeBlocks--;
+    }
+
+    if ((staleMap[block / 32] & mask) == 0 && value == MBFS_DELETED)
+    {
+        staleMap[block / 32] |= mask;
+        deletedBlocks++;
+    }
+
+    // There may now be more garbage to collect.
+    status &= ~MBFS_STATUS_GC_COMPLETE;
+}
+
+/**
+  * Locate the metadata journal, claiming the last MBFS_JOURNAL_PAGES physical pages of the file system for it
+  * if they are free, and complete any transactions that were interrupted by a loss of power.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if no journal is available. Updates are then made directly.
+  */
+int MicroBitFileSystem::journalOpen()
+{
+    int blocksPerPage = PAGE_SIZE / MBFS_BLOCK_SIZE;
+
+    journal = NULL;
+    journalSequence = 0;
+    journalPages = 0;
+
+    // File systems created without a journal, or with fewer pages for it, gain pages from the end of the file system
+    // while they are free. A claim interrupted by a loss of power is completed.
+    while (journalPages < MBFS_JOURNAL_PAGES)
+    {
+        int page = fileSystemSize - (journalPages + 1) * blocksPerPage;
+        int claimed = 0;
+        int unused = 0;
+
+        if (page <= fileSystemTableSize)
+            break;
+
+        for (int block = page; block < page + blocksPerPage; block++)
+        {
+            if (fileSystemTable[block] == MBFS_JOURNAL)
+                claimed++;
+
+            if (fileSystemTable[block] == MBFS_UNUSED)
+                unused++;
+        }
+
+        if (claimed < blocksPerPage)
+        {
+            if ((MBFS_JOURNAL_SIZE == 0 && claimed == 0) || claimed + unused < blocksPerPage)
+                break;
+
+            erasePage(getBlock(page));
+
+            uint16_t value = MBFS_JOURNAL;
+            for (int block = page; block < page + blocksPerPage; block++)
+                flash.flash_write(&fileSystemTable[block], &value, 2);
+        }
+
+        journalPages++;
+    }
+
+    if (journalPages == 0)
+        return MICROBIT_NO_RESOURCES;
+
+    // A new journal starts in the first of its pages.
+    journal = journalFind(journalPages);
+
+    if (journal == NULL)
+        journal = getBlock(fileSystemSize - journalPages * blocksPerPage);
+
+    status |= MBFS_STATUS_JOURNAL_BUSY;
+    journalReplay();
+    status &= ~MBFS_STATUS_JOURNAL_BUSY;
+
+    // Record the wear of any pages erased while the journal was opened.
+    journalRecordWear();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Complete any transactions in the journal held in the last pages of the file system, without reference
+  * to the file table, as power may have been lost while the file table itself was being refreshed.
+  *
+  * @return MICROBIT_OK if a journal was found, or MICROBIT_NO_DATA otherwise.
+  */
+int MicroBitFileSystem::journalRecover()
+{
+    // A page must start with a valid transaction for it to be trusted.
+    journal = journalFind(MBFS_JOURNAL_PAGES);
+
+    if (journal == NULL)
+        return MICROBIT_NO_DATA;
+
+    // Which pages the journal may move on to is not known until the file table can be read, by journalOpen().
+    journalPages = 0;
+    journalReplay();
+    journal = NULL;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Find the page of the journal in use: of the given number of pages at the end of the file system,
+  * the one beginning with the most recent valid transaction.
+  *
+  * @param pages The number of pages to search.
+  * @return The page, or NULL if none begins with a valid transaction.
+  */
+uint32_t *MicroBitFileSystem::journalFind(int pages)
+{
+    uint32_t *newest = NULL;
+
+    for (int i = 1; i <= pages; i++)
+    {
+        int page = fileSystemSize - i * (PAGE_SIZE / MBFS_BLOCK_SIZE);
+        uint32_t *address = getBlock(page);
+
+        if (page <= fileSystemTableSize)
+            break;
+
+        if (!journalValid(address, address + PAGE_SIZE / 4))
+            continue;
+
+        // Sequence numbers wrap, so the most recent is the one furthest ahead of the others.
+        if (newest == NULL || (int16_t)(((MBFSJournalHeader *)address)->sequence - ((MBFSJournalHeader *)newest)->sequence) > 0)
+            newest = address;
+    }
+
+    return newest;
+}
+
+/**
+  * Determine if a transaction recorded in the journal is complete and intact.
+  *
+  * @param record The header of the transaction.
+  * @param end The end of the page holding it.
+  * @return true if the transaction is valid.
+  */
+bool MicroBitFileSystem::journalValid(uint32_t *record, uint32_t *end)
+{
+    MBFSJournalHeader *header = (MBFSJournalHeader *)record;
+    uint32_t *ops = record + sizeof(MBFSJournalHeader) / 4;
+
+    return *record != 0xFFFFFFFF && ops + header->length <= end &&
+           header->crc == crc16((uint8_t *)ops, header->length * 4, crc16((uint8_t *)header, 4, 0xFFFF));
+}
+
+/**
+  * Move the journal on to the next of its pages, which is erased. Every transaction recorded
+  * in the current page has been applied, so it is simply left behind.
+  */
+void MicroBitFileSystem::journalSwitch()
+{
+    uint32_t *next = journal + PAGE_SIZE / 4;
+
+    if (next >= getBlock(fileSystemSize))
+        next = getBlock(fileSystemSize - journalPages * (PAGE_SIZE / MBFS_BLOCK_SIZE));
+
+    erasePage(next);
+
+    journal = next;
+    journalNext = next;
+
+    // The erase counts recorded in the page left behind are lost when it is next erased, so begin with them all.
+    int words = (fileSystemSize / (PAGE_SIZE / MBFS_BLOCK_SIZE) + 1) / 2;
+    uint32_t op[2] = { MBFS_JOURNAL_OP_WEAR | (uint32_t)(words << 8), 0 };
+
+    journalRecord(op, 2, (uint32_t *)eraseCounts, words, MBFS_JOURNAL_STATE_APPLIED);
+    memset(wearMap, 0, ((fileSystemSize / (PAGE_SIZE / MBFS_BLOCK_SIZE) + 31) / 32) * 4);
+}
+
+/**
+  * Record a transaction in the journal, moving on to the next page of the journal if there is no room for it.
+  *
+  * @param ops The operations of the transaction.
+  * @param length The number of words of operations.
+  * @param data Further words of the last operation, or NULL.
+  * @param words The number of further words.
+  * @param state The MBFS_JOURNAL_STATE_* value to record the transaction with.
+  * @return The header of the transaction.
+  */
+MBFSJournalHeader *MicroBitFileSystem::journalRecord(uint32_t *ops, int length, uint32_t *data, int words, uint32_t state)
+{
+    MBFSJournalHeader header;
+    uint32_t *record;
+
+    // Every transaction in the journal has been applied, so when a page is full, the journal simply moves on.
+    if (journalNext + sizeof(MBFSJournalHeader) / 4 + length + words > journal + PAGE_SIZE / 4)
+        journalSwitch();
+
+    header.sequence = ++journalSequence;
+    header.length = length + words;
+    header.crc = crc16((uint8_t *)data, words * 4, crc16((uint8_t *)ops, length * 4, crc16((uint8_t *)&header, 4, 0xFFFF)));
+    header.reserved = 0xFFFF;
+    header.state = state;
+
+    record = journalNext;
+
+    flash.flash_burn(record, (uint32_t *)&header, sizeof(MBFSJournalHeader) / 4);
+    flash.flash_burn(record + sizeof(MBFSJournalHeader) / 4, ops, length);
+
+    if (words)
+        flash.flash_burn(record + sizeof(MBFSJournalHeader) / 4 + length, data, words);
+
+    journalNext = record + sizeof(MBFSJournalHeader) / 4 + length + words;
+
+    return (MBFSJournalHeader *)record;
+}
+
+/**
+  * Record the erase counts of any pages erased since they were last recorded in the journal.
+  */
+void MicroBitFileSystem::journalRecordWear()
+{
+    uint32_t ops[24];
+    int length = 0;
+    int pages = fileSystemSize / (PAGE_SIZE / MBFS_BLOCK_SIZE);
+
+    if (journal == NULL)
+        return;
+
+    status |= MBFS_STATUS_JOURNAL_BUSY;
+
+    // Counts are recorded in pairs, as they are held.
+    for (int page = 0; page < pages; page += 2)
+    {
+        if (!(wearMap[page / 32] & (3UL << (page % 32))))
+            continue;
+
+        wearMap[page / 32] &= ~(3UL << (page % 32));
+
+        ops[length++] = MBFS_JOURNAL_OP_WEAR | (1 << 8);
+        ops[length++] = page;
+        ops[length++] = eraseCounts[page] | (eraseCounts[page + 1] << 16);
+
+        if (length == sizeof(ops) / 4)
+        {
+            journalRecord(ops, length, NULL, 0, MBFS_JOURNAL_STATE_APPLIED);
+            length = 0;
+        }
+    }
+
+    if (length)
+        journalRecord(ops, length, NULL, 0, MBFS_JOURNAL_STATE_APPLIED);
+
+    status &= ~MBFS_STATUS_JOURNAL_BUSY;
+}
+
+/**
+  * Complete any transactions in the journal that were committed but not applied,
+  * and find the location at which the next transaction will be recorded.
+  */
+void MicroBitFileSystem::journalReplay()
+{
+    uint32_t *end = journal + PAGE_SIZE / 4;
+    uint32_t *p = journal;
+
+    // Walk the chain of transactions, completing any that were committed but not applied.
+    while (p + sizeof(MBFSJournalHeader) / 4 <= end && *p != 0xFFFFFFFF)
+    {
+        MBFSJournalHeader *header = (MBFSJournalHeader *)p;
+        uint32_t *ops = p + sizeof(MBFSJournalHeader) / 4;
+
+        if ((p != journal && header->sequence != (uint16_t)(journalSequence + 1)) || !journalValid(p, end))
+            break;
+
+        // Transactions that were never committed are ignored. Their operations have not been started.
+        if (header->state != MBFS_JOURNAL_STATE_FREE && header->state != MBFS_JOURNAL_STATE_APPLIED)
+        {
+            uint32_t state = MBFS_JOURNAL_STATE_APPLIED;
+
+            journalApply(ops, header->length);
+            flash.flash_burn(&header->state, &state, 1);
+        }
+
+        for (uint32_t *op = ops; op < ops + header->length; op += 2 + ((*op >> 8) & 0xFF))
+        {
+            uint32_t *scratch = (uint32_t *)op[2];
+
+            // Restore the wear of the pages recorded, unless recovering before the file system has been loaded.
+            if ((*op & 0xFF) == MBFS_JOURNAL_OP_WEAR && eraseCounts != NULL)
+            {
+                int pages = fileSystemSize / (PAGE_SIZE / MBFS_BLOCK_SIZE);
+
+                for (int i = 0; i < 2 * (int)((*op >> 8) & 0xFF) && (int)op[1] + i < pages; i++)
+                    eraseCounts[op[1] + i] = ((uint16_t *)&op[2])[i];
+            }
+
+            // The scratch page of a copy is erased once the copy has been applied. Ensure that it was.
+
+            if ((*op & 0xFF) == MBFS_JOURNAL_OP_COPY && scratch >= (uint32_t *)fileSystemTable && scratch < getBlock(fileSystemSize))
+            {
+                uint16_t block = getBlockNumber(scratch);
+                int unused = 0;
+                bool erased = true;
+
+                for (int i = 0; i < PAGE_SIZE / MBFS_BLOCK_SIZE; i++)
+                    if (fileSystemTable[block + i] == MBFS_UNUSED)
+                        unused++;
+
+                for (int word = 0; word < PAGE_SIZE / 4; word++)
+                    erased = erased && scratch[word] == 0xFFFFFFFF;
+
+                if (unused == PAGE_SIZE / MBFS_BLOCK_SIZE && !erased)
+                    erasePage(scratch);
+            }
+        }
+
+        journalSequence = header->sequence;
+        p = ops + header->length;
+    }
+
+    journalNext = p;
+
+    // Anything beyond the last transaction is left over from an interrupted transaction or erase.
+    // Start afresh in the next page, once the pages of the journal are known.
+    while (p < end && journalPages)
+    {
+        if (*p++ != 0xFFFFFFFF)
+        {
+            journalSwitch();
+            break;
+        }
+    }
+}
+
+/**
+  * Add an operation to the current journal transaction.
+  * If the transaction is full, it is committed, and the operation begins a new transaction.
+  *
+  * @param op The MBFS_JOURNAL_OP_* code of the operation.
+  * @param address The address the operation applies to.
+  * @param data The data words of the operation.
+  * @param words The number of data words.
+  */
+void MicroBitFileSystem::journalAdd(int op, void *address, uint32_t *data, int words)
+{
+    uint32_t operation[2 + 6];
+
+    // Without a transaction to add to, the operation is simply performed.
+    if (journalBuffer == NULL)
+    {
+        operation[0] = op | (words << 8);
+        operation[1] = (uint32_t)(uintptr_t) address;
+        memcpy(&operation[2], data, words * 4);
+
+        journalApply(operation, 2 + words);
+        return;
+    }
+
+    if (journalLength + 2 + words > MBFS_JOURNAL_SIZE)
+        journalCommit();
+
+    journalBuffer[journalLength++] = op | (words << 8);
+    journalBuffer[journalLength++] = (uint32_t)(uintptr_t) address;
+
+    for (int i = 0; i < words; i++)
+        journalBuffer[journalLength++] = data[i];
+}
+
+/**
+  * Add a write of metadata to the current journal transaction. The data need not be word aligned.
+  *
+  * @param address The location in FLASH memory to write to.
+  * @param data The data to write.
+  * @param length The number of bytes to write.
+  */
+void MicroBitFileSystem::journalWrite(void *address, const void *data, int length)
+{
+    uint32_t words[6];
+    uint32_t start = (uint32_t)(uintptr_t)address & ~3;
+    int count = ((uint32_t)(uintptr_t)address + length - start + 3) / 4;
+
+    // Bytes of the words that are not written are left unchanged by programming them as 0xFF.
+    memset(words, 0xFF, sizeof(words));
+    memcpy((uint8_t *)words + ((uint32_t)(uintptr_t)address - start), data, length);
+
+    journalAdd(MBFS_JOURNAL_OP_WRITE, (void *)start, words, count);
+}
+
+/**
+  * Record the current journal transaction in the journal, then apply it.
+  *
+  * @return MICROBIT_OK on success.
+  */
+int MicroBitFileSystem::journalCommit()
+{
+    if (journalBuffer == NULL || journalLength == 0)
+        return MICROBIT_OK;
+
+    // If we have no journal, the updates are made directly.
+    if (journal == NULL)
+    {
+        journalApply(journalBuffer, journalLength);
+        journalLength = 0;
+        return MICROBIT_OK;
+    }
+
+    uint32_t state;
+
+    // No other record may follow the transaction until it has been applied, so erases made meanwhile are recorded afterwards.
+    status |= MBFS_STATUS_JOURNAL_BUSY;
+
+    MBFSJournalHeader *record = journalRecord(journalBuffer, journalLength, NULL, 0, MBFS_JOURNAL_STATE_FREE);
+
+    // Once committed, the transaction will be completed even if power is lost while it is applied.
+    state = MBFS_JOURNAL_STATE_COMMITTED;
+    flash.flash_burn(&record->state, &state, 1);
+
+    journalApply(journalBuffer, journalLength);
+
+    state = MBFS_JOURNAL_STATE_APPLIED;
+    flash.flash_burn(&record->state, &state, 1);
+
+    journalLength = 0;
+    status &= ~MBFS_STATUS_JOURNAL_BUSY;
+
+    // Record the wear of any pages the transaction erased.
+    journalRecordWear();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Perform the operations of a journal transaction. Each operation can be safely repeated.
+  *
+  * @param ops The operations.
+  * @param length The number of words of operations.
+  */
+void MicroBitFileSystem::journalApply(uint32_t *ops, int length)
+{
+    uint32_t *op = ops;
+    uint32_t data[6];
+
+    while (op < ops + length)
+    {
+        int words = (op[0] >> 8) & 0xFF;
+        uint32_t *address = (uint32_t *)op[1];
+
+        switch (op[0] & 0xFF)
+        {
+            // Bits already programmed, whether by an earlier write to the same word or an interrupted attempt at this one, are left as they are.
+            case MBFS_JOURNAL_OP_WRITE:
+                for (int i = 0; i < words; i++)
+                    data[i] = op[2 + i] & address[i];
+
+                flash.flash_burn(address, data, words);
+                break;
+
+            // Refresh a page from a copy held in a scratch page.
+            case MBFS_JOURNAL_OP_COPY:
+                erasePage(address);
+                flash.flash_burn(address, (uint32_t *)op[2], PAGE_SIZE / 4);
+                break;
+
+            case MBFS_JOURNAL_OP_DELETE:
+                deleteChain((uint16_t *)address - fileSystemTable);
+                break;
+        }
+
+        op += 2 + words;
+    }
+}
+
+/**
+  * Mark each block in a chain as DELETED. Blocks are deleted from the end of the chain, so the chain
+  * can be found from its first block until the whole chain has been deleted.
+  *
+  * @param block The first block of the chain.
+  */
+void MicroBitFileSystem::deleteChain(uint16_t block)
+{
+    while (fileSystemTable[block] != MBFS_DELETED && fileSystemTable[block] != MBFS_UNUSED)
+    {
+        uint16_t last = block;
+
+        // Find the last block of the chain yet to be deleted.
+        while (fileSystemTable[last] != MBFS_EOF && fileSystemTable[fileSystemTable[last]] != MBFS_DELETED && fileSystemTable[fileSystemTable[last]] != MBFS_UNUSED)
+            last = fileSystemTable[last];
+
+        // Program the entry as a whole word, leaving the other entry in the word unchanged.
+        uint32_t *word = (uint32_t *)&fileSystemTable[last & ~1];
+        uint32_t value = *word & ((last & 1) ? 0x0000FFFF : 0xFFFF0000);
+        flash.flash_burn(word, &value, 1);
+    }
+}
+
+
+
+/**
+  * Calculate the position in the directory index of the given name in the given directory.
+  *
+  * @param name The name of the file or directory.
+  * @param directory The directory holding the file or directory.
+  * @return The first entry of the directory index to search.
+  */
+int MicroBitFileSystem::getIndexSlot(char const *name, const DirectoryEntry *directory)
+{
+    // FNV-1a hash of the name, combined with the address of the directory.
+    uint32_t hash = 2166136261UL;
+
+    while (*name)
+    {
+        hash ^= (uint8_t) *name++;
+        hash *= 16777619UL;
+    }
+
+    hash ^= (uint32_t)(uintptr_t) directory;
+    hash *= 16777619UL;
+
+    return hash % MBFS_DIRECTORY_INDEX_SIZE;
+}
+
+/**
+  * Build the directory index, by walking the directory tree from the root directory.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if the index could not be allocated.
+  */
+int MicroBitFileSystem::buildDirectoryIndex()
+{
+    if (MBFS_DIRECTORY_INDEX_SIZE == 0)
+        return MICROBIT_NO_RESOURCES;
+
+    directoryIndex = new MBFSIndexEntry[MBFS_DIRECTORY_INDEX_SIZE];
+    if (directoryIndex == NULL)
+        return MICROBIT_NO_RESOURCES;
+
+    memset(directoryIndex, 0, sizeof(MBFSIndexEntry) * MBFS_DIRECTORY_INDEX_SIZE);
+    directoryIndexCount = 0;
+    status &= ~MBFS_STATUS_INDEX_INCOMPLETE;
+
+    indexDirectory(rootDirectory);
+
     return MICROBIT_OK;
 }
 
+/**
+  * Add the entries of the given directory, and of any directories within it, to the directory index.
+  *
+  * @param directory The directory to index.
+  */
+void MicroBitFileSystem::indexDirectory(DirectoryEntry *directory)
+{
+    uint16_t block = directory->first_block;
+
+    while (block != MBFS_EOF)
+    {
+        Directory *dir = (Directory *) getBlock(block);
+
+        for (uint16_t entry = 0; entry < MBFS_BLOCK_SIZE / sizeof(DirectoryEntry); entry++)
+        {
+            DirectoryEntry *dirent = &dir->entry[entry];
+
+            // Skip entries that are unused or have been deleted.
+            if ((dirent->flags & MBFS_DIRECTORY_ENTRY_VALID) == 0 || dirent->file_name[0] == (char)0xFF)
+                continue;
+
+            indexAdd(dirent, directory);
+
+            // Index the content of any subdirectories. The entry holding our magic signature refers to the root directory itself.
+            if (dirent->flags != MBFS_DIRECTORY_ENTRY_NEW && (dirent->flags & MBFS_DIRECTORY_ENTRY_DIRECTORY) && dirent != rootDirectory)
+                indexDirectory(dirent);
+        }
+
+        block = getNextFileBlock(block);
+    }
+}
+
+/**
+  * Add a DirectoryEntry to the directory index.
+  * If the index is full, it is marked as incomplete, and lookups that are not found in it fall back to a search of the directory.
+  *
+  * @param dirent The DirectoryEntry to add.
+  * @param directory The directory holding the DirectoryEntry.
+  */
+void MicroBitFileSystem::indexAdd(DirectoryEntry *dirent, const DirectoryEntry *directory)
+{
+    if (directoryIndex == NULL)
+        return;
+
+    // Keep some entries free, so that searches of the index are short and always terminate.
+    if (directoryIndexCount >= MBFS_DIRECTORY_INDEX_SIZE * 3 / 4)
+    {
+        status |= MBFS_STATUS_INDEX_INCOMPLETE;
+        return;
+    }
+
+    int i = getIndexSlot(dirent->file_name, directory);
+
+    while (directoryIndex[i].dirent)
+        i = (i + 1) % MBFS_DIRECTORY_INDEX_SIZE;
+
+    directoryIndex[i].dirent = dirent;
+    directoryIndex[i].directory = directory;
+    directoryIndexCount++;
+}
+
+/**
+  * Remove a DirectoryEntry from the directory index.
+  *
+  * @param dirent The DirectoryEntry to remove.
+  * @param directory The directory holding the DirectoryEntry.
+  */
+void MicroBitFileSystem::indexRemove(DirectoryEntry *dirent, const DirectoryEntry *directory)
+{
+    if (directoryIndex == NULL)
+        return;
+
+    int i = getIndexSlot(dirent->file_name, directory);
+
+    while (directoryIndex[i].dirent && directoryIndex[i].dirent != dirent)
+        i = (i + 1) % MBFS_DIRECTORY_INDEX_SIZE;
+
+    if (directoryIndex[i].dirent == NULL)
+        return;
+
+    directoryIndex[i].dirent = NULL;
+    directoryIndexCount--;
+
+    // Reinsert the entries that follow, so that none are separated from the position they hash to by the gap we just made.
+    for (i = (i + 1) % MBFS_DIRECTORY_INDEX_SIZE; directoryIndex[i].dirent; i = (i + 1) % MBFS_DIRECTORY_INDEX_SIZE)
+    {
+        MBFSIndexEntry e = directoryIndex[i];
+
+        directoryIndex[i].dirent = NULL;
+        directoryIndexCount--;
+
+        indexAdd(e.dirent, e.directory);
+    }
+}
+
+/**
+  * Discard the directory index and the path cache. The index is rebuilt when next used.
+  */
+void MicroBitFileSystem::indexReset()
+{
+    delete[] directoryIndex;
+    directoryIndex = NULL;
 
+    if (pathCache)
+    {
+        for (int i = 0; i < MBFS_PATH_CACHE_SIZE; i++)
+        {
+            delete[] pathCache[i].path;
+            pathCache[i].path = NULL;
+        }
+    }
+}
 
 /**
   * Retrieve the DirectoryEntry for the given filename.
@@ -421,14 +1296,36 @@ DirectoryEntry* MicroBitFileSystem::getDirectoryOf(char const * filename)
     if (filename == NULL || filename[0] == 0)
         return rootDirectory;
 
+    // Determine the length of the path of the directory, up to and including the last '/'.
+    int length = 0;
+
+    for (int i = 0; filename[i]; i++)
+        if (filename[i] == '/')
+            length = i + 1;
+
+    // Files in the root directory have no path to resolve.
+    if (length == 0)
+        return rootDirectory;
+
+    // See if we have resolved this path recently.
+    if (pathCache)
+    {
+        for (int i = 0; i < MBFS_PATH_CACHE_SIZE; i++)
+        {
+            if (pathCache[i].path && strncmp(pathCache[i].path, filename, length) == 0 && pathCache[i].path[length] == 0)
+                return pathCache[i].directory;
+        }
+    }
+
     char s[MBFS_FILENAME_LENGTH + 1];
+    char const *path = filename;
 
     uint8_t i = 0;
 
     directory = rootDirectory;
 
-    while (*filename != '\0') {
-        if (*filename == '/') {
+    while (*path != '\0') {
+        if (*path == '/') {
             s[i] = '\0';
 
             // Ensure each level of the filename is valid
@@ -445,9 +1342,34 @@ DirectoryEntry* MicroBitFileSystem::getDirectoryOf(char const * filename)
             i = 0;
         }
         else
-            s[i++] = *filename;
+            s[i++] = *path;
+
+        path++;
+    }
 
-        filename++;
+    // Remember the path, replacing the entries of the path cache in turn.
+    if (MBFS_PATH_CACHE_SIZE > 0 && pathCache == NULL)
+    {
+        pathCache = new MBFSPathCacheEntry[MBFS_PATH_CACHE_SIZE];
+
+        if (pathCache)
+            memset(pathCache, 0, sizeof(MBFSPathCacheEntry) * MBFS_PATH_CACHE_SIZE);
+    }
+
+    if (pathCache)
+    {
+        MBFSPathCacheEntry *entry = &pathCache[pathCacheNext];
+        pathCacheNext = (pathCacheNext + 1) % MBFS_PATH_CACHE_SIZE;
+
+        delete[] entry->path;
+        entry->path = new char[length + 1];
+
+        if (entry->path)
+        {
+            memcpy(entry->path, filename, length);
+            entry->path[length] = 0;
+            entry->directory = directory;
+        }
     }
 
     return directory;
@@ -464,6 +1386,10 @@ DirectoryEntry* MicroBitFileSystem::getDirectoryOf(char const * filename)
   */
 int MicroBitFileSystem::recycleBlock(uint16_t block, int type)
 {
+    // Ensure all data and metadata is in FLASH before pages are copied and erased.
+    writeBack();
+    journalCommit();
+
     uint32_t *page = getPage(block);
     uint32_t* scratch = getFreePage();
     uint8_t *write = (uint8_t *)scratch;
@@ -517,10 +1443,10 @@ int MicroBitFileSystem::recycleBlock(uint16_t block, int type)
         b++;
     }
 
-    // Now refresh the page originally holding the block.
-    flash.erase_page(page);
-    flash.flash_write(page, scratch, PAGE_SIZE);
-    flash.erase_page(scratch);
+    // Now refresh the page originally holding the block. The copy is journalled, as the page may hold the file table.
+    journalAdd(MBFS_JOURNAL_OP_COPY, page, (uint32_t *)&scratch, 1);
+    journalCommit();
+    erasePage(scratch);
 
     return MICROBIT_OK;
 }
@@ -533,26 +1459,74 @@ int MicroBitFileSystem::recycleBlock(uint16_t block, int type)
   */
 int MicroBitFileSystem::recycleFileTable()
 {
-    bool pageRecycled = false;
-    
-    for (uint16_t block = 0; block < fileSystemSize; block++)
+    // Ensure all data and metadata is in FLASH before pages are erased.
+    writeBack();
+    journalCommit();
+
+    // Erase the data held by DELETED blocks. Pages that have been erased since the blocks were deleted need no further work.
+    for (uint16_t page = 0; page < fileSystemSize; page += PAGE_SIZE / MBFS_BLOCK_SIZE)
     {
-        // if we just crossed a page boundary, reset pageRecycled.
-        if (block % (PAGE_SIZE / MBFS_BLOCK_SIZE) == 0)
-            pageRecycled = false;
+        if (countBlocks(staleMap, page) == 0)
+            continue;
+
+        if (countLiveBlocks(page) == 0)
+            erasePage(getBlock(page));
+        else
+            recycleBlock(page);
+    }
+
+    // now, recycle the FileSystemTable itself, upcycling entries marked as DELETED to UNUSED as we go.
+    for (uint16_t block = 0; getPage(block) < (uint32_t *)rootDirectory; block += PAGE_SIZE / MBFS_BLOCK_SIZE)
+        recycleBlock(block);
+
+    buildBlockMap();
+
+    return MICROBIT_OK;
+}
 
-        if (fileSystemTable[block] == MBFS_DELETED && !pageRecycled)
+/**
+  * Performs a step of garbage collection. Pages holding only DELETED or UNUSED blocks are erased ahead of time,
+  * and once free space runs low, the file table is recycled so that DELETED blocks become available for allocation.
+  *
+  * @return MICROBIT_OK if a step was performed, or MICROBIT_NO_DATA if there is nothing to do.
+  */
+int MicroBitFileSystem::collectGarbage()
+{
+    // Erase one page holding only deleted data, so that a later recycle of the file table need not.
+    for (uint16_t page = 0; page < fileSystemSize; page += PAGE_SIZE / MBFS_BLOCK_SIZE)
+    {
+        if (countBlocks(staleMap, page) && countLiveBlocks(page) == 0)
         {
-            recycleBlock(block);
-            pageRecycled = true;
+            writeBack();
+            erasePage(getBlock(page));
+            return MICROBIT_OK;
         }
     }
 
-    // now, recycle the FileSystemTable itself, upcycling entries marked as DELETED to UNUSED as we go.
-    for (uint16_t block = 0; getPage(block) < (uint32_t *)rootDirectory; block += PAGE_SIZE / MBFS_BLOCK_SIZE)
-        recycleBlock(block);
+    // Reclaim DELETED blocks before allocation has to stall to do so.
+    if (deletedBlocks > 0 && freeBlocks < fileSystemSize / 4)
+    {
+        recycleFileTable();
+        return MICROBIT_OK;
+    }
+
+    return MICROBIT_NO_DATA;
+}
+
+/**
+  * Event handler, called from the idle thread to perform a step of garbage collection.
+  */
+void MicroBitFileSystem::onGarbageCollect(MicroBitEvent)
+{
+    lock.lock();
+
+    // Files may have been opened since the step was requested.
+    if (openFiles == NULL && collectGarbage() == MICROBIT_NO_DATA)
+        status |= MBFS_STATUS_GC_COMPLETE;
 
-    return MICROBIT_OK;
+    status &= ~MBFS_STATUS_GC_PENDING;
+
+    lock.unlock();
 }
 
 
@@ -579,7 +1553,7 @@ DirectoryEntry* MicroBitFileSystem::createDirectoryEntry(DirectoryEntry *directo
     while (1)
     {
         // Scan through each of the blocks in the directory
-        if ((uint32_t)(dirent+1) > (uint32_t)dir + MBFS_BLOCK_SIZE)
+        if ((uint32_t)(uintptr_t)(dirent+1) > (uint32_t)(uintptr_t)dir + MBFS_BLOCK_SIZE)
         {
             block = getNextFileBlock(block);
             if (block == MBFS_EOF)
@@ -589,8 +1563,8 @@ DirectoryEntry* MicroBitFileSystem::createDirectoryEntry(DirectoryEntry *directo
             dirent = &dir->entry[0];
         }
 
-        // If we find an empty slot, use that.
-        if (dirent->flags & MBFS_DIRECTORY_ENTRY_FREE)
+        // If we find an empty slot, use that. The flags of a NEW entry also have the FREE bit set, but it has a first block.
+        if ((dirent->flags & MBFS_DIRECTORY_ENTRY_FREE) && dirent->first_block == MBFS_UNUSED)
         {
             empty = dirent;
             break;
@@ -695,8 +1669,12 @@ DirectoryEntry* MicroBitFileSystem::createFile(char const * filename, DirectoryE
     }
 
     // Push the new data back to FLASH memory
-    flash.flash_write(dirent, &d, sizeof(DirectoryEntry));
+    journalWrite(dirent, &d, sizeof(DirectoryEntry));
     fileTableWrite(d.first_block, MBFS_EOF);
+    journalCommit();
+
+    indexAdd(dirent, directory);
+
     return dirent;
 }
 
@@ -743,7 +1721,7 @@ FileDescriptor* MicroBitFileSystem::getFileDescriptor(int fd, bool remove)
 int MicroBitFileSystem::createDirectory(char const *name)
 {
     DirectoryEntry* directory;        // Directory holding this file.
-    DirectoryEntry* dirent;            // Entry in the direcoty of this file.
+    int result = MICROBIT_OK;
 
     // Protect against accidental re-initialisation
     if ((status & MBFS_STATUS_INITIALISED) == 0)
@@ -753,24 +1731,22 @@ int MicroBitFileSystem::createDirectory(char const *name)
     if (!isValidFilename(name))
         return MICROBIT_INVALID_PARAMETER;
 
+    lock.lock();
+
     // Determine the directory for this file.
     directory = getDirectoryOf(name);
 
-    if (directory == NULL)
-        return MICROBIT_INVALID_PARAMETER;
-
     // Find the DirectoryEntry associated with the given name (if it exists).
     // We don't permit files or directories with the same name.
-    dirent = getDirectoryEntry(name, directory);
+    if (directory == NULL || getDirectoryEntry(name, directory) != NULL)
+        result = MICROBIT_INVALID_PARAMETER;
 
-    if (dirent)
-        return MICROBIT_INVALID_PARAMETER;
+    else if (createFile(name, directory, true) == NULL)
+        result = MICROBIT_NO_RESOURCES;
 
-    dirent = createFile(name, directory, true);
-    if (dirent == NULL)
-        return MICROBIT_NO_RESOURCES;
+    lock.unlock();
 
-    return MICROBIT_OK;
+    return result;
 }
 
 
@@ -798,6 +1774,22 @@ int MicroBitFileSystem::createDirectory(char const *name)
   * @endcode
   */
 int MicroBitFileSystem::open(char const * filename, uint32_t flags)
+{
+    lock.lock();
+    int result = openFile(filename, flags);
+    lock.unlock();
+
+    return result;
+}
+
+/**
+  * Open a file, as open(). The caller must hold the lock.
+  *
+  * @param filename name of the file to open.
+  * @param flags One or more of MB_READ, MB_WRITE or MB_CREAT.
+  * @return the file handle, or an error code as open().
+  */
+int MicroBitFileSystem::openFile(char const * filename, uint32_t flags)
 {
     FileDescriptor *file;               // File Descriptor of this file.
     DirectoryEntry* directory;          // Directory holding this file.
@@ -864,7 +1856,8 @@ int MicroBitFileSystem::open(char const * filename, uint32_t flags)
     file->seek = (flags & MB_APPEND) ? file->length : 0;
     file->dirent = dirent;
     file->directory = directory;
-    file->cacheLength = 0;
+    file->block = dirent->first_block;
+    file->blockPosition = 0;
 
     // Add the file descriptor to the chain of open files.
     file->next = openFiles;
@@ -894,6 +1887,21 @@ int MicroBitFileSystem::open(char const * filename, uint32_t flags)
   * @endcode
   */
 int MicroBitFileSystem::flush(int fd)
+{
+    lock.lock();
+    int result = flushFile(fd);
+    lock.unlock();
+
+    return result;
+}
+
+/**
+  * Write back all state associated with the given file, as flush(). The caller must hold the lock.
+  *
+  * @param fd file descriptor - obtained with open().
+  * @return MICROBIT_OK on success, or an error code as flush().
+  */
+int MicroBitFileSystem::flushFile(int fd)
 {
     // Protect against accidental re-initialisation
     if ((status & MBFS_STATUS_INITIALISED) == 0)
@@ -906,7 +1914,7 @@ int MicroBitFileSystem::flush(int fd)
         return MICROBIT_INVALID_PARAMETER;
 
     // Flush any data in the writeback cache.
-    writeBack(file);
+    writeBack();
 
     // If the file has changed size, create an updated directory entry for the file, reflecting it's new length.
     if (file->dirent->length != file->length)
@@ -918,7 +1926,8 @@ int MicroBitFileSystem::flush(int fd)
         if (file->dirent->flags == MBFS_DIRECTORY_ENTRY_NEW)
         {
             d.flags = MBFS_DIRECTORY_ENTRY_VALID;
-            flash.flash_write(file->dirent, &d, sizeof(DirectoryEntry));
+            journalWrite(file->dirent, &d, sizeof(DirectoryEntry));
+            journalCommit();
         }
 
         // Otherwise, replace the dirent with a freshly allocated one, and mark the other as INVALID.
@@ -927,10 +1936,20 @@ int MicroBitFileSystem::flush(int fd)
             DirectoryEntry *newDirent;
             uint16_t value = MBFS_DELETED;
 
-            // invalidate the old directory entry and create a new one with the updated data.
-            flash.flash_write(&file->dirent->flags, &value, 2);
+            // Create the new directory entry before the old one is invalidated, so the two can be swapped in a single transaction.
+            // Any recycling of the directory block leaves the old entry in place.
             newDirent = createDirectoryEntry(file->directory);
-            flash.flash_write(newDirent, &d, sizeof(DirectoryEntry));
+            if (newDirent == NULL)
+                return MICROBIT_NO_RESOURCES;
+
+            indexRemove(file->dirent, file->directory);
+            journalWrite(newDirent, &d, sizeof(DirectoryEntry));
+            journalWrite(&file->dirent->flags, &value, 2);
+            journalCommit();
+            indexAdd(newDirent, file->directory);
+
+            // The file is now described by the new entry.
+            file->dirent = newDirent;
         }
     }
 
@@ -961,18 +1980,20 @@ int MicroBitFileSystem::flush(int fd)
   */
 int MicroBitFileSystem::close(int fd)
 {
+    lock.lock();
+
     // Firstly, ensure all unwritten data is flushed.
-    int r = flush(fd);
+    int r = flushFile(fd);
 
     // If the flush called failed on validation, pass the error code onto the caller.
-    if (r != MICROBIT_OK)
-        return r;
-
-    // Remove the file descriptor from the list of open files, and free it.
+    // Otherwise, remove the file descriptor from the list of open files, and free it.
     // n.b. we know this is safe, as flush() validates this.
-    delete getFileDescriptor(fd, true);
+    if (r == MICROBIT_OK)
+        delete getFileDescriptor(fd, true);
 
-    return MICROBIT_OK;
+    lock.unlock();
+
+    return r;
 }
 
 /**
@@ -1007,14 +2028,16 @@ int MicroBitFileSystem::seek(int fd, int offset, uint8_t flags)
     if ((status & MBFS_STATUS_INITIALISED) == 0)
         return MICROBIT_NOT_SUPPORTED;
 
+    lock.lock();
+
     // Ensure the file is open.
     file = getFileDescriptor(fd);
 
     if (file == NULL)
+    {
+        lock.unlock();
         return MICROBIT_INVALID_PARAMETER;
-    
-    // Flush any data in the writeback cache.
-    writeBack(file);
+    }
 
     position = file->seek;
 
@@ -1028,9 +2051,11 @@ int MicroBitFileSystem::seek(int fd, int offset, uint8_t flags)
         position = file->seek + offset;
     
     if (position < 0 || (uint32_t)position > file->length)
-        return MICROBIT_INVALID_PARAMETER;
+        position = MICROBIT_INVALID_PARAMETER;
+    else
+        file->seek = position;
 
-    file->seek = position;
+    lock.unlock();
     
     return position;
 }
@@ -1065,7 +2090,6 @@ int MicroBitFileSystem::read(int fd, uint8_t* buffer, int size)
     uint8_t *writePointer;
 
     uint32_t offset;
-    uint32_t position = 0;
     int bytesCopied = 0;
     int segmentLength;
 
@@ -1073,30 +2097,25 @@ int MicroBitFileSystem::read(int fd, uint8_t* buffer, int size)
     if ((status & MBFS_STATUS_INITIALISED) == 0)
         return MICROBIT_NOT_SUPPORTED;
 
+    lock.lock();
+
     // Ensure the file is open.
     file = getFileDescriptor(fd);
 
     if (file == NULL || buffer == NULL || size == 0)
+    {
+        lock.unlock();
         return MICROBIT_INVALID_PARAMETER;
-
-    // Flush any data in the writeback cache before we change the seek pointer.
-    writeBack(file);
+    }
 
     // Validate the read length.
     size = min(size, file->length - file->seek);
 
     // Find the read position.
-    block = file->dirent->first_block; 
-
-    // Walk the file table until we reach the start block
-    while (file->seek - position > MBFS_BLOCK_SIZE)
-    {
-        block = getNextFileBlock(block);
-        position += MBFS_BLOCK_SIZE;
-    }
+    block = getSeekBlock(file);
 
     // Once we have the correct start block, handle the byte offset.
-    offset = file->seek - position;
+    offset = file->seek - file->blockPosition;
 
     // Now, start copying bytes into the requested buffer.
     writePointer = buffer;
@@ -1107,13 +2126,13 @@ int MicroBitFileSystem::read(int fd, uint8_t* buffer, int size)
         segmentLength = min(size - bytesCopied, MBFS_BLOCK_SIZE - offset);
 
         if(segmentLength > 0)
-            memcpy(writePointer, readPointer, segmentLength);
+            cacheRead(writePointer, readPointer, segmentLength);
 
         bytesCopied += segmentLength;
         writePointer += segmentLength;
         offset += segmentLength;
 
-        if (offset == MBFS_BLOCK_SIZE)
+        if (offset == MBFS_BLOCK_SIZE && bytesCopied < size)
         {
             block = getNextFileBlock(block);
             offset = 0;
@@ -1121,27 +2140,358 @@ int MicroBitFileSystem::read(int fd, uint8_t* buffer, int size)
     }
 
     file->seek += bytesCopied;
+    file->block = block;
+    file->blockPosition = file->seek - offset;
+
+    lock.unlock();
 
     return bytesCopied;
 }
 
 /**
-  * Flush a given file's cache back to FLASH memory.
+  * Obtain direct access to the content of a file, with no copy into RAM.
+  *
+  * Provides the address of the data at the current seek position of the file, and the
+  * number of bytes that can be read from there. Consecutive blocks of the file that are
+  * adjacent in FLASH memory are returned as a single span. The seek position of the file
+  * handle is advanced past the span, so repeated calls visit each span of the file in turn.
+  *
+  * The data is read-only, and remains valid until the file is written to or removed.
+  *
+  * @param fd File handle, obtained with open()
+  * @param data Set to the address of the data at the current seek position.
+  * @return the number of bytes available at data on success, zero at the end of the file,
+  *         MICROBIT_NOT_SUPPORTED if the file system is not initialised, or
+  *         MICROBIT_INVALID_PARAMETER if the given file handle is invalid.
+  *
+  * @code
+  * MicroBitFileSystem f;
+  * const uint8_t *data;
+  * int fd = f.open("table.bin", MB_READ);
+  * int length;
+  * while ((length = f.map(fd, &data)) > 0)
+  *    process(data, length);
+  * @endcode
+  */
+int MicroBitFileSystem::map(int fd, const uint8_t **data)
+{
+    FileDescriptor *file;
+    uint16_t block;
+    uint32_t offset;
+    uint32_t position;
+    int length;
+    int size;
+
+    // Protect against accidental re-initialisation
+    if ((status & MBFS_STATUS_INITIALISED) == 0)
+        return MICROBIT_NOT_SUPPORTED;
+
+    lock.lock();
+
+    // Ensure the file is open.
+    file = getFileDescriptor(fd);
+
+    if (file == NULL || data == NULL)
+    {
+        lock.unlock();
+        return MICROBIT_INVALID_PARAMETER;
+    }
+
+    size = file->length - file->seek;
+    if (size <= 0)
+    {
+        lock.unlock();
+        return 0;
+    }
+
+    // Data held in the writeback cache must be in FLASH memory before it can be used in place.
+    writeBack();
+
+    // Find the block holding the current position. A position at the end of a block starts the next.
+    block = getSeekBlock(file);
+    position = file->blockPosition;
+    offset = file->seek - position;
+
+    if (offset == MBFS_BLOCK_SIZE)
+    {
+        block = getNextFileBlock(block);
+        position += MBFS_BLOCK_SIZE;
+        offset = 0;
+    }
+
+    *data = (uint8_t *)getBlock(block) + offset;
+    length = min(size, MBFS_BLOCK_SIZE - offset);
+
+    // Extend the span across any following blocks of the file held immediately after this one.
+    while (length < size && getNextFileBlock(block) == block + 1)
+    {
+        block++;
+        position += MBFS_BLOCK_SIZE;
+        length += min(size - length, MBFS_BLOCK_SIZE);
+    }
+
+    file->seek += length;
+    file->block = block;
+    file->blockPosition = position;
+
+    lock.unlock();
+
+    return length;
+}
+
+/**
+  * Find the writeback cache page holding the given physical page, optionally claiming one for it.
+  * If no cache page is free, the least recently used page is written back to FLASH and reused.
   *
-  * @param file File descriptor to flush.
-  * @return The number of bytes written.
-  * 
+  * @param page The physical page to look up.
+  * @param create true to claim a cache page for the physical page if it is not cached.
+  * @return The cache page, or NULL if the page is not cached, or no cache is available.
   */
-int MicroBitFileSystem::writeBack(FileDescriptor *file)
+MBFSCachePage* MicroBitFileSystem::getCachePage(uint32_t *page, bool create)
 {
-    if (file->cacheLength)
+    MBFSCachePage *c = NULL;
+
+    if (MBFS_CACHE_PAGES == 0)
+        return NULL;
+
+    if (cache == NULL)
     {
-        int r = writeBuffer(file, file->cache, file->cacheLength);
-        file->cacheLength = 0;
-        return r;
+        if (!create)
+            return NULL;
+
+        cache = new MBFSCachePage[MBFS_CACHE_PAGES];
+        if (cache == NULL)
+            return NULL;
+
+        for (int i = 0; i < MBFS_CACHE_PAGES; i++)
+            cache[i].page = NULL;
     }
 
-    return 0;
+    for (int i = 0; i < MBFS_CACHE_PAGES; i++)
+    {
+        if (cache[i].page == page)
+        {
+            cache[i].lastUsed = system_timer_current_time();
+            return &cache[i];
+        }
+
+        // Keep track of the best page to reuse: an unused one, or failing that, the least recently used.
+        if (c == NULL || (c->page != NULL && (cache[i].page == NULL || cache[i].lastUsed < c->lastUsed)))
+            c = &cache[i];
+    }
+
+    if (!create)
+        return NULL;
+
+    writeBack(c);
+
+    c->page = page;
+    c->flags = 0;
+    c->dirtyWords = 0;
+    c->lastUsed = system_timer_current_time();
+    memset(c->dirty, 0, sizeof(c->dirty));
+
+    return c;
+}
+
+/**
+  * Write data to FLASH memory through the writeback cache.
+  * The data must lie within a single physical page.
+  *
+  * @param address The location in FLASH memory to write to.
+  * @param buffer The data to write.
+  * @param length The number of bytes to write.
+  * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if no cache is available.
+  */
+int MicroBitFileSystem::cacheWrite(uint8_t *address, uint8_t *buffer, int length)
+{
+    uint32_t *page = (uint32_t *)((uint32_t)(uintptr_t)address - (uint32_t)(uintptr_t)address % PAGE_SIZE);
+    MBFSCachePage *c = getCachePage(page, true);
+
+    if (c == NULL)
+        return MICROBIT_NO_RESOURCES;
+
+    uint8_t *data = (uint8_t *)c->data;
+    int offset = address - (uint8_t *)page;
+
+    if (c->dirtyWords == 0)
+        c->dirtyTime = system_timer_current_time();
+
+    for (int i = offset; i < offset + length; i++)
+    {
+        int word = i / 4;
+        uint32_t mask = 1UL << (word % 32);
+
+        // Only modified words are held in the cache. Load the rest of a word from FLASH when it is first modified.
+        if (!(c->dirty[word / 32] & mask))
+        {
+            c->data[word] = page[word];
+            c->dirty[word / 32] |= mask;
+            c->dirtyWords++;
+        }
+
+        data[i] = *buffer++;
+
+        // If this byte cannot be programmed over its current value in FLASH, the page must be erased on write back.
+        if (data[i] & ~((uint8_t *)page)[i])
+            c->flags |= MBFS_CACHE_PAGE_ERASE;
+    }
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Read data from FLASH memory, including any data held in the writeback cache.
+  * The data must lie within a single physical page.
+  *
+  * @param buffer The buffer to read into.
+  * @param address The location in FLASH memory to read from.
+  * @param length The number of bytes to read.
+  */
+void MicroBitFileSystem::cacheRead(uint8_t *buffer, uint8_t *address, int length)
+{
+    uint32_t *page = (uint32_t *)((uint32_t)(uintptr_t)address - (uint32_t)(uintptr_t)address % PAGE_SIZE);
+    MBFSCachePage *c = getCachePage(page, false);
+
+    memcpy(buffer, address, length);
+
+    if (c == NULL || c->dirtyWords == 0)
+        return;
+
+    uint8_t *data = (uint8_t *)c->data;
+    int offset = address - (uint8_t *)page;
+
+    for (int i = offset; i < offset + length; i++)
+    {
+        int word = i / 4;
+
+        if (c->dirty[word / 32] & (1UL << (word % 32)))
+            buffer[i - offset] = data[i];
+    }
+}
+
+/**
+  * Write back a cache page to FLASH memory.
+  * The modified words are written with a single write operation, preceded by a page erase if necessary.
+  *
+  * @param c The cache page to write back.
+  * @return MICROBIT_OK on success.
+  */
+int MicroBitFileSystem::writeBack(MBFSCachePage *c)
+{
+    if (c->page == NULL || c->dirtyWords == 0)
+        return MICROBIT_OK;
+
+    int start = PAGE_SIZE / 4;
+    int end = 0;
+
+    // Fill in the unmodified words from FLASH, and find the range of words to write.
+    for (int word = 0; word < PAGE_SIZE / 4; word++)
+    {
+        if (c->dirty[word / 32] & (1UL << (word % 32)))
+        {
+            start = min(start, word);
+            end = word + 1;
+        }
+        else
+        {
+            c->data[word] = c->page[word];
+        }
+    }
+
+    // If the page needs to be erased, the whole page is rewritten. Otherwise, reprogramming the unmodified words
+    // within the range with their current value leaves them unchanged.
+    if (c->flags & MBFS_CACHE_PAGE_ERASE)
+    {
+        start = 0;
+        end = PAGE_SIZE / 4;
+
+        // There's no need to restore the data of DELETED blocks.
+        uint16_t block = getBlockNumber(c->page);
+
+        for (int i = 0; i < PAGE_SIZE / MBFS_BLOCK_SIZE; i++)
+        {
+            if (fileSystemTable[block + i] == MBFS_DELETED)
+                memset(&c->data[i * MBFS_BLOCK_SIZE / 4], 0xFF, MBFS_BLOCK_SIZE);
+        }
+
+        // Stage the page in a scratch page, so the page can be refreshed without risk of losing the blocks of other files.
+        uint32_t *scratch = getFreePage();
+
+        flash.flash_burn(scratch, c->data, PAGE_SIZE / 4);
+        journalAdd(MBFS_JOURNAL_OP_COPY, c->page, (uint32_t *)&scratch, 1);
+        journalCommit();
+        erasePage(scratch);
+    }
+    else
+    {
+        flash.flash_burn(c->page + start, c->data + start, end - start);
+    }
+
+    c->flags = 0;
+    c->dirtyWords = 0;
+    memset(c->dirty, 0, sizeof(c->dirty));
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Write back all modified pages in the writeback cache to FLASH memory.
+  *
+  * @return MICROBIT_OK on success.
+  */
+int MicroBitFileSystem::writeBack()
+{
+    if (cache)
+    {
+        for (int i = 0; i < MBFS_CACHE_PAGES; i++)
+            writeBack(&cache[i]);
+    }
+
+    status &= ~MBFS_STATUS_FLUSH_PENDING;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Event handler, called when data has been held in the writeback cache for MBFS_CACHE_TIMEOUT milliseconds.
+  */
+void MicroBitFileSystem::onCacheTimeout(MicroBitEvent)
+{
+    lock.lock();
+    writeBack();
+    lock.unlock();
+}
+
+/**
+  * Periodic callback from the idle thread.
+  * Requests that the writeback cache is written back to FLASH, once data has been held in it for MBFS_CACHE_TIMEOUT milliseconds,
+  * and that garbage collection is performed while there are DELETED blocks and no open files.
+  */
+void MicroBitFileSystem::idleTick()
+{
+    if (EventModel::defaultEventBus == NULL)
+        return;
+
+    // Writing back and collecting garbage may block, so both are performed by event handlers rather than the idle thread.
+    if (cache && !(status & MBFS_STATUS_FLUSH_PENDING))
+    {
+        for (int i = 0; i < MBFS_CACHE_PAGES; i++)
+        {
+            if (cache[i].page && cache[i].dirtyWords && system_timer_current_time() - cache[i].dirtyTime >= MBFS_CACHE_TIMEOUT)
+            {
+                status |= MBFS_STATUS_FLUSH_PENDING;
+                MicroBitEvent(MICROBIT_ID_FILESYSTEM, MBFS_EVT_CACHE_TIMEOUT);
+                return;
+            }
+        }
+    }
+
+    if (!(status & (MBFS_STATUS_GC_PENDING | MBFS_STATUS_GC_COMPLETE)) && openFiles == NULL && deletedBlocks > 0)
+    {
+        status |= MBFS_STATUS_GC_PENDING;
+        MicroBitEvent(MICROBIT_ID_FILESYSTEM, MBFS_EVT_GC);
+    }
 }
 
 /**
@@ -1158,22 +2508,14 @@ int MicroBitFileSystem::writeBuffer(FileDescriptor *file, uint8_t *buffer, int s
     uint8_t *writePointer;
 
     uint32_t offset;
-    uint32_t position = 0;
     int bytesCopied = 0;
     int segmentLength;
 
-    // Find the read position.
-    block = file->dirent->first_block;
-
-    // Walk the file table until we reach the start block
-    while (file->seek - position > MBFS_BLOCK_SIZE)
-    {
-        block = getNextFileBlock(block);
-        position += MBFS_BLOCK_SIZE;
-    }
+    // Find the write position.
+    block = getSeekBlock(file);
 
     // Once we have the correct start block, handle the byte offset.
-    offset = file->seek - position;
+    offset = file->seek - file->blockPosition;
     writePointer = (uint8_t *)getBlock(block) + offset;
 
     // Now, start copying bytes from the requested buffer.
@@ -1183,8 +2525,15 @@ int MicroBitFileSystem::writeBuffer(FileDescriptor *file, uint8_t *buffer, int s
         // First, determine if we need to write a partial block.
         segmentLength = min(size - bytesCopied, MBFS_BLOCK_SIZE - offset);
 
-        if (segmentLength != 0)
-            flash.flash_write(writePointer, readPointer, segmentLength, file->seek + bytesCopied < file->length ? getFreePage() : NULL);
+        if (segmentLength != 0 && cacheWrite(writePointer, readPointer, segmentLength) != MICROBIT_OK)
+        {
+            uint32_t *scratch = file->seek + bytesCopied < file->length ? getFreePage() : NULL;
+            flash.flash_write(writePointer, readPointer, segmentLength, scratch);
+
+            // Leave any scratch page erased, as free pages are expected to be.
+            if (scratch)
+                erasePage(scratch);
+        }
 
         offset += segmentLength;
         bytesCopied += segmentLength;
@@ -1192,12 +2541,20 @@ int MicroBitFileSystem::writeBuffer(FileDescriptor *file, uint8_t *buffer, int s
 
         if (offset == MBFS_BLOCK_SIZE && bytesCopied < size)
         {
-            newBlock = getFreeBlock();
-            if (newBlock == 0)
-                break;
+            // Continue along the file's existing chain of blocks, which may extend past the end of the file if an earlier
+            // write was interrupted by a reset. Only extend the chain past its end. The entries of blocks added by this
+            // write are still pending in the journal, so read as UNUSED.
+            newBlock = getNextFileBlock(block);
+
+            if (newBlock == MBFS_EOF || newBlock == MBFS_UNUSED)
+            {
+                newBlock = getFreeBlock();
+                if (newBlock == 0)
+                    break;
 
-            fileTableWrite(newBlock, MBFS_EOF);
-            fileTableWrite(block, newBlock);
+                fileTableWrite(newBlock, MBFS_EOF);
+                fileTableWrite(block, newBlock);
+            }
 
             block = newBlock;
 
@@ -1206,9 +2563,14 @@ int MicroBitFileSystem::writeBuffer(FileDescriptor *file, uint8_t *buffer, int s
         }
     }
 
+    // Make the blocks added to the file permanent.
+    journalCommit();
+
     // update the filelength metadata and seek position such that multiple writes are sequential.
     file->length = max(file->length, file->seek + bytesCopied);
     file->seek += bytesCopied;
+    file->block = block;
+    file->blockPosition = file->seek - offset;
 
     return bytesCopied;
 }
@@ -1263,45 +2625,24 @@ bool MicroBitFileSystem::isValidFilename(const char *name)
 int MicroBitFileSystem::write(int fd, uint8_t* buffer, int size)
 {
     FileDescriptor *file;
-    int bytesCopied = 0;
-    int segmentSize;
 
     // Protect against accidental re-initialisation
     if ((status & MBFS_STATUS_INITIALISED) == 0)
         return MICROBIT_NOT_SUPPORTED;
 
+    lock.lock();
+
     // Ensure the file is open.
     file = getFileDescriptor(fd);
 
     if (file == NULL || buffer == NULL || size == 0)
-        return MICROBIT_INVALID_PARAMETER;
-
-    // Determine how to handle the write. If the buffer size is less than our cache size, 
-    // write the data via the cache. Otherwise, a direct write through is likely more efficient.
-    // This may take a few iterations if the cache is already quite full.
-    if (size < MBFS_CACHE_SIZE)
-    {
-        while (bytesCopied < size)
-        {
-            segmentSize = min(size, MBFS_CACHE_SIZE - file->cacheLength);
-            memcpy(&file->cache[file->cacheLength], buffer, segmentSize);
-
-            file->cacheLength += segmentSize;
-            bytesCopied += segmentSize;
-            
-            if (file->cacheLength == MBFS_CACHE_SIZE)
-                writeBack(file);
-
-
-        }
-
-        return bytesCopied;
-    }
+        size = MICROBIT_INVALID_PARAMETER;
+    else
+        size = writeBuffer(file, buffer, size);
 
-    // If we have a relatively large block, then write it directly (
-    writeBack(file);
+    lock.unlock();
 
-    return writeBuffer(file, buffer, size);
+    return size;
 }
 
 /**
@@ -1320,33 +2661,52 @@ int MicroBitFileSystem::write(int fd, uint8_t* buffer, int size)
   */
 int MicroBitFileSystem::remove(char const * filename)
 {
-    int fd = open(filename, MB_READ);
+    lock.lock();
+
+    int fd = openFile(filename, MB_READ);
     uint16_t block, nextBlock;
     uint16_t value;
 
     // If the file can't be opened, then it is impossible to delete. Pass through any error codes.
     if (fd < 0)
+    {
+        lock.unlock();
         return fd;
+    }
 
     FileDescriptor *file = getFileDescriptor(fd, true);
 
+    // Ensure no cached data remains to be written to the blocks being released.
+    writeBack();
+
     // To erase a file, all we need to do is mark its directory entry and data blocks as INVALID.
-    // First mark the file table
+    // First mark the file table. The chain is deleted by a single journal operation, however long it is.
     block = file->dirent->first_block;
     while (block != MBFS_EOF)
     {
         nextBlock = fileSystemTable[block];
-        fileTableWrite(block, MBFS_DELETED);
+        updateBlockMap(block, MBFS_DELETED);
         block = nextBlock;
     }
 
+    journalAdd(MBFS_JOURNAL_OP_DELETE, &fileSystemTable[file->dirent->first_block], NULL, 0);
+
+    // Remove the file from the directory index. Removing a directory orphans the entries it held, so start afresh.
+    if (file->dirent->flags != MBFS_DIRECTORY_ENTRY_NEW && (file->dirent->flags & MBFS_DIRECTORY_ENTRY_DIRECTORY))
+        indexReset();
+    else
+        indexRemove(file->dirent, file->directory);
+
     // Mark the directory entry of this file as invalid.
     value = MBFS_DIRECTORY_ENTRY_DELETED;
-    flash.flash_write(&file->dirent->flags, &value, 2);
+    journalWrite(&file->dirent->flags, &value, 2);
+    journalCommit();
 
     // release file metadata
     delete file;
 
+    lock.unlock();
+
     return MICROBIT_OK;
 }
 
@@ -22,6 +22,7 @@ DEALINGS IN THE SOFTWARE.
 #include "MicroBitConfig.h"
 #include "MicroBitFlash.h"
 #include "MicroBitDevice.h"
+#include "MicroBitFiber.h"
 #include "ErrorNo.h"
 #include "mbed.h"                   // NVIC
 
@@ -52,13 +53,174 @@ extern "C" void btle_set_user_evt_handler(void (*func)(uint32_t));
 #pragma GCC diagnostic pop
 #endif
 
+MicroBitFlashBackend *MicroBitFlash::backend = NULL;
+
 static bool evt_handler_registered = false;
-static volatile bool flash_op_complete = false;
+
+// The queue of requests waiting to be performed by the SoftDevice. The request at the head is in progress if operation_busy is set.
+static MicroBitFlashRequest *request_queue = NULL;
+static volatile bool operation_busy = false;
+
+// Owned requests that have completed, to be freed outside of interrupt context.
+static MicroBitFlashRequest *completed_requests = NULL;
+
+// The ticket of the most recently submitted, and most recently completed requests.
+static volatile uint16_t submitted_ticket = 0;
+static volatile uint16_t completed_ticket = 0;
+
+// The number of times the request at the head of the queue has failed.
+static uint8_t retries = 0;
+
+// The range of tickets covered by the most recent request to fail, if any.
+static volatile bool request_failed = false;
+static volatile uint16_t failed_first = 0;
+static volatile uint16_t failed_last = 0;
+
+/**
+  * Records the completion of a request. Requests complete in the order they were submitted,
+  * so a request covers every ticket since the previous one completed, including those of any writes merged into it.
+  * Must be called with interrupts disabled.
+  *
+  * @param ticket the ticket of the request.
+  *
+  * @param failed true if the request was abandoned, false if it was performed.
+  */
+static void complete_ticket(uint16_t ticket, bool failed)
+{
+    if (failed)
+    {
+        request_failed = true;
+        failed_first = completed_ticket + 1;
+        failed_last = ticket;
+    }
+
+    completed_ticket = ticket;
+}
+
+/**
+  * Removes the request at the head of the queue, once it has been performed or abandoned.
+  * Must be called with interrupts disabled.
+  *
+  * @param failed true if the request was abandoned, false if it was performed.
+  */
+static void complete_request(bool failed)
+{
+    MicroBitFlashRequest *r = request_queue;
+
+    request_queue = r->next;
+    retries = 0;
+
+    complete_ticket(r->ticket, failed);
+
+    if (r->flags & MICROBIT_FLASH_REQUEST_OWNED)
+    {
+        r->next = completed_requests;
+        completed_requests = r;
+    }
+}
+
+/**
+  * Starts the request at the head of the queue, if the SoftDevice is not already performing one.
+  * If the SoftDevice is busy with other work, the request remains at the head of the queue, to be retried later.
+  * A request that the SoftDevice rejects is abandoned.
+  */
+static void start_request()
+{
+    __disable_irq();
+
+    while (request_queue && !operation_busy)
+    {
+        MicroBitFlashRequest *r = request_queue;
+        uint32_t result;
+
+        if (r->flags & MICROBIT_FLASH_REQUEST_ERASE)
+            result = sd_flash_page_erase(((uint32_t)(uintptr_t)r->address)/PAGE_SIZE);
+        else
+            result = sd_flash_write(r->address, r->data, r->length);
+
+        if (result == NRF_ERROR_BUSY)
+            break;
+
+        if (result == NRF_SUCCESS)
+            operation_busy = true;
+        else
+            complete_request(true);
+    }
+
+    __enable_irq();
+}
+
+/**
+  * Determines the last request in the queue.
+  *
+  * @return the request at the tail of the queue, or NULL if the queue is empty.
+  */
+static MicroBitFlashRequest *queue_tail()
+{
+    MicroBitFlashRequest *r = request_queue;
+
+    while (r && r->next)
+        r = r->next;
+
+    return r;
+}
+
+/**
+  * Determines if a write can be merged into the request at the tail of the queue. This is possible if the tail
+  * is an owned write that is not yet in progress, and the write continues directly on from it, within the same page.
+  *
+  * @param tail the request at the tail of the queue.
+  * @param request the write to merge.
+  *
+  * @return true if the write can be merged, false otherwise.
+  */
+static bool can_merge(MicroBitFlashRequest *tail, MicroBitFlashRequest *request)
+{
+    if (tail == NULL || (tail == request_queue && operation_busy))
+        return false;
+
+    if ((tail->flags | request->flags) & MICROBIT_FLASH_REQUEST_ERASE || !(tail->flags & MICROBIT_FLASH_REQUEST_OWNED))
+        return false;
+
+    return tail->address + tail->length == request->address &&
+           ((uint32_t)(uintptr_t)tail->address) / PAGE_SIZE == ((uint32_t)(uintptr_t)(request->address + request->length) - 1) / PAGE_SIZE;
+}
+
+/**
+  * Frees any owned requests that have completed.
+  */
+static void free_completed_requests()
+{
+    __disable_irq();
+    MicroBitFlashRequest *r = completed_requests;
+    completed_requests = NULL;
+    __enable_irq();
+
+    while (r)
+    {
+        MicroBitFlashRequest *next = r->next;
+
+        free(r->data);
+        delete r;
+
+        r = next;
+    }
+}
 
 static void nvmc_event_handler(uint32_t evt)
 {
-    if(evt == NRF_EVT_FLASH_OPERATION_SUCCESS)
-        flash_op_complete = true;
+    if (evt != NRF_EVT_FLASH_OPERATION_SUCCESS && evt != NRF_EVT_FLASH_OPERATION_ERROR)
+        return;
+
+    operation_busy = false;
+
+    // A failed operation is left at the head of the queue, and retried a limited number of times.
+    if (request_queue && (evt == NRF_EVT_FLASH_OPERATION_SUCCESS || ++retries >= MICROBIT_FLASH_MAX_RETRIES))
+        complete_request(evt != NRF_EVT_FLASH_OPERATION_SUCCESS);
+
+    start_request();
+
+    MicroBitEvent(MICROBIT_ID_FLASH, MICROBIT_FLASH_EVT_COMPLETE);
 }
 
 /**
@@ -98,86 +260,406 @@ int MicroBitFlash::need_erase(uint8_t* source, uint8_t* flash_addr, int len)
 }
 
 /**
-  * Erase an entire page
-  * @param page_address address of first word of page
+  * Performs a request immediately, either through the installed backend or by programming the NVMC directly.
+  * Addresses that the backend does not manage are in the nRF51 flash, and are programmed through the NVMC.
+  * The request must not be queued.
+  *
+  * @param request the request to perform.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_BUSY if the request is in the nRF51 flash and must be queued for the
+  *         SoftDevice, or the error returned by the backend.
   */
-void MicroBitFlash::erase_page(uint32_t* pg_addr) 
+int MicroBitFlash::perform(MicroBitFlashRequest *request)
 {
-    if (ble_running())
+    if (backend)
     {
-        flash_op_complete = false;
-        while(1)
-        {
-            if (sd_flash_page_erase(((uint32_t)pg_addr)/PAGE_SIZE) == NRF_SUCCESS)
-                break;
+        int result;
 
-            wait_ms(10);
-        }
-        // Wait for SoftDevice to diable the write operation when it completes...
-        while(!flash_op_complete);
+        if (request->flags & MICROBIT_FLASH_REQUEST_ERASE)
+            result = backend->erasePage(request->address);
+        else
+            result = backend->write(request->address, request->data, request->length);
+
+        if (result != MICROBIT_INVALID_PARAMETER)
+            return result;
     }
-    else
+
+    // While the SoftDevice is running, it alone may program the NVMC.
+    if (ble_running())
+        return MICROBIT_BUSY;
+
+    if (request->flags & MICROBIT_FLASH_REQUEST_ERASE)
     {
         // Turn on flash erase enable and wait until the NVMC is ready:
         NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Een);
         while (NRF_NVMC->READY == NVMC_READY_READY_Busy) { }
 
         // Erase page:
-        NRF_NVMC->ERASEPAGE = (uint32_t)pg_addr;
+        NRF_NVMC->ERASEPAGE = (uint32_t)(uintptr_t)request->address;
         while (NRF_NVMC->READY == NVMC_READY_READY_Busy) { }
 
         // Turn off flash erase enable and wait until the NVMC is ready:
         NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Ren << NVMC_CONFIG_WEN_Pos);
         while (NRF_NVMC->READY == NVMC_READY_READY_Busy) { }
     }
+    else
+    {
+        // Turn on flash write enable and wait until the NVMC is ready:
+        NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Wen << NVMC_CONFIG_WEN_Pos);
+        while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {};
+
+        for(int i=0;i<request->length;i++)
+        {
+            *(request->address+i) = *(request->data+i);
+            while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {};
+        }
+
+        // Turn off flash write enable and wait until the NVMC is ready:
+        NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Ren << NVMC_CONFIG_WEN_Pos);
+        while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {};
+    }
+
+    return MICROBIT_OK;
 }
- 
+
 /**
-  * Write to flash memory, assuming that a write is valid
-  * (using need_erase).
+  * Submits a request to the flash request queue.
   *
-  * @param page_address address of memory to write to.
-  *     Must be word aligned.
-  * @param buffer address to write from, must be word-aligned.
-  * @param len number of uint32_t words to write.
+  * Without the SoftDevice, or if the request is managed by the installed backend, the request is performed immediately
+  * once any queued requests have completed. Otherwise, it is queued for the SoftDevice to perform. A write that continues
+  * the write at the tail of the queue, within the same page, is merged into it.
+  *
+  * @param request the request to submit. If it is not owned, it must remain valid until it completes.
+  *
+  * @return the ticket of the request, for use with flash_wait().
   */
-void MicroBitFlash::flash_burn(uint32_t* addr, uint32_t* buffer, int size) 
-{ 
-    if (ble_running())
+int MicroBitFlash::submit(MicroBitFlashRequest *request)
+{
+    free_completed_requests();
+
+    if (backend || !ble_running())
     {
-        // Schedule SoftDevice to write this memory for us, and wait for it to complete.
-        // This happens ASYNCHRONOUSLY when SD is enabled (and synchronously if disabled!!)
-        flash_op_complete = false;
+        flash_wait(submitted_ticket);
 
-        while(1)
+        int result = perform(request);
+
+        if (result != MICROBIT_BUSY)
         {
-            if (sd_flash_write(addr, buffer, size) == NRF_SUCCESS)
-                break;
+            if (request->flags & MICROBIT_FLASH_REQUEST_OWNED)
+            {
+                free(request->data);
+                delete request;
+            }
+
+            __disable_irq();
 
-            wait_ms(10);
+            int ticket = ++submitted_ticket;
+            complete_ticket(ticket, result != MICROBIT_OK);
+
+            __enable_irq();
+
+            return ticket;
         }
+    }
+
+    // Allocate room to merge this write into the queued write before it, if that looks possible.
+    MicroBitFlashRequest *tail = queue_tail();
+    uint32_t *merged = NULL;
+    uint16_t tailLength = 0;
 
-        // Wait for SoftDevice to diable the write operation when it completes...
-        while(!flash_op_complete);
+    if (can_merge(tail, request))
+    {
+        tailLength = tail->length;
+        merged = (uint32_t *)malloc((tailLength + request->length) * 4);
+    }
+
+    __disable_irq();
+
+    int ticket = ++submitted_ticket;
+
+    // The queue may have moved on while we were allocating, so check again.
+    tail = queue_tail();
+
+    if (merged && can_merge(tail, request) && tail->length == tailLength)
+    {
+        uint32_t *data = tail->data;
+
+        memcpy(merged, data, tailLength * 4);
+        memcpy(merged + tailLength, request->data, request->length * 4);
+
+        tail->data = merged;
+        tail->length += request->length;
+        tail->ticket = ticket;
+
+        __enable_irq();
+
+        free(data);
+
+        if (request->flags & MICROBIT_FLASH_REQUEST_OWNED)
+        {
+            free(request->data);
+            delete request;
+        }
+
+        return ticket;
     }
+
+    request->ticket = ticket;
+    request->next = NULL;
+
+    if (tail)
+        tail->next = request;
     else
+        request_queue = request;
+
+    __enable_irq();
+
+    if (merged)
+        free(merged);
+
+    start_request();
+
+    return ticket;
+}
+
+/**
+  * Queues the erasure of an entire page, without waiting for it to complete.
+  *
+  * @param page_address address of first word of page.
+  *
+  * @return a ticket to pass to flash_wait(), or MICROBIT_NO_RESOURCES if the request could not be queued.
+  */
+int MicroBitFlash::erase_page_async(uint32_t* page_address)
+{
+    MicroBitFlashRequest *request = new MicroBitFlashRequest();
+
+    if (request == NULL)
+        return MICROBIT_NO_RESOURCES;
+
+    request->address = page_address;
+    request->data = NULL;
+    request->length = 0;
+    request->flags = MICROBIT_FLASH_REQUEST_ERASE | MICROBIT_FLASH_REQUEST_OWNED;
+
+    return submit(request);
+}
+
+/**
+  * Queues a write to flash memory, without waiting for it to complete. The data is copied,
+  * so the buffer may be reused immediately. Consecutive writes within a page are merged into
+  * a single operation.
+  *
+  * @param address address of memory to write to. Must be word aligned.
+  * @param buffer address to write from, must be word-aligned.
+  * @param len number of uint32_t words to write.
+  *
+  * @return a ticket to pass to flash_wait(), or MICROBIT_NO_RESOURCES if the request could not be queued.
+  */
+int MicroBitFlash::flash_burn_async(uint32_t* address, uint32_t* buffer, int len)
+{
+    MicroBitFlashRequest *request = new MicroBitFlashRequest();
+
+    if (request == NULL)
+        return MICROBIT_NO_RESOURCES;
+
+    request->data = (uint32_t *)malloc(len * 4);
+
+    if (request->data == NULL)
     {
-        // Turn on flash write enable and wait until the NVMC is ready:
-        NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Wen << NVMC_CONFIG_WEN_Pos);
-        while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {};
+        delete request;
+        return MICROBIT_NO_RESOURCES;
+    }
+
+    memcpy(request->data, buffer, len * 4);
 
-        for(int i=0;i<size;i++) 
+    request->address = address;
+    request->length = len;
+    request->flags = MICROBIT_FLASH_REQUEST_OWNED;
+
+    return submit(request);
+}
+
+/**
+  * Waits for a queued request, and all those queued before it, to complete.
+  * The calling fiber sleeps until then, so other fibers continue to run.
+  * If the scheduler is not running, this call performs a spinning wait.
+  *
+  * @param ticket the ticket returned when the request was queued.
+  *
+  * @return MICROBIT_OK once the request has completed, or MICROBIT_CANCELLED if it failed and was abandoned.
+  *
+  * @code
+  * MicroBitFlash flash;
+  *
+  * int ticket = flash.erase_page_async(page);
+  *
+  * // do other work while the page is erased...
+  *
+  * flash.flash_wait(ticket);
+  * @endcode
+  */
+int MicroBitFlash::flash_wait(int ticket)
+{
+    return wait(ticket, true);
+}
+
+/**
+  * Waits for a queued request, and all those queued before it, to complete.
+  *
+  * @param ticket the ticket returned when the request was queued.
+  *
+  * @param yield true to let other fibers run while waiting, false to perform a spinning wait.
+  *
+  * @return MICROBIT_OK once the request has completed, or MICROBIT_CANCELLED if it failed and was abandoned.
+  */
+int MicroBitFlash::wait(int ticket, bool yield)
+{
+    if (!fiber_scheduler_running())
+        yield = false;
+
+    while ((int16_t)(completed_ticket - (uint16_t)ticket) < 0)
+    {
+        start_request();
+
+        // The SoftDevice is busy with radio activity. Try again shortly.
+        if (!operation_busy)
         {
-            *(addr+i) = *(buffer+i);
-            while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {};
+            if (yield)
+                fiber_sleep(10);
+            else
+                wait_ms(10);
+
+            continue;
         }
 
-        // Turn off flash write enable and wait until the NVMC is ready:
-        NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Ren << NVMC_CONFIG_WEN_Pos);
-        while (NRF_NVMC->READY == NVMC_READY_READY_Busy) {};
+        if (!yield)
+            continue;
+
+        // Register for the completion event before testing for completion, so that it cannot be missed.
+        if (fiber_wake_on_event(MICROBIT_ID_FLASH, MICROBIT_FLASH_EVT_COMPLETE) == MICROBIT_NOT_SUPPORTED)
+            continue;
+
+        // If the request completed in the meantime, wake ourselves.
+        if ((int16_t)(completed_ticket - (uint16_t)ticket) >= 0 || !operation_busy)
+            MicroBitEvent(MICROBIT_ID_FLASH, MICROBIT_FLASH_EVT_COMPLETE);
+
+        schedule();
     }
+
+    free_completed_requests();
+
+    __disable_irq();
+
+    bool failed = request_failed && (uint16_t)(ticket - failed_first) <= (uint16_t)(failed_last - failed_first);
+
+    __enable_irq();
+
+    return failed ? MICROBIT_CANCELLED : MICROBIT_OK;
+}
+
+/**
+  * Erase an entire page
+  * @param page_address address of first word of page
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the page could not be erased.
+  */
+int MicroBitFlash::erase_page(uint32_t* pg_addr) 
+{
+    int ticket = erase_page_async(pg_addr);
+
+    if (ticket != MICROBIT_NO_RESOURCES)
+        return flash_wait(ticket);
+
+    // Without the memory to queue a copy, queue the request from the stack. Fibers share the stack,
+    // so we must not let another fiber run until the request completes.
+    MicroBitFlashRequest request;
+
+    request.address = pg_addr;
+    request.data = NULL;
+    request.length = 0;
+    request.flags = MICROBIT_FLASH_REQUEST_ERASE;
+
+    return wait(submit(&request), false);
+}
+ 
+/**
+  * Write to flash memory, assuming that a write is valid
+  * (using need_erase).
+  *
+  * @param page_address address of memory to write to.
+  *     Must be word aligned.
+  * @param buffer address to write from, must be word-aligned.
+  * @param len number of uint32_t words to write.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the words could not be written.
+  */
+int MicroBitFlash::flash_burn(uint32_t* addr, uint32_t* buffer, int size) 
+{ 
+    int ticket = flash_burn_async(addr, buffer, size);
+
+    if (ticket != MICROBIT_NO_RESOURCES)
+        return flash_wait(ticket);
+
+    // Without the memory to queue a copy, queue the request from the stack. Fibers share the stack,
+    // so we must not let another fiber run until the request completes.
+    MicroBitFlashRequest request;
+
+    request.address = addr;
+    request.data = buffer;
+    request.length = size;
+    request.flags = 0;
+
+    return wait(submit(&request), false);
 }
  
+/**
+  * Installs a backend to perform all subsequent erase and write operations,
+  * in place of the nRF51 flash.
+  *
+  * @param backend The backend to use, or NULL to return to the nRF51 flash.
+  *
+  * @code
+  * MicroBitFlashSimulator simulator(region, 2);
+  * MicroBitFlash::setBackend(&simulator);
+  * @endcode
+  */
+void MicroBitFlash::setBackend(MicroBitFlashBackend *backend)
+{
+    MicroBitFlash::backend = backend;
+}
+
+/**
+  * Determines the backend in use.
+  *
+  * @return the backend installed with setBackend(), or NULL if the nRF51 flash is in use.
+  */
+MicroBitFlashBackend *MicroBitFlash::getBackend()
+{
+    return backend;
+}
+
+/**
+  * Assembles a word to write to a page, from the bytes being written where they overlap it, and from the
+  * original contents of the page elsewhere.
+  *
+  * @param original the original contents of the page.
+  * @param buffer the bytes being written.
+  * @param offset the offset within the page of the first byte being written.
+  * @param length the number of bytes being written.
+  * @param i the offset within the page of the word.
+  *
+  * @return the word to write.
+  */
+static uint32_t page_word(uint8_t *original, uint8_t *buffer, int offset, int length, int i)
+{
+    uint32_t word = 0;
+
+    for (int b = 0; b < 4; b++, i++)
+        word |= (uint32_t)((i >= offset && i < offset + length) ? buffer[i - offset] : original[i]) << (b * 8);
+
+    return word;
+}
+
 /**
   * Writes the given number of bytes to the address in flash specified.
   * Neither address nor buffer need be word-aligned.
@@ -199,19 +681,23 @@ int MicroBitFlash::flash_write(void* address, void* from_buffer,
                                int length, void* scratch_addr)
 {
     // Ensure that scratch_addr is aligned on a page boundary.
-    if((uint32_t)scratch_addr & 0x3FF) 
+    if((uint32_t)(uintptr_t)scratch_addr & 0x3FF) 
         return MICROBIT_INVALID_PARAMETER;
 
     // Locate the hardware FLASH page used by this operation.
-    int page = (uint32_t)address / PAGE_SIZE;
+    int page = (uint32_t)(uintptr_t)address / PAGE_SIZE;
     uint32_t* pgAddr = (uint32_t*)(page * PAGE_SIZE);
 
     // offset to write from within page.
-    int offset = (uint32_t)address % PAGE_SIZE;
+    int offset = (uint32_t)(uintptr_t)address % PAGE_SIZE;
 
     uint8_t* writeFrom = (uint8_t*)pgAddr;
     int start = WORD_ADDR(offset);
-    int end = WORD_ADDR((offset+length+4));
+    int end = WORD_ADDR((offset+length+3));
+
+    // Ensure any queued operations are complete before we inspect the page.
+    flash_wait(submitted_ticket);
+
     int erase = need_erase((uint8_t *)from_buffer, (uint8_t *)address, length);
 
     // Preserve the data by writing to the scratch page.
@@ -220,36 +706,44 @@ int MicroBitFlash::flash_write(void* address, void* from_buffer,
         if (!scratch_addr)
             return MICROBIT_INVALID_PARAMETER;
 
-        this->flash_burn((uint32_t*)scratch_addr, pgAddr, PAGE_SIZE/4);
-        this->erase_page(pgAddr);
+        if (this->flash_burn((uint32_t*)scratch_addr, pgAddr, PAGE_SIZE/4) != MICROBIT_OK || this->erase_page(pgAddr) != MICROBIT_OK)
+            return MICROBIT_CANCELLED;
         writeFrom = (uint8_t*)scratch_addr;
         start = 0;
         end = PAGE_SIZE;
     }
 
-    uint32_t writeWord = 0;
+    // Queue the words of the page together, as a single operation.
+    int words = (end - start) / 4;
+    uint32_t *data = (uint32_t *)malloc(words * 4);
+    MicroBitFlashRequest *request = data ? new MicroBitFlashRequest() : NULL;
 
-    for(int i=start;i<end;i++) 
+    if (request == NULL)
     {
-        int byteOffset = i%4;
+        free(data);
 
-        if(i >= offset && i < (offset + length)) 
-        {
-            // Write from buffer.
-            writeWord |= (((uint8_t *)from_buffer)[i-offset] << ((byteOffset)*8));
-        }
-        else 
+        // Without the memory to queue the words together, write them one at a time.
+        for (int i = start; i < end; i += 4)
         {
-            writeWord |= (writeFrom[i] << ((byteOffset)*8));
-        }
+            uint32_t word = page_word(writeFrom, (uint8_t *)from_buffer, offset, length, i);
 
-        if( ((i+1)%4) == 0) 
-        {
-            this->flash_burn(pgAddr + (i/4), &writeWord, 1);
-            writeWord = 0;
+            if (this->flash_burn(pgAddr + (i/4), &word, 1) != MICROBIT_OK)
+                return MICROBIT_CANCELLED;
         }
+
+        return MICROBIT_OK;
     }
 
-    return MICROBIT_OK;
+    for (int i = 0; i < words; i++)
+        data[i] = page_word(writeFrom, (uint8_t *)from_buffer, offset, length, start + i*4);
+
+    request->address = pgAddr + (start/4);
+    request->data = data;
+    request->length = words;
+    request->flags = MICROBIT_FLASH_REQUEST_OWNED;
+
+    submit(request);
+
+    return flash_wait(submitted_ticket);
 }
 
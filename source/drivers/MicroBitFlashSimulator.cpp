@@ -0,0 +1,301 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for a MicroBitFlashSimulator.
+  *
+  * Simulates flash memory in a region of RAM, so that flash based code such as MicroBitFileSystem can be measured
+  * and tested without wearing the real flash.
+  */
+#include "MicroBitConfig.h"
+#include "MicroBitFlashSimulator.h"
+#include "ErrorNo.h"
+
+/**
+  * Constructor.
+  *
+  * Create a simulated flash over a region of RAM. The content of the region is preserved,
+  * so a region can be reused to simulate a restart.
+  *
+  * @param base The start of the region. Must be aligned on a page boundary.
+  *
+  * @param pages The number of pages in the region.
+  */
+MicroBitFlashSimulator::MicroBitFlashSimulator(uint32_t *base, int pages)
+{
+    this->base = base;
+    this->pages = pages;
+    this->status = 0;
+    this->powerLossAfter = -1;
+    this->eraseTime = 0;
+    this->writeTime = 0;
+    this->eraseCounts = new uint16_t[pages];
+
+    resetStatistics();
+}
+
+/**
+  * Accounts for the time taken by an operation, and blocks for that time if running in real time.
+  *
+  * @param time The time taken, in microseconds.
+  */
+void MicroBitFlashSimulator::busy(uint32_t time)
+{
+    busyTime += time;
+
+    if (status & MICROBIT_FLASH_SIMULATOR_REAL_TIME)
+        wait_us(time);
+}
+
+/**
+  * Determines if power is lost during the next operation, and updates the scheduled power loss.
+  *
+  * @return true if power is lost during the operation, false otherwise.
+  */
+bool MicroBitFlashSimulator::losePower()
+{
+    if (powerLossAfter < 0)
+        return false;
+
+    if (powerLossAfter-- > 0)
+        return false;
+
+    status |= MICROBIT_FLASH_SIMULATOR_POWERED_DOWN;
+    return true;
+}
+
+/**
+  * Erase an entire page, setting every bit in it to 1.
+  *
+  * @param page_address address of the first word of the page.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the page is not in the simulated region.
+  */
+int MicroBitFlashSimulator::erasePage(uint32_t *page_address)
+{
+    uint32_t offset = (uint8_t *)page_address - (uint8_t *)base;
+
+    if (page_address < base || offset % PAGE_SIZE || offset / PAGE_SIZE >= (uint32_t)pages)
+        return MICROBIT_INVALID_PARAMETER;
+
+    if (status & MICROBIT_FLASH_SIMULATOR_POWERED_DOWN)
+        return MICROBIT_OK;
+
+    // A page that loses power while being erased is left half erased.
+    memset(page_address, 0xFF, losePower() ? PAGE_SIZE / 2 : PAGE_SIZE);
+
+    erases++;
+    eraseCounts[offset / PAGE_SIZE]++;
+    busy(eraseTime);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Program words of flash. Programming can only clear bits, so each word written becomes the logical AND
+  * of its previous and new values.
+  *
+  * @param address address of the first word to write. Must be word aligned.
+  *
+  * @param buffer address to write from. Must be word aligned.
+  *
+  * @param len number of uint32_t words to write.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the words are not in the simulated region.
+  */
+int MicroBitFlashSimulator::write(uint32_t *address, uint32_t *buffer, int len)
+{
+    if (address < base || len < 0 || address + len > base + pages * PAGE_SIZE / 4)
+        return MICROBIT_INVALID_PARAMETER;
+
+    for (int i = 0; i < len; i++)
+    {
+        if (status & MICROBIT_FLASH_SIMULATOR_POWERED_DOWN)
+            break;
+
+        uint32_t value = buffer[i];
+
+        if (~address[i] & value)
+            violations++;
+
+        // A word that loses power while being written only has its low half programmed.
+        if (losePower())
+            value |= 0xFFFF0000;
+
+        address[i] &= value;
+
+        wordsWritten++;
+        busy(writeTime);
+    }
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Sets the time modelled for each operation.
+  *
+  * @param eraseTime The time taken to erase a page, in microseconds.
+  *
+  * @param writeTime The time taken to write a word, in microseconds.
+  *
+  * @param realTime If true, each operation blocks for the time modelled. Otherwise, the time is only recorded.
+  *
+  * @code
+  * // The typical timings of the nRF51.
+  * simulator.setLatency(22300, 46);
+  * @endcode
+  */
+void MicroBitFlashSimulator::setLatency(uint32_t eraseTime, uint32_t writeTime, bool realTime)
+{
+    this->eraseTime = eraseTime;
+    this->writeTime = writeTime;
+
+    if (realTime)
+        status |= MICROBIT_FLASH_SIMULATOR_REAL_TIME;
+    else
+        status &= ~MICROBIT_FLASH_SIMULATOR_REAL_TIME;
+}
+
+/**
+  * Schedules a loss of power. Power is lost part way through the given operation: a word being written
+  * has only some of its bits programmed, and a page being erased is only partly erased. No further
+  * operations have any effect until powerUp() is called.
+  *
+  * @param operations The number of page erase or word write operations that complete before power is lost,
+  *                   or -1 to cancel a scheduled power loss.
+  *
+  * @code
+  * simulator.losePowerAfter(10);
+  * fs.write(fd, data, 4);
+  *
+  * if (simulator.isPoweredDown())
+  * {
+  *     simulator.powerUp();
+  *     MicroBitFileSystem recovered((uint32_t)region, 2);
+  * }
+  * @endcode
+  */
+void MicroBitFlashSimulator::losePowerAfter(int operations)
+{
+    powerLossAfter = operations < 0 ? -1 : operations;
+}
+
+/**
+  * Determines if a scheduled power loss has occurred.
+  *
+  * @return true if power has been lost, false otherwise.
+  */
+bool MicroBitFlashSimulator::isPoweredDown()
+{
+    return status & MICROBIT_FLASH_SIMULATOR_POWERED_DOWN;
+}
+
+/**
+  * Restores power after a simulated power loss.
+  */
+void MicroBitFlashSimulator::powerUp()
+{
+    status &= ~MICROBIT_FLASH_SIMULATOR_POWERED_DOWN;
+}
+
+/**
+  * Determines the total time modelled for all operations since the statistics were reset.
+  *
+  * @return the time, in microseconds.
+  */
+uint32_t MicroBitFlashSimulator::getBusyTime()
+{
+    return busyTime;
+}
+
+/**
+  * Determines the number of page erases since the statistics were reset.
+  *
+  * @return the number of erases.
+  */
+uint32_t MicroBitFlashSimulator::getEraseCount()
+{
+    return erases;
+}
+
+/**
+  * Determines the number of times a page has been erased since the statistics were reset.
+  *
+  * @param page The index of the page in the simulated region.
+  *
+  * @return the number of erases, or MICROBIT_INVALID_PARAMETER if the page is not in the simulated region.
+  */
+int MicroBitFlashSimulator::getEraseCount(int page)
+{
+    if (page < 0 || page >= pages)
+        return MICROBIT_INVALID_PARAMETER;
+
+    return eraseCounts[page];
+}
+
+/**
+  * Determines the number of words written since the statistics were reset.
+  *
+  * @return the number of words written.
+  */
+uint32_t MicroBitFlashSimulator::getWordsWritten()
+{
+    return wordsWritten;
+}
+
+/**
+  * Determines the number of words written since the statistics were reset that would have needed
+  * a bit to be set from 0 to 1, without the page being erased first.
+  *
+  * @return the number of violations.
+  */
+uint32_t MicroBitFlashSimulator::getViolations()
+{
+    return violations;
+}
+
+/**
+  * Resets all statistics to zero.
+  */
+void MicroBitFlashSimulator::resetStatistics()
+{
+    busyTime = 0;
+    erases = 0;
+    wordsWritten = 0;
+    violations = 0;
+
+    memset(eraseCounts, 0, pages * sizeof(uint16_t));
+}
+
+/**
+  * Destructor.
+  */
+MicroBitFlashSimulator::~MicroBitFlashSimulator()
+{
+    if (MicroBitFlash::getBackend() == this)
+        MicroBitFlash::setBackend(NULL);
+
+    delete[] eraseCounts;
+}
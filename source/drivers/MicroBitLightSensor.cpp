@@ -32,29 +32,88 @@ DEALINGS IN THE SOFTWARE.
 #include "MicroBitConfig.h"
 #include "MicroBitLightSensor.h"
 #include "MicroBitDisplay.h"
+#include "MicroBitSystemTimer.h"
+#include "MicroBitFiber.h"
+
+// GPIO configurations of a column pin while it is being sensed, and while it is driving the display.
+#define MICROBIT_LIGHT_SENSOR_PIN_INPUT     ((GPIO_PIN_CNF_DIR_Input << GPIO_PIN_CNF_DIR_Pos) | \
+                                             (GPIO_PIN_CNF_INPUT_Disconnect << GPIO_PIN_CNF_INPUT_Pos) | \
+                                             (GPIO_PIN_CNF_PULL_Disabled << GPIO_PIN_CNF_PULL_Pos))
+
+#define MICROBIT_LIGHT_SENSOR_PIN_OUTPUT    ((GPIO_PIN_CNF_DIR_Output << GPIO_PIN_CNF_DIR_Pos) | \
+                                             (GPIO_PIN_CNF_INPUT_Disconnect << GPIO_PIN_CNF_INPUT_Pos) | \
+                                             (GPIO_PIN_CNF_PULL_Disabled << GPIO_PIN_CNF_PULL_Pos) | \
+                                             (GPIO_PIN_CNF_DRIVE_S0S1 << GPIO_PIN_CNF_DRIVE_Pos))
+
+/**
+  * Determines the analog input of the nRF51 that is connected to the given pin.
+  *
+  * @param pin The GPIO pin number.
+  *
+  * @return The ADC_CONFIG_PSEL bit of the analog input, or ADC_CONFIG_PSEL_Disabled if the pin has none.
+  */
+static uint32_t analogInputOf(int pin)
+{
+    // AIN0 and AIN1 are on P0.26 and P0.27, and AIN2 - AIN7 on P0.01 - P0.06.
+    if (pin == 26 || pin == 27)
+        return 1 << (pin - 26);
+
+    if (pin >= 1 && pin <= 6)
+        return 1 << (pin + 1);
+
+    return ADC_CONFIG_PSEL_Disabled;
+}
 
 /**
   * After the startSensing method has been called, this method will be called
   * MICROBIT_LIGHT_SENSOR_AN_SET_TIME after.
   *
-  * It will then read from the currently selected channel using the AnalogIn
-  * that was configured in the startSensing method.
+  * It will then read from the currently selected channel using the ADC
+  * configuration that was selected in the startSensing method.
   */
 void MicroBitLightSensor::analogReady()
 {
-    this->results[chan] = this->sensePin->read_u16();
+    int pin = matrixMap.columnStart + chan;
+
+    NRF_ADC->ENABLE = ADC_ENABLE_ENABLE_Enabled;
+    NRF_ADC->CONFIG = adcConfig[chan];
+    NRF_ADC->TASKS_START = 1;
+
+    // A 10 bit conversion takes around 68us.
+    while (NRF_ADC->BUSY & ADC_BUSY_BUSY_Msk);
+
+    this->results[chan] = NRF_ADC->RESULT;
 
     analogDisable();
 
-    DigitalOut((PinName)(matrixMap.columnStart + chan)).write(1);
+    // Return the column to the display.
+    NRF_GPIO->OUTSET = 1 << pin;
+    NRF_GPIO->PIN_CNF[pin] = MICROBIT_LIGHT_SENSOR_PIN_OUTPUT;
+
+    status &= ~MICROBIT_LIGHT_SENSOR_SENSING;
 
     chan++;
 
-    chan = chan % MICROBIT_LIGHT_SENSOR_CHAN_NUM;
+    // Once every section has been sampled, feed the new light level through the filter.
+    if (chan == MICROBIT_LIGHT_SENSOR_CHAN_NUM)
+    {
+        int sample = calculateLevel();
+
+        chan = 0;
+
+        if (status & MICROBIT_LIGHT_SENSOR_HAS_READING)
+            level = level - (level >> MICROBIT_LIGHT_SENSOR_FILTER_SHIFT) + sample;
+        else
+            level = sample << MICROBIT_LIGHT_SENSOR_FILTER_SHIFT;
+
+        status |= MICROBIT_LIGHT_SENSOR_HAS_READING;
+
+        MicroBitEvent(MICROBIT_ID_LIGHT_SENSOR, MICROBIT_LIGHT_SENSOR_EVT_UPDATE);
+    }
 }
 
 /**
-  * Forcibly disables the AnalogIn, otherwise it will remain in possession
+  * Forcibly disables the ADC, otherwise it will remain in possession
   * of the GPIO channel it is using, meaning that the display will not be
   * able to use a channel (COL).
   *
@@ -85,19 +144,105 @@ MicroBitLightSensor::MicroBitLightSensor(const MatrixMap &map) :
     analogTrigger(),
     matrixMap(map)
 {
+    this->id = MICROBIT_ID_LIGHT_SENSOR;
     this->chan = 0;
+    this->status = 0;
+    this->level = 0;
+    this->rowMask = 0;
+    this->samplePeriod = MICROBIT_LIGHT_SENSOR_DEFAULT_PERIOD;
+    this->sampleTime = 0;
+    this->activeUntil = 0;
 
     for(int i = 0; i < MICROBIT_LIGHT_SENSOR_CHAN_NUM; i++)
+    {
         results[i] = 0;
 
+        // The same configuration as mbed's AnalogIn, so that readings remain in the calibrated range.
+        adcConfig[i] = (ADC_CONFIG_RES_10bit                            << ADC_CONFIG_RES_Pos) |
+                       (ADC_CONFIG_INPSEL_AnalogInputOneThirdPrescaling << ADC_CONFIG_INPSEL_Pos) |
+                       (ADC_CONFIG_REFSEL_VBG                           << ADC_CONFIG_REFSEL_Pos) |
+                       (analogInputOf(matrixMap.columnStart + i)        << ADC_CONFIG_PSEL_Pos) |
+                       (ADC_CONFIG_EXTREFSEL_None                       << ADC_CONFIG_EXTREFSEL_Pos);
+    }
+
+    for (int i = matrixMap.rowStart; i < matrixMap.rowStart + matrixMap.rows; i++)
+        rowMask |= 1 << i;
+
     if (EventModel::defaultEventBus)
+    {
         EventModel::defaultEventBus->listen(MICROBIT_ID_DISPLAY, MICROBIT_DISPLAY_EVT_LIGHT_SENSE, this, &MicroBitLightSensor::startSensing, MESSAGE_BUS_LISTENER_IMMEDIATE);
+        EventModel::defaultEventBus->listen(MICROBIT_ID_MESSAGE_BUS_LISTENER, MICROBIT_ID_LIGHT_SENSOR, this, &MicroBitLightSensor::onListenerRegisteredEvent, MESSAGE_BUS_LISTENER_IMMEDIATE);
+
+        if (hasListeners())
+            status |= MICROBIT_LIGHT_SENSOR_SUBSCRIBED;
+    }
 
-    this->sensePin = NULL;
+    fiber_add_idle_component(this);
 }
 
 /**
-  * This method returns a summed average of the three sections of the display.
+  * Calculates the light level from the most recent result of each section of the display.
+  *
+  * @return a value in the range 0 - 255 where 0 is dark, and 255 is very bright
+  */
+int MicroBitLightSensor::calculateLevel()
+{
+    int sum = 0;
+
+    for(int i = 0; i < MICROBIT_LIGHT_SENSOR_CHAN_NUM; i++)
+        sum += results[i];
+
+    int average = sum / MICROBIT_LIGHT_SENSOR_CHAN_NUM;
+
+    average = min(average, MICROBIT_LIGHT_SENSOR_MAX_VALUE);
+
+    average = max(average, MICROBIT_LIGHT_SENSOR_MIN_VALUE);
+
+    int inverted = (MICROBIT_LIGHT_SENSOR_MAX_VALUE - average) + MICROBIT_LIGHT_SENSOR_MIN_VALUE;
+
+    int a = 0;
+
+    int b = 255;
+
+    int normalised = a + ((((inverted - MICROBIT_LIGHT_SENSOR_MIN_VALUE)) * (b - a))/ (MICROBIT_LIGHT_SENSOR_MAX_VALUE - MICROBIT_LIGHT_SENSOR_MIN_VALUE));
+
+    return normalised;
+}
+
+/**
+  * Determines if anything is listening for MICROBIT_LIGHT_SENSOR_EVT_UPDATE events.
+  *
+  * @return true if there is a listener, false otherwise.
+  */
+bool MicroBitLightSensor::hasListeners()
+{
+    if (EventModel::defaultEventBus == NULL)
+        return false;
+
+    MicroBitListener *l;
+
+    for (int i = 0; (l = EventModel::defaultEventBus->elementAt(i)) != NULL; i++)
+    {
+        if (l->id == MICROBIT_ID_LIGHT_SENSOR && !(l->flags & MESSAGE_BUS_LISTENER_DELETING))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+  * The method that is invoked when a listener is added to the default EventModel.
+  * Starts sampling if the listener is for light sensor events.
+  */
+void MicroBitLightSensor::onListenerRegisteredEvent(MicroBitEvent)
+{
+    __disable_irq();
+    status |= MICROBIT_LIGHT_SENSOR_SUBSCRIBED;
+    __enable_irq();
+}
+
+/**
+  * This method returns a filtered, summed average of the three sections of the display.
   *
   * A section is defined as:
   *  ___________________
@@ -114,31 +259,87 @@ MicroBitLightSensor::MicroBitLightSensor(const MatrixMap &map) :
   *
   * Where each number represents a different section on the 5 x 5 matrix display.
   *
+  * Reading the light level keeps the sensor sampling for MICROBIT_LIGHT_SENSOR_ACTIVE_WINDOW milliseconds.
+  *
   * @return returns a value in the range 0 - 255 where 0 is dark, and 255
   * is very bright
+  *
+  * @note this will return 0 until the sensor has sampled every section of the display.
   */
 int MicroBitLightSensor::read()
 {
-    int sum = 0;
+    activeUntil = system_timer_current_time() + MICROBIT_LIGHT_SENSOR_ACTIVE_WINDOW;
 
-    for(int i = 0; i < MICROBIT_LIGHT_SENSOR_CHAN_NUM; i++)
-        sum += results[i];
+    return level >> MICROBIT_LIGHT_SENSOR_FILTER_SHIFT;
+}
 
-    int average = sum / MICROBIT_LIGHT_SENSOR_CHAN_NUM;
+/**
+  * Set the time between samples of each section of the display, in milliseconds.
+  *
+  * Each sample takes a row period from the display, so longer periods give a brighter,
+  * smoother display at the expense of a slower response to changes in light level.
+  *
+  * @param period the requested time between samples, in milliseconds.
+  *
+  * @return MICROBIT_OK, or MICROBIT_INVALID_PARAMETER if the period is not in the range 1 - 65535.
+  */
+int MicroBitLightSensor::setPeriod(int period)
+{
+    if (period <= 0 || period > 0xFFFF)
+        return MICROBIT_INVALID_PARAMETER;
 
-    average = min(average, MICROBIT_LIGHT_SENSOR_MAX_VALUE);
+    samplePeriod = period;
 
-    average = max(average, MICROBIT_LIGHT_SENSOR_MIN_VALUE);
+    return MICROBIT_OK;
+}
 
-    int inverted = (MICROBIT_LIGHT_SENSOR_MAX_VALUE - average) + MICROBIT_LIGHT_SENSOR_MIN_VALUE;
+/**
+  * Reads the currently configured sample period of the light sensor.
+  *
+  * @return The time between samples, in milliseconds.
+  */
+int MicroBitLightSensor::getPeriod()
+{
+    return samplePeriod;
+}
 
-    int a = 0;
+/**
+  * Determines if the sensor is due to take a sample, and if so, schedules the one after it.
+  * Called by the display at the point in its refresh cycle where a sample could be taken.
+  *
+  * @return true if the display should give the next row period to the sensor, false otherwise.
+  */
+bool MicroBitLightSensor::isSampleNeeded()
+{
+    uint64_t now = system_timer_current_time();
 
-    int b = 255;
+    if (now < sampleTime)
+        return false;
 
-    int normalised = a + ((((inverted - MICROBIT_LIGHT_SENSOR_MIN_VALUE)) * (b - a))/ (MICROBIT_LIGHT_SENSOR_MAX_VALUE - MICROBIT_LIGHT_SENSOR_MIN_VALUE));
+    if (now >= activeUntil)
+    {
+        if (!(status & MICROBIT_LIGHT_SENSOR_SUBSCRIBED))
+            return false;
 
-    return normalised;
+        // Listeners are never announced as they are removed, so have idleTick() check that one remains once per window.
+        // Sampling continues until it has done so.
+        status |= MICROBIT_LIGHT_SENSOR_CHECK_LISTENERS;
+        activeUntil = now + MICROBIT_LIGHT_SENSOR_ACTIVE_WINDOW;
+    }
+
+    sampleTime = now + samplePeriod;
+
+    return true;
+}
+
+/**
+  * Determines if the sensor is taking a sample. The display must not drive the LED matrix until it has finished.
+  *
+  * @return true if a column of the display is being sensed, false otherwise.
+  */
+bool MicroBitLightSensor::isSensing()
+{
+    return status & MICROBIT_LIGHT_SENSOR_SENSING;
 }
 
 /**
@@ -151,30 +352,63 @@ int MicroBitLightSensor::read()
   */
 void MicroBitLightSensor::startSensing(MicroBitEvent)
 {
-    for(int rowCount = 0; rowCount < matrixMap.rows; rowCount++)
-        DigitalOut((PinName)(matrixMap.rowStart + rowCount)).write(0);
+    int pin = matrixMap.columnStart + chan;
+
+    status |= MICROBIT_LIGHT_SENSOR_SENSING;
 
-    PinName currentPin = (PinName)(matrixMap.columnStart + chan);
+    // Turn off every row, and charge the column before letting it float as an input.
+    NRF_GPIO->OUTCLR = rowMask;
+    NRF_GPIO->OUTSET = 1 << pin;
+    NRF_GPIO->PIN_CNF[pin] = MICROBIT_LIGHT_SENSOR_PIN_INPUT;
+
+    analogTrigger.attach_us(this, &MicroBitLightSensor::analogReady, MICROBIT_LIGHT_SENSOR_AN_SET_TIME);
+}
+
+/**
+  * A periodic callback invoked by the fiber scheduler idle thread.
+  *
+  * Checks whether anything is still listening for MICROBIT_LIGHT_SENSOR_EVT_UPDATE events, when
+  * asked to by isSampleNeeded(). The listener list cannot be walked safely from interrupt context.
+  */
+void MicroBitLightSensor::idleTick()
+{
+    if (!(status & MICROBIT_LIGHT_SENSOR_CHECK_LISTENERS))
+        return;
 
-    DigitalOut(currentPin).write(1);
+    bool listening = hasListeners();
 
-    DigitalIn(currentPin, PullNone).~DigitalIn();
+    // The display updates our status from interrupt context.
+    __disable_irq();
 
-    if(this->sensePin != NULL)
-        delete this->sensePin;
+    status &= ~MICROBIT_LIGHT_SENSOR_CHECK_LISTENERS;
 
-    this->sensePin = new AnalogIn(currentPin);
+    if (!listening)
+        status &= ~MICROBIT_LIGHT_SENSOR_SUBSCRIBED;
 
-    analogTrigger.attach_us(this, &MicroBitLightSensor::analogReady, MICROBIT_LIGHT_SENSOR_AN_SET_TIME);
+    __enable_irq();
 }
 
 /**
   * A destructor for MicroBitLightSensor.
   *
-  * The destructor removes the listener, used by MicroBitLightSensor from the default EventModel.
+  * The destructor removes the listeners, used by MicroBitLightSensor from the default EventModel.
   */
 MicroBitLightSensor::~MicroBitLightSensor()
 {
+    analogTrigger.detach();
+
+    // Return the column to the display if a sample was in progress.
+    if (status & MICROBIT_LIGHT_SENSOR_SENSING)
+    {
+        analogDisable();
+        NRF_GPIO->PIN_CNF[matrixMap.columnStart + chan] = MICROBIT_LIGHT_SENSOR_PIN_OUTPUT;
+    }
+
+    fiber_remove_idle_component(this);
+
     if (EventModel::defaultEventBus)
+    {
         EventModel::defaultEventBus->ignore(MICROBIT_ID_DISPLAY, MICROBIT_DISPLAY_EVT_LIGHT_SENSE, this, &MicroBitLightSensor::startSensing);
+        EventModel::defaultEventBus->ignore(MICROBIT_ID_MESSAGE_BUS_LISTENER, MICROBIT_ID_LIGHT_SENSOR, this, &MicroBitLightSensor::onListenerRegisteredEvent);
+    }
 }
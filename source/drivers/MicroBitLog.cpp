@@ -0,0 +1,460 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for MicroBitLog.
+  *
+  * An append only log of records, held in a region of FLASH memory of its own.
+  */
+
+#include "MicroBitConfig.h"
+#include "MicroBitLog.h"
+#include "MicroBitCompat.h"
+
+/**
+  * Determines if a page of FLASH memory is erased.
+  *
+  * @param page The page to check.
+  *
+  * @return true if every word of the page is erased, false otherwise.
+  */
+static bool isErased(uint32_t *page)
+{
+    for (int i = 0; i < PAGE_SIZE / 4; i++)
+        if (page[i] != 0xFFFFFFFF)
+            return false;
+
+    return true;
+}
+
+/**
+  * Constructor.
+  *
+  * Creates an instance of MicroBitLog over the given region of FLASH memory, loading the records already there.
+  *
+  * @param flashStart The address of the first page of the region. Must be aligned on a page boundary.
+  *
+  * @param flashPages The number of pages in the region.
+  *
+  * @param recordSize The size of every record, or zero for records of variable length. Defaults to zero.
+  *
+  * @param flags MICROBIT_LOG_RING to erase the oldest records when the log is full. Defaults to zero.
+  */
+MicroBitLog::MicroBitLog(uint32_t flashStart, int flashPages, int recordSize, int flags)
+{
+    this->base = (uint32_t *)flashStart;
+    this->pages = flashPages;
+    this->recordSize = recordSize;
+    this->flags = flags;
+    this->sequence = 0;
+
+    buffer = new uint32_t[PAGE_SIZE / 4];
+    readPage = -1;
+
+    load();
+}
+
+/**
+  * Determines the address of a page of the log.
+  *
+  * @param page The page number.
+  *
+  * @return The address of the page.
+  */
+uint32_t *MicroBitLog::getPage(int page)
+{
+    return base + page * (PAGE_SIZE / 4);
+}
+
+/**
+  * Locates the oldest and newest pages of the log, and the end of the newest page.
+  * If the log was created with a different record size, it is cleared.
+  */
+void MicroBitLog::load()
+{
+    oldest = -1;
+    current = -1;
+    written = 0;
+    end = 0;
+
+    for (int page = 0; page < pages; page++)
+    {
+        MicroBitLogPageHeader *header = (MicroBitLogPageHeader *)getPage(page);
+
+        if (header->magic != MICROBIT_LOG_MAGIC)
+            continue;
+
+        if (header->recordSize != recordSize)
+        {
+            clear();
+            return;
+        }
+
+        // Sequences only ever differ by less than the number of pages, so the comparison is safe if they wrap.
+        if (current < 0 || (int32_t)(header->sequence - sequence) > 0)
+        {
+            current = page;
+            sequence = header->sequence;
+        }
+
+        if (oldest < 0 || (int32_t)(header->sequence - ((MicroBitLogPageHeader *)getPage(oldest))->sequence) < 0)
+            oldest = page;
+    }
+
+    memset(buffer, 0xFF, PAGE_SIZE);
+
+    if (current < 0)
+        return;
+
+    // Find the end of the records in the newest page. Once a record has been torn by a loss of power, the rest
+    // of its page can not be used.
+    uint16_t offset = sizeof(MicroBitLogPageHeader);
+    int length;
+    int result;
+
+    memcpy(buffer, getPage(current), PAGE_SIZE);
+
+    while ((result = decode((uint8_t *)buffer, offset, length)) >= 0);
+
+    if (result == MICROBIT_INVALID_PARAMETER)
+        offset = PAGE_SIZE;
+
+    // The last word holding a record has been written, so the next record begins at the next word.
+    end = min((offset + 3) & ~3, PAGE_SIZE);
+    written = end;
+}
+
+/**
+  * Decodes the record at the given offset in a page.
+  *
+  * @param page The content of the page.
+  *
+  * @param offset The offset of the record. Updated to the offset of the next record, skipping any padding.
+  *
+  * @param length Set to the length of the record.
+  *
+  * @return The offset of the data of the record, MICROBIT_NO_DATA if there are no more records in the page,
+  *         or MICROBIT_INVALID_PARAMETER if the record is corrupt. No records follow a corrupt record in its page.
+  */
+int MicroBitLog::decode(const uint8_t *page, uint16_t &offset, int &length)
+{
+    // The first byte of a record is never unused, so an unused byte within a word is padding to the next word.
+    if (offset < PAGE_SIZE && offset % 4 && page[offset] == MICROBIT_LOG_UNUSED)
+        offset = (offset + 3) & ~3;
+
+    if (offset + 2 > PAGE_SIZE || page[offset] == MICROBIT_LOG_UNUSED)
+        return MICROBIT_NO_DATA;
+
+    int position = offset + 2;
+
+    if (recordSize)
+    {
+        length = recordSize;
+    }
+    else
+    {
+        length = page[position++];
+
+        if (length & 0x80 && position < PAGE_SIZE)
+            length = (length & 0x7F) | (page[position++] << 7);
+    }
+
+    if (position + length > PAGE_SIZE)
+        return MICROBIT_INVALID_PARAMETER;
+
+    uint16_t crc = crc16(&page[offset + 2], position + length - (offset + 2), 0xFFFF) & 0x7FFF;
+
+    if (page[offset] != (crc >> 8) || page[offset + 1] != (crc & 0xFF))
+        return MICROBIT_INVALID_PARAMETER;
+
+    offset = position + length;
+
+    return position;
+}
+
+/**
+  * Writes the buffered records of the current page to FLASH.
+  * The next record begins on a word boundary, so no word is written twice.
+  */
+void MicroBitLog::writeBuffer()
+{
+    if (current < 0 || written >= end)
+        return;
+
+    int from = written / 4;
+    int to = (end + 3) / 4;
+
+    // Records appended while the calling fiber waits for the write begin on the next word, leaving the words being written unchanged.
+    end = to * 4;
+    written = end;
+
+    flash.flash_burn(getPage(current) + from, buffer + from, to - from);
+}
+
+/**
+  * Writes the current page to FLASH, and begins the next page, erasing the oldest page if in ring mode.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if the log is full.
+  */
+int MicroBitLog::nextPage()
+{
+    int next = 0;
+
+    if (pages == 0)
+        return MICROBIT_NO_RESOURCES;
+
+    if (current >= 0)
+    {
+        writeBuffer();
+        next = (current + 1) % pages;
+
+        // Once every page is in use, the next page is the oldest.
+        if (next == oldest)
+        {
+            if (!(flags & MICROBIT_LOG_RING))
+                return MICROBIT_NO_RESOURCES;
+
+            oldest = pages > 1 ? (oldest + 1) % pages : next;
+        }
+    }
+
+    // Pages are erased as they are needed. Any left partially erased by a loss of power are erased again.
+    if (!isErased(getPage(next)))
+        flash.erase_page(getPage(next));
+
+    current = next;
+    sequence++;
+
+    if (oldest < 0)
+        oldest = current;
+
+    // The header is written along with the first records of the page.
+    MicroBitLogPageHeader *header = (MicroBitLogPageHeader *)buffer;
+
+    memset(buffer, 0xFF, PAGE_SIZE);
+    header->sequence = sequence;
+    header->recordSize = recordSize;
+    header->magic = MICROBIT_LOG_MAGIC;
+
+    written = 0;
+    end = sizeof(MicroBitLogPageHeader);
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Appends a record to the log. The record is held in RAM until its page is full or flush() is called.
+  *
+  * @param data The record.
+  *
+  * @param length The length of the record, which must be the record size of a log of fixed size records.
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the length is invalid,
+  *         or MICROBIT_NO_RESOURCES if the log is full and not in ring mode.
+  */
+int MicroBitLog::append(const uint8_t *data, int length)
+{
+    if (data == NULL || length <= 0 || length > (int)MICROBIT_LOG_MAX_RECORD_SIZE || (recordSize && length != recordSize))
+        return MICROBIT_INVALID_PARAMETER;
+
+    int size = 2 + length;
+
+    if (recordSize == 0)
+        size += length < 128 ? 1 : 2;
+
+    lock.lock();
+
+    if (current < 0 || end + size > PAGE_SIZE)
+    {
+        int result = nextPage();
+
+        if (result != MICROBIT_OK)
+        {
+            lock.unlock();
+            return result;
+        }
+    }
+
+    uint8_t *record = (uint8_t *)buffer + end;
+    uint8_t *p = record + 2;
+
+    // Variable length records record their length as a varint.
+    if (recordSize == 0)
+    {
+        if (length < 128)
+        {
+            *p++ = length;
+        }
+        else
+        {
+            *p++ = 0x80 | (length & 0x7F);
+            *p++ = length >> 7;
+        }
+    }
+
+    memcpy(p, data, length);
+
+    // The top bit of the CRC is clear, so the first byte of a record is never unused.
+    uint16_t crc = crc16(record + 2, size - 2, 0xFFFF) & 0x7FFF;
+
+    record[0] = crc >> 8;
+    record[1] = crc & 0xFF;
+
+    end += size;
+
+    lock.unlock();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Writes any records held in RAM to FLASH.
+  *
+  * @return MICROBIT_OK on success.
+  */
+int MicroBitLog::flush()
+{
+    lock.lock();
+    writeBuffer();
+    lock.unlock();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Moves the read position to the oldest record in the log.
+  *
+  * @return MICROBIT_OK on success.
+  */
+int MicroBitLog::rewind()
+{
+    readPage = oldest;
+    readOffset = sizeof(MicroBitLogPageHeader);
+
+    if (readPage >= 0)
+        readSequence = ((MicroBitLogPageHeader *)(readPage == current ? buffer : getPage(readPage)))->sequence;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Reads the record at the read position, and moves on to the next. If the record being read has been erased
+  * to make room in ring mode, reading continues from the oldest record.
+  *
+  * @param buffer The buffer to read the record into.
+  *
+  * @param size The size of the buffer. Longer records are truncated.
+  *
+  * @return The length of the record, or MICROBIT_NO_DATA if there are no more records.
+  */
+int MicroBitLog::read(uint8_t *buffer, int size)
+{
+    if (buffer == NULL || size < 0)
+        return MICROBIT_INVALID_PARAMETER;
+
+    if (readPage < 0)
+        rewind();
+
+    while (readPage >= 0)
+    {
+        // Records of the current page are read from RAM, as they may not have been written to FLASH yet.
+        uint8_t *page = (uint8_t *)(readPage == current ? this->buffer : getPage(readPage));
+        MicroBitLogPageHeader *header = (MicroBitLogPageHeader *)page;
+
+        if (header->magic != MICROBIT_LOG_MAGIC || header->sequence != readSequence)
+        {
+            rewind();
+            continue;
+        }
+
+        uint16_t offset = readOffset;
+        int length;
+        int data = decode(page, offset, length);
+
+        if (data >= 0)
+        {
+            memcpy(buffer, page + data, min(length, size));
+            readOffset = offset;
+
+            return length;
+        }
+
+        // More records may yet be appended to the current page.
+        if (readPage == current)
+            break;
+
+        readPage = (readPage + 1) % pages;
+        readOffset = sizeof(MicroBitLogPageHeader);
+        readSequence = ((MicroBitLogPageHeader *)(readPage == current ? this->buffer : getPage(readPage)))->sequence;
+    }
+
+    return MICROBIT_NO_DATA;
+}
+
+/**
+  * Erases every record in the log.
+  *
+  * @return MICROBIT_OK on success.
+  */
+int MicroBitLog::clear()
+{
+    lock.lock();
+
+    for (int page = 0; page < pages; page++)
+        if (!isErased(getPage(page)))
+            flash.erase_page(getPage(page));
+
+    oldest = -1;
+    current = -1;
+    written = 0;
+    end = 0;
+    readPage = -1;
+
+    lock.unlock();
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Determines the number of pages of the log holding records.
+  *
+  * @return The number of pages in use.
+  */
+int MicroBitLog::getPagesUsed()
+{
+    if (current < 0)
+        return 0;
+
+    return (current - oldest + pages) % pages + 1;
+}
+
+/**
+  * Destructor. Writes any records held in RAM to FLASH.
+  */
+MicroBitLog::~MicroBitLog()
+{
+    flush();
+    delete[] buffer;
+}
@@ -143,7 +143,7 @@ int MicroBitRadioDatagram::send(uint8_t *buffer, int len)
   * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the buffer is invalid,
   *         or the number of bytes to transmit is greater than `MICROBIT_RADIO_MAX_PACKET_SIZE + MICROBIT_RADIO_HEADER_SIZE`.
   */
-int MicroBitRadioDatagram::send(PacketBuffer data)
+int MicroBitRadioDatagram::send(const PacketBuffer &data)
 {
     return send((uint8_t *)data.getBytes(), data.length());
 }
@@ -159,7 +159,7 @@ int MicroBitRadioDatagram::send(PacketBuffer data)
   * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER if the buffer is invalid,
   *         or the number of bytes to transmit is greater than `MICROBIT_RADIO_MAX_PACKET_SIZE + MICROBIT_RADIO_HEADER_SIZE`.
   */
-int MicroBitRadioDatagram::send(ManagedString data)
+int MicroBitRadioDatagram::send(const ManagedString &data)
 {
     return send((uint8_t *)data.toCharArray(), data.length());
 }
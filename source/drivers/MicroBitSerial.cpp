@@ -445,11 +445,41 @@ int MicroBitSerial::sendChar(char c, MicroBitSerialMode mode)
   *         is using the serial instance for transmission, MICROBIT_INVALID_PARAMETER
   *         if buffer is invalid, or the given bufferLen is <= 0.
   */
-int MicroBitSerial::send(ManagedString s, MicroBitSerialMode mode)
+int MicroBitSerial::send(const ManagedString &s, MicroBitSerialMode mode)
 {
     return send((uint8_t *)s.toCharArray(), s.length(), mode);
 }
 
+/**
+  * Sends the string held by a ManagedStringBuilder over the serial line, directly from its buffer.
+  * The content of the ManagedStringBuilder is not changed.
+  *
+  * @param b the ManagedStringBuilder holding the string to send.
+  *
+  * @param mode the selected mode, one of: ASYNC, SYNC_SPINWAIT, SYNC_SLEEP. Each mode
+  *        gives a different behaviour:
+  *
+  *            ASYNC - bytes are copied into the txBuff and returns immediately.
+  *
+  *            SYNC_SPINWAIT - bytes are copied into the txBuff and this method
+  *                            will spin (lock up the processor) until all bytes
+  *                            have been sent.
+  *
+  *            SYNC_SLEEP - bytes are copied into the txBuff and the fiber sleeps
+  *                         until all bytes have been sent. This allows other fibers
+  *                         to continue execution.
+  *
+  *         Defaults to SYNC_SLEEP.
+  *
+  * @return the number of bytes written, MICROBIT_SERIAL_IN_USE if another fiber
+  *         is using the serial instance for transmission, MICROBIT_INVALID_PARAMETER
+  *         if buffer is invalid, or the given bufferLen is <= 0.
+  */
+int MicroBitSerial::send(const ManagedStringBuilder &b, MicroBitSerialMode mode)
+{
+    return send((uint8_t *)b.toCharArray(), b.length(), mode);
+}
+
 /**
   * Sends a buffer of known length over the serial line.
   *
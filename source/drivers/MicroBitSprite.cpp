@@ -0,0 +1,249 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for a MicroBitSprite.
+  *
+  * A MicroBitSprite is an image placed at a position on the display, at a given depth.
+  */
+#include "MicroBitConfig.h"
+#include "MicroBitSprite.h"
+
+/**
+  * Constructor.
+  *
+  * Create a sprite from the given image. The sprite is visible, but is not shown until it is added to a display.
+  *
+  * @param image The bitmap of the sprite.
+  *
+  * @param x The horizontal position of the sprite on the display. Defaults to 0.
+  *
+  * @param y The vertical position of the sprite on the display. Defaults to 0.
+  *
+  * @param z The depth of the sprite. Sprites with a higher z are drawn over those with a lower z. Defaults to 0.
+  *
+  * @param alpha true if clear pixels in the image should be treated as transparent, false otherwise. Defaults to true.
+  */
+MicroBitSprite::MicroBitSprite(const MicroBitImage &image, int16_t x, int16_t y, uint8_t z, bool alpha) : image(image)
+{
+    this->x = x;
+    this->y = y;
+    this->z = z;
+    this->vx = 0;
+    this->vy = 0;
+    this->period = 0;
+    this->tick = 0;
+    this->next = NULL;
+    this->flags = MICROBIT_SPRITE_VISIBLE | MICROBIT_SPRITE_CHANGED | (alpha ? MICROBIT_SPRITE_ALPHA : 0);
+}
+
+/**
+  * Updates the flags of this sprite.
+  *
+  * The display also updates the flags from interrupt context, so this is done with interrupts disabled.
+  *
+  * @param set The flags to set.
+  *
+  * @param clear The flags to clear.
+  */
+void MicroBitSprite::updateFlags(uint8_t set, uint8_t clear)
+{
+    __disable_irq();
+    flags = (flags & ~clear) | set;
+    __enable_irq();
+}
+
+/**
+  * Replaces the bitmap of this sprite.
+  *
+  * @param image The new bitmap of the sprite.
+  */
+void MicroBitSprite::setImage(const MicroBitImage &image)
+{
+    // The display may be drawing the old bitmap from interrupt context. Hold a reference to it until the
+    // new bitmap is in place, so that it is released here rather than while the display is using it.
+    MicroBitImage previous = this->image;
+
+    __disable_irq();
+    this->image = image;
+    flags |= MICROBIT_SPRITE_CHANGED;
+    __enable_irq();
+}
+
+/**
+  * Retrieves the bitmap of this sprite.
+  *
+  * If the bitmap is modified in place, call invalidate() to have the change shown.
+  *
+  * @return the bitmap of this sprite.
+  */
+MicroBitImage MicroBitSprite::getImage()
+{
+    return image;
+}
+
+/**
+  * Moves this sprite to the given position.
+  *
+  * @param x The new horizontal position of the sprite on the display.
+  *
+  * @param y The new vertical position of the sprite on the display.
+  */
+void MicroBitSprite::moveTo(int16_t x, int16_t y)
+{
+    // The display may also be moving the sprite from interrupt context.
+    __disable_irq();
+
+    if (this->x != x || this->y != y)
+    {
+        this->x = x;
+        this->y = y;
+        flags |= MICROBIT_SPRITE_CHANGED;
+    }
+
+    __enable_irq();
+}
+
+/**
+  * Retrieves the horizontal position of this sprite.
+  *
+  * @return the horizontal position of this sprite on the display.
+  */
+int MicroBitSprite::getX()
+{
+    return x;
+}
+
+/**
+  * Retrieves the vertical position of this sprite.
+  *
+  * @return the vertical position of this sprite on the display.
+  */
+int MicroBitSprite::getY()
+{
+    return y;
+}
+
+/**
+  * Sets the velocity of this sprite. The display moves the sprite by (vx, vy) pixels every period milliseconds.
+  *
+  * @param vx The number of pixels to move right in each step. Negative values move left.
+  *
+  * @param vy The number of pixels to move down in each step. Negative values move up.
+  *
+  * @param period The time between steps, in milliseconds. Zero stops the sprite.
+  *
+  * @code
+  * sprite.setVelocity(-1, 0, 100); // move left ten pixels per second
+  * @endcode
+  */
+void MicroBitSprite::setVelocity(int8_t vx, int8_t vy, uint16_t period)
+{
+    // The display steps the sprite from interrupt context.
+    __disable_irq();
+
+    this->vx = vx;
+    this->vy = vy;
+    this->tick = 0;
+    this->period = period;
+
+    __enable_irq();
+}
+
+/**
+  * Changes the depth of this sprite.
+  *
+  * @param z The depth of the sprite. Sprites with a higher z are drawn over those with a lower z.
+  */
+void MicroBitSprite::setZ(uint8_t z)
+{
+    if (this->z == z)
+        return;
+
+    // The display reorders its sprites by depth from interrupt context.
+    __disable_irq();
+
+    this->z = z;
+    flags |= MICROBIT_SPRITE_REORDER | MICROBIT_SPRITE_CHANGED;
+
+    __enable_irq();
+}
+
+/**
+  * Retrieves the depth of this sprite.
+  *
+  * @return the depth of this sprite.
+  */
+int MicroBitSprite::getZ()
+{
+    return z;
+}
+
+/**
+  * Shows or hides this sprite.
+  *
+  * @param visible true to show the sprite, false to hide it.
+  */
+void MicroBitSprite::setVisible(bool visible)
+{
+    if (visible == isVisible())
+        return;
+
+    if (visible)
+        updateFlags(MICROBIT_SPRITE_VISIBLE | MICROBIT_SPRITE_CHANGED, 0);
+    else
+        updateFlags(MICROBIT_SPRITE_CHANGED, MICROBIT_SPRITE_VISIBLE);
+}
+
+/**
+  * Determines if this sprite is visible.
+  *
+  * @return true if this sprite is visible, false otherwise.
+  */
+bool MicroBitSprite::isVisible()
+{
+    return flags & MICROBIT_SPRITE_VISIBLE;
+}
+
+/**
+  * Determines if clear pixels in this sprite are drawn, or treated as transparent.
+  *
+  * @param alpha true if clear pixels should be treated as transparent, false otherwise.
+  */
+void MicroBitSprite::setAlpha(bool alpha)
+{
+    if (alpha)
+        updateFlags(MICROBIT_SPRITE_ALPHA | MICROBIT_SPRITE_CHANGED, 0);
+    else
+        updateFlags(MICROBIT_SPRITE_CHANGED, MICROBIT_SPRITE_ALPHA);
+}
+
+/**
+  * Indicates that the bitmap of this sprite has been modified in place, and should be redrawn.
+  */
+void MicroBitSprite::invalidate()
+{
+    updateFlags(MICROBIT_SPRITE_CHANGED, 0);
+}
@@ -32,29 +32,87 @@ DEALINGS IN THE SOFTWARE.
 #include "MicroBitStorage.h"
 #include "MicroBitFlash.h"
 #include "MicroBitCompat.h"
+#include "MicroBitFiberLock.h"
 
+#define MICROBIT_STORAGE_RECORD_WORDS   (sizeof(KeyValueRecord) / 4)
+
+// Held by the fiber updating the store, as updates may block part way through while flash is written.
+// Every instance operates on the same pages, so the lock is shared between them.
+static MicroBitFiberLock lock;
+
+uint32_t *MicroBitStorage::logPage = NULL;
+uint32_t *MicroBitStorage::sparePage = NULL;
+uint32_t MicroBitStorage::generation = 0;
+uint32_t MicroBitStorage::sequence = 0;
+uint16_t MicroBitStorage::logStart = 0;
+uint16_t MicroBitStorage::logEnd = 0;
+uint16_t MicroBitStorage::keys = 0;
+uint16_t MicroBitStorage::indexHash[MICROBIT_STORAGE_INDEX_SIZE];
+uint16_t MicroBitStorage::indexOffset[MICROBIT_STORAGE_INDEX_SIZE];
+
+/**
+  * Calculates the 16 bit hash of a key, used to index it.
+  *
+  * @param key The null terminated key.
+  *
+  * @return The FNV-1a hash of the key, folded to 16 bits. Never zero.
+  */
+static uint16_t keyHash(const char *key)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*key)
+    {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+
+    hash = (hash >> 16) ^ (hash & 0xFFFF);
+
+    return hash ? hash : 1;
+}
+
+/**
+  * Calculates the CRC of a record, covering everything but the CRC itself.
+  *
+  * @param record The record to checksum.
+  *
+  * @return The CRC of the record.
+  */
+static uint16_t recordCrc(const KeyValueRecord *record)
+{
+    uint16_t crc = crc16((const uint8_t *)&record->sequence, sizeof(record->sequence), 0xFFFF);
+    crc = crc16((const uint8_t *)&record->flags, sizeof(record->flags), crc);
+
+    return crc16((const uint8_t *)&record->pair, sizeof(KeyValuePair), crc);
+}
 
 /**
   * Default constructor.
   *
   * Creates an instance of MicroBitStorage which acts like a KeyValueStore
   * that allows the retrieval, addition and deletion of KeyValuePairs.
+  *
+  * The state of the store is shared by every instance, and is reloaded from FLASH whenever an instance is created.
   */
 MicroBitStorage::MicroBitStorage()
 {
-    //initialise our magic block, if required.
-    size();
+    lock.lock();
+    load();
+    lock.unlock();
 }
 
 /**
   * Method for erasing a page in flash.
   *
   * @param page_address Address of the first word in the page to be erased.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the page could not be erased.
   */
-void MicroBitStorage::flashPageErase(uint32_t * page_address)
+int MicroBitStorage::flashPageErase(uint32_t * page_address)
 {
     MicroBitFlash flash;
-    flash.erase_page(page_address);
+    return flash.erase_page(page_address);
 }
 
 /**
@@ -65,11 +123,13 @@ void MicroBitStorage::flashPageErase(uint32_t * page_address)
   * @param to the address to copy the data to.
   *
   * @param sizeInWords the number of words to copy
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the words could not be written.
   */
-void MicroBitStorage::flashCopy(uint32_t* from, uint32_t* to, int sizeInWords)
+int MicroBitStorage::flashCopy(uint32_t* from, uint32_t* to, int sizeInWords)
 {
     MicroBitFlash flash;
-    flash.flash_burn(to, from, sizeInWords);
+    return flash.flash_burn(to, from, sizeInWords);
 }
 
 /**
@@ -78,159 +138,370 @@ void MicroBitStorage::flashCopy(uint32_t* from, uint32_t* to, int sizeInWords)
   * @param address Address of the word to change.
   *
   * @param value Value to be written to flash.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the word could not be written.
   */
-void MicroBitStorage::flashWordWrite(uint32_t * address, uint32_t value)
+int MicroBitStorage::flashWordWrite(uint32_t * address, uint32_t value)
 {
-    flashCopy(&value, address, 1);
+    return flashCopy(&value, address, 1);
 }
 
 /**
-  * Function for populating the scratch page with a KeyValueStore.
+  * Determines the number of keys that fit into a page.
   *
-  * @param store the KeyValueStore struct to write to the scratch page.
+  * @return the maximum number of keys in the store.
   */
-void MicroBitStorage::scratchKeyValueStore(KeyValueStore store)
+int MicroBitStorage::capacity()
 {
-    //calculate our various offsets
-    uint32_t *s = (uint32_t *) &store;
-    uint32_t pg_size = NRF_FICR->CODEPAGESIZE;
-    uint32_t *scratchPointer = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET));
-    int wordsToWrite = sizeof(KeyValueStore) / 4;
-
-    flashCopy(s, scratchPointer, wordsToWrite);
+    return (NRF_FICR->CODEPAGESIZE - sizeof(KeyValueLogHeader)) / sizeof(KeyValuePair);
 }
 
 /**
-  * Function for populating the scratch page with a KeyValuePair.
+  * Writes the header of a log page. The magic is written last, so the page only becomes a log once it is complete.
+  *
+  * @param page The page to write the header of.
   *
-  * @param pair the KeyValuePair struct to write to the scratch page.
+  * @param generation The generation of the log.
   *
-  * @param flashPointer the pointer in flash where this KeyValuePair resides. This pointer
-  * is used to determine the offset into the scratch page, where the KeyValuePair should
-  * be written.
+  * @param pairs The number of KeyValuePairs compacted into the page.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the header could not be written.
   */
-void MicroBitStorage::scratchKeyValuePair(KeyValuePair pair, uint32_t* flashPointer)
+int MicroBitStorage::writeHeader(uint32_t *page, uint32_t generation, uint32_t pairs)
 {
-    //we can only write using words
-    uint32_t *p = (uint32_t *) &pair;
+    KeyValueLogHeader header;
+
+    header.magic = MICROBIT_STORAGE_LOG_MAGIC;
+    header.generation = generation;
+    header.pairs = pairs;
+
+    if (flashCopy(&header.generation, &((KeyValueLogHeader *)page)->generation, 2) != MICROBIT_OK)
+        return MICROBIT_CANCELLED;
+
+    return flashCopy(&header.magic, &((KeyValueLogHeader *)page)->magic, 1);
+}
 
-    //calculate our various offsets
+/**
+  * Locates the log page, migrating a store in the legacy format or creating an empty log if there is none,
+  * and builds the index of the keys in it.
+  */
+void MicroBitStorage::load()
+{
     uint32_t pg_size = NRF_FICR->CODEPAGESIZE;
-    uint32_t pg_num  = NRF_FICR->CODESIZE - MICROBIT_STORAGE_STORE_PAGE_OFFSET;
+    uint32_t *storePage = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_STORE_PAGE_OFFSET));
+    uint32_t *scratchPage = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET));
+
+    KeyValueLogHeader *storeHeader = (KeyValueLogHeader *)storePage;
+    KeyValueLogHeader *scratchHeader = (KeyValueLogHeader *)scratchPage;
+
+    bool storeValid = storeHeader->magic == MICROBIT_STORAGE_LOG_MAGIC && (int)storeHeader->pairs <= capacity();
+    bool scratchValid = scratchHeader->magic == MICROBIT_STORAGE_LOG_MAGIC && (int)scratchHeader->pairs <= capacity();
+
+    // If both pages hold a log, we were reset after compaction completed but before the old log was next reused.
+    if (storeValid && (!scratchValid || (int32_t)(storeHeader->generation - scratchHeader->generation) > 0))
+    {
+        logPage = storePage;
+        sparePage = scratchPage;
+    }
+    else if (scratchValid)
+    {
+        logPage = scratchPage;
+        sparePage = storePage;
+    }
+    else
+    {
+        // There is no log yet. Start one in the scratch page, carrying over any pairs held in the legacy format.
+        // A legacy store never holds more pairs than the log page can, so every pair is carried over as it is.
+        KeyValueStore *store = (KeyValueStore *)storePage;
+        int legacyPairs = 0;
+
+        if (store->magic == MICROBIT_STORAGE_MAGIC && (int)store->size <= capacity())
+            legacyPairs = store->size;
 
-    uint32_t *scratchPointer = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET));
-    uint32_t *flashBlockPointer = (uint32_t *)(pg_size * pg_num);
+        logPage = scratchPage;
+        sparePage = storePage;
 
-    uint32_t flashPointerOffset = flashPointer - flashBlockPointer;
+        flashPageErase(logPage);
 
-    scratchPointer += flashPointerOffset;
+        if (legacyPairs)
+            flashCopy(storePage + sizeof(KeyValueStore) / 4, logPage + sizeof(KeyValueLogHeader) / 4, legacyPairs * sizeof(KeyValuePair) / 4);
 
-    //KeyValuePair is word aligned...
-    int wordsToWrite = sizeof(KeyValuePair) / 4;
+        writeHeader(logPage, 0, legacyPairs);
+    }
 
-    flashCopy(p, scratchPointer, wordsToWrite);
+    generation = ((KeyValueLogHeader *)logPage)->generation;
+
+    buildIndex();
 }
 
 /**
-  * Places a given key, and it's corresponding value into flash at the earliest
-  * available point.
+  * Rebuilds the index, the number of keys, and the end of the log by scanning the log page.
+  * Records that fail their CRC check are skipped.
+  */
+void MicroBitStorage::buildIndex()
+{
+    uint32_t pg_size = NRF_FICR->CODEPAGESIZE;
+    uint32_t pairs = ((KeyValueLogHeader *)logPage)->pairs;
+    uint32_t offset = sizeof(KeyValueLogHeader);
+
+    memset(indexHash, 0, sizeof(indexHash));
+    memset(indexOffset, 0, sizeof(indexOffset));
+
+    sequence = 0;
+    keys = 0;
+
+    // The compacted pairs are the oldest versions in the log, and hold each key at most once.
+    for (uint32_t i = 0; i < pairs; i++, offset += sizeof(KeyValuePair))
+    {
+        const char *key = (const char *)((KeyValuePair *)((uint8_t *)logPage + offset))->key;
+        uint16_t hash = keyHash(key);
+        int entry = findEntry(key, hash);
+
+        indexHash[entry] = hash;
+        indexOffset[entry] = offset;
+        keys++;
+    }
+
+    logStart = offset;
+
+    for (; offset + sizeof(KeyValueRecord) <= pg_size; offset += sizeof(KeyValueRecord))
+    {
+        KeyValueRecord *record = (KeyValueRecord *)((uint8_t *)logPage + offset);
+
+        if (record->sequence == MICROBIT_STORAGE_RECORD_UNUSED)
+            break;
+
+        // A record torn by a reset still occupies its space in the log, but is otherwise ignored.
+        if (record->crc != recordCrc(record) || record->pair.key[MICROBIT_STORAGE_KEY_SIZE - 1] != 0)
+            continue;
+
+        const char *key = (const char *)record->pair.key;
+        uint16_t hash = keyHash(key);
+        int entry = findEntry(key, hash);
+
+        if (indexOffset[entry])
+        {
+            if (indexOffset[entry] >= logStart)
+            {
+                KeyValueRecord *previous = (KeyValueRecord *)((uint8_t *)logPage + indexOffset[entry] - offsetof(KeyValueRecord, pair));
+
+                if ((int32_t)(record->sequence - previous->sequence) < 0)
+                    continue;
+            }
+
+            if (pairAt(indexOffset[entry]))
+                keys--;
+        }
+
+        indexHash[entry] = hash;
+        indexOffset[entry] = offset + offsetof(KeyValueRecord, pair);
+
+        if (!(record->flags & MICROBIT_STORAGE_RECORD_REMOVED))
+            keys++;
+
+        if ((int32_t)(record->sequence + 1 - sequence) > 0)
+            sequence = record->sequence + 1;
+    }
+
+    logEnd = offset;
+}
+
+/**
+  * Determines the latest version of a key from its offset in the log page.
   *
-  * @param key the unique name that should be used as an identifier for the given data.
-  *            The key is presumed to be null terminated.
+  * @param offset The byte offset of a KeyValuePair in the log page, as held in the index.
   *
-  * @param data a pointer to the beginning of the data to be persisted.
+  * @return The KeyValuePair at that offset, or NULL if the offset is unused or records the removal of the key.
+  */
+KeyValuePair* MicroBitStorage::pairAt(uint16_t offset)
+{
+    if (offset == 0)
+        return NULL;
+
+    KeyValuePair *pair = (KeyValuePair *)((uint8_t *)logPage + offset);
+
+    // Only keys that have not been removed are compacted, so a removal is always held in a record.
+    if (offset >= logStart && ((KeyValueRecord *)((uint8_t *)pair - offsetof(KeyValueRecord, pair)))->flags & MICROBIT_STORAGE_RECORD_REMOVED)
+        return NULL;
+
+    return pair;
+}
+
+/**
+  * Finds the entry in the index for the given key.
   *
-  * @param dataSize the size of the data to be persisted
+  * @param key The key to look up. The key is presumed to be null terminated.
   *
-  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the key or size is too large,
-  *         MICROBIT_NO_RESOURCES if the storage page is full
+  * @param hash The hash of the key.
+  *
+  * @return The position of the entry for the key in the index, or of the unused entry where it should be added.
   */
-int MicroBitStorage::put(const char *key, uint8_t *data, int dataSize)
+int MicroBitStorage::findEntry(const char *key, uint16_t hash)
 {
-    KeyValuePair pair = KeyValuePair();
+    int entry = hash & (MICROBIT_STORAGE_INDEX_SIZE - 1);
 
-    int keySize = strlen(key) + 1;
+    // The index is larger than the log, so there is always an unused entry to stop at.
+    while (indexOffset[entry])
+    {
+        if (indexHash[entry] == hash && strcmp(key, (char *)((KeyValuePair *)((uint8_t *)logPage + indexOffset[entry]))->key) == 0)
+            break;
 
-    if(keySize > (int)sizeof(pair.key) || dataSize > (int)sizeof(pair.value) || dataSize < 0)
-        return MICROBIT_INVALID_PARAMETER;
+        entry = (entry + 1) & (MICROBIT_STORAGE_INDEX_SIZE - 1);
+    }
 
-    KeyValuePair *currentValue = get(key);
+    return entry;
+}
 
-    int upToDate = currentValue && (memcmp(currentValue->value, data, dataSize) == 0);
+/**
+  * Copies the latest value of each key that has not been removed into the spare page, and makes it the log page.
+  *
+  * @param pair A change to apply to the store as it is compacted, or NULL.
+  *
+  * @param flags MICROBIT_STORAGE_RECORD_* flags for the change.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the spare page could not be written, leaving the log unchanged.
+  */
+int MicroBitStorage::compact(KeyValuePair *pair, uint16_t flags)
+{
+    MicroBitFlash flash;
+    uint32_t *next = sparePage + sizeof(KeyValueLogHeader) / 4;
+    uint32_t pairs = 0;
+    int ticket = MICROBIT_NO_DATA;
+    int result = flashPageErase(sparePage);
 
-    if(currentValue)
-        delete currentValue;
+    for (int i = 0; i <= MICROBIT_STORAGE_INDEX_SIZE; i++)
+    {
+        KeyValuePair *latest;
 
-    if(upToDate)
-        return MICROBIT_OK;
+        // The change is written after every other key.
+        if (i == MICROBIT_STORAGE_INDEX_SIZE)
+            latest = pair && !(flags & MICROBIT_STORAGE_RECORD_REMOVED) ? pair : NULL;
+        else
+            latest = pairAt(indexOffset[i]);
 
-    memcpy(pair.key, key, keySize);
-    memcpy(pair.value, data, dataSize);
+        if (latest == NULL || (latest != pair && pair && strcmp((char *)latest->key, (char *)pair->key) == 0))
+            continue;
 
-    //calculate our various offsets.
-    uint32_t pg_size = NRF_FICR->CODEPAGESIZE;
-    uint32_t *flashPointer = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_STORE_PAGE_OFFSET));
-    uint32_t *flashBlockPointer = flashPointer;
-    uint32_t *scratchPointer = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET));
+        // Queue each copy without waiting, so that consecutive pairs are written in a single flash operation.
+        int t = flash.flash_burn_async(next, (uint32_t *)latest, sizeof(KeyValuePair) / 4);
 
-    uint32_t kvStoreSize = sizeof(KeyValueStore) / 4;
-    uint32_t kvPairSize = sizeof(KeyValuePair) / 4;
+        if (t != MICROBIT_NO_RESOURCES)
+            ticket = t;
+        else if (flashCopy((uint32_t *)latest, next, sizeof(KeyValuePair) / 4) != MICROBIT_OK)
+            result = MICROBIT_CANCELLED;
 
-    int storeSize = size();
+        next += sizeof(KeyValuePair) / 4;
+        pairs++;
+    }
 
-    //our KeyValueStore struct is always at 0
-    flashPointer += kvStoreSize;
+    if (ticket != MICROBIT_NO_DATA && flash.flash_wait(ticket) != MICROBIT_OK)
+        result = MICROBIT_CANCELLED;
 
-    KeyValuePair storedPair = KeyValuePair();
+    // The header is written last, so the old log remains current until the new one is complete.
+    if (result != MICROBIT_OK || writeHeader(sparePage, generation + 1, pairs) != MICROBIT_OK)
+        return MICROBIT_CANCELLED;
 
-    int found = 0;
+    uint32_t *oldLog = logPage;
 
-    //erase our scratch page
-    flashPageErase(scratchPointer);
+    logPage = sparePage;
+    sparePage = oldLog;
+    generation++;
 
-    //iterate through key value pairs in flash, writing them to the scratch page.
-    for(int i = 0; i < storeSize; i++)
-    {
-        memcpy(&storedPair, flashPointer, sizeof(KeyValuePair));
+    buildIndex();
 
-        //check if the keys match...
-        if(strcmp((char *)storedPair.key, (char *)pair.key) == 0)
-        {
-            found = 1;
-            //scratch our KeyValueStore struct so that it is preserved.
-            scratchKeyValueStore(KeyValueStore(MICROBIT_STORAGE_MAGIC, storeSize));
-            scratchKeyValuePair(pair, flashPointer);
-        }
-        else
-        {
-            scratchKeyValuePair(storedPair, flashPointer);
-        }
+    return MICROBIT_OK;
+}
 
-        flashPointer += kvPairSize;
-    }
+/**
+  * Appends a record to the log, and updates the index. If the log is full, it is compacted instead, with the record applied.
+  *
+  * @param pair The KeyValuePair to record.
+  *
+  * @param flags MICROBIT_STORAGE_RECORD_* flags for the record.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_CANCELLED if the record could not be written.
+  */
+int MicroBitStorage::append(KeyValuePair &pair, uint16_t flags)
+{
+    if (logEnd + sizeof(KeyValueRecord) > NRF_FICR->CODEPAGESIZE)
+        return compact(&pair, flags);
 
-    if(!found)
-    {
-        //if we haven't got a match for the key, check we can add a new KeyValuePair
-        if(storeSize == (int)((pg_size - kvStoreSize) / MICROBIT_STORAGE_BLOCK_SIZE))
-            return MICROBIT_NO_RESOURCES;
+    KeyValueRecord record;
 
-        storeSize += 1;
+    record.sequence = sequence++;
+    record.flags = flags;
+    memcpy(&record.pair, &pair, sizeof(KeyValuePair));
+    record.crc = recordCrc(&record);
 
-        //scratch our updated values.
-        scratchKeyValueStore(KeyValueStore(MICROBIT_STORAGE_MAGIC, storeSize));
-        scratchKeyValuePair(pair, flashPointer);
+    // If the write failed, the record may be partly written. Rescan the log to skip over it.
+    if (flashCopy((uint32_t *)&record, logPage + logEnd / 4, MICROBIT_STORAGE_RECORD_WORDS) != MICROBIT_OK)
+    {
+        buildIndex();
+        return MICROBIT_CANCELLED;
     }
 
-    //erase our storage page
-    flashPageErase((uint32_t *)flashBlockPointer);
+    const char *key = (const char *)pair.key;
+    uint16_t hash = keyHash(key);
+    int entry = findEntry(key, hash);
+    bool wasLive = pairAt(indexOffset[entry]) != NULL;
+
+    indexHash[entry] = hash;
+    indexOffset[entry] = logEnd + offsetof(KeyValueRecord, pair);
+    logEnd += sizeof(KeyValueRecord);
 
-    //copy from scratch to storage.
-    flashCopy((uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET)), flashBlockPointer, kvStoreSize + (storeSize * kvPairSize));
+    if (wasLive && (flags & MICROBIT_STORAGE_RECORD_REMOVED))
+        keys--;
+
+    if (!wasLive && !(flags & MICROBIT_STORAGE_RECORD_REMOVED))
+        keys++;
 
     return MICROBIT_OK;
 }
 
+/**
+  * Places a given key, and it's corresponding value into flash at the earliest
+  * available point.
+  *
+  * @param key the unique name that should be used as an identifier for the given data.
+  *            The key is presumed to be null terminated.
+  *
+  * @param data a pointer to the beginning of the data to be persisted.
+  *
+  * @param dataSize the size of the data to be persisted
+  *
+  * @return MICROBIT_OK on success, MICROBIT_INVALID_PARAMETER if the key or size is too large,
+  *         MICROBIT_NO_RESOURCES if the storage page is full
+  */
+int MicroBitStorage::put(const char *key, uint8_t *data, int dataSize)
+{
+    KeyValuePair pair = KeyValuePair();
+
+    int keySize = strlen(key) + 1;
+
+    if(keySize > (int)sizeof(pair.key) || dataSize > (int)sizeof(pair.value) || dataSize < 0)
+        return MICROBIT_INVALID_PARAMETER;
+
+    lock.lock();
+
+    KeyValuePair *current = pairAt(indexOffset[findEntry(key, keyHash(key))]);
+    int result = MICROBIT_OK;
+
+    if(current == NULL && keys >= capacity())
+        result = MICROBIT_NO_RESOURCES;
+
+    else if(current == NULL || memcmp(current->value, data, dataSize) != 0)
+    {
+        memcpy(pair.key, key, keySize);
+        memcpy(pair.value, data, dataSize);
+
+        result = append(pair, 0);
+    }
+
+    lock.unlock();
+
+    return result;
+}
+
 /**
   * Places a given key, and it's corresponding value into flash at the earliest
   * available point.
@@ -261,42 +532,13 @@ int MicroBitStorage::put(ManagedString key, uint8_t* data, int dataSize)
   */
 KeyValuePair* MicroBitStorage::get(const char* key)
 {
-    //calculate our offsets for our storage page
-    uint32_t pg_size = NRF_FICR->CODEPAGESIZE;
-    uint32_t pg_num  = NRF_FICR->CODESIZE - MICROBIT_STORAGE_STORE_PAGE_OFFSET;
-
-    uint32_t *flashBlockPointer = (uint32_t *)(pg_size * pg_num);
-
-    int storeSize = size();
+    KeyValuePair *current = pairAt(indexOffset[findEntry(key, keyHash(key))]);
 
-    //we haven't got anything stored, so return...
-    if(storeSize == 0)
+    if (current == NULL)
         return NULL;
 
-    //our KeyValueStore struct is always at 0
-    flashBlockPointer += sizeof(KeyValueStore) / 4;
-
     KeyValuePair *pair = new KeyValuePair();
-
-    int i;
-
-    //iterate through flash until we have a match, or drop out.
-    for(i = 0; i < storeSize; i++)
-    {
-        memcpy(pair, flashBlockPointer, sizeof(KeyValuePair));
-
-        if(strcmp(key,(char *)pair->key) == 0)
-            break;
-
-        flashBlockPointer += sizeof(KeyValuePair) / 4;
-    }
-
-    //clean up
-    if(i == storeSize)
-    {
-        delete pair;
-        return NULL;
-    }
+    memcpy(pair, current, sizeof(KeyValuePair));
 
     return pair;
 }
@@ -326,66 +568,23 @@ KeyValuePair* MicroBitStorage::get(ManagedString key)
   */
 int MicroBitStorage::remove(const char* key)
 {
-    //calculate our various offsets
-    uint32_t pg_size = NRF_FICR->CODEPAGESIZE;
-    uint32_t *flashPointer = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_STORE_PAGE_OFFSET));
-    uint32_t *flashBlockPointer = flashPointer;
-    uint32_t *scratchPointer = (uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET));
+    lock.lock();
 
-    uint32_t kvStoreSize = sizeof(KeyValueStore) / 4;
-    uint32_t kvPairSize = sizeof(KeyValuePair) / 4;
+    KeyValuePair *current = pairAt(indexOffset[findEntry(key, keyHash(key))]);
+    int result = MICROBIT_NO_DATA;
 
-    int storeSize = size();
-
-    //if we have no data, we have nothing to do.
-    if(storeSize == 0)
-        return MICROBIT_NO_DATA;
-
-    //our KeyValueStore struct is always at 0
-    flashPointer += kvStoreSize;
-    scratchPointer += kvStoreSize;
-
-    KeyValuePair storedPair = KeyValuePair();
-
-    int found = 0;
-
-    //set up our scratch area
-    flashPageErase(scratchPointer);
-
-    //iterate through our flash copy pairs to scratch, unless there is a key patch
-    for(int i = 0; i < storeSize; i++)
+    // Removal is recorded by appending a record for the key, with no value.
+    if (current)
     {
-        memcpy(&storedPair, flashPointer, sizeof(KeyValuePair));
-
-        //if we have a match, don't increment our scratchPointer
-        if(strcmp((char *)storedPair.key, (char *)key) == 0)
-        {
-            found = 1;
-            //write our new KeyValueStore data
-            scratchKeyValueStore(KeyValueStore(MICROBIT_STORAGE_MAGIC, storeSize - 1));
-        }
-        else
-        {
-            //otherwise copy the KeyValuePair from our storage page.
-            flashCopy(flashPointer, scratchPointer, sizeof(KeyValuePair) / 4);
-            scratchPointer += sizeof(KeyValuePair) / 4;
-        }
-
-        flashPointer += sizeof(KeyValuePair) / 4;
-    }
+        KeyValuePair pair = KeyValuePair();
+        memcpy(pair.key, current->key, sizeof(pair.key));
 
-    //if we haven't got a match, write our old KeyValueStore struct
-    if(!found)
-    {
-        scratchKeyValueStore(KeyValueStore(MICROBIT_STORAGE_MAGIC, storeSize));
-        return MICROBIT_NO_DATA;
+        result = append(pair, MICROBIT_STORAGE_RECORD_REMOVED);
     }
 
-    //copy scratch to our storage page
-    flashPageErase((uint32_t *)flashBlockPointer);
-    flashCopy((uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET)), flashBlockPointer, kvStoreSize + (storeSize * kvPairSize));
+    lock.unlock();
 
-    return MICROBIT_OK;
+    return result;
 }
 
 /**
@@ -408,30 +607,5 @@ int MicroBitStorage::remove(ManagedString key)
   */
 int MicroBitStorage::size()
 {
-    uint32_t pg_size = NRF_FICR->CODEPAGESIZE;
-    uint32_t pg_num  = NRF_FICR->CODESIZE - MICROBIT_STORAGE_STORE_PAGE_OFFSET;
-
-    uint32_t *flashBlockPointer = (uint32_t *)(pg_size * pg_num);
-
-    KeyValueStore store = KeyValueStore();
-
-    //read our data!
-    memcpy(&store, flashBlockPointer, sizeof(KeyValueStore));
-
-    //if we haven't used flash before, we need to configure it
-    if(store.magic != MICROBIT_STORAGE_MAGIC)
-    {
-        store.magic = MICROBIT_STORAGE_MAGIC;
-        store.size = 0;
-
-        //erase the scratch page and write our new KeyValueStore
-        flashPageErase((uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET)));
-        scratchKeyValueStore(store);
-
-        //erase flash, and copy the scratch page over
-        flashPageErase((uint32_t *)flashBlockPointer);
-        flashCopy((uint32_t *)(pg_size * (NRF_FICR->CODESIZE - MICROBIT_STORAGE_SCRATCH_PAGE_OFFSET)), flashBlockPointer, pg_size/4);
-    }
-
-    return store.size;
+    return keys;
 }
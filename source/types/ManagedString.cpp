@@ -52,6 +52,25 @@ DEALINGS IN THE SOFTWARE.
 
 static const char empty[] __attribute__ ((aligned (4))) = "\xff\xff\0\0\0";
 
+// Read-only, flash resident strings for each printable ASCII character (32..127). Single character strings
+// are very common (e.g. ManagedString(c) or ManagedString(7) when printing), so these are used in place of a heap allocation.
+#define MICROBIT_STRING_CHAR(c)     0xffff, 1, (c), 0
+#define MICROBIT_STRING_CHAR8(c)    MICROBIT_STRING_CHAR(c), MICROBIT_STRING_CHAR(c+1), MICROBIT_STRING_CHAR(c+2), MICROBIT_STRING_CHAR(c+3), \
+                                    MICROBIT_STRING_CHAR(c+4), MICROBIT_STRING_CHAR(c+5), MICROBIT_STRING_CHAR(c+6), MICROBIT_STRING_CHAR(c+7)
+
+static const uint16_t printable[] __attribute__ ((aligned (4))) =
+{
+    MICROBIT_STRING_CHAR8(32), MICROBIT_STRING_CHAR8(40), MICROBIT_STRING_CHAR8(48), MICROBIT_STRING_CHAR8(56),
+    MICROBIT_STRING_CHAR8(64), MICROBIT_STRING_CHAR8(72), MICROBIT_STRING_CHAR8(80), MICROBIT_STRING_CHAR8(88),
+    MICROBIT_STRING_CHAR8(96), MICROBIT_STRING_CHAR8(104), MICROBIT_STRING_CHAR8(112), MICROBIT_STRING_CHAR8(120)
+};
+
+#if MICROBIT_STRING_INTERN_TABLE_SIZE > 0
+// Strings that have been interned. The table holds a reference to each.
+static StringData *internTable[MICROBIT_STRING_INTERN_TABLE_SIZE] = { };
+static uint8_t internNext = 0;
+#endif
+
 /**
   * Internal constructor helper.
   *
@@ -71,11 +90,29 @@ void ManagedString::initString(const char *str)
 {
     // Initialise this ManagedString as a new string, using the data provided.
     // We assume the string is sane, and null terminated.
-    int len = strlen(str);
-    ptr = (StringData *) malloc(4+len+1);
+    initString(str, strlen(str));
+}
+
+/**
+  * Internal constructor helper.
+  *
+  * Creates this ManagedString based on a given char array of a given length.
+  * Single printable characters refer to a read-only, flash resident string rather than using the heap.
+  */
+void ManagedString::initString(const char *str, int len)
+{
+    if (len == 1 && (uint8_t)str[0] >= 32 && (uint8_t)str[0] < 128)
+    {
+        ptr = (StringData *)(void *)&printable[((uint8_t)str[0] - 32) * 4];
+        return;
+    }
+
+    // Allocate a new buffer, and create a NULL terminated string. Short strings are held in the pool of small payloads.
+    ptr = (StringData *) RefCounted::allocate(4+len+1);
     ptr->init();
     ptr->len = len;
-    memcpy(ptr->data, str, len+1);
+    memcpy(ptr->data, str, len);
+    ptr->data[len] = 0;
 }
 
 /**
@@ -192,7 +229,7 @@ ManagedString::ManagedString(const ManagedString &s1, const ManagedString &s2)
     int len = s1.length() + s2.length();
 
     // Create a new buffer for holding the new string data.
-    ptr = (StringData*) malloc(4+len+1);
+    ptr = (StringData*) RefCounted::allocate(4+len+1);
     ptr->init();
     ptr->len = len;
 
@@ -221,14 +258,8 @@ ManagedString::ManagedString(PacketBuffer buffer)
         return;
     }
 
-    // Allocate a new buffer ( just in case the data is not NULL terminated).
-    ptr = (StringData*) malloc(4+buffer.length()+1);
-    ptr->init();
-
-    // Store the length of the new string
-    ptr->len = buffer.length();
-    memcpy(ptr->data, buffer.getBytes(), buffer.length());
-    ptr->data[buffer.length()] = 0;
+    // Copy into a new buffer ( just in case the data is not NULL terminated).
+    initString((const char *)buffer.getBytes(), buffer.length());
 }
 
 /**
@@ -255,14 +286,7 @@ ManagedString::ManagedString(const char *str, const int16_t length)
         return;
     }
 
-
-    // Allocate a new buffer, and create a NULL terminated string.
-    ptr = (StringData*) malloc(4+length+1);
-    ptr->init();
-    // Store the length of the new string
-    ptr->len = length;
-    memcpy(ptr->data, str, length);
-    ptr->data[length] = 0;
+    initString(str, length);
 }
 
 /**
@@ -284,6 +308,25 @@ ManagedString::ManagedString(const ManagedString &s)
     ptr->incr();
 }
 
+#if MICROBIT_CPP11
+/**
+  * Move constructor.
+  * Takes over the character buffer of the supplied ManagedString, without changing its reference count.
+  *
+  * @param s The ManagedString to move from. This is left as an empty string.
+  *
+  * @code
+  * ManagedString s("abcdefg");
+  * ManagedString p(std::move(s));
+  * @endcode
+  */
+ManagedString::ManagedString(ManagedString &&s)
+{
+    ptr = s.ptr;
+    s.initEmpty();
+}
+#endif
+
 
 /**
   * Default constructor.
@@ -343,6 +386,33 @@ ManagedString& ManagedString::operator = (const ManagedString& s)
     return *this;
 }
 
+#if MICROBIT_CPP11
+/**
+  * Move assign operation.
+  *
+  * Called when a ManagedString is assigned the value of a temporary (e.g. the result of a concatenation).
+  *
+  * Our existing character buffer is swapped with that of the supplied ManagedString, so no
+  * reference counts are changed here. Our old buffer is released when the temporary is destroyed.
+  *
+  * @param s The ManagedString to move from.
+  *
+  * @code
+  * ManagedString s("abcd");
+  * s = s + "efgh";   // no reference counting is needed to hold the new string
+  * @endcode
+  */
+ManagedString& ManagedString::operator = (ManagedString&& s)
+{
+    StringData *p = ptr;
+
+    ptr = s.ptr;
+    s.ptr = p;
+
+    return *this;
+}
+#endif
+
 /**
   * Equality operation.
   *
@@ -491,11 +561,55 @@ ManagedString operator+ (const ManagedString& lhs, const ManagedString& rhs)
   * display.scroll(s.charAt(1)) // scrolls "b"
   * @endcode
   */
-char ManagedString::charAt(int16_t index)
+char ManagedString::charAt(int16_t index) const
 {
     return (index >=0 && index < length()) ? ptr->data[index] : 0;
 }
 
+/**
+  * Provides a shared instance of this string from the intern table.
+  *
+  * Strings that are repeatedly created with the same content (e.g. file names or storage keys) can be
+  * interned so that all equal copies share a single heap allocation. The table holds a reference to
+  * each entry, and evicts the oldest entry when full.
+  *
+  * @return a ManagedString equal to this one, sharing its buffer with any previously interned equal string.
+  *
+  * @code
+  * ManagedString a = ManagedString("log.txt").intern();
+  * ManagedString b = ManagedString("log.txt").intern(); // a and b share the same buffer
+  * @endcode
+  *
+  * @note If MICROBIT_STRING_INTERN_TABLE_SIZE is zero, a copy of this string is returned.
+  */
+ManagedString ManagedString::intern() const
+{
+#if MICROBIT_STRING_INTERN_TABLE_SIZE > 0
+    // Strings that reside in flash are already shared, so there's nothing to do.
+    if (ptr->isReadOnly())
+        return *this;
+
+    for (int i = 0; i < MICROBIT_STRING_INTERN_TABLE_SIZE; i++)
+    {
+        StringData *s = internTable[i];
+
+        if (s != NULL && s->len == ptr->len && memcmp(s->data, ptr->data, ptr->len) == 0)
+            return ManagedString(s);
+    }
+
+    // Not yet interned. Replace the oldest entry with a reference to our buffer.
+    if (internTable[internNext] != NULL)
+        internTable[internNext]->decr();
+
+    internTable[internNext] = ptr;
+    ptr->incr();
+
+    internNext = (internNext + 1) % MICROBIT_STRING_INTERN_TABLE_SIZE;
+#endif
+
+    return *this;
+}
+
 /**
   * Empty string constant literal
   */
@@ -0,0 +1,377 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for a ManagedStringBuilder.
+  *
+  * Joining ManagedStrings with operator+ allocates and copies a new string for every step, which
+  * becomes expensive when building up longer strings (e.g. a line of telemetry) piece by piece.
+  *
+  * A ManagedStringBuilder instead appends into a single growable buffer, which is handed over to
+  * a ManagedString when complete, without any further allocation or copying.
+  */
+#include <string.h>
+
+#include "MicroBitConfig.h"
+#include "ManagedStringBuilder.h"
+#include "MicroBitCompat.h"
+#include "ErrorNo.h"
+
+/**
+  * Constructor.
+  *
+  * Create an empty ManagedStringBuilder.
+  *
+  * @param capacity The number of characters to allocate space for initially. Defaults to MANAGED_STRING_BUILDER_DEFAULT_CAPACITY.
+  *                 Values above MANAGED_STRING_BUILDER_MAX_CAPACITY are clamped to it.
+  *
+  * @code
+  * ManagedStringBuilder b(32);
+  * @endcode
+  */
+ManagedStringBuilder::ManagedStringBuilder(int capacity)
+{
+    if (capacity < 1)
+        capacity = 1;
+
+    if (capacity > MANAGED_STRING_BUILDER_MAX_CAPACITY)
+        capacity = MANAGED_STRING_BUILDER_MAX_CAPACITY;
+
+    this->capacity = capacity;
+    truncated = false;
+
+    ptr = (StringData *) malloc(4 + capacity + 1);
+    ptr->init();
+    ptr->len = 0;
+    ptr->data[0] = 0;
+}
+
+/**
+  * Destructor.
+  *
+  * Releases the buffer, if it has not been handed over to a ManagedString.
+  */
+ManagedStringBuilder::~ManagedStringBuilder()
+{
+    ptr->decr();
+}
+
+/**
+  * Ensures the buffer can hold at least the given number of additional characters,
+  * growing it if necessary.
+  *
+  * @param n The number of characters to make room for.
+  *
+  * @return MICROBIT_OK on success, or MICROBIT_NO_RESOURCES if the string would become too long.
+  */
+int ManagedStringBuilder::reserve(int n)
+{
+    int needed = ptr->len + n;
+
+    if (needed <= capacity)
+        return MICROBIT_OK;
+
+    if (needed > MANAGED_STRING_BUILDER_MAX_CAPACITY)
+        return MICROBIT_NO_RESOURCES;
+
+    // Grow geometrically, so that long chains of appends need only a few reallocations.
+    int newCapacity = max(needed, min(max(capacity * 2, MANAGED_STRING_BUILDER_DEFAULT_CAPACITY), MANAGED_STRING_BUILDER_MAX_CAPACITY));
+
+    StringData *p = (StringData *) malloc(4 + newCapacity + 1);
+    if (p == NULL)
+        return MICROBIT_NO_RESOURCES;
+
+    p->init();
+    p->len = ptr->len;
+    memcpy(p->data, ptr->data, ptr->len + 1);
+
+    ptr->decr();
+    ptr = p;
+    capacity = newCapacity;
+
+    return MICROBIT_OK;
+}
+
+/**
+  * Appends the given character array to the end of the string being built.
+  *
+  * @param str A pointer to the characters to append.
+  *
+  * @param len The number of characters to append.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  */
+ManagedStringBuilder& ManagedStringBuilder::append(const char *str, int len)
+{
+    if (str == NULL || len <= 0)
+        return *this;
+
+    if (reserve(len) != MICROBIT_OK)
+    {
+        truncated = true;
+        return *this;
+    }
+
+    memcpy(ptr->data + ptr->len, str, len);
+    ptr->len += len;
+    ptr->data[ptr->len] = 0;
+
+    return *this;
+}
+
+/**
+  * Appends the given NULL terminated string to the end of the string being built.
+  *
+  * @param str The string to append.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  */
+ManagedStringBuilder& ManagedStringBuilder::append(const char *str)
+{
+    if (str == NULL)
+        return *this;
+
+    return append(str, strlen(str));
+}
+
+/**
+  * Appends the given ManagedString to the end of the string being built.
+  *
+  * @param s The ManagedString to append.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  */
+ManagedStringBuilder& ManagedStringBuilder::append(const ManagedString &s)
+{
+    return append(s.toCharArray(), s.length());
+}
+
+/**
+  * Appends a single character to the end of the string being built.
+  *
+  * @param c The character to append.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  */
+ManagedStringBuilder& ManagedStringBuilder::append(char c)
+{
+    return append(&c, 1);
+}
+
+/**
+  * Appends the decimal representation of the given integer to the end of the string being built.
+  *
+  * @param value The integer to append.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  */
+ManagedStringBuilder& ManagedStringBuilder::append(int value)
+{
+    return append(value, 0);
+}
+
+/**
+  * Appends a number, formatted in the given base.
+  *
+  * @param value The magnitude of the number.
+  *
+  * @param negative true if the number is negative.
+  *
+  * @param base The base to format the number in: 10 or 16.
+  *
+  * @param width The minimum number of characters to append. Shorter numbers are padded on the left.
+  *
+  * @param pad The character to pad with. Zero padding is placed after any sign.
+  *
+  * @param decimals The number of digits to place after a decimal point.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  */
+ManagedStringBuilder& ManagedStringBuilder::appendNumber(uint32_t value, bool negative, int base, int width, char pad, int decimals)
+{
+    // Room for the digits of a 32 bit number, a sign, a decimal point, and the zeros of the widest fraction.
+    char str[MANAGED_STRING_BUILDER_MAX_WIDTH + MANAGED_STRING_BUILDER_MAX_DECIMALS + 4];
+    int i = sizeof(str);
+
+    if (width < 0 || width > MANAGED_STRING_BUILDER_MAX_WIDTH || decimals < 0 || decimals > MANAGED_STRING_BUILDER_MAX_DECIMALS)
+    {
+        truncated = true;
+        return *this;
+    }
+
+    // Calculate each digit, starting with the least significant, with at least one before any decimal point.
+    int digits = 0;
+
+    do {
+        if (digits == decimals && decimals > 0)
+            str[--i] = '.';
+
+        str[--i] = "0123456789ABCDEF"[value % base];
+        value /= base;
+        digits++;
+    } while (value > 0 || digits <= decimals);
+
+    int length = sizeof(str) - i + (negative ? 1 : 0);
+
+    // Pad to the requested width. Spaces go before the sign, and zeros after it.
+    if (pad == '0')
+        for (; length < width; length++)
+            str[--i] = '0';
+
+    if (negative)
+        str[--i] = '-';
+
+    for (; length < width; length++)
+        str[--i] = pad;
+
+    return append(str + i, sizeof(str) - i);
+}
+
+/**
+  * Appends the decimal representation of the given integer, padded on the left to a minimum width.
+  *
+  * @param value The integer to append.
+  *
+  * @param width The minimum number of characters to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH.
+  *
+  * @param pad The character to pad with. Defaults to ' '. With '0', the padding is placed after any sign.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  *
+  * @code
+  * b.append(-42, 5, '0'); // "-0042"
+  * @endcode
+  */
+ManagedStringBuilder& ManagedStringBuilder::append(int value, int width, char pad)
+{
+    // Negate in unsigned arithmetic, so that the most negative integer is handled.
+    return appendNumber(value < 0 ? 0 - (uint32_t)value : (uint32_t)value, value < 0, 10, width, pad, 0);
+}
+
+/**
+  * Appends the decimal representation of the given unsigned integer, padded on the left to a minimum width.
+  *
+  * @param value The unsigned integer to append.
+  *
+  * @param width The minimum number of characters to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH. Defaults to 0.
+  *
+  * @param pad The character to pad with. Defaults to ' '.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  *
+  * @code
+  * b.appendUnsigned(system_timer_current_time(), 10, '0');
+  * @endcode
+  */
+ManagedStringBuilder& ManagedStringBuilder::appendUnsigned(uint32_t value, int width, char pad)
+{
+    return appendNumber(value, false, 10, width, pad, 0);
+}
+
+/**
+  * Appends the upper case hexadecimal representation of the given unsigned integer, zero padded
+  * on the left to a minimum number of digits.
+  *
+  * @param value The unsigned integer to append.
+  *
+  * @param width The minimum number of digits to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH. Defaults to 0.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  *
+  * @code
+  * b.appendHex(0x2a, 4); // "002A"
+  * @endcode
+  */
+ManagedStringBuilder& ManagedStringBuilder::appendHex(uint32_t value, int width)
+{
+    return appendNumber(value, false, 16, width, '0', 0);
+}
+
+/**
+  * Appends a fixed point number, held as an integer scaled by a power of ten, with the given number
+  * of digits after the decimal point.
+  *
+  * @param value The number, multiplied by 10 to the power of decimals.
+  *
+  * @param decimals The number of digits after the decimal point, up to MANAGED_STRING_BUILDER_MAX_DECIMALS.
+  *
+  * @param width The minimum number of characters to append, up to MANAGED_STRING_BUILDER_MAX_WIDTH. Defaults to 0.
+  *
+  * @return a reference to this ManagedStringBuilder, so that calls can be chained.
+  *
+  * @code
+  * b.appendFixed(-1250, 3); // a reading in milli-g: "-1.250"
+  * @endcode
+  */
+ManagedStringBuilder& ManagedStringBuilder::appendFixed(int value, int decimals, int width)
+{
+    return appendNumber(value < 0 ? 0 - (uint32_t)value : (uint32_t)value, value < 0, 10, width, ' ', decimals);
+}
+
+/**
+  * Discards the content of the string being built, retaining the buffer for reuse.
+  * The ManagedStringBuilder is then valid.
+  */
+void ManagedStringBuilder::clear()
+{
+    truncated = false;
+
+    // If our buffer has been handed over, we're already empty.
+    if (capacity == 0)
+        return;
+
+    ptr->len = 0;
+    ptr->data[0] = 0;
+}
+
+/**
+  * Hands the buffer over to a new ManagedString, without copying.
+  * The ManagedStringBuilder is then empty and valid, and may be reused.
+  *
+  * @return a ManagedString holding the string that has been built.
+  *
+  * @code
+  * ManagedStringBuilder b;
+  * b.append("score: ").append(score);
+  * ManagedString s = b.toManagedString();
+  * @endcode
+  */
+ManagedString ManagedStringBuilder::toManagedString()
+{
+    ManagedString s;
+
+    truncated = false;
+
+    if (ptr->len == 0)
+        return s;
+
+    // Transfer our reference to the buffer to the new ManagedString, and refer to the
+    // (read-only) empty string until more data is appended.
+    s.ptr = ptr;
+    ptr = ManagedString::EmptyString.ptr;
+    capacity = 0;
+
+    return s;
+}
@@ -0,0 +1,169 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 British Broadcasting Corporation.
+This software is provided by Lancaster University by arrangement with the BBC.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  * Class definition for a MicroBitAnimation.
+  *
+  * A MicroBitAnimation is a sequence of run length and delta encoded frames, held in flash.
+  */
+#include "MicroBitConfig.h"
+#include "MicroBitAnimation.h"
+
+/**
+  * Default constructor. Creates an empty animation, with no frames.
+  */
+MicroBitAnimation::MicroBitAnimation()
+{
+    this->data = NULL;
+}
+
+/**
+  * Constructor. Creates an animation from encoded data.
+  *
+  * @param data The encoded animation. This is not copied, so must remain valid for the lifetime of the animation.
+  */
+MicroBitAnimation::MicroBitAnimation(const uint8_t *data)
+{
+    this->data = data;
+}
+
+/**
+  * Gets the width of each frame of this animation.
+  *
+  * @return The width of each frame, in pixels.
+  */
+int MicroBitAnimation::getWidth() const
+{
+    return data ? data[0] : 0;
+}
+
+/**
+  * Gets the height of each frame of this animation.
+  *
+  * @return The height of each frame, in pixels.
+  */
+int MicroBitAnimation::getHeight() const
+{
+    return data ? data[1] : 0;
+}
+
+/**
+  * Gets the number of frames in this animation.
+  *
+  * @return The number of frames.
+  */
+int MicroBitAnimation::getFrameCount() const
+{
+    return data ? data[2] : 0;
+}
+
+/**
+  * Determines if this animation can be played.
+  *
+  * @return true if this animation has at least one frame of no more than 256 pixels, false otherwise.
+  */
+bool MicroBitAnimation::isValid() const
+{
+    int pixels = getWidth() * getHeight();
+
+    return pixels > 0 && pixels <= 256 && getFrameCount() > 0;
+}
+
+/**
+  * Gets the encoded data of the first frame of this animation.
+  *
+  * @return A pointer to the first frame, suitable for decodeFrame(), or NULL if the animation is not valid.
+  */
+const uint8_t *MicroBitAnimation::getFirstFrame() const
+{
+    return isValid() ? data + MICROBIT_ANIMATION_HEADER_SIZE : NULL;
+}
+
+/**
+  * Decodes a frame of this animation into the given image.
+  *
+  * The frame is drawn with its top left corner at (x, y). DELTA frames only modify the pixels
+  * that have changed, so the image is expected to still hold the previous frame.
+  *
+  * @param frame The encoded frame, as returned by getFirstFrame() or a previous call to decodeFrame().
+  *
+  * @param image The image to decode the frame into.
+  *
+  * @param x The horizontal position at which to draw the frame.
+  *
+  * @param y The vertical position at which to draw the frame.
+  *
+  * @param duration Set to the time the frame should be shown for, in milliseconds.
+  *
+  * @return A pointer to the next frame.
+  */
+const uint8_t *MicroBitAnimation::decodeFrame(const uint8_t *frame, MicroBitImage &image, int16_t x, int16_t y, uint16_t &duration) const
+{
+    int width = getWidth();
+    int pixels = width * getHeight();
+    int encoding = frame[2];
+    int count = frame[3];
+
+    // Frames are byte aligned, so the duration is read a byte at a time.
+    duration = frame[0] | (frame[1] << 8);
+    frame += MICROBIT_ANIMATION_FRAME_HEADER_SIZE;
+
+    if (encoding == MICROBIT_ANIMATION_FRAME_RLE)
+    {
+        int px = 0;
+        int py = 0;
+        int index = 0;
+
+        for (int i = 0; i < count; i++, frame += 2)
+        {
+            int run = frame[0];
+            uint8_t value = frame[1];
+
+            // Runs beyond the end of the frame are ignored.
+            for (; run > 0 && index < pixels; run--, index++)
+            {
+                image.setPixelValue(x + px, y + py, value);
+
+                if (++px == width)
+                {
+                    px = 0;
+                    py++;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < count; i++, frame += 2)
+        {
+            int index = frame[0];
+
+            if (index < pixels)
+                image.setPixelValue(x + index % width, y + index / width, frame[1]);
+        }
+    }
+
+    return frame;
+}
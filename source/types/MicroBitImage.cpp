@@ -44,6 +44,210 @@ DEALINGS IN THE SOFTWARE.
 static const uint16_t empty[] __attribute__ ((aligned (4))) = { 0xffff, 1, 1, 0, };
 MicroBitImage MicroBitImage::EmptyImage((ImageData*)(void*)empty);
 
+/**
+  * Returns a mask of the lowest n bits of a word.
+  */
+static inline uint32_t lowBits(int n)
+{
+    return n >= 32 ? 0xFFFFFFFF : (((uint32_t)1) << n) - 1;
+}
+
+/**
+  * Counts the number of bits set in the given word.
+  */
+static inline int countBits(uint32_t v)
+{
+    int n = 0;
+
+    while (v)
+    {
+        v &= v - 1;
+        n++;
+    }
+
+    return n;
+}
+
+/**
+  * Font rows hold the leftmost pixel in bit 4. This table reverses the five pixels of a row,
+  * so that the leftmost pixel is in bit 0, as it is in a packed image.
+  */
+static const uint8_t fontRowReversed[32] = {
+    0x00, 0x10, 0x08, 0x18, 0x04, 0x14, 0x0C, 0x1C, 0x02, 0x12, 0x0A, 0x1A, 0x06, 0x16, 0x0E, 0x1E,
+    0x01, 0x11, 0x09, 0x19, 0x05, 0x15, 0x0D, 0x1D, 0x03, 0x13, 0x0B, 0x1B, 0x07, 0x17, 0x0F, 0x1F
+};
+
+/**
+  * Reads up to 32 bits from a row of packed pixel data, starting at any bit offset.
+  *
+  * @param row The first word of the row.
+  *
+  * @param words The number of words in the row.
+  *
+  * @param bit The offset of the first bit to read.
+  */
+static inline uint32_t readBits(const uint32_t *row, int words, int bit)
+{
+    int w = bit >> 5;
+    int b = bit & 31;
+    uint32_t v = row[w] >> b;
+
+    if (b && w + 1 < words)
+        v |= row[w + 1] << (32 - b);
+
+    return v;
+}
+
+/**
+  * Writes up to 32 bits into a row of packed pixel data, starting at any bit offset.
+  * Only those bits set in the given mask are modified.
+  *
+  * @param row The first word of the row.
+  *
+  * @param words The number of words in the row.
+  *
+  * @param bit The offset of the first bit to write.
+  *
+  * @param value The bits to write.
+  *
+  * @param mask The bits of value to write.
+  */
+static inline void writeBits(uint32_t *row, int words, int bit, uint32_t value, uint32_t mask)
+{
+    int w = bit >> 5;
+    int b = bit & 31;
+
+    value &= mask;
+    row[w] = (row[w] & ~(mask << b)) | (value << b);
+
+    if (b && w + 1 < words)
+        row[w + 1] = (row[w + 1] & ~(mask >> (32 - b))) | (value >> (32 - b));
+}
+
+/**
+  * Copies a row of 8 bit pixels, skipping those that are zero in the source.
+  *
+  * Pixels are processed four at a time: a word of source pixels that is entirely clear is skipped,
+  * one that is entirely lit is stored whole, and anything else is merged under a mask of its lit bytes.
+  *
+  * @param out The first pixel to write.
+  *
+  * @param in The first pixel to read.
+  *
+  * @param n The number of pixels in the row.
+  *
+  * @return The number of pixels written.
+  */
+static int pasteRowAlpha(uint8_t *out, const uint8_t *in, int n)
+{
+    int written = 0;
+
+    // Bring the output up to a word boundary.
+    while (n > 0 && ((uintptr_t)out & 3))
+    {
+        if (*in)
+        {
+            *out = *in;
+            written++;
+        }
+
+        in++;
+        out++;
+        n--;
+    }
+
+    for (; n >= 4; n -= 4, in += 4, out += 4)
+    {
+        uint32_t v;
+
+        if (((uintptr_t)in & 3) == 0)
+            v = *(const uint32_t *)in;
+        else
+            v = in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+
+        if (v == 0)
+            continue;
+
+        // Set the top bit of each byte of the word that is non-zero.
+        uint32_t lit = (((v & 0x7F7F7F7F) + 0x7F7F7F7F) | v) & 0x80808080;
+
+        if (lit == 0x80808080)
+        {
+            *(uint32_t *)out = v;
+            written += 4;
+            continue;
+        }
+
+        uint32_t mask = (lit >> 7) * 0xFF;
+
+        *(uint32_t *)out = (*(uint32_t *)out & ~mask) | (v & mask);
+        written += countBits(lit);
+    }
+
+    while (n > 0)
+    {
+        if (*in)
+        {
+            *out = *in;
+            written++;
+        }
+
+        in++;
+        out++;
+        n--;
+    }
+
+    return written;
+}
+
+/**
+  * Moves the bits of a row of packed pixel data towards bit 0 (i.e. shifts the pixels left), zero filling the end of the row.
+  */
+static void shiftRowDown(uint32_t *row, int words, int bits)
+{
+    int ws = bits >> 5;
+    int bs = bits & 31;
+
+    for (int i = 0; i < words; i++)
+    {
+        uint32_t v = 0;
+
+        if (i + ws < words)
+        {
+            v = row[i + ws] >> bs;
+
+            if (bs && i + ws + 1 < words)
+                v |= row[i + ws + 1] << (32 - bs);
+        }
+
+        row[i] = v;
+    }
+}
+
+/**
+  * Moves the bits of a row of packed pixel data away from bit 0 (i.e. shifts the pixels right), zero filling the start of the row.
+  */
+static void shiftRowUp(uint32_t *row, int words, int bits)
+{
+    int ws = bits >> 5;
+    int bs = bits & 31;
+
+    for (int i = words - 1; i >= 0; i--)
+    {
+        uint32_t v = 0;
+
+        if (i - ws >= 0)
+        {
+            v = row[i - ws] << bs;
+
+            if (bs && i - ws - 1 >= 0)
+                v |= row[i - ws - 1] >> (32 - bs);
+        }
+
+        row[i] = v;
+    }
+}
+
 /**
   * Default Constructor.
   * Creates a new reference to the empty MicroBitImage bitmap
@@ -100,6 +304,25 @@ MicroBitImage::MicroBitImage(const MicroBitImage &image)
     ptr->incr();
 }
 
+#if MICROBIT_CPP11
+/**
+  * Move Constructor.
+  * Takes over the bitmap of the supplied MicroBitImage, without changing its reference count.
+  *
+  * @param image The MicroBitImage to move from. This is left referencing the EmptyImage.
+  *
+  * @code
+  * MicroBitImage i(10,5);
+  * MicroBitImage i2(std::move(i)); // i2 now holds the bitmap, i is empty
+  * @endcode
+  */
+MicroBitImage::MicroBitImage(MicroBitImage &&image)
+{
+    ptr = image.ptr;
+    image.init_empty();
+}
+#endif
+
 /**
   * Constructor.
   * Create a blank bitmap representation of a given size.
@@ -217,6 +440,55 @@ MicroBitImage::MicroBitImage(ImageData *p)
     ptr->incr();
 }
 
+/**
+  * Constructor.
+  * Create a read-only image from image data held in FLASH memory, with no copying. This allows images stored
+  * in files to be used in place, using the data returned by MicroBitFileSystem::map().
+  *
+  * @param data The image data, laid out as for MicroBitImage(ImageData *): the first two bytes should be 0xff,
+  *             then width, height and the bitmap. The data has to be 4-byte aligned.
+  *
+  * @param length The number of bytes available at data. If the data is not laid out as above, or is too short
+  *               to hold the bitmap, the empty image is created.
+  *
+  * @code
+  * const uint8_t *data;
+  * int fd = fs.open("heart.img", MB_READ);
+  * int length = fs.map(fd, &data);
+  * MicroBitImage i(data, length);
+  * @endcode
+  */
+MicroBitImage::MicroBitImage(const uint8_t *data, int length)
+{
+    ImageData *p = (ImageData *)(void *)data;
+
+    // Only image data marked as residing in FLASH can be used in place.
+    if (data == NULL || ((uint32_t)(uintptr_t)data & 3) || length < (int)sizeof(ImageData) || !p->isReadOnly())
+    {
+        init_empty();
+        return;
+    }
+
+    int width = p->width & MICROBIT_IMAGE_WIDTH_MASK;
+    int format = p->width >> MICROBIT_IMAGE_FORMAT_SHIFT;
+    int size = sizeof(ImageData) + width * p->height;
+
+    // Packed rows are a whole number of words, and start on a word boundary just after the header.
+    if (format == MICROBIT_IMAGE_FORMAT_1BPP)
+        size = ((sizeof(ImageData) + 3) & ~3) + (((width + 31) >> 5) << 2) * p->height;
+
+    if (format == MICROBIT_IMAGE_FORMAT_4BPP)
+        size = ((sizeof(ImageData) + 3) & ~3) + (((width * 4 + 31) >> 5) << 2) * p->height;
+
+    if (format > MICROBIT_IMAGE_FORMAT_1BPP || size > length)
+    {
+        init_empty();
+        return;
+    }
+
+    ptr = p;
+}
+
 /**
   * Get current ptr, do not decr() it, and set the current instance to empty image.
   *
@@ -250,6 +522,26 @@ MicroBitImage::MicroBitImage(const int16_t x, const int16_t y, const uint8_t *bi
     this->init(x,y,bitmap);
 }
 
+/**
+  * Constructor.
+  * Create a blank bitmap representation of a given size and pixel format.
+  *
+  * @param x the width of the image.
+  *
+  * @param y the height of the image.
+  *
+  * @param format the pixel format of the image. MICROBIT_IMAGE_FORMAT_1BPP images use an eighth
+  *               of the RAM of the default 8 bit format, and are shifted and pasted a word at a time.
+  *
+  * @code
+  * MicroBitImage banner(200, 5, MICROBIT_IMAGE_FORMAT_1BPP); // 160 bytes of pixel data, rather than 1000.
+  * @endcode
+  */
+MicroBitImage::MicroBitImage(const int16_t x, const int16_t y, MicroBitImageFormat format)
+{
+    this->init(x,y,NULL,format);
+}
+
 /**
   * Destructor.
   *
@@ -276,30 +568,41 @@ void MicroBitImage::init_empty()
   * @param y the height of the image
   *
   * @param bitmap an array of integers that make up an image.
+  *
+  * @param format the pixel format of the image. Defaults to MICROBIT_IMAGE_FORMAT_8BPP.
   */
-void MicroBitImage::init(const int16_t x, const int16_t y, const uint8_t *bitmap)
+void MicroBitImage::init(const int16_t x, const int16_t y, const uint8_t *bitmap, MicroBitImageFormat format)
 {
     //sanity check size of image - you cannot have a negative sizes
-    if(x < 0 || y < 0)
+    if(x < 0 || y < 0 || x > MICROBIT_IMAGE_WIDTH_MASK)
     {
         init_empty();
         return;
     }
 
+    int size = x * y;
+
+    // Packed rows are a whole number of words, and start on a word boundary just after the header.
+    if (format == MICROBIT_IMAGE_FORMAT_1BPP)
+        size = (((x + 31) >> 5) << 2) * y + 3;
+
+    if (format == MICROBIT_IMAGE_FORMAT_4BPP)
+        size = (((x * 4 + 31) >> 5) << 2) * y + 3;
 
     // Create a copy of the array
-    ptr = (ImageData*)malloc(sizeof(ImageData) + x * y);
+    ptr = (ImageData*)malloc(sizeof(ImageData) + size);
     ptr->init();
-    ptr->width = x;
+    ptr->width = x | (format << MICROBIT_IMAGE_FORMAT_SHIFT);
     ptr->height = y;
 
     // create a linear buffer to represent the image. We could use a jagged/2D array here, but experimentation
     // showed this had a negative effect on memory management (heap fragmentation etc).
 
+    if (bitmap == NULL || format != MICROBIT_IMAGE_FORMAT_8BPP)
+        this->clear();
+
     if (bitmap)
         this->printImage(x,y,bitmap);
-    else
-        this->clear();
 }
 
 /**
@@ -333,6 +636,33 @@ MicroBitImage& MicroBitImage::operator = (const MicroBitImage& i)
     return *this;
 }
 
+#if MICROBIT_CPP11
+/**
+  * Move assign operation.
+  *
+  * Called when a MicroBitImage is assigned the value of a temporary (e.g. the result of crop()).
+  *
+  * Our existing buffer is swapped with that of the supplied MicroBitImage, so no
+  * reference counts are changed here. Our old buffer is released when the temporary is destroyed.
+  *
+  * @param i The MicroBitImage to move from.
+  *
+  * @code
+  * MicroBitImage i(10,5);
+  * i = i.crop(0,0,5,5); // no reference counting is needed to hold the cropped image
+  * @endcode
+  */
+MicroBitImage& MicroBitImage::operator = (MicroBitImage&& i)
+{
+    ImageData *p = ptr;
+
+    ptr = i.ptr;
+    i.ptr = p;
+
+    return *this;
+}
+#endif
+
 /**
   * Equality operation.
   *
@@ -356,7 +686,7 @@ bool MicroBitImage::operator== (const MicroBitImage& i)
     if (ptr == i.ptr)
         return true;
     else
-        return (ptr->width == i.ptr->width && ptr->height == i.ptr->height && (memcmp(getBitmap(), i.ptr->data, getSize())==0));
+        return (ptr->width == i.ptr->width && ptr->height == i.ptr->height && (memcmp(getBitmap(), i.getBitmap(), getSize())==0));
 }
 
 
@@ -397,7 +727,24 @@ int MicroBitImage::setPixelValue(int16_t x , int16_t y, uint8_t value)
     if(x >= getWidth() || y >= getHeight() || x < 0 || y < 0)
         return MICROBIT_INVALID_PARAMETER;
 
-    this->getBitmap()[y*getWidth()+x] = value;
+    if (getFormat() == MICROBIT_IMAGE_FORMAT_8BPP)
+    {
+        this->getBitmap()[y*getWidth()+x] = value;
+        return MICROBIT_OK;
+    }
+
+    int bpp = getBitsPerPixel();
+    uint32_t *row = (uint32_t *)(getBitmap() + y * getStride());
+
+    // Quantise the value, but never let a lit pixel become unlit.
+    if (bpp == 4 && value)
+        value = max(value >> 4, 1);
+
+    if (bpp == 1)
+        value = value ? 1 : 0;
+
+    writeBits(row, getStride() >> 2, x * bpp, value, lowBits(bpp));
+
     return MICROBIT_OK;
 }
 
@@ -415,13 +762,22 @@ int MicroBitImage::setPixelValue(int16_t x , int16_t y, uint8_t value)
   * i.getPixelValue(0,0); //should be 0;
   * @endcode
   */
-int MicroBitImage::getPixelValue(int16_t x , int16_t y)
+int MicroBitImage::getPixelValue(int16_t x , int16_t y) const
 {
     //sanity check
     if(x >= getWidth() || y >= getHeight() || x < 0 || y < 0)
         return MICROBIT_INVALID_PARAMETER;
 
-    return this->getBitmap()[y*getWidth()+x];
+    if (getFormat() == MICROBIT_IMAGE_FORMAT_8BPP)
+        return this->getBitmap()[y*getWidth()+x];
+
+    int bit = x * getBitsPerPixel();
+    uint32_t v = ((const uint32_t *)(getBitmap() + y * getStride()))[bit >> 5] >> (bit & 31);
+
+    if (getFormat() == MICROBIT_IMAGE_FORMAT_1BPP)
+        return (v & 0x01) ? 255 : 0;
+
+    return (v & 0x0F) * 0x11;
 }
 
 /**
@@ -458,6 +814,16 @@ int MicroBitImage::printImage(int16_t width, int16_t height, const uint8_t *bitm
     pixelsToCopyX = min(width,this->getWidth());
     pixelsToCopyY = min(height,this->getHeight());
 
+    // Packed images are converted pixel by pixel.
+    if (getFormat() != MICROBIT_IMAGE_FORMAT_8BPP)
+    {
+        for (int i=0; i<pixelsToCopyY; i++)
+            for (int j=0; j<pixelsToCopyX; j++)
+                setPixelValue(j, i, bitmap[i*width+j]);
+
+        return MICROBIT_OK;
+    }
+
     pIn = bitmap;
     pOut = this->getBitmap();
 
@@ -495,59 +861,218 @@ int MicroBitImage::printImage(int16_t width, int16_t height, const uint8_t *bitm
   */
 int MicroBitImage::paste(const MicroBitImage &image, int16_t x, int16_t y, uint8_t alpha)
 {
-    uint8_t *pIn, *pOut;
-    int cx, cy;
+    return paste(image, x, y, 0, 0, image.getWidth(), image.getHeight(), alpha);
+}
+
+/**
+  * Pastes a region of a given bitmap at the given co-ordinates.
+  *
+  * This is equivalent to pasting image.crop(sx, sy, sw, sh), without creating the cropped image.
+  * Any pixels in the relevant area of this image are replaced.
+  *
+  * @param image The MicroBitImage to paste from.
+  *
+  * @param x The leftmost X co-ordinate in this image where the region should be pasted.
+  *
+  * @param y The uppermost Y co-ordinate in this image where the region should be pasted.
+  *
+  * @param sx The leftmost X co-ordinate of the region in the given image.
+  *
+  * @param sy The uppermost Y co-ordinate of the region in the given image.
+  *
+  * @param sw The width of the region.
+  *
+  * @param sh The height of the region.
+  *
+  * @param alpha set to 1 if transparency clear pixels in given image should be treated as transparent. Set to 0 otherwise.  Defaults to 0.
+  *
+  * @return The number of pixels written.
+  *
+  * @code
+  * MicroBitImage sheet(50,5);
+  * MicroBitImage i(5,5);
+  * i.paste(sheet, 0, 0, 10, 0, 5, 5); // the third 5x5 frame of the sheet
+  * @endcode
+  */
+int MicroBitImage::paste(const MicroBitImage &image, int16_t x, int16_t y, int16_t sx, int16_t sy, int16_t sw, int16_t sh, uint8_t alpha)
+{
+    const uint8_t *pIn;
+    uint8_t *pOut;
+    int inX = sx, inY = sy, outX = x, outY = y;
+    int cx = sw, cy = sh;
     int pxWritten = 0;
 
-    // Sanity check.
-    // We permit writes that overlap us, but ones that are clearly out of scope we can filter early.
-    if (x >= getWidth() || y >= getHeight() || x+image.getWidth() <= 0 || y+image.getHeight() <= 0)
+    // Clip the region to the bounds of the source image...
+    if (inX < 0)
+    {
+        outX -= inX;
+        cx += inX;
+        inX = 0;
+    }
+
+    if (inY < 0)
+    {
+        outY -= inY;
+        cy += inY;
+        inY = 0;
+    }
+
+    cx = min(cx, image.getWidth() - inX);
+    cy = min(cy, image.getHeight() - inY);
+
+    // ...and then to the bounds of this image. We permit writes that overlap us, but filter those that are clearly out of scope.
+    if (outX < 0)
+    {
+        inX -= outX;
+        cx += outX;
+        outX = 0;
+    }
+
+    if (outY < 0)
+    {
+        inY -= outY;
+        cy += outY;
+        outY = 0;
+    }
+
+    cx = min(cx, getWidth() - outX);
+    cy = min(cy, getHeight() - outY);
+
+    if (cx <= 0 || cy <= 0)
         return 0;
 
-    //Calculate the number of byte we need to copy in each dimension.
-    cx = x < 0 ? min(image.getWidth() + x, getWidth()) : min(image.getWidth(), getWidth() - x);
-    cy = y < 0 ? min(image.getHeight() + y, getHeight()) : min(image.getHeight(), getHeight() - y);
+    // Images of the same packed format are copied a word at a time, on bit offsets.
+    if (getFormat() != MICROBIT_IMAGE_FORMAT_8BPP && image.getFormat() == getFormat())
+    {
+        int bpp = getBitsPerPixel();
+        int inWords = image.getStride() >> 2;
+        int outWords = getStride() >> 2;
+        int inBit = inX * bpp;
+        int outBit = outX * bpp;
+        int bits = cx * bpp;
 
-    // Calculate sane start pointer.
-    pIn = image.ptr->data;
-    pIn += (x < 0) ? -x : 0;
-    pIn += (y < 0) ? -image.getWidth()*y : 0;
+        const uint32_t *rowIn = (const uint32_t *)image.getBitmap() + inY * inWords;
+        uint32_t *rowOut = (uint32_t *)getBitmap() + outY * outWords;
 
-    pOut = getBitmap();
-    pOut += (x > 0) ? x : 0;
-    pOut += (y > 0) ? getWidth()*y : 0;
+        for (int i=0; i<cy; i++)
+        {
+            for (int done = 0; done < bits; done += 32)
+            {
+                uint32_t mask = lowBits(bits - done);
+                uint32_t v = readBits(rowIn, inWords, inBit + done) & mask;
+
+                if (alpha)
+                {
+                    // Only write those pixels that are lit. For 4 bit pixels, build a nibble mask of the non-zero pixels.
+                    uint32_t lit = v;
+
+                    if (bpp == 4)
+                    {
+                        lit = (v | (v >> 1) | (v >> 2) | (v >> 3)) & 0x11111111;
+                        mask = lit * 0x0F;
+                    }
+                    else
+                    {
+                        mask = v;
+                    }
+
+                    pxWritten += countBits(lit);
+                }
 
-    // Copy the image, stride by stride
-    // If we want primitive transparecy, we do this byte by byte.
-    // If we don't, use a more efficient block memory copy instead. Every little helps!
+                writeBits(rowOut, outWords, outBit + done, v, mask);
+            }
+
+            if (!alpha)
+                pxWritten += cx;
 
-    if (alpha)
+            rowIn += inWords;
+            rowOut += outWords;
+        }
+
+        return pxWritten;
+    }
+
+    // 1 bit images (such as pre-rendered text) are expanded into 8 bit images a word at a time.
+    if (getFormat() == MICROBIT_IMAGE_FORMAT_8BPP && image.getFormat() == MICROBIT_IMAGE_FORMAT_1BPP)
     {
+        int inWords = image.getStride() >> 2;
+
+        const uint32_t *rowIn = (const uint32_t *)image.getBitmap() + inY * inWords;
+        pOut = getBitmap() + outY * getWidth() + outX;
+
         for (int i=0; i<cy; i++)
         {
-            for (int j=0; j<cx; j++)
+            for (int done = 0; done < cx; done += 32)
             {
-                // Copy this byte if appropriate.
-                if (*(pIn+j) != 0){
-                    *(pOut+j) = *(pIn+j);
-                    pxWritten++;
+                uint32_t v = readBits(rowIn, inWords, inX + done);
+                int n = min(cx - done, 32);
+
+                for (int j=0; j<n; j++)
+                {
+                    if (v & 0x01)
+                    {
+                        pOut[done + j] = 255;
+                        pxWritten++;
+                    }
+                    else if (!alpha)
+                    {
+                        pOut[done + j] = 0;
+                        pxWritten++;
+                    }
+
+                    v >>= 1;
                 }
             }
 
-            pIn += image.getWidth();
+            rowIn += inWords;
             pOut += getWidth();
         }
+
+        return pxWritten;
     }
-    else
+
+    // Images of differing formats are converted pixel by pixel.
+    if (getFormat() != MICROBIT_IMAGE_FORMAT_8BPP || image.getFormat() != MICROBIT_IMAGE_FORMAT_8BPP)
     {
         for (int i=0; i<cy; i++)
         {
-            memcpy(pOut, pIn, cx);
+            for (int j=0; j<cx; j++)
+            {
+                int v = image.getPixelValue(inX + j, inY + i);
+
+                if (v || !alpha)
+                {
+                    setPixelValue(outX + j, outY + i, v);
+                    pxWritten++;
+                }
+            }
+        }
+
+        return pxWritten;
+    }
 
+    // Calculate sane start pointer.
+    pIn = image.getBitmap() + inY * image.getWidth() + inX;
+    pOut = getBitmap() + outY * getWidth() + outX;
+
+    // Copy the image, stride by stride
+    // If we want primitive transparecy, we do this four pixels at a time, skipping the clear ones.
+    // If we don't, use a more efficient block memory copy instead. Every little helps!
+
+    for (int i=0; i<cy; i++)
+    {
+        if (alpha)
+        {
+            pxWritten += pasteRowAlpha(pOut, pIn, cx);
+        }
+        else
+        {
+            memcpy(pOut, pIn, cx);
             pxWritten += cx;
-            pIn += image.getWidth();
-            pOut += getWidth();
         }
+
+        pIn += image.getWidth();
+        pOut += getWidth();
     }
 
     return pxWritten;
@@ -564,6 +1089,9 @@ int MicroBitImage::paste(const MicroBitImage &image, int16_t x, int16_t y, uint8
   *
   * @return MICROBIT_OK on success, or MICROBIT_INVALID_PARAMETER.
   *
+  * @note If the system font is proportional, x is the position of the first column the character uses,
+  * and only the columns the character uses are drawn.
+  *
   * @code
   * MicroBitImage i(5,5);
   * i.print('a');
@@ -580,6 +1108,12 @@ int MicroBitImage::print(char c, int16_t x, int16_t y)
     if (x >= getWidth() || y >= getHeight() || c < MICROBIT_FONT_ASCII_START || c > font.asciiEnd)
         return MICROBIT_INVALID_PARAMETER;
 
+    // Characters of proportional fonts are drawn from their first used column, leaving the columns either side untouched.
+    int first = font.getCharOffset(c);
+    int last = first + font.getCharWidth(c);
+
+    x -= first;
+
     // Paste.
     int offset = (c-MICROBIT_FONT_ASCII_START) * 5;
 
@@ -592,13 +1126,45 @@ int MicroBitImage::print(char c, int16_t x, int16_t y)
         // Update our Y co-ord write position
         y1 = y+row;
 
-        for (int col = 0; col < MICROBIT_FONT_WIDTH; col++)
+        if (y1 < 0 || y1 >= getHeight())
+            continue;
+
+        // 1 bit images take a whole row of the character in a single write.
+        if (getFormat() == MICROBIT_IMAGE_FORMAT_1BPP)
+        {
+            uint32_t bits = fontRowReversed[v & 0x1F];
+            uint32_t mask = lowBits(last) & ~lowBits(first);
+
+            x1 = x;
+
+            if (x1 <= -MICROBIT_FONT_WIDTH)
+                continue;
+
+            if (x1 < 0)
+            {
+                bits >>= -x1;
+                mask >>= -x1;
+                x1 = 0;
+            }
+
+            mask &= lowBits(getWidth() - x1);
+
+            writeBits((uint32_t *)(getBitmap() + y1 * getStride()), getStride() >> 2, x1, bits, mask);
+            continue;
+        }
+
+        for (int col = first; col < last; col++)
         {
             // Update our X co-ord write position
             x1 = x+col;
 
-            if (x1 < getWidth() && y1 < getHeight())
+            if (x1 < 0 || x1 >= getWidth())
+                continue;
+
+            if (getFormat() == MICROBIT_IMAGE_FORMAT_8BPP)
                 this->getBitmap()[y1*getWidth()+x1] = (v & (0x10 >> col)) ? 255 : 0;
+            else
+                setPixelValue(x1, y1, (v & (0x10 >> col)) ? 255 : 0);
         }
     }
 
@@ -633,10 +1199,23 @@ int MicroBitImage::shiftLeft(int16_t n)
         return MICROBIT_OK;
     }
 
+    // Packed rows are shifted a word at a time.
+    if (getFormat() != MICROBIT_IMAGE_FORMAT_8BPP)
+    {
+        for (int y = 0; y < getHeight(); y++)
+        {
+            shiftRowDown((uint32_t *)p, getStride() >> 2, n * getBitsPerPixel());
+            p += getStride();
+        }
+
+        return MICROBIT_OK;
+    }
+
+    // Move the whole bitmap in one pass. Each row then holds the first pixels of the next in its rightmost columns, so blank fill those.
+    memmove(p, p+n, getSize()-n);
+
     for (int y = 0; y < getHeight(); y++)
     {
-        // Copy, and blank fill the rightmost column.
-        memcpy(p, p+n, pixels);
         memclr(p+pixels, n);
         p += getWidth();
     }
@@ -661,7 +1240,6 @@ int MicroBitImage::shiftLeft(int16_t n)
 int MicroBitImage::shiftRight(int16_t n)
 {
     uint8_t *p = getBitmap();
-    int pixels = getWidth()-n;
 
     if (n <= 0)
         return MICROBIT_INVALID_PARAMETER;
@@ -672,10 +1250,27 @@ int MicroBitImage::shiftRight(int16_t n)
         return MICROBIT_OK;
     }
 
+    // Packed rows are shifted a word at a time. Any pixels shifted into the padding at the end of the row are cleared.
+    if (getFormat() != MICROBIT_IMAGE_FORMAT_8BPP)
+    {
+        int words = getStride() >> 2;
+        uint32_t padding = lowBits(getWidth() * getBitsPerPixel() - (words - 1) * 32);
+
+        for (int y = 0; y < getHeight(); y++)
+        {
+            shiftRowUp((uint32_t *)p, words, n * getBitsPerPixel());
+            ((uint32_t *)p)[words - 1] &= padding;
+            p += getStride();
+        }
+
+        return MICROBIT_OK;
+    }
+
+    // Move the whole bitmap in one pass. Each row then holds the last pixels of the previous in its leftmost columns, so blank fill those.
+    memmove(p+n, p, getSize()-n);
+
     for (int y = 0; y < getHeight(); y++)
     {
-        // Copy, and blank fill the leftmost column.
-        memmove(p+n, p, pixels);
         memclr(p, n);
         p += getWidth();
     }
@@ -699,7 +1294,8 @@ int MicroBitImage::shiftRight(int16_t n)
   */
 int MicroBitImage::shiftUp(int16_t n)
 {
-    uint8_t *pOut, *pIn;
+    uint8_t *p = getBitmap();
+    int bytes = getStride()*n;
 
     if (n <= 0 )
         return MICROBIT_INVALID_PARAMETER;
@@ -710,20 +1306,9 @@ int MicroBitImage::shiftUp(int16_t n)
         return MICROBIT_OK;
     }
 
-    pOut = getBitmap();
-    pIn = getBitmap()+getWidth()*n;
-
-    for (int y = 0; y < getHeight(); y++)
-    {
-        // Copy, and blank fill the leftmost column.
-        if (y < getHeight()-n)
-            memcpy(pOut, pIn, getWidth());
-        else
-            memclr(pOut, getWidth());
-
-        pIn += getWidth();
-        pOut += getWidth();
-    }
+    // Rows are contiguous, so move them all at once, and blank fill the bottom rows.
+    memmove(p, p+bytes, getSize()-bytes);
+    memclr(p+getSize()-bytes, bytes);
 
     return MICROBIT_OK;
 }
@@ -744,7 +1329,8 @@ int MicroBitImage::shiftUp(int16_t n)
   */
 int MicroBitImage::shiftDown(int16_t n)
 {
-    uint8_t *pOut, *pIn;
+    uint8_t *p = getBitmap();
+    int bytes = getStride()*n;
 
     if (n <= 0 )
         return MICROBIT_INVALID_PARAMETER;
@@ -755,20 +1341,9 @@ int MicroBitImage::shiftDown(int16_t n)
         return MICROBIT_OK;
     }
 
-    pOut = getBitmap() + getWidth()*(getHeight()-1);
-    pIn = pOut - getWidth()*n;
-
-    for (int y = 0; y < getHeight(); y++)
-    {
-        // Copy, and blank fill the leftmost column.
-        if (y < getHeight()-n)
-            memcpy(pOut, pIn, getWidth());
-        else
-            memclr(pOut, getWidth());
-
-        pIn -= getWidth();
-        pOut -= getWidth();
-    }
+    // Rows are contiguous, so move them all at once, and blank fill the top rows.
+    memmove(p+bytes, p, getSize()-bytes);
+    memclr(p, bytes);
 
     return MICROBIT_OK;
 }
@@ -786,21 +1361,20 @@ int MicroBitImage::shiftDown(int16_t n)
 ManagedString MicroBitImage::toString()
 {
     //width including commans and \n * height
-    int stringSize = getSize() * 2;
+    int stringSize = getWidth() * getHeight() * 2;
 
     //plus one for string terminator
     char parseBuffer[stringSize + 1];
 
     parseBuffer[stringSize] = '\0';
 
-    uint8_t *bitmapPtr = getBitmap();
-
     int parseIndex = 0;
     int widthCount = 0;
+    int heightCount = 0;
 
     while (parseIndex < stringSize)
     {
-        if(*bitmapPtr)
+        if(getPixelValue(widthCount, heightCount))
             parseBuffer[parseIndex] = '1';
         else
             parseBuffer[parseIndex] = '0';
@@ -811,6 +1385,7 @@ ManagedString MicroBitImage::toString()
         {
             parseBuffer[parseIndex] = '\n';
             widthCount = 0;
+            heightCount++;
         }
         else
         {
@@ -819,7 +1394,6 @@ ManagedString MicroBitImage::toString()
         }
 
         parseIndex++;
-        bitmapPtr++;
     }
 
     return ManagedString(parseBuffer);
@@ -844,34 +1418,30 @@ ManagedString MicroBitImage::toString()
   */
 MicroBitImage MicroBitImage::crop(int startx, int starty, int cropWidth, int cropHeight)
 {
-    int newWidth = startx + cropWidth;
-    int newHeight = starty + cropHeight;
-
-    if (newWidth >= getWidth() || newWidth <=0)
-        newWidth = getWidth();
-
-    if (newHeight >= getHeight() || newHeight <= 0)
-        newHeight = getHeight();
+    // Clip the requested region to the bounds of this image.
+    if (startx < 0)
+    {
+        cropWidth += startx;
+        startx = 0;
+    }
 
-    //allocate our storage.
-    uint8_t cropped[newWidth * newHeight];
+    if (starty < 0)
+    {
+        cropHeight += starty;
+        starty = 0;
+    }
 
-    //calculate the pointer to where we want to begin cropping
-    uint8_t *copyPointer = getBitmap() + (getWidth() * starty) + startx;
+    cropWidth = min(cropWidth, getWidth() - startx);
+    cropHeight = min(cropHeight, getHeight() - starty);
 
-    //get a reference to our storage
-    uint8_t *pastePointer = cropped;
+    if (cropWidth <= 0 || cropHeight <= 0)
+        return MicroBitImage();
 
-    //go through row by row and select our image.
-    for (int i = starty; i < newHeight; i++)
-    {
-        memcpy(pastePointer, copyPointer, newWidth);
+    // Paste the region of interest into a new image of the same format.
+    MicroBitImage cropped(cropWidth, cropHeight, getFormat());
+    cropped.paste(*this, 0, 0, startx, starty, cropWidth, cropHeight);
 
-        copyPointer += getWidth();
-        pastePointer += newHeight;
-    }
-
-    return MicroBitImage(newWidth, newHeight, cropped);
+    return cropped;
 }
 
 /**
@@ -889,5 +1459,32 @@ bool MicroBitImage::isReadOnly()
   */
 MicroBitImage MicroBitImage::clone()
 {
-    return MicroBitImage(getWidth(), getHeight(), getBitmap());
+    MicroBitImage image(getWidth(), getHeight(), getFormat());
+
+    memcpy(image.getBitmap(), getBitmap(), getSize());
+
+    return image;
+}
+
+/**
+  * Create a copy of the image in the given pixel format.
+  *
+  * @param format The MicroBitImageFormat of the new image.
+  *
+  * @return an instance of MicroBitImage holding the same picture in the given format.
+  *
+  * @code
+  * MicroBitImage i("0,1,0,1,0\n1,0,1,0,1\n0,1,0,1,0\n1,0,1,0,1\n0,1,0,1,0\n");
+  * MicroBitImage packed = i.convert(MICROBIT_IMAGE_FORMAT_1BPP);
+  * @endcode
+  */
+MicroBitImage MicroBitImage::convert(MicroBitImageFormat format)
+{
+    if (format == getFormat())
+        return clone();
+
+    MicroBitImage image(getWidth(), getHeight(), format);
+    image.paste(*this);
+
+    return image;
 }
@@ -30,6 +30,11 @@ DEALINGS IN THE SOFTWARE.
 // Create the EmptyPacket reference.
 PacketBuffer PacketBuffer::EmptyPacket = PacketBuffer(1);
 
+#if MICROBIT_CPP11
+// A read only, zero length packet, used to hold no resources in a PacketBuffer that has been moved from.
+static const uint32_t empty[] __attribute__ ((aligned (4))) = { 0xffff, 0, 0 };
+#endif
+
 /**
   * Default Constructor.
   * Creates an empty Packet Buffer.
@@ -96,6 +101,25 @@ PacketBuffer::PacketBuffer(const PacketBuffer &buffer)
     ptr->incr();
 }
 
+#if MICROBIT_CPP11
+/**
+  * Move Constructor.
+  * Takes over the packet of the supplied PacketBuffer, without changing its reference count.
+  *
+  * @param buffer The PacketBuffer to move from. This is left as an empty, zero length packet.
+  *
+  * @code
+  * PacketBuffer p(16);
+  * PacketBuffer p2(std::move(p)); // p2 now holds the packet, p is empty.
+  * @endcode
+  */
+PacketBuffer::PacketBuffer(PacketBuffer &&buffer)
+{
+    ptr = buffer.ptr;
+    buffer.ptr = (PacketData *)(void *)empty;
+}
+#endif
+
 /**
   * Internal constructor-initialiser.
   *
@@ -163,6 +187,33 @@ PacketBuffer& PacketBuffer::operator = (const PacketBuffer &p)
     return *this;
 }
 
+#if MICROBIT_CPP11
+/**
+  * Move assign operation.
+  *
+  * Called when a PacketBuffer is assigned the value of a temporary (e.g. the result of recv()).
+  *
+  * Our existing packet is swapped with that of the supplied PacketBuffer, so no
+  * reference counts are changed here. Our old packet is released when the temporary is destroyed.
+  *
+  * @param p The PacketBuffer to move from.
+  *
+  * @code
+  * PacketBuffer p;
+  * p = uBit.radio.datagram.recv();
+  * @endcode
+  */
+PacketBuffer& PacketBuffer::operator = (PacketBuffer&& p)
+{
+    PacketData *tmp = ptr;
+
+    ptr = p.ptr;
+    p.ptr = tmp;
+
+    return *this;
+}
+#endif
+
 /**
   * Array access operation (read).
   *
@@ -282,6 +333,16 @@ uint8_t*PacketBuffer::getBytes()
     return ptr->payload;
 }
 
+/**
+  * Provide a read only pointer to a memory location containing the packet data.
+  *
+  * @return The contents of this packet, as an array of bytes.
+  */
+const uint8_t *PacketBuffer::getBytes() const
+{
+    return ptr->payload;
+}
+
 /**
   * Gets number of bytes in this buffer
   *
@@ -292,7 +353,7 @@ uint8_t*PacketBuffer::getBytes()
   * p1.length(); // Returns 16.
   * @endcode
   */
-int PacketBuffer::length()
+int PacketBuffer::length() const
 {
     return ptr->length;
 }
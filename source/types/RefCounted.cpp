@@ -32,6 +32,14 @@ DEALINGS IN THE SOFTWARE.
 #include "RefCounted.h"
 #include "MicroBitDisplay.h"
 
+#if MICROBIT_STRING_POOL_SIZE > 0
+// A pool of fixed size blocks for small payloads, such as short strings, which are created and released very often.
+// Free blocks are held in a list, linked through their first word. Blocks that have never been used are taken in order.
+static uint32_t pool[MICROBIT_STRING_POOL_SIZE][REF_COUNTED_POOL_BLOCK_SIZE / 4];
+static uint32_t *poolFree = NULL;
+static uint16_t poolUsed = 0;
+#endif
+
 /**
   * Initializes for one outstanding reference.
   */
@@ -55,10 +63,12 @@ static inline bool isReadOnlyInline(RefCounted *t)
     if (refCount == 0xffff)
         return true; // object in flash
 
+#if CONFIG_ENABLED(MICROBIT_PANIC_REFCOUNT_ERROR)
     // Do some sanity checking while we're here
     if (refCount == 1 ||        // object should have been deleted
         (refCount & 1) == 0)    // refCount doesn't look right
         microbit_panic(MICROBIT_HEAP_ERROR);
+#endif
 
     // Not read only
     return false;
@@ -93,6 +103,54 @@ void RefCounted::decr()
 
     refCount -= 2;
     if (refCount == 1) {
+#if MICROBIT_STRING_POOL_SIZE > 0
+        if ((uint32_t *)this >= pool[0] && (uint32_t *)this < pool[MICROBIT_STRING_POOL_SIZE])
+        {
+            __disable_irq();
+            *(uint32_t **)this = poolFree;
+            poolFree = (uint32_t *)this;
+            __enable_irq();
+            return;
+        }
+#endif
         free(this);
     }
 }
+
+/**
+  * Allocates the memory for a new payload. Payloads of up to REF_COUNTED_POOL_BLOCK_SIZE bytes are taken
+  * from a pool of MICROBIT_STRING_POOL_SIZE fixed size blocks while any are free, avoiding the heap.
+  * The memory is released by decr() when the last reference is removed.
+  *
+  * @param size the size of the payload in bytes.
+  *
+  * @return the memory allocated, or NULL if there is insufficient memory.
+  */
+RefCounted *RefCounted::allocate(int size)
+{
+#if MICROBIT_STRING_POOL_SIZE > 0
+    if (size <= REF_COUNTED_POOL_BLOCK_SIZE)
+    {
+        uint32_t *block = NULL;
+
+        __disable_irq();
+
+        if (poolFree)
+        {
+            block = poolFree;
+            poolFree = *(uint32_t **)block;
+        }
+        else if (poolUsed < MICROBIT_STRING_POOL_SIZE)
+        {
+            block = pool[poolUsed++];
+        }
+
+        __enable_irq();
+
+        if (block)
+            return (RefCounted *)block;
+    }
+#endif
+
+    return (RefCounted *)malloc(size);
+}
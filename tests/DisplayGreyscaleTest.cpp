@@ -0,0 +1,210 @@
+/**
+  * Runs the greyscale renderer of MicroBitDisplay on the simulated timer, for a set of representative images.
+  *
+  * The time each LED is lit in every row period is measured from the values written to the LED matrix, and checked
+  * against the duration given for each bit of its brightness, scaled to the on-time of a row. Columns due to be
+  * turned off within MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL of each other share a timer event, so may be lit for up
+  * to that interval longer or shorter, as may a column lit for less than that interval.
+  *
+  * The number of timer events taken to render each row and frame, and the time spent in them on the host, are reported.
+  */
+#include <assert.h>
+#include <math.h>
+#include "HostRuntime.h"
+#include "MicroBitDisplay.h"
+#include "MicroBitSystemTimer.h"
+
+#define FRAMES                  20
+
+// The duration of each bit of the brightness of a pixel, as given by greyScaleTimings in MicroBitDisplay.cpp.
+static const int bitTimes[MICROBIT_DISPLAY_GREYSCALE_BIT_DEPTH] = {1, 23, 70, 163, 351, 726, 1476, 2976};
+
+// The error allowed in the time the renderer computes for a column, from its 12 bit fixed point scale.
+#define SCALE_ERROR             2.5
+
+static const MatrixMap &matrix = microbitMatrixMap;
+
+// The time each LED of the matrix has been lit, in microseconds, indexed as the entries of the matrix map.
+static uint64_t onTime[MICROBIT_DISPLAY_ROW_COUNT * MICROBIT_DISPLAY_COLUMN_COUNT];
+
+static uint32_t lastValue = 0;
+static uint64_t lastWrite = 0;
+
+/**
+  * Adds the time since the last write to the LED matrix to each LED it lit: those in a driven row and a sunk column.
+  */
+static void portWrite(uint32_t value, uint32_t)
+{
+    for (int row = 0; row < matrix.rows; row++)
+    {
+        if (!(lastValue & (1 << (matrix.rowStart + row))))
+            continue;
+
+        for (int column = 0; column < matrix.columns; column++)
+            if (!(lastValue & (1 << (matrix.columnStart + column))))
+                onTime[column * matrix.rows + row] += hostTimeUs - lastWrite;
+    }
+
+    lastValue = value;
+    lastWrite = hostTimeUs;
+}
+
+/**
+  * The time for which a pixel of the given brightness should be lit in each row period.
+  */
+static double expectedOnTime(int value, double rowOnTime)
+{
+    int total = 0;
+    int time = 0;
+
+    for (int bit = 0; bit < MICROBIT_DISPLAY_GREYSCALE_BIT_DEPTH; bit++)
+    {
+        total += bitTimes[bit];
+
+        if (value & (1 << bit))
+            time += bitTimes[bit];
+    }
+
+    return time * rowOnTime / total;
+}
+
+/**
+  * Runs the simulated timer to the start of the next row period at the given refresh rate.
+  */
+static int startRow(int rate)
+{
+    int rowPeriod = 1000000 / (rate * matrix.rows);
+
+    hostRunTimers(rowPeriod - hostTimeUs % rowPeriod);
+
+    return rowPeriod;
+}
+
+/**
+  * Shows an image for FRAMES frames, checking the on-time of every LED and reporting the timer events taken.
+  */
+static void run(MicroBitDisplay &display, const char *name, int brightness)
+{
+    display.setBrightness(brightness);
+
+    int rowPeriod = startRow(display.getRefreshRate());
+    double rowOnTime = rowPeriod * MICROBIT_DISPLAY_ROW_DUTY_CYCLE / 100;
+    double worst = 0;
+
+    memset(onTime, 0, sizeof(onTime));
+
+    uint32_t calls = hostTimerCalls;
+    double seconds = hostTimerSeconds;
+    uint32_t rowCalls = 0;
+
+    for (int i = 0; i < FRAMES * matrix.rows; i++)
+    {
+        uint32_t start = hostTimerCalls;
+
+        hostRunTimers(rowPeriod);
+        rowCalls = max(rowCalls, hostTimerCalls - start);
+    }
+
+    calls = hostTimerCalls - calls;
+    seconds = hostTimerSeconds - seconds;
+
+    for (int i = 0; i < matrix.rows * matrix.columns; i++)
+    {
+        int value = min(display.image.getPixelValue(matrix.map[i].x, matrix.map[i].y), brightness);
+        double measured = (double)onTime[i] / FRAMES;
+
+        if (value == 0)
+        {
+            assert(measured == 0);
+            continue;
+        }
+
+        double error = fabs(measured - max(expectedOnTime(value, rowOnTime), (double)MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL));
+
+        if (error > MICROBIT_DISPLAY_GREYSCALE_MIN_INTERVAL + SCALE_ERROR)
+        {
+            printf("DisplayGreyscaleTest: %s: LED %d of brightness %d lit for %.1f us, expected %.1f us\n", name, i, value,
+                   measured, expectedOnTime(value, rowOnTime));
+            exit(1);
+        }
+
+        worst = max(worst, error);
+    }
+
+    printf("    %-14s %3d %6.2f events/row (max %2d) %6.2f events/frame %7.2f us/frame  max error %4.1f us\n", name, brightness,
+           (double)calls / (FRAMES * matrix.rows), (int)rowCalls, (double)calls / FRAMES, seconds * 1e6 / FRAMES, worst);
+}
+
+int main()
+{
+    MicroBitDisplay display;
+
+    // Tick the system timer only once a minute, so that the events counted are those of the display.
+    system_timer_set_period(60000);
+
+    hostPortWrite = portWrite;
+    display.setDisplayMode(DISPLAY_MODE_GREYSCALE);
+
+    printf("greyscale rendering at %d Hz (host time in timer events):\n", display.getRefreshRate());
+
+    display.image.clear();
+    run(display, "clear", 255);
+
+    display.image.setPixelValue(2, 2, 128);
+    run(display, "single pixel", 255);
+
+    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++)
+        for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; x++)
+            display.image.setPixelValue(x, y, 255);
+
+    run(display, "full", 255);
+    run(display, "full", 128);
+    run(display, "full", 1);
+
+    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++)
+        for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; x++)
+            display.image.setPixelValue(x, y, (y * MICROBIT_DISPLAY_WIDTH + x) * 255 / 24);
+
+    run(display, "gradient", 255);
+    run(display, "gradient", 100);
+
+    // Many of the dimmest levels are lit for the minimum interval, so share a single event.
+    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++)
+        for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; x++)
+            display.image.setPixelValue(x, y, 1 + y * MICROBIT_DISPLAY_WIDTH + x);
+
+    run(display, "dim", 255);
+
+    // Levels that differ by one are within the minimum interval of each other, as are their bit durations.
+    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++)
+        for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; x++)
+            display.image.setPixelValue(x, y, 100 + y * MICROBIT_DISPLAY_WIDTH + x);
+
+    run(display, "adjacent", 255);
+
+    uint32_t seed = 1;
+
+    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++)
+    {
+        for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; x++)
+        {
+            seed = seed * 1103515245 + 12345;
+            display.image.setPixelValue(x, y, (seed >> 16) & 0xFF);
+        }
+    }
+
+    run(display, "random", 255);
+    run(display, "random", 160);
+
+    // Row periods begin when the refresh rate is set, so set it at the start of one.
+    startRow(MICROBIT_DISPLAY_MAXIMUM_REFRESH_RATE);
+    display.setRefreshRate(MICROBIT_DISPLAY_MAXIMUM_REFRESH_RATE);
+    printf("at %d Hz:\n", display.getRefreshRate());
+
+    run(display, "random", 255);
+    run(display, "gradient", 255);
+
+    printf("DisplayGreyscaleTest: OK\n");
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+  * Runs MicroBitDisplay on the simulated timer with the system timer ticking at several periods, and checks that the
+  * period of each frame and the time each row is lit for, at every brightness with a linear and a gamma corrected
+  * brightness curve, are the same whatever the period of the system timer.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitDisplay.h"
+#include "MicroBitSystemTimer.h"
+
+#define FRAMES                  10
+
+static const int tickPeriods[] = {1, 6, SYSTEM_TICK_PERIOD_MS * 2, 20, 35};
+static const int refreshRates[] = {MICROBIT_DISPLAY_MINIMUM_REFRESH_RATE, MICROBIT_DISPLAY_REFRESH_RATE, 100, MICROBIT_DISPLAY_MAXIMUM_REFRESH_RATE};
+
+#define TICK_PERIODS            (int)(sizeof(tickPeriods) / sizeof(tickPeriods[0]))
+#define REFRESH_RATES           (int)(sizeof(refreshRates) / sizeof(refreshRates[0]))
+
+static const MatrixMap &matrix = microbitMatrixMap;
+
+// The time the first LED of the matrix has been lit, in microseconds.
+static uint64_t onTime = 0;
+
+// The time at which the first row was last driven, and the longest and shortest times between frames since.
+static uint64_t frameStart = 0;
+static uint64_t longestFrame = 0;
+static uint64_t shortestFrame = 0;
+
+static uint32_t lastValue = 0;
+static uint64_t lastWrite = 0;
+
+/**
+  * Records the start of each frame, and the time for which the first LED, in the first row and column, is lit.
+  */
+static void portWrite(uint32_t value, uint32_t)
+{
+    uint32_t firstRow = 1 << matrix.rowStart;
+    uint32_t firstColumn = 1 << matrix.columnStart;
+
+    if ((lastValue & firstRow) && !(lastValue & firstColumn))
+        onTime += hostTimeUs - lastWrite;
+
+    if ((value & firstRow) && !(lastValue & firstRow))
+    {
+        if (frameStart)
+        {
+            longestFrame = max(longestFrame, hostTimeUs - frameStart);
+            shortestFrame = shortestFrame ? min(shortestFrame, hostTimeUs - frameStart) : hostTimeUs - frameStart;
+        }
+
+        frameStart = hostTimeUs;
+    }
+
+    lastValue = value;
+    lastWrite = hostTimeUs;
+}
+
+/**
+  * Shows the lit image at the given brightness for FRAMES frames.
+  *
+  * @return the time the first LED was lit in each frame, in microseconds.
+  */
+static int measure(MicroBitDisplay &display, int brightness)
+{
+    int framePeriod = matrix.rows * (1000000 / (display.getRefreshRate() * matrix.rows));
+
+    display.setBrightness(brightness);
+
+    // Measure whole frames, from the start of the next.
+    hostRunTimers(framePeriod);
+    hostRunTimers(frameStart + framePeriod - hostTimeUs);
+
+    onTime = 0;
+    longestFrame = 0;
+    shortestFrame = 0;
+
+    hostRunTimers(FRAMES * framePeriod);
+
+    assert(longestFrame == (uint64_t)framePeriod && shortestFrame == (uint64_t)framePeriod);
+
+    return (int)(onTime / FRAMES);
+}
+
+int main()
+{
+    // The time the first LED is lit for in each frame, at each brightness, for each curve and refresh rate.
+    static int expected[2][REFRESH_RATES][256];
+
+    MicroBitDisplay display;
+
+    hostPortWrite = portWrite;
+
+    for (int y = 0; y < MICROBIT_DISPLAY_HEIGHT; y++)
+        for (int x = 0; x < MICROBIT_DISPLAY_WIDTH; x++)
+            display.image.setPixelValue(x, y, 255);
+
+    for (int t = 0; t < TICK_PERIODS; t++)
+    {
+        assert(system_timer_set_period(tickPeriods[t]) == MICROBIT_OK);
+
+        for (int r = 0; r < REFRESH_RATES; r++)
+        {
+            assert(display.setRefreshRate(refreshRates[r]) == MICROBIT_OK);
+
+            int rowPeriod = 1000000 / (refreshRates[r] * matrix.rows);
+            int rowOnTime = rowPeriod * MICROBIT_DISPLAY_ROW_DUTY_CYCLE / 100;
+
+            for (int curve = 0; curve < 2; curve++)
+            {
+                display.setBrightnessCurve(curve ? MicroBitDisplay::gammaCurve : NULL);
+
+                for (int b = 1; b < 256; b++)
+                {
+                    int lit = measure(display, b);
+
+                    // A row is lit for the whole of its period at full brightness, and otherwise for its share of the
+                    // on-time of the row, given by the brightness curve.
+                    if (b == MICROBIT_DISPLAY_MAXIMUM_BRIGHTNESS)
+                        assert(lit == rowPeriod);
+                    else if (b > MICROBIT_DISPLAY_MINIMUM_BRIGHTNESS)
+                        assert(lit == (curve ? MicroBitDisplay::gammaCurve[b] : b) * rowOnTime / 255);
+
+                    if (t == 0)
+                        expected[curve][r][b] = lit;
+
+                    if (lit != expected[curve][r][b])
+                    {
+                        printf("DisplayRefreshTest: brightness %d at %d Hz lit for %d us with a %d ms tick, %d us with a %d ms tick\n",
+                               b, refreshRates[r], lit, tickPeriods[t], expected[curve][r][b], tickPeriods[0]);
+                        exit(1);
+                    }
+                }
+            }
+        }
+
+        printf("    %2d ms tick: frame periods and row on-times unchanged at", tickPeriods[t]);
+
+        for (int r = 0; r < REFRESH_RATES; r++)
+            printf(" %d Hz", refreshRates[r]);
+
+        printf("\n");
+    }
+
+    printf("DisplayRefreshTest: OK\n");
+
+    return 0;
+}
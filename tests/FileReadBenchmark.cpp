@@ -0,0 +1,87 @@
+/**
+  * Measures the time taken to read a 50 KB file in 32 byte chunks with MicroBitFileSystem.
+  *
+  * Sequential reads continue from the block cached in the file descriptor. Reading the chunks in reverse order moves
+  * the position back past the cached block on every read, so each read walks the file table from the first block of
+  * the file, as every read did before the block was cached.
+  */
+#include <assert.h>
+#include <chrono>
+#include "HostRuntime.h"
+#include "MicroBitFileSystem.h"
+
+#define FILE_SYSTEM_PAGES       80
+#define CHUNK_SIZE              32
+#define CHUNKS                  1600
+#define REPEATS                 10
+
+static void makeChunk(uint8_t *chunk, int n)
+{
+    for (int i = 0; i < CHUNK_SIZE; i++)
+        chunk[i] = (uint8_t)(n + i);
+}
+
+/**
+  * Reads every chunk of the file REPEATS times, checking its contents.
+  *
+  * @param reverse true to read the chunks from the end of the file to the start.
+  */
+static void readChunks(MicroBitFileSystem &fs, int fd, const char *name, bool reverse)
+{
+    uint8_t chunk[CHUNK_SIZE];
+    uint8_t expected[CHUNK_SIZE];
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+    {
+        fs.seek(fd, 0, MB_SEEK_SET);
+
+        for (int i = 0; i < CHUNKS; i++)
+        {
+            int n = reverse ? CHUNKS - 1 - i : i;
+
+            if (reverse)
+                fs.seek(fd, n * CHUNK_SIZE, MB_SEEK_SET);
+
+            assert(fs.read(fd, chunk, CHUNK_SIZE) == CHUNK_SIZE);
+
+            makeChunk(expected, n);
+            assert(memcmp(chunk, expected, CHUNK_SIZE) == 0);
+        }
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("    %-12s %8.2f ms %8.0f KB/s\n", name, ms / REPEATS, CHUNKS * CHUNK_SIZE * REPEATS / 1024.0 / (ms / 1000));
+}
+
+int main()
+{
+    uint8_t chunk[CHUNK_SIZE];
+
+    MicroBitFlash::setBackend(new MicroBitFlashSimulator(hostFlash(), HOST_FLASH_PAGES));
+    MicroBitFileSystem fs((uint32_t)(uintptr_t)hostFlash(), FILE_SYSTEM_PAGES);
+
+    int fd = fs.open("big", MB_WRITE | MB_CREAT);
+    assert(fd >= 0);
+
+    for (int n = 0; n < CHUNKS; n++)
+    {
+        makeChunk(chunk, n);
+        assert(fs.write(fd, chunk, CHUNK_SIZE) == CHUNK_SIZE);
+    }
+
+    assert(fs.close(fd) == MICROBIT_OK);
+
+    fd = fs.open("big", MB_READ);
+    assert(fd >= 0);
+
+    printf("read %d bytes in %d byte chunks:\n", CHUNKS * CHUNK_SIZE, CHUNK_SIZE);
+    readChunks(fs, fd, "sequential", false);
+    readChunks(fs, fd, "reverse", true);
+
+    fs.close(fd);
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**
+  * Tests that MicroBitFileSystem recovers from a loss of power after any flash operation of a sequence of updates.
+  * After each loss of power, every file must hold either its old or its new contents, the file system must remain
+  * usable, and no space may be lost.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitFileSystem.h"
+
+#define FILE_SYSTEM_PAGES       16
+
+static PowerLossSimulator *simulator;
+static uint32_t flashStart;
+
+static void writeFile(MicroBitFileSystem &fs, const char *name, char c, int length)
+{
+    uint8_t data[2000];
+
+    memset(data, c, length);
+
+    int fd = fs.open(name, MB_WRITE | MB_CREAT);
+    assert(fd >= 0);
+    assert(fs.write(fd, data, length) == length);
+    assert(fs.close(fd) == MICROBIT_OK);
+}
+
+/**
+  * Reads a file.
+  *
+  * @return the length of the file, or -1 if it does not exist.
+  */
+static int readFile(MicroBitFileSystem &fs, const char *name, uint8_t *data)
+{
+    int fd = fs.open(name, MB_READ);
+
+    if (fd < 0)
+        return -1;
+
+    int length = fs.read(fd, data, 4000);
+    fs.close(fd);
+
+    return max(length, 0);
+}
+
+// Determines if the given part of a buffer holds only the given character.
+static bool filled(uint8_t *data, char c, int from, int to)
+{
+    for (int i = from; i < to; i++)
+        if (data[i] != c)
+            return false;
+
+    return true;
+}
+
+/**
+  * Determines the space available for a new file, by writing one until the file system is full.
+  */
+static int freeSpace(MicroBitFileSystem &fs)
+{
+    uint8_t data[MBFS_BLOCK_SIZE];
+    int total = 0;
+    int written;
+
+    memset(data, 0, sizeof(data));
+
+    int fd = fs.open("space", MB_WRITE | MB_CREAT);
+    assert(fd >= 0);
+
+    while ((written = fs.write(fd, data, sizeof(data))) > 0)
+        total += written;
+
+    fs.close(fd);
+    fs.remove("space");
+
+    return total;
+}
+
+/**
+  * The updates interrupted by the loss of power: appending, overwriting, creating and removing files.
+  */
+static void update(MicroBitFileSystem &fs)
+{
+    uint8_t data[500];
+
+    fs.remove("B");
+
+    int fd = fs.open("A", MB_WRITE | MB_APPEND);
+    memset(data, 'a', 500);
+    fs.write(fd, data, 500);
+    fs.close(fd);
+
+    writeFile(fs, "D", 'D', 200);
+
+    fd = fs.open("C", MB_WRITE | MB_READ);
+    fs.seek(fd, 10, MB_SEEK_SET);
+    memset(data, 'x', 20);
+    fs.write(fd, data, 20);
+    fs.close(fd);
+
+    // Churn through enough files to need garbage collection.
+    for (int i = 0; i < 12; i++)
+    {
+        char name[8];
+        sprintf(name, "t%d", i % 4);
+
+        writeFile(fs, name, '0' + i, 300);
+        fs.remove(name);
+    }
+
+    fs.remove("C");
+    writeFile(fs, "E", 'E', 1100);
+}
+
+int main()
+{
+    uint8_t data[4000];
+    int length;
+
+    uint32_t *flash = hostFlash();
+
+    simulator = new PowerLossSimulator(flash, HOST_FLASH_PAGES);
+    MicroBitFlash::setBackend(simulator);
+
+    flashStart = (uint32_t)(uintptr_t)flash;
+
+    // The space available once the files that survive every update are written.
+    int expectedSpace;
+
+    {
+        hostFlashReset();
+
+        MicroBitFileSystem fs(flashStart, FILE_SYSTEM_PAGES);
+
+        writeFile(fs, "A", 'A', 1200);
+        writeFile(fs, "F", 'F', 900);
+
+        expectedSpace = freeSpace(fs);
+    }
+
+    for (int operations = 0; ; operations++)
+    {
+        hostFlashReset();
+
+        MicroBitFileSystem *fs = new MicroBitFileSystem(flashStart, FILE_SYSTEM_PAGES);
+        bool poweredDown = false;
+
+        writeFile(*fs, "A", 'A', 700);
+        writeFile(*fs, "B", 'B', 300);
+        writeFile(*fs, "C", 'C', 1500);
+
+        simulator->losePowerAfter(operations);
+
+        try
+        {
+            update(*fs);
+        }
+        catch (PowerLoss)
+        {
+            poweredDown = true;
+        }
+
+        simulator->losePowerAfter(-1);
+        simulator->powerUp();
+
+        // The RAM state of the interrupted file system is lost, as it would be on a reset.
+        MicroBitFileSystem recovered(flashStart, FILE_SYSTEM_PAGES);
+
+        length = readFile(recovered, "A", data);
+        assert((length == 700 || length == 1200) && filled(data, 'A', 0, 700) && filled(data, 'a', 700, length));
+
+        length = readFile(recovered, "B", data);
+        assert(length == -1 || (length == 300 && filled(data, 'B', 0, 300)));
+
+        length = readFile(recovered, "C", data);
+        assert(length == -1 || (length == 1500 && filled(data, 'C', 0, 10) && filled(data, 'C', 30, 1500) &&
+               (filled(data, 'C', 10, 30) || filled(data, 'x', 10, 30))));
+
+        // A file being written when power was lost may be incomplete, but holds nothing else.
+        length = readFile(recovered, "D", data);
+        assert(length <= 200 && filled(data, 'D', 0, length));
+
+        length = readFile(recovered, "E", data);
+        assert(length <= 1100 && filled(data, 'E', 0, length));
+
+        // Keep using the file system, and check that no space was lost.
+        const char *removed[] = { "B", "C", "D", "E", "t0", "t1", "t2", "t3" };
+
+        for (int i = 0; i < 8; i++)
+            recovered.remove(removed[i]);
+
+        if (readFile(recovered, "A", data) == 700)
+        {
+            int fd = recovered.open("A", MB_WRITE | MB_APPEND);
+            memset(data, 'a', 500);
+            assert(recovered.write(fd, data, 500) == 500);
+            recovered.close(fd);
+        }
+
+        writeFile(recovered, "F", 'F', 900);
+
+        assert(readFile(recovered, "F", data) == 900 && filled(data, 'F', 0, 900));
+        assert(freeSpace(recovered) == expectedSpace);
+        assert(simulator->getViolations() == 0);
+
+        if (!poweredDown)
+        {
+            printf("FileSystemPowerLossTest: recovered from a loss of power at %d points\n", operations);
+            break;
+        }
+    }
+
+    printf("FileSystemPowerLossTest: OK\n");
+
+    return 0;
+}
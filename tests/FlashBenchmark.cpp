@@ -0,0 +1,295 @@
+/**
+  * Replays file and key value workloads against MicroBitFlashSimulator, modelling the flash timings of the nRF51,
+  * and reports the throughput, the number of page erases per MB written, and how evenly the erases wear the pages,
+  * including the pages of the file system journal.
+  * Built as FlashBenchmarkNoCache without the write back cache of the file system, for comparison.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitCompat.h"
+#include "MicroBitFileSystem.h"
+#include "MicroBitStorage.h"
+#include "MicroBitFlashSimulator.h"
+
+// The typical time taken to erase a page and write a word of the nRF51 flash, in microseconds.
+#define NRF51_ERASE_TIME        22300
+#define NRF51_WRITE_TIME        46
+
+// The pages of the simulated flash used by the file system.
+#define FILE_SYSTEM_PAGES       64
+
+static MicroBitFlashSimulator *simulator;
+
+/**
+  * Prints the results of a workload.
+  *
+  * @param name The name of the workload.
+  * @param bytes The number of bytes of data written by the workload.
+  * @param first The first page used by the workload.
+  * @param pages The number of pages used by the workload.
+  */
+static void report(const char *name, uint32_t bytes, int first, int pages)
+{
+    double seconds = simulator->getBusyTime() / 1e6;
+    double megabytes = bytes / (1024.0 * 1024.0);
+
+    printf("%-24s %8u bytes %8u words %10.0f bytes/s %8.1f erases/MB %6u violations\n", name, bytes, simulator->getWordsWritten(),
+           seconds > 0 ? bytes / seconds : 0, simulator->getEraseCount() / megabytes, simulator->getViolations());
+
+    // Group the pages by the number of times they were erased.
+    int most = 0;
+    int total = 0;
+
+    for (int i = 0; i < pages; i++)
+    {
+        int erases = simulator->getEraseCount(first + i);
+
+        most = max(most, erases);
+        total += erases;
+    }
+
+    int width = most / 8 + 1;
+
+    printf("    page wear: mean %.1f, max %d\n", (double)total / pages, most);
+
+    // The journal of the file system rotates between its last pages.
+    if (first == 0)
+    {
+        printf("    journal wear:");
+
+        for (int i = pages - MBFS_JOURNAL_PAGES; i < pages; i++)
+            printf(" page %d %d", i, simulator->getEraseCount(first + i));
+
+        putchar('\n');
+    }
+
+    for (int bucket = 0; bucket * width <= most; bucket++)
+    {
+        int count = 0;
+
+        for (int i = 0; i < pages; i++)
+            if (simulator->getEraseCount(first + i) / width == bucket)
+                count++;
+
+        printf("    %4d-%-4d erases: %3d pages ", bucket * width, bucket * width + width - 1, count);
+
+        for (int i = 0; i < count; i++)
+            putchar('#');
+
+        putchar('\n');
+    }
+}
+
+/**
+  * Appends small records to a single file, as a data logger would, closing the file every so often.
+  */
+static void fileAppend(MicroBitFileSystem &fs)
+{
+    uint8_t record[32];
+    uint32_t bytes = 0;
+
+    int fd = fs.open("log.bin", MB_WRITE | MB_CREAT | MB_APPEND);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        memset(record, i, sizeof(record));
+        bytes += fs.write(fd, record, sizeof(record));
+
+        if (i % 100 == 99)
+        {
+            fs.close(fd);
+            fd = fs.open("log.bin", MB_WRITE | MB_APPEND);
+        }
+    }
+
+    fs.close(fd);
+    fs.remove("log.bin");
+
+    report("file append", bytes, 0, FILE_SYSTEM_PAGES);
+}
+
+/**
+  * Logs short text records to a single file, as a data logger would, flushing every so often.
+  */
+static void fileLog(MicroBitFileSystem &fs)
+{
+    char record[16];
+    uint32_t bytes = 0;
+
+    int fd = fs.open("log.txt", MB_WRITE | MB_CREAT | MB_APPEND);
+
+    for (int i = 0; i < 3000; i++)
+    {
+        sprintf(record, "%05d,%03d\n", i, i % 1000);
+        bytes += fs.write(fd, (uint8_t *)record, strlen(record));
+
+        if (i % 500 == 499)
+            fs.flush(fd);
+    }
+
+    fs.close(fd);
+    fs.remove("log.txt");
+
+    report("file log", bytes, 0, FILE_SYSTEM_PAGES);
+}
+
+/**
+  * Creates, writes and removes many small files.
+  */
+static void fileChurn(MicroBitFileSystem &fs)
+{
+    uint8_t data[200];
+    uint32_t bytes = 0;
+    char name[16];
+
+    for (int i = 0; i < 400; i++)
+    {
+        sprintf(name, "file%d", i % 8);
+        memset(data, i, sizeof(data));
+
+        fs.remove(name);
+
+        int fd = fs.open(name, MB_WRITE | MB_CREAT);
+        bytes += fs.write(fd, data, sizeof(data));
+        fs.close(fd);
+    }
+
+    report("file create/remove", bytes, 0, FILE_SYSTEM_PAGES);
+}
+
+/**
+  * Creates, writes and removes small files, mounting the file system afresh every few files, as a device that is often
+  * reset would. The wear of each page is restored from the journal on each mount, so new data continues to be placed
+  * in the least worn pages rather than in the first free pages after every reset.
+  */
+static void fileRemount(uint32_t *flash)
+{
+    uint8_t data[200];
+    uint32_t bytes = 0;
+    char name[16];
+
+    for (int mount = 0; mount < 50; mount++)
+    {
+        MicroBitFileSystem fs((uint32_t)(uintptr_t)flash, FILE_SYSTEM_PAGES);
+
+        for (int i = 0; i < 8; i++)
+        {
+            sprintf(name, "boot%d", i % 4);
+            memset(data, i, sizeof(data));
+
+            fs.remove(name);
+
+            int fd = fs.open(name, MB_WRITE | MB_CREAT);
+            bytes += fs.write(fd, data, sizeof(data));
+            fs.close(fd);
+        }
+    }
+
+    report("file create/remount", bytes, 0, FILE_SYSTEM_PAGES);
+}
+
+/**
+  * Rewrites a file in place, a chunk at a time.
+  */
+static void fileOverwrite(MicroBitFileSystem &fs)
+{
+    uint8_t data[64];
+    uint32_t bytes = 0;
+
+    memset(data, 0, sizeof(data));
+
+    int fd = fs.open("table.bin", MB_WRITE | MB_CREAT);
+
+    for (int i = 0; i < 4096 / (int)sizeof(data); i++)
+        fs.write(fd, data, sizeof(data));
+
+    fs.close(fd);
+    simulator->resetStatistics();
+
+    fd = fs.open("table.bin", MB_WRITE);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        memset(data, i, sizeof(data));
+
+        fs.seek(fd, (i * 7 % 64) * sizeof(data), MB_SEEK_SET);
+        bytes += fs.write(fd, data, sizeof(data));
+    }
+
+    fs.close(fd);
+    fs.remove("table.bin");
+
+    report("file overwrite", bytes, 0, FILE_SYSTEM_PAGES);
+}
+
+/**
+  * Updates a single key repeatedly, as a setting or counter would be.
+  */
+static void keyValueUpdate(MicroBitStorage &storage)
+{
+    uint32_t bytes = 0;
+
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        assert(storage.put("counter", (uint8_t *)&i, sizeof(i)) == MICROBIT_OK);
+        bytes += sizeof(i);
+    }
+
+    report("key value update", bytes, HOST_STORAGE_PAGE, HOST_STORAGE_PAGES);
+}
+
+/**
+  * Updates a set of keys in turn, each with a full size value.
+  */
+static void keyValueChurn(MicroBitStorage &storage)
+{
+    uint8_t value[MICROBIT_STORAGE_VALUE_SIZE];
+    uint32_t bytes = 0;
+    char key[16];
+
+    for (int i = 0; i < 2000; i++)
+    {
+        sprintf(key, "key%d", i % 12);
+        memset(value, i, sizeof(value));
+
+        assert(storage.put(key, value, sizeof(value)) == MICROBIT_OK);
+        bytes += sizeof(value);
+    }
+
+    report("key value churn", bytes, HOST_STORAGE_PAGE, HOST_STORAGE_PAGES);
+}
+
+int main()
+{
+    uint32_t *flash = hostFlash();
+
+    simulator = new MicroBitFlashSimulator(flash, HOST_FLASH_PAGES);
+    simulator->setLatency(NRF51_ERASE_TIME, NRF51_WRITE_TIME);
+    MicroBitFlash::setBackend(simulator);
+
+    MicroBitFileSystem fs((uint32_t)(uintptr_t)flash, FILE_SYSTEM_PAGES);
+
+    simulator->resetStatistics();
+    fileAppend(fs);
+
+    simulator->resetStatistics();
+    fileLog(fs);
+
+    simulator->resetStatistics();
+    fileChurn(fs);
+
+    fileOverwrite(fs);
+
+    simulator->resetStatistics();
+    fileRemount(flash);
+
+    MicroBitStorage storage;
+
+    simulator->resetStatistics();
+    keyValueUpdate(storage);
+
+    simulator->resetStatistics();
+    keyValueChurn(storage);
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+  * Tests the heap region management of MicroBitHeapAllocator on simulated SRAM: creating and removing regions,
+  * the usage summary of each region, and allocation from each region in turn, then from the native heap.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitHeapAllocator.h"
+
+// Two regions of the simulated SRAM, of 1KB and 4KB.
+#define REGION_A_START          (HOST_RAM_BASE + 0x100)
+#define REGION_A_END            (HOST_RAM_BASE + 0x500)
+#define REGION_B_START          (HOST_RAM_BASE + 0x1000)
+#define REGION_B_END            (HOST_RAM_BASE + 0x2000)
+
+static bool inRegion(void *p, uint32_t start, uint32_t end)
+{
+    return (uint32_t)(uintptr_t)p > start && (uint32_t)(uintptr_t)p < end;
+}
+
+static MicroBitHeapInfo info(int index)
+{
+    MicroBitHeapInfo i;
+
+    assert(microbit_heap_info(index, i) == MICROBIT_OK);
+
+    return i;
+}
+
+int main()
+{
+    void *p[300];
+    int n;
+
+    hostRam();
+
+    // Regions must be large enough and word aligned.
+    assert(microbit_create_heap(REGION_A_END, REGION_A_START) == MICROBIT_INVALID_PARAMETER);
+    assert(microbit_create_heap(REGION_A_START, REGION_A_START + 4) == MICROBIT_INVALID_PARAMETER);
+    assert(microbit_create_heap(REGION_A_START + 2, REGION_A_END) == MICROBIT_INVALID_PARAMETER);
+    assert(microbit_heap_count() == 0);
+
+    assert(microbit_create_heap(REGION_A_START, REGION_A_END) == MICROBIT_OK);
+    assert(microbit_create_heap(REGION_B_START, REGION_B_END) == MICROBIT_OK);
+    assert(microbit_heap_count() == 2);
+
+    // An empty region is one free block, less the index block of an allocation.
+    MicroBitHeapInfo a = info(0);
+    assert(a.start == REGION_A_START && a.end == REGION_A_END);
+    assert(a.free == 0x400 && a.largest == 0x400 - 4);
+    assert(info(1).start == REGION_B_START && info(1).free == 0x1000);
+
+    MicroBitHeapInfo unused;
+    assert(microbit_heap_info(2, unused) == MICROBIT_INVALID_PARAMETER);
+    assert(microbit_heap_info(-1, unused) == MICROBIT_INVALID_PARAMETER);
+
+    // Allocations are served from the first region created until it is full, then from the next.
+    for (n = 0; n < 300; n++)
+    {
+        p[n] = microbit_malloc(60);
+        assert(p[n] != NULL);
+
+        if (!inRegion(p[n], REGION_A_START, REGION_A_END))
+            break;
+    }
+
+    // Each allocation of 60 bytes uses 16 blocks, including its index block.
+    assert(n == 0x400 / 64);
+    assert(inRegion(p[n], REGION_B_START, REGION_B_END));
+    assert(info(0).free == 0 && info(0).largest == 0);
+    assert(info(1).free == 0x1000 - 64);
+
+    // A region still holding allocations cannot be removed.
+    assert(microbit_remove_heap(REGION_A_START) == MICROBIT_BUSY);
+    assert(microbit_remove_heap(REGION_A_START + 4) == MICROBIT_INVALID_PARAMETER);
+
+    // Freed blocks are reported as one run, and the largest allocation possible reflects any fragmentation.
+    microbit_free(p[1]);
+    microbit_free(p[2]);
+    microbit_free(p[5]);
+    assert(info(0).free == 3 * 64 && info(0).largest == 2 * 64 - 4);
+
+    // The freed blocks are reused before the next region.
+    void *q = microbit_malloc(100);
+    assert(q == p[1]);
+    p[1] = q;
+    p[2] = NULL;
+    p[5] = NULL;
+
+    for (int i = 0; i <= n; i++)
+        microbit_free(p[i]);
+
+    assert(info(0).free == 0x400 && info(0).largest == 0x400 - 4);
+    assert(info(1).free == 0x1000 && info(1).largest == 0x1000 - 4);
+
+    // Once empty, a region can be removed. Later regions keep their order, and allocation continues from them.
+    assert(microbit_remove_heap(REGION_A_START) == MICROBIT_OK);
+    assert(microbit_heap_count() == 1);
+    assert(info(0).start == REGION_B_START);
+
+    q = microbit_malloc(16);
+    assert(inRegion(q, REGION_B_START, REGION_B_END));
+    microbit_free(q);
+
+    // A removed region can be added again, after those remaining.
+    assert(microbit_create_heap(REGION_A_START, REGION_A_END) == MICROBIT_OK);
+    assert(info(1).start == REGION_A_START);
+
+    // When no region has space, memory is allocated from the native heap, and freed back to it.
+    q = microbit_malloc(0x1800);
+    assert(q != NULL && !inRegion(q, REGION_A_START, REGION_A_END) && !inRegion(q, REGION_B_START, REGION_B_END));
+    microbit_free(q);
+
+    // No more regions can be created than MICROBIT_MAXIMUM_HEAPS.
+    for (n = microbit_heap_count(); n < MICROBIT_MAXIMUM_HEAPS; n++)
+        assert(microbit_create_heap(HOST_RAM_BASE + 0x2000 + n * 0x100, HOST_RAM_BASE + 0x2100 + n * 0x100) == MICROBIT_OK);
+
+    assert(microbit_create_heap(HOST_RAM_BASE + 0x3000, HOST_RAM_BASE + 0x3100) == MICROBIT_NO_RESOURCES);
+
+    printf("HeapAllocatorTest: OK\n");
+
+    return 0;
+}
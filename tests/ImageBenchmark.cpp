@@ -0,0 +1,117 @@
+/**
+  * Measures the word parallel paste and shift kernels of MicroBitImage against the byte-wise reference versions of
+  * ImageTest, for images the size of the display and of a line of scrolling text, in each pixel format.
+  *
+  * Each shift is made on a fresh copy of the image, restored by copying its bitmap, which is included in both times.
+  */
+#include <assert.h>
+#include <chrono>
+#include "HostRuntime.h"
+#include "MicroBitImage.h"
+#include "ImageReference.h"
+
+// The minimum time each operation is repeated for, in seconds.
+#define MINIMUM_TIME            0.02
+
+static const MicroBitImageFormat formats[] = { MICROBIT_IMAGE_FORMAT_8BPP, MICROBIT_IMAGE_FORMAT_4BPP, MICROBIT_IMAGE_FORMAT_1BPP };
+static const char *formatNames[] = { "8bpp", "4bpp", "1bpp" };
+
+static const int widths[] = { 5, 64 };
+static const int heights[] = { 5, 8 };
+
+#define FORMATS                 3
+#define SIZES                   2
+
+// Accumulates the results of each operation, so that none are optimised away.
+static volatile int sink = 0;
+
+/**
+  * Repeats an operation for at least MINIMUM_TIME.
+  *
+  * @return the mean time taken by the operation, in nanoseconds.
+  */
+template <typename Operation> static double measure(Operation operation)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double seconds;
+    int n = 0;
+
+    do
+    {
+        for (int i = 0; i < 100; i++)
+            sink += operation();
+
+        n += 100;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < MINIMUM_TIME);
+
+    return seconds * 1e9 / n;
+}
+
+static void report(const char *format, int width, int height, const char *name, double kernel, double reference)
+{
+    printf("    %s %2dx%d  %-14s %10.1f %10.1f %7.1fx\n", format, width, height, name, kernel, reference, reference / kernel);
+}
+
+/**
+  * Copies the bitmap of one image over that of another of the same size and format.
+  */
+static int restore(MicroBitImage &image, const MicroBitImage &original)
+{
+    memcpy(image.getBitmap(), original.getBitmap(), original.getStride() * original.getHeight());
+
+    return 0;
+}
+
+int main()
+{
+    printf("image kernels against byte-wise reference (ns/op):\n");
+    printf("    %-24s %10s %10s %8s\n", "", "kernel", "reference", "speedup");
+
+    for (int f = 0; f < FORMATS; f++)
+    for (int s = 0; s < SIZES; s++)
+    {
+        int w = widths[s];
+        int h = heights[s];
+        const char *name = formatNames[f];
+
+        MicroBitImage image(w, h, formats[f]);
+        MicroBitImage source(w, h, formats[f]);
+        MicroBitImage original(w, h, formats[f]);
+
+        fill(image, PATTERN_MIXED, 1);
+        fill(source, PATTERN_MIXED, 2);
+        fill(original, PATTERN_MIXED, 3);
+
+        report(name, w, h, "paste",
+               measure([&] { return image.paste(source, 1, 1, 0); }),
+               measure([&] { return referencePaste(image, source, 1, 1, 0, 0, w, h, 0); }));
+
+        report(name, w, h, "paste alpha",
+               measure([&] { return image.paste(source, 1, 1, 1); }),
+               measure([&] { return referencePaste(image, source, 1, 1, 0, 0, w, h, 1); }));
+
+        // A character of a line of text, as pasted by a scroll.
+        report(name, w, h, "paste region",
+               measure([&] { return image.paste(source, 0, 0, 2, 0, 5, h, 0); }),
+               measure([&] { return referencePaste(image, source, 0, 0, 2, 0, 5, h, 0); }));
+
+        report(name, w, h, "shiftLeft",
+               measure([&] { return restore(image, original) + image.shiftLeft(1); }),
+               measure([&] { referenceShift(image, -1, 0); return restore(image, original); }));
+
+        report(name, w, h, "shiftRight",
+               measure([&] { return restore(image, original) + image.shiftRight(1); }),
+               measure([&] { referenceShift(image, 1, 0); return restore(image, original); }));
+
+        report(name, w, h, "shiftUp",
+               measure([&] { return restore(image, original) + image.shiftUp(1); }),
+               measure([&] { referenceShift(image, 0, -1); return restore(image, original); }));
+
+        report(name, w, h, "shiftDown",
+               measure([&] { return restore(image, original) + image.shiftDown(1); }),
+               measure([&] { referenceShift(image, 0, 1); return restore(image, original); }));
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+  * Byte-wise reference versions of the paste and shift kernels of MicroBitImage, which work one pixel at a time
+  * through getPixelValue() and setPixelValue(), and the patterns of pixels they are tested and measured with.
+  */
+#ifndef IMAGE_REFERENCE_H
+#define IMAGE_REFERENCE_H
+
+#include "MicroBitImage.h"
+
+// The patterns of pixels used to fill images.
+#define PATTERN_CLEAR           0
+#define PATTERN_LIT             1
+#define PATTERN_MIXED           2
+#define PATTERNS                3
+
+/**
+  * Fills an image with a pattern of pixels. Mixed patterns hold runs of unlit pixels, so that some words of the
+  * image are entirely unlit, some entirely lit, and some a mixture.
+  */
+static inline void fill(MicroBitImage &image, int pattern, uint32_t seed)
+{
+    for (int y = 0; y < image.getHeight(); y++)
+    {
+        for (int x = 0; x < image.getWidth(); x++)
+        {
+            seed = seed * 1103515245 + 12345;
+
+            int value = 1 + (seed >> 16) % 255;
+
+            if (pattern == PATTERN_CLEAR || (pattern == PATTERN_MIXED && ((x + (seed >> 28)) / 3 + y) % 3 == 0))
+                value = 0;
+
+            image.setPixelValue(x, y, value);
+        }
+    }
+}
+
+/**
+  * Byte-wise reference version of MicroBitImage::paste().
+  */
+static inline int referencePaste(MicroBitImage &image, const MicroBitImage &source, int x, int y, int sx, int sy, int sw, int sh, int alpha)
+{
+    int written = 0;
+
+    for (int j = 0; j < sh; j++)
+    {
+        for (int i = 0; i < sw; i++)
+        {
+            if (sx + i < 0 || sx + i >= source.getWidth() || sy + j < 0 || sy + j >= source.getHeight())
+                continue;
+
+            if (x + i < 0 || x + i >= image.getWidth() || y + j < 0 || y + j >= image.getHeight())
+                continue;
+
+            int value = source.getPixelValue(sx + i, sy + j);
+
+            if (value || !alpha)
+            {
+                image.setPixelValue(x + i, y + j, value);
+                written++;
+            }
+        }
+    }
+
+    return written;
+}
+
+/**
+  * Byte-wise reference version of the MicroBitImage shifts, moving every pixel by the given offset.
+  */
+static inline void referenceShift(MicroBitImage &image, int dx, int dy)
+{
+    MicroBitImage original = image.clone();
+
+    for (int y = 0; y < image.getHeight(); y++)
+    {
+        for (int x = 0; x < image.getWidth(); x++)
+        {
+            int fromX = x - dx;
+            int fromY = y - dy;
+
+            bool inside = fromX >= 0 && fromX < image.getWidth() && fromY >= 0 && fromY < image.getHeight();
+
+            image.setPixelValue(x, y, inside ? original.getPixelValue(fromX, fromY) : 0);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,227 @@
+/**
+  * Tests the word parallel paste, shift and crop kernels of MicroBitImage against byte-wise reference versions, which
+  * work one pixel at a time through getPixelValue() and setPixelValue().
+  *
+  * Every combination of pixel formats is tested exhaustively over small images, with widths either side of the 4 pixel
+  * words of 8 bit images and the 32 pixel words of 1 bit images, and every position and region that overlaps them.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitImage.h"
+#include "ImageReference.h"
+
+static const MicroBitImageFormat formats[] = { MICROBIT_IMAGE_FORMAT_8BPP, MICROBIT_IMAGE_FORMAT_4BPP, MICROBIT_IMAGE_FORMAT_1BPP };
+
+// Image widths either side of the word boundaries of each format.
+static const int widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 12, 31, 32, 33 };
+
+#define FORMATS                 3
+#define WIDTHS                  12
+
+static int comparisons = 0;
+
+static bool same(const MicroBitImage &a, const MicroBitImage &b)
+{
+    comparisons++;
+
+    if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight() || a.getFormat() != b.getFormat())
+        return false;
+
+    for (int y = 0; y < a.getHeight(); y++)
+        for (int x = 0; x < a.getWidth(); x++)
+            if (a.getPixelValue(x, y) != b.getPixelValue(x, y))
+                return false;
+
+    return true;
+}
+
+/**
+  * Byte-wise reference version of MicroBitImage::crop().
+  */
+static MicroBitImage referenceCrop(MicroBitImage &image, int startx, int starty, int width, int height)
+{
+    int fromX = max(startx, 0);
+    int fromY = max(starty, 0);
+    int toX = min(startx + width, image.getWidth());
+    int toY = min(starty + height, image.getHeight());
+
+    if (toX <= fromX || toY <= fromY)
+        return MicroBitImage();
+
+    MicroBitImage cropped(toX - fromX, toY - fromY, image.getFormat());
+
+    for (int y = fromY; y < toY; y++)
+        for (int x = fromX; x < toX; x++)
+            cropped.setPixelValue(x - fromX, y - fromY, image.getPixelValue(x, y));
+
+    return cropped;
+}
+
+/**
+  * Pastes whole images of every size, format and pattern at every position that overlaps the image pasted into.
+  */
+static void testPaste()
+{
+    for (int f = 0; f < FORMATS; f++)
+    for (int w = 0; w < WIDTHS; w++)
+    for (int h = 1; h <= 3; h++)
+    {
+        MicroBitImage image(widths[w], h, formats[f]);
+        fill(image, PATTERN_MIXED, w * 7 + h);
+
+        for (int sf = 0; sf < FORMATS; sf++)
+        for (int sw = 0; sw < WIDTHS; sw++)
+        for (int sh = 1; sh <= 2; sh++)
+        for (int pattern = 0; pattern < PATTERNS; pattern++)
+        {
+            MicroBitImage source(widths[sw], sh, formats[sf]);
+            fill(source, pattern, sw * 5 + sh);
+
+            for (int y = -sh - 1; y <= h; y++)
+            for (int x = -source.getWidth() - 1; x <= image.getWidth(); x++)
+            for (int alpha = 0; alpha <= 1; alpha++)
+            {
+                MicroBitImage expected = image.clone();
+                MicroBitImage actual = image.clone();
+
+                int written = referencePaste(expected, source, x, y, 0, 0, source.getWidth(), source.getHeight(), alpha);
+
+                assert(actual.paste(source, x, y, alpha) == written);
+                assert(same(actual, expected));
+            }
+        }
+    }
+}
+
+/**
+  * Pastes every region of a source image, including regions clipped by its edges, at every position.
+  */
+static void testPasteRegion()
+{
+    for (int f = 0; f < FORMATS; f++)
+    for (int sf = 0; sf < FORMATS; sf++)
+    {
+        MicroBitImage image(9, 3, formats[f]);
+        MicroBitImage source(10, 3, formats[sf]);
+
+        fill(image, PATTERN_MIXED, 1);
+        fill(source, PATTERN_MIXED, 2);
+
+        for (int sy = -1; sy <= 3; sy++)
+        for (int sh = 0; sh <= 4; sh++)
+        for (int sx = -2; sx <= 11; sx++)
+        for (int sw = 0; sw <= 12; sw++)
+        for (int y = -1; y <= 3; y++)
+        for (int x = -3; x <= 9; x++)
+        for (int alpha = 0; alpha <= 1; alpha++)
+        {
+            MicroBitImage expected = image.clone();
+            MicroBitImage actual = image.clone();
+
+            int written = referencePaste(expected, source, x, y, sx, sy, sw, sh, alpha);
+
+            assert(actual.paste(source, x, y, sx, sy, sw, sh, alpha) == written);
+            assert(same(actual, expected));
+        }
+    }
+}
+
+/**
+  * Shifts images of every format and size in each direction, by every distance up to and past their edges.
+  */
+static void testShift()
+{
+    for (int f = 0; f < FORMATS; f++)
+    for (int w = 1; w <= 40; w++)
+    for (int h = 1; h <= 5; h++)
+    {
+        MicroBitImage image(w, h, formats[f]);
+        fill(image, PATTERN_MIXED, w * 11 + h);
+
+        for (int n = -1; n <= w + 1; n++)
+        {
+            MicroBitImage expected = image.clone();
+            MicroBitImage actual = image.clone();
+
+            if (n > 0)
+            {
+                referenceShift(expected, -n, 0);
+                assert(actual.shiftLeft(n) == MICROBIT_OK);
+            }
+            else
+            {
+                assert(actual.shiftLeft(n) == MICROBIT_INVALID_PARAMETER);
+            }
+
+            assert(same(actual, expected));
+
+            expected = image.clone();
+            actual = image.clone();
+
+            if (n > 0)
+            {
+                referenceShift(expected, n, 0);
+                assert(actual.shiftRight(n) == MICROBIT_OK);
+            }
+            else
+            {
+                assert(actual.shiftRight(n) == MICROBIT_INVALID_PARAMETER);
+            }
+
+            assert(same(actual, expected));
+        }
+
+        for (int n = 1; n <= h + 1; n++)
+        {
+            MicroBitImage expected = image.clone();
+            MicroBitImage actual = image.clone();
+
+            referenceShift(expected, 0, -n);
+            assert(actual.shiftUp(n) == MICROBIT_OK);
+            assert(same(actual, expected));
+
+            expected = image.clone();
+            actual = image.clone();
+
+            referenceShift(expected, 0, n);
+            assert(actual.shiftDown(n) == MICROBIT_OK);
+            assert(same(actual, expected));
+        }
+    }
+}
+
+/**
+  * Crops every region of images of every format, including regions clipped by their edges.
+  */
+static void testCrop()
+{
+    for (int f = 0; f < FORMATS; f++)
+    for (int w = 0; w < WIDTHS; w++)
+    {
+        MicroBitImage image(widths[w], 4, formats[f]);
+        fill(image, PATTERN_MIXED, w);
+
+        for (int starty = -1; starty <= 4; starty++)
+        for (int height = 0; height <= 5; height++)
+        for (int startx = -2; startx <= image.getWidth() + 1; startx++)
+        for (int width = 0; width <= image.getWidth() + 2; width++)
+        {
+            MicroBitImage expected = referenceCrop(image, startx, starty, width, height);
+            MicroBitImage actual = image.crop(startx, starty, width, height);
+
+            assert(same(actual, expected));
+        }
+    }
+}
+
+int main()
+{
+    testPaste();
+    testPasteRegion();
+    testShift();
+    testCrop();
+
+    printf("ImageTest: %d comparisons OK\n", comparisons);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+/**
+  * Measures the sustained rate at which small records can be logged with MicroBitLog, and with MicroBitFile::append()
+  * for comparison, modelling the flash timings of the nRF51.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitLog.h"
+#include "MicroBitFile.h"
+
+// The typical time taken to erase a page and write a word of the nRF51 flash, in microseconds.
+#define NRF51_ERASE_TIME        22300
+#define NRF51_WRITE_TIME        46
+
+#define LOG_PAGES               48
+#define RECORDS                 6000
+#define RECORD_SIZE             6
+
+static MicroBitFlashSimulator *simulator;
+
+static void makeRecord(uint8_t *record, uint32_t n)
+{
+    for (int i = 0; i < RECORD_SIZE; i++)
+        record[i] = (uint8_t)(n * 7 + i);
+}
+
+static void report(const char *name)
+{
+    printf("    %-16s %7u words %5u erases %8.0f records/s\n", name, simulator->getWordsWritten(), simulator->getEraseCount(),
+           RECORDS / (simulator->getBusyTime() / 1e6));
+}
+
+/**
+  * Logs RECORDS records with each of MicroBitLog and MicroBitFile, flushing after every given number of records.
+  */
+static void compare(int flushEvery)
+{
+    uint8_t record[RECORD_SIZE];
+
+    printf("flush every %d records:\n", flushEvery);
+
+    hostFlashReset();
+    simulator->resetStatistics();
+
+    {
+        MicroBitLog log((uint32_t)(uintptr_t)hostFlash(), LOG_PAGES, RECORD_SIZE);
+
+        for (int n = 0; n < RECORDS; n++)
+        {
+            makeRecord(record, n);
+            assert(log.append(record, RECORD_SIZE) == MICROBIT_OK);
+
+            if (n % flushEvery == flushEvery - 1)
+                log.flush();
+        }
+
+        log.flush();
+    }
+
+    report("MicroBitLog");
+
+    hostFlashReset();
+
+    MicroBitFileSystem fs((uint32_t)(uintptr_t)hostFlash(), LOG_PAGES);
+    simulator->resetStatistics();
+
+    {
+        MicroBitFile file("log");
+
+        for (int n = 0; n < RECORDS; n++)
+        {
+            makeRecord(record, n);
+            assert(file.append((char *)record, RECORD_SIZE) == RECORD_SIZE);
+
+            if (n % flushEvery == flushEvery - 1)
+                file.flush();
+        }
+
+        file.close();
+    }
+
+    report("MicroBitFile");
+}
+
+int main()
+{
+    simulator = new MicroBitFlashSimulator(hostFlash(), HOST_FLASH_PAGES);
+    simulator->setLatency(NRF51_ERASE_TIME, NRF51_WRITE_TIME);
+    MicroBitFlash::setBackend(simulator);
+
+    compare(16);
+    compare(RECORDS);
+
+    // A ring that has wrapped erases a page for every page of records written.
+    uint8_t record[RECORD_SIZE];
+    MicroBitLog log((uint32_t)(uintptr_t)hostFlash(), 16, RECORD_SIZE, MICROBIT_LOG_RING);
+
+    for (int n = 0; n < 4000; n++)
+    {
+        makeRecord(record, n);
+        log.append(record, RECORD_SIZE);
+    }
+
+    simulator->resetStatistics();
+
+    for (int n = 0; n < RECORDS; n++)
+    {
+        makeRecord(record, n);
+        log.append(record, RECORD_SIZE);
+
+        if (n % 16 == 15)
+            log.flush();
+    }
+
+    printf("wrapped ring, flush every 16 records:\n");
+    report("MicroBitLog");
+
+    return 0;
+}
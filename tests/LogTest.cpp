@@ -0,0 +1,332 @@
+/**
+  * Tests MicroBitLog on simulated flash: fixed and variable length records, reading while writing, ring mode,
+  * and recovery from a loss of power after any flash operation.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitCompat.h"
+#include "MicroBitLog.h"
+
+#define LOG_PAGES       48
+
+static PowerLossSimulator *simulator;
+static uint32_t flashStart;
+
+/**
+  * Fills a record with data derived from its number, which is held in its first four bytes.
+  */
+static void makeRecord(uint8_t *record, uint32_t n, int length)
+{
+    for (int i = 0; i < length; i++)
+        record[i] = (uint8_t)(n * 7 + i);
+
+    memcpy(record, &n, min(length, 4));
+}
+
+/**
+  * Checks the data in a record made by makeRecord().
+  *
+  * @return the number of the record.
+  */
+static uint32_t checkRecord(uint8_t *record, int length)
+{
+    uint32_t n;
+
+    memcpy(&n, record, 4);
+
+    for (int i = 4; i < length; i++)
+        assert(record[i] == (uint8_t)(n * 7 + i));
+
+    return n;
+}
+
+// The length of each variable length record.
+static int recordLength(uint32_t n)
+{
+    return n % 5 == 0 ? 150 + n % 200 : 4 + n % 20;
+}
+
+static void testFixedLength()
+{
+    uint8_t record[6];
+    uint32_t count = 0;
+
+    hostFlashReset();
+
+    MicroBitLog log(flashStart, 4, sizeof(record));
+
+    while (true)
+    {
+        makeRecord(record, count, sizeof(record));
+
+        int result = log.append(record, sizeof(record));
+
+        if (result == MICROBIT_NO_RESOURCES)
+            break;
+
+        assert(result == MICROBIT_OK);
+
+        if (++count % 37 == 0)
+            log.flush();
+    }
+
+    assert(log.append(record, 5) == MICROBIT_INVALID_PARAMETER);
+    log.flush();
+
+    MicroBitLog reloaded(flashStart, 4, sizeof(record));
+    uint32_t n = 0;
+    int length;
+
+    while ((length = reloaded.read(record, sizeof(record))) > 0)
+    {
+        assert(length == sizeof(record));
+        assert(checkRecord(record, length) == n++);
+    }
+
+    assert(n == count);
+    assert(reloaded.append(record, sizeof(record)) == MICROBIT_NO_RESOURCES);
+
+    reloaded.clear();
+    assert(reloaded.getPagesUsed() == 0);
+}
+
+static void testVariableLength()
+{
+    uint8_t record[MICROBIT_LOG_MAX_RECORD_SIZE];
+    uint32_t count = 0;
+    int length;
+
+    hostFlashReset();
+    srand(1);
+
+    {
+        MicroBitLog log(flashStart, LOG_PAGES);
+
+        for (; count < 300; count++)
+        {
+            makeRecord(record, count, recordLength(count));
+            assert(log.append(record, recordLength(count)) == MICROBIT_OK);
+
+            if (rand() % 7 == 0)
+                log.flush();
+        }
+    }
+
+    {
+        MicroBitLog log(flashStart, LOG_PAGES);
+
+        for (; count < 600; count++)
+        {
+            makeRecord(record, count, recordLength(count));
+            assert(log.append(record, recordLength(count)) == MICROBIT_OK);
+
+            if (rand() % 7 == 0)
+                log.flush();
+
+            // Records that have not been flushed can be read back too.
+            if (count == 450)
+            {
+                uint32_t n = 0;
+
+                log.rewind();
+
+                while ((length = log.read(record, sizeof(record))) > 0)
+                {
+                    assert(length == recordLength(n));
+                    assert(checkRecord(record, length) == n++);
+                }
+
+                assert(n == 451);
+            }
+        }
+
+        assert(log.append(record, 0) == MICROBIT_INVALID_PARAMETER);
+        assert(log.append(record, MICROBIT_LOG_MAX_RECORD_SIZE + 1) == MICROBIT_INVALID_PARAMETER);
+
+        makeRecord(record, count, MICROBIT_LOG_MAX_RECORD_SIZE);
+        assert(log.append(record, MICROBIT_LOG_MAX_RECORD_SIZE) == MICROBIT_OK);
+        count++;
+    }
+
+    {
+        MicroBitLog log(flashStart, LOG_PAGES);
+        uint32_t n = 0;
+
+        while ((length = log.read(record, sizeof(record))) > 0)
+        {
+            assert(length == (n == 600 ? (int)MICROBIT_LOG_MAX_RECORD_SIZE : recordLength(n)));
+            assert(checkRecord(record, length) == n++);
+        }
+
+        assert(n == count);
+    }
+
+    // Opening the log with a different record size clears it.
+    MicroBitLog log(flashStart, LOG_PAGES, 6);
+
+    assert(log.getPagesUsed() == 0);
+    assert(log.read(record, sizeof(record)) == MICROBIT_NO_DATA);
+}
+
+static void testRing()
+{
+    uint8_t record[6];
+    uint32_t count = 0;
+    uint32_t n;
+    int length;
+
+    hostFlashReset();
+
+    {
+        MicroBitLog log(flashStart, 4, sizeof(record), MICROBIT_LOG_RING);
+
+        for (; count < 100; count++)
+        {
+            makeRecord(record, count, sizeof(record));
+            assert(log.append(record, sizeof(record)) == MICROBIT_OK);
+        }
+
+        assert(log.read(record, sizeof(record)) == sizeof(record));
+        assert(checkRecord(record, sizeof(record)) == 0);
+
+        for (; count < 5000; count++)
+        {
+            makeRecord(record, count, sizeof(record));
+            assert(log.append(record, sizeof(record)) == MICROBIT_OK);
+        }
+
+        // The writer has overtaken the reader, which restarts from the oldest record.
+        assert(log.read(record, sizeof(record)) == sizeof(record));
+        n = checkRecord(record, sizeof(record));
+        assert(n > 100);
+
+        while ((length = log.read(record, sizeof(record))) > 0)
+            assert(checkRecord(record, length) == ++n);
+
+        assert(n == count - 1);
+    }
+
+    MicroBitLog log(flashStart, 4, sizeof(record), MICROBIT_LOG_RING);
+    uint32_t first = 0;
+    uint32_t read = 0;
+
+    while ((length = log.read(record, sizeof(record))) > 0)
+    {
+        n = checkRecord(record, length);
+
+        if (read == 0)
+            first = n;
+
+        assert(n == first + read++);
+    }
+
+    assert(first + read == count);
+    assert(simulator->getViolations() == 0);
+}
+
+/**
+  * Loses power after every possible number of flash operations while logging, and checks that every record
+  * flushed before then is recovered intact, in order, and that logging can continue.
+  */
+static void testPowerLoss()
+{
+    uint8_t record[MICROBIT_LOG_MAX_RECORD_SIZE];
+    int length;
+
+    for (int operations = 0; ; operations++)
+    {
+        uint32_t durable = 0;
+        bool poweredDown = false;
+
+        hostFlashReset();
+
+        MicroBitLog *log = new MicroBitLog(flashStart, 3, 0, MICROBIT_LOG_RING);
+
+        simulator->losePowerAfter(operations);
+
+        try
+        {
+            for (uint32_t n = 0; n < 400; n++)
+            {
+                makeRecord(record, n, recordLength(n));
+                log->append(record, recordLength(n));
+
+                if (n % 9 == 8)
+                {
+                    log->flush();
+                    durable = n + 1;
+                }
+            }
+        }
+        catch (PowerLoss)
+        {
+            poweredDown = true;
+        }
+
+        simulator->losePowerAfter(-1);
+        simulator->powerUp();
+
+        if (!poweredDown)
+        {
+            delete log;
+            printf("LogTest: recovered from a loss of power at %d points\n", operations);
+            break;
+        }
+
+        MicroBitLog recovered(flashStart, 3, 0, MICROBIT_LOG_RING);
+        uint32_t read = 0;
+        uint32_t next = 0;
+
+        while ((length = recovered.read(record, sizeof(record))) > 0)
+        {
+            uint32_t n = checkRecord(record, length);
+
+            assert(length == recordLength(n));
+            assert(read == 0 || n == next);
+
+            next = n + 1;
+            read++;
+        }
+
+        assert(durable == 0 || next >= durable);
+
+        for (uint32_t n = 1000; n < 1020; n++)
+        {
+            makeRecord(record, n, 8);
+            assert(recovered.append(record, 8) == MICROBIT_OK);
+        }
+
+        recovered.flush();
+
+        MicroBitLog reloaded(flashStart, 3, 0, MICROBIT_LOG_RING);
+        int appended = 0;
+
+        while ((length = reloaded.read(record, sizeof(record))) > 0)
+            if (checkRecord(record, length) >= 1000)
+                appended++;
+
+        assert(appended == 20);
+        assert(simulator->getViolations() == 0);
+
+        delete log;
+    }
+}
+
+int main()
+{
+    uint32_t *flash = hostFlash();
+
+    simulator = new PowerLossSimulator(flash, HOST_FLASH_PAGES);
+    MicroBitFlash::setBackend(simulator);
+
+    flashStart = (uint32_t)(uintptr_t)flash;
+
+    testFixedLength();
+    testVariableLength();
+    testRing();
+    testPowerLoss();
+
+    printf("LogTest: OK\n");
+
+    return 0;
+}
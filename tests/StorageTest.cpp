@@ -0,0 +1,247 @@
+/**
+  * Tests MicroBitStorage on simulated flash: migration of the legacy format, sharing of the store between instances,
+  * compaction, and recovery from a loss of power part way through any update.
+  */
+#include <assert.h>
+#include "HostRuntime.h"
+#include "MicroBitStorage.h"
+
+static PowerLossSimulator *simulator;
+
+// The pages used by MicroBitStorage.
+static uint32_t *storePage;
+static uint32_t *scratchPage;
+
+/**
+  * Determines the value of a key, as a single byte.
+  *
+  * @return the value, or -1 if the key is not in the store.
+  */
+static int value(MicroBitStorage &storage, const char *key)
+{
+    KeyValuePair *pair = storage.get(key);
+
+    if (pair == NULL)
+        return -1;
+
+    int v = pair->value[0];
+    delete pair;
+
+    return v;
+}
+
+static int put(MicroBitStorage &storage, const char *key, uint8_t v)
+{
+    return storage.put(key, &v, 1);
+}
+
+/**
+  * Writes a store in the legacy format, holding as many pairs as its page can.
+  */
+static int writeLegacyStore()
+{
+    int pairs = (PAGE_SIZE - sizeof(KeyValueStore)) / sizeof(KeyValuePair);
+    KeyValueStore store(MICROBIT_STORAGE_MAGIC, pairs);
+    KeyValuePair *pair = (KeyValuePair *)(storePage + sizeof(KeyValueStore) / 4);
+
+    hostFlashReset();
+    memcpy(storePage, &store, sizeof(store));
+
+    for (int i = 0; i < pairs; i++, pair++)
+    {
+        memset(pair, 0, sizeof(KeyValuePair));
+        sprintf((char *)pair->key, "legacy%d", i);
+        pair->value[0] = i;
+    }
+
+    return pairs;
+}
+
+static void testLegacyMigration()
+{
+    int pairs = writeLegacyStore();
+
+    MicroBitStorage storage;
+
+    assert(storage.size() == pairs);
+
+    for (int i = 0; i < pairs; i++)
+    {
+        char key[16];
+        sprintf(key, "legacy%d", i);
+        assert(value(storage, key) == i);
+    }
+
+    // The store is full, but every key can still be updated and removed.
+    assert(put(storage, "another", 1) == MICROBIT_NO_RESOURCES);
+
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < pairs; i++)
+        {
+            char key[16];
+            sprintf(key, "legacy%d", i);
+            assert(put(storage, key, i + round + 1) == MICROBIT_OK);
+        }
+    }
+
+    assert(storage.remove("legacy0") == MICROBIT_OK);
+    assert(storage.remove("legacy0") == MICROBIT_NO_DATA);
+    assert(put(storage, "another", 1) == MICROBIT_OK);
+
+    MicroBitStorage reloaded;
+
+    assert(reloaded.size() == pairs);
+    assert(value(reloaded, "legacy0") == -1);
+    assert(value(reloaded, "legacy5") == 8);
+    assert(value(reloaded, "another") == 1);
+}
+
+static void testSharedInstances()
+{
+    hostFlashReset();
+
+    MicroBitStorage first;
+    MicroBitStorage second;
+
+    // Each instance must see the updates made through the other, including across compactions.
+    for (int i = 0; i < 100; i++)
+    {
+        char key[16];
+        sprintf(key, "key%d", i % 7);
+
+        assert(put(i % 2 ? first : second, key, i) == MICROBIT_OK);
+        assert(value(i % 2 ? second : first, key) == i);
+        assert(first.size() == second.size());
+    }
+
+    assert(first.remove("key3") == MICROBIT_OK);
+    assert(value(second, "key3") == -1);
+    assert(second.size() == 6);
+}
+
+static void testCapacity()
+{
+    hostFlashReset();
+
+    MicroBitStorage storage;
+    int stored = 0;
+
+    for (int i = 0; i < 30; i++)
+    {
+        char key[16];
+        sprintf(key, "k%d", i);
+
+        if (put(storage, key, i) == MICROBIT_OK)
+            stored++;
+    }
+
+    assert(stored == (int)((PAGE_SIZE - sizeof(KeyValueLogHeader)) / sizeof(KeyValuePair)));
+    assert(storage.size() == stored);
+    assert(simulator->getViolations() == 0);
+}
+
+/**
+  * Loses power after every possible number of flash operations during an update, and checks that the store
+  * always recovers either the old or the new value, with every other key intact.
+  */
+static void testPowerLoss()
+{
+    static uint32_t snapshot[3 * PAGE_SIZE / 4];
+    uint32_t *pages = hostFlash() + HOST_STORAGE_PAGE * PAGE_SIZE / 4;
+
+    hostFlashReset();
+
+    {
+        MicroBitStorage storage;
+
+        for (int i = 0; i < 12; i++)
+        {
+            char key[16];
+            sprintf(key, "key%d", i);
+            assert(put(storage, key, i) == MICROBIT_OK);
+        }
+    }
+
+    memcpy(snapshot, pages, sizeof(snapshot));
+
+    // Repeat the same updates with power lost at a later point each time, until the updates complete.
+    for (int operations = 0; ; operations++)
+    {
+        memcpy(pages, snapshot, sizeof(snapshot));
+
+        MicroBitStorage storage;
+        bool poweredDown = false;
+
+        simulator->losePowerAfter(operations);
+
+        try
+        {
+            for (int i = 0; i < 12; i++)
+            {
+                char key[16];
+                sprintf(key, "key%d", i);
+                assert(put(storage, key, 100 + i) == MICROBIT_OK);
+            }
+
+            assert(storage.remove("key0") == MICROBIT_OK);
+        }
+        catch (PowerLoss)
+        {
+            poweredDown = true;
+        }
+
+        simulator->losePowerAfter(-1);
+        simulator->powerUp();
+
+        MicroBitStorage recovered;
+        int updated = 0;
+
+        for (int i = 1; i < 12; i++)
+        {
+            char key[16];
+            sprintf(key, "key%d", i);
+
+            int v = value(recovered, key);
+            assert(v == i || v == 100 + i);
+
+            if (v == 100 + i)
+                updated++;
+        }
+
+        int v = value(recovered, "key0");
+        assert(v == 0 || v == 100 || v == -1);
+        assert(recovered.size() == (v == -1 ? 11 : 12));
+
+        // The store must remain usable.
+        assert(put(recovered, "key1", 42) == MICROBIT_OK);
+        assert(value(recovered, "key1") == 42);
+
+        if (!poweredDown)
+        {
+            assert(updated == 11 && v == -1);
+            printf("StorageTest: recovered from a loss of power at %d points\n", operations);
+            break;
+        }
+    }
+}
+
+int main()
+{
+    uint32_t *flash = hostFlash();
+
+    simulator = new PowerLossSimulator(flash, HOST_FLASH_PAGES);
+    MicroBitFlash::setBackend(simulator);
+
+    scratchPage = flash + HOST_STORAGE_PAGE * PAGE_SIZE / 4;
+    storePage = scratchPage + 2 * PAGE_SIZE / 4;
+
+    testLegacyMigration();
+    testSharedInstances();
+    testCapacity();
+    testPowerLoss();
+
+    printf("StorageTest: OK\n");
+
+    return 0;
+}
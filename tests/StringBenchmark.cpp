@@ -0,0 +1,82 @@
+/**
+  * Measures the heap allocations made by ManagedString in typical print, scroll and serial workloads, and the rate
+  * at which they are made on the host. Built as StringBenchmarkNoPool without the pool of short strings, for comparison.
+  */
+#include <assert.h>
+#include <chrono>
+#include "HostRuntime.h"
+#include "ManagedString.h"
+
+#define ITERATIONS              100000
+
+// Count the heap allocations made, by wrapping the allocator of the C library.
+extern "C" void *__libc_malloc(size_t size);
+
+static uint32_t allocations = 0;
+
+extern "C" void *malloc(size_t size)
+{
+    allocations++;
+    return __libc_malloc(size);
+}
+
+/**
+  * Printing a counter on the display, as MicroBitDisplay::print(int) does.
+  */
+static int printCounter(int i)
+{
+    ManagedString s(i % 1000);
+
+    return s.length();
+}
+
+/**
+  * Building a short message to scroll across the display.
+  */
+static int scrollReading(int i)
+{
+    ManagedString s = ManagedString("T:") + ManagedString(i % 40) + "C";
+
+    return s.length();
+}
+
+/**
+  * Sending a line of readings over serial, and splitting a received command into its fields.
+  */
+static int serialLine(int i)
+{
+    ManagedString line = ManagedString(i % 1024) + "," + ManagedString(-(i % 512)) + "\r\n";
+    ManagedString command("led 2 3");
+
+    return line.length() + command.substring(0, 3).length() + command.substring(4, 1).length() + command.substring(6, 1).length();
+}
+
+static void run(const char *name, int (*workload)(int))
+{
+    int total = 0;
+
+    uint32_t start = allocations;
+    std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ITERATIONS; i++)
+        total += workload(i);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+    uint32_t n = allocations - start;
+
+    assert(total > 0);
+
+    printf("    %-16s %6.2f allocations/op %12.0f allocations/s %10.0f ops/s\n", name, (double)n / ITERATIONS, n / seconds,
+           ITERATIONS / seconds);
+}
+
+int main()
+{
+    printf("string pool of %d blocks:\n", MICROBIT_STRING_POOL_SIZE);
+
+    run("print counter", printCounter);
+    run("scroll reading", scrollReading);
+    run("serial line", serialLine);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+/**
+  * Tests the formatted numeric appends of ManagedStringBuilder, and that appends which are dropped are reported
+  * through isValid().
+  */
+#include <assert.h>
+#include <limits.h>
+#include "HostRuntime.h"
+#include "ManagedStringBuilder.h"
+
+// Checks the string built so far, then empties the builder.
+static void expect(ManagedStringBuilder &b, const char *expected)
+{
+    if (strcmp(b.toCharArray(), expected) != 0)
+    {
+        printf("StringBuilderTest: got \"%s\", expected \"%s\"\n", b.toCharArray(), expected);
+        exit(1);
+    }
+
+    assert(b.isValid());
+    b.clear();
+}
+
+int main()
+{
+    ManagedStringBuilder b;
+
+    b.append(0).append(',').append(-7).append(',').append(INT_MAX).append(',').append(INT_MIN);
+    expect(b, "0,-7,2147483647,-2147483648");
+
+    b.append(42, 5).append('|').append(-42, 5).append('|').append(-42, 5, '0').append('|').append(123456, 3);
+    expect(b, "   42|  -42|-0042|123456");
+
+    b.appendUnsigned(0).append(',').appendUnsigned(UINT_MAX).append(',').appendUnsigned(1234, 8, '0');
+    expect(b, "0,4294967295,00001234");
+
+    b.appendHex(0).append(',').appendHex(0x2a, 4).append(',').appendHex(0xDEADBEEF).append(',').appendHex(0xDEADBEEF, 2);
+    expect(b, "0,002A,DEADBEEF,DEADBEEF");
+
+    b.appendFixed(-1250, 3).append(',').appendFixed(5, 2).append(',').appendFixed(-5, 2).append(',').appendFixed(12345, 0);
+    expect(b, "-1.250,0.05,-0.05,12345");
+
+    b.appendFixed(7, 1, 6).append(',').appendFixed(INT_MIN, 9);
+    expect(b, "   0.7,-2.147483648");
+
+    b.append("x=").append(-3, 4, '0').append(",t=").appendFixed(2150, 2).append(",id=").appendHex(0xBEEF, 8);
+    expect(b, "x=-003,t=21.50,id=0000BEEF");
+
+    // Numbers with an invalid format are dropped, and reported.
+    b.append("a").append(1, MANAGED_STRING_BUILDER_MAX_WIDTH + 1).appendFixed(1, MANAGED_STRING_BUILDER_MAX_DECIMALS + 1);
+    assert(!b.isValid() && strcmp(b.toCharArray(), "a") == 0);
+
+    b.clear();
+    assert(b.isValid() && b.length() == 0);
+
+    // Text that would exceed the largest capacity is dropped, and reported, until the builder is emptied.
+    char block[1024];
+    memset(block, 'z', sizeof(block));
+
+    while (b.length() + (int)sizeof(block) <= MANAGED_STRING_BUILDER_MAX_CAPACITY)
+        b.append(block, sizeof(block));
+
+    int length = b.length();
+    assert(b.isValid());
+
+    b.append(block, sizeof(block)).append(1);
+    assert(!b.isValid() && b.length() == length + 1);
+
+    ManagedString s = b.toManagedString();
+    assert(s.length() == length + 1);
+    assert(b.isValid() && b.length() == 0);
+
+    b.append(12, 3, '0');
+    expect(b, "012");
+
+    printf("StringBuilderTest: OK\n");
+
+    return 0;
+}
@@ -0,0 +1,300 @@
+/**
+  * Support for running parts of the runtime on the host, for the tests and benchmarks in this directory.
+  */
+#include <sys/mman.h>
+#include <chrono>
+#include "HostRuntime.h"
+#include "MicroBitLightSensor.h"
+#include "MicroBitFiber.h"
+#include "MicroBitSystemTimer.h"
+#include "nrf_soc.h"
+
+static NRF_FICR_Type ficr = { PAGE_SIZE, HOST_FLASH_BASE / PAGE_SIZE + HOST_STORAGE_PAGE + 19 };
+// The NVMC is always ready. Words outside the simulated flash are written directly, but their pages are never erased.
+static NRF_NVMC_Type nvmc = { NVMC_READY_READY_Ready };
+
+NRF_FICR_Type *NRF_FICR = &ficr;
+NRF_NVMC_Type *NRF_NVMC = &nvmc;
+
+uint64_t hostTime = 0;
+
+uint64_t hostTimeUs = 0;
+uint32_t hostTimerCalls = 0;
+double hostTimerSeconds = 0;
+
+void (*hostPortWrite)(uint32_t value, uint32_t mask) = NULL;
+
+// The timers awaiting a call, in the order they were scheduled.
+static Timeout *timers = NULL;
+
+static uint32_t *flash = NULL;
+
+uint32_t *hostFlash()
+{
+    if (flash == NULL)
+    {
+        void *region = mmap((void *)HOST_FLASH_BASE, HOST_FLASH_PAGES * PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (region != (void *)HOST_FLASH_BASE)
+        {
+            fprintf(stderr, "unable to map the simulated flash at 0x%x\n", HOST_FLASH_BASE);
+            exit(1);
+        }
+
+        flash = (uint32_t *)region;
+        hostFlashReset();
+    }
+
+    return flash;
+}
+
+void hostFlashReset()
+{
+    memset(hostFlash(), 0xFF, HOST_FLASH_PAGES * PAGE_SIZE);
+}
+
+uint8_t *hostRam()
+{
+    static uint8_t *ram = NULL;
+
+    if (ram == NULL)
+    {
+        void *region = mmap((void *)HOST_RAM_BASE, HOST_RAM_SIZE, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (region != (void *)HOST_RAM_BASE)
+        {
+            fprintf(stderr, "unable to map the simulated SRAM at 0x%x\n", HOST_RAM_BASE);
+            exit(1);
+        }
+
+        ram = (uint8_t *)region;
+    }
+
+    return ram;
+}
+
+void microbit_panic(int code)
+{
+    fprintf(stderr, "panic %d\n", code);
+    abort();
+}
+
+extern "C" void btle_set_user_evt_handler(void (*)(uint32_t))
+{
+}
+
+bool ble_running()
+{
+    return false;
+}
+
+uint32_t sd_flash_page_erase(uint32_t)
+{
+    return NRF_ERROR_BUSY;
+}
+
+uint32_t sd_flash_write(uint32_t *, uint32_t const *, uint32_t)
+{
+    return NRF_ERROR_BUSY;
+}
+
+int fiber_scheduler_running()
+{
+    return 0;
+}
+
+int fiber_wake_on_event(uint16_t, uint16_t)
+{
+    return MICROBIT_NOT_SUPPORTED;
+}
+
+int fiber_wait_for_event(uint16_t, uint16_t)
+{
+    return MICROBIT_NOT_SUPPORTED;
+}
+
+void schedule()
+{
+}
+
+void fiber_sleep(unsigned long)
+{
+}
+
+int fiber_add_idle_component(MicroBitComponent *)
+{
+    return MICROBIT_OK;
+}
+
+int fiber_remove_idle_component(MicroBitComponent *)
+{
+    return MICROBIT_OK;
+}
+
+uint64_t system_timer_current_time()
+{
+    return hostTime;
+}
+
+uint64_t system_timer_current_time_us()
+{
+    return (uint64_t)hostTime * 1000;
+}
+
+void Timeout::schedule(uint32_t us, uint32_t period)
+{
+    detach();
+
+    this->due = hostTimeUs + us;
+    this->period = period;
+
+    Timeout **p = &timers;
+
+    while (*p != NULL)
+        p = &(*p)->next;
+
+    *p = this;
+    next = NULL;
+}
+
+void Timeout::detach()
+{
+    for (Timeout **p = &timers; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == this)
+        {
+            *p = next;
+            break;
+        }
+    }
+}
+
+void hostRunTimers(uint32_t us)
+{
+    uint64_t end = hostTimeUs + us;
+
+    while (true)
+    {
+        Timeout *t = NULL;
+
+        // Timers due at the same time are called in the order they were scheduled.
+        for (Timeout *p = timers; p != NULL; p = p->next)
+            if (p->due <= end && (t == NULL || p->due < t->due))
+                t = p;
+
+        if (t == NULL)
+            break;
+
+        hostTimeUs = t->due;
+        t->detach();
+
+        if (t->period)
+            t->schedule(t->period, t->period);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        t->call();
+
+        hostTimerSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        hostTimerCalls++;
+    }
+
+    hostTimeUs = end;
+}
+
+void PortOut::write(int value)
+{
+    if (hostPortWrite)
+        hostPortWrite(value & mask, mask);
+}
+
+static unsigned int tick_period = 0;
+static MicroBitComponent *systemTickComponents[MICROBIT_SYSTEM_COMPONENTS];
+static Ticker ticker;
+
+int system_timer_init(int period)
+{
+    return system_timer_set_period(period);
+}
+
+int system_timer_set_period(int period)
+{
+    if (period < 1)
+        return MICROBIT_INVALID_PARAMETER;
+
+    tick_period = period;
+    ticker.attach_us(system_timer_tick, period * 1000);
+
+    return MICROBIT_OK;
+}
+
+int system_timer_get_period()
+{
+    return tick_period;
+}
+
+void system_timer_tick()
+{
+    for (int i = 0; i < MICROBIT_SYSTEM_COMPONENTS; i++)
+        if (systemTickComponents[i] != NULL)
+            systemTickComponents[i]->systemTick();
+}
+
+int system_timer_add_component(MicroBitComponent *component)
+{
+    if (tick_period == 0)
+        system_timer_init(SYSTEM_TICK_PERIOD_MS);
+
+    for (int i = 0; i < MICROBIT_SYSTEM_COMPONENTS; i++)
+    {
+        if (systemTickComponents[i] == NULL)
+        {
+            systemTickComponents[i] = component;
+            return MICROBIT_OK;
+        }
+    }
+
+    return MICROBIT_NO_RESOURCES;
+}
+
+int system_timer_remove_component(MicroBitComponent *component)
+{
+    for (int i = 0; i < MICROBIT_SYSTEM_COMPONENTS; i++)
+    {
+        if (systemTickComponents[i] == component)
+        {
+            systemTickComponents[i] = NULL;
+            return MICROBIT_OK;
+        }
+    }
+
+    return MICROBIT_INVALID_PARAMETER;
+}
+
+// The light sensor samples through the ADC, so is never available. The display senses light only when asked.
+MicroBitLightSensor::MicroBitLightSensor(const MatrixMap &map) : matrixMap(map)
+{
+}
+
+int MicroBitLightSensor::read()
+{
+    return 0;
+}
+
+bool MicroBitLightSensor::isSampleNeeded()
+{
+    return false;
+}
+
+bool MicroBitLightSensor::isSensing()
+{
+    return false;
+}
+
+void MicroBitLightSensor::idleTick()
+{
+}
+
+MicroBitLightSensor::~MicroBitLightSensor()
+{
+}
@@ -0,0 +1,102 @@
+/**
+  * Support for running parts of the runtime on the host, for the tests and benchmarks in this directory.
+  *
+  * The fiber scheduler is never started, so blocking calls perform spinning waits, and there is no event bus.
+  * Flash is simulated in RAM by MicroBitFlashSimulator. The system timer and the mbed timers run only when a test
+  * advances the simulated microsecond timer, and the light sensor is not simulated.
+  */
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+#include "MicroBitConfig.h"
+#include "MicroBitCompat.h"
+#include "ErrorNo.h"
+#include "MicroBitFlashSimulator.h"
+
+// The runtime holds addresses in 32 bit integers, so the simulated flash must lie in the lowest 4GB of the address space.
+#define HOST_FLASH_BASE         0x10000000
+#define HOST_FLASH_PAGES        128
+
+// MicroBitStorage uses the last three pages of the simulated flash.
+#define HOST_STORAGE_PAGE       (HOST_FLASH_PAGES - 3)
+#define HOST_STORAGE_PAGES      3
+
+/**
+  * Maps the simulated flash on first use, with every page erased.
+  *
+  * @return the address of the first page.
+  */
+uint32_t *hostFlash();
+
+/**
+  * Erases every page of the simulated flash, without recording any erase.
+  */
+void hostFlashReset();
+
+// The simulated SRAM, at the address of the nRF51 SRAM, for tests of the heap allocator.
+#define HOST_RAM_BASE           0x20000000
+#define HOST_RAM_SIZE           0x4000
+
+/**
+  * Maps the simulated SRAM on first use, with every byte zeroed.
+  *
+  * @return the address of the first byte.
+  */
+uint8_t *hostRam();
+
+// The time returned by system_timer_current_time(), in milliseconds. Advanced only by the tests.
+extern uint64_t hostTime;
+
+// The time of the simulated microsecond timer that runs the callbacks of Timeout and Ticker.
+extern uint64_t hostTimeUs;
+
+// The number of timer callbacks made by hostRunTimers(), and the time spent in them on the host, in seconds.
+extern uint32_t hostTimerCalls;
+extern double hostTimerSeconds;
+
+/**
+  * Advances the simulated microsecond timer, making every timer callback that falls due on the way in order of time.
+  *
+  * @param us the number of microseconds to advance the timer by.
+  */
+void hostRunTimers(uint32_t us);
+
+// Called with the value of each write to a PortOut, and the pins it drives. NULL if writes are not observed.
+extern void (*hostPortWrite)(uint32_t value, uint32_t mask);
+
+// Thrown when a scheduled loss of power occurs, to abandon the operation in progress as a reset would.
+struct PowerLoss {};
+
+/**
+  * A MicroBitFlashSimulator that throws PowerLoss as soon as power is lost, rather than ignoring later operations.
+  */
+class PowerLossSimulator : public MicroBitFlashSimulator
+{
+    public:
+
+    PowerLossSimulator(uint32_t *base, int pages) : MicroBitFlashSimulator(base, pages)
+    {
+    }
+
+    virtual int erasePage(uint32_t *page_address)
+    {
+        int result = MicroBitFlashSimulator::erasePage(page_address);
+
+        if (isPoweredDown())
+            throw PowerLoss();
+
+        return result;
+    }
+
+    virtual int write(uint32_t *address, uint32_t *buffer, int len)
+    {
+        int result = MicroBitFlashSimulator::write(address, buffer, len);
+
+        if (isPoweredDown())
+            throw PowerLoss();
+
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,170 @@
+/**
+  * A minimal stand in for the mbed and nRF51 headers, sufficient to build the parts of the runtime
+  * exercised by the host tests. Flash is programmed through MicroBitFlashSimulator, so the NVMC is never used.
+  */
+#ifndef HOST_MBED_H
+#define HOST_MBED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static inline void __disable_irq() {}
+static inline void __enable_irq() {}
+static inline void __WFE() {}
+static inline void __WFI() {}
+static inline uint32_t __get_IPSR() { return 0; }
+
+static inline void wait_ms(int) {}
+static inline void wait_us(int) {}
+
+typedef enum {
+    p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15,
+    p16, p17, p18, p19, p20, p21, p22, p23, p24, p25, p26, p27, p28, p29, p30,
+    NC = -1
+} PinName;
+
+typedef enum { Port0 } PortName;
+
+typedef enum { PullNone, PullDown, PullUp } PinMode;
+
+/**
+  * Timeout and Ticker run their callbacks on a simulated microsecond timer, which advances only when a test
+  * calls hostRunTimers(). A callback may attach or detach any timer, including its own.
+  */
+struct Timeout
+{
+    Timeout() : due(0), period(0), next(NULL), object(NULL), invoke(NULL) {}
+    ~Timeout() { detach(); }
+
+    template <typename T> void attach_us(T *object, void (T::*method)(), uint32_t us)
+    {
+        bind(object, method);
+        schedule(us, 0);
+    }
+
+    void attach_us(void (*function)(), uint32_t us)
+    {
+        bind(function);
+        schedule(us, 0);
+    }
+
+    void detach();
+
+    // Schedules the next call, after us microseconds, then every period microseconds if period is not zero.
+    void schedule(uint32_t us, uint32_t period);
+
+    // Calls the attached function, or method of the attached object.
+    void call() { invoke(this); }
+
+    // The time of the next call, in microseconds of the simulated timer.
+    uint64_t due;
+
+    // The time between calls of a Ticker, or zero for a Timeout.
+    uint32_t period;
+
+    // The next timer awaiting a call, in the list kept by hostRunTimers().
+    Timeout *next;
+
+    protected:
+
+    template <typename T> void bind(T *object, void (T::*method)())
+    {
+        static_assert(sizeof(method) <= sizeof(this->method), "member function pointer too large");
+
+        this->object = object;
+        memcpy(this->method, &method, sizeof(method));
+        invoke = &callMethod<T>;
+    }
+
+    void bind(void (*function)())
+    {
+        this->object = (void *)function;
+        invoke = &callFunction;
+    }
+
+    private:
+
+    template <typename T> static void callMethod(Timeout *t)
+    {
+        void (T::*method)();
+
+        memcpy(&method, t->method, sizeof(method));
+        (((T *)t->object)->*method)();
+    }
+
+    static void callFunction(Timeout *t)
+    {
+        ((void (*)())t->object)();
+    }
+
+    void *object;
+    char method[2 * sizeof(void *)];
+    void (*invoke)(Timeout *);
+};
+
+struct Ticker : Timeout
+{
+    template <typename T> void attach_us(T *object, void (T::*method)(), uint32_t us)
+    {
+        bind(object, method);
+        schedule(us, us);
+    }
+
+    void attach_us(void (*function)(), uint32_t us)
+    {
+        bind(function);
+        schedule(us, us);
+    }
+};
+
+/**
+  * Every value written to a PortOut is passed to hostPortWrite(), with the time at which it was written.
+  */
+struct PortOut
+{
+    PortOut(int, int mask = 0) : mask(mask) {}
+
+    void write(int value);
+
+    PortOut &operator=(int value)
+    {
+        write(value);
+        return *this;
+    }
+
+    int mask;
+};
+
+struct PortIn
+{
+    PortIn(int, int = 0) {}
+    void mode(PinMode) {}
+};
+
+struct NRF_FICR_Type
+{
+    uint32_t CODEPAGESIZE;
+    uint32_t CODESIZE;
+};
+
+struct NRF_NVMC_Type
+{
+    uint32_t READY;
+    uint32_t CONFIG;
+    uint32_t ERASEPAGE;
+};
+
+extern NRF_FICR_Type *NRF_FICR;
+extern NRF_NVMC_Type *NRF_NVMC;
+
+#define NVMC_CONFIG_WEN_Ren     0
+#define NVMC_CONFIG_WEN_Wen     1
+#define NVMC_CONFIG_WEN_Een     2
+#define NVMC_CONFIG_WEN_Pos     0
+#define NVMC_READY_READY_Busy   0
+#define NVMC_READY_READY_Ready  1
+
+#endif
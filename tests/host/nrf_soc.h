@@ -0,0 +1,18 @@
+/**
+  * A minimal stand in for the SoftDevice API used by MicroBitFlash. The host tests never run the SoftDevice.
+  */
+#ifndef HOST_NRF_SOC_H
+#define HOST_NRF_SOC_H
+
+#include <stdint.h>
+
+#define NRF_SUCCESS                         0
+#define NRF_ERROR_BUSY                      17
+
+#define NRF_EVT_FLASH_OPERATION_SUCCESS     2
+#define NRF_EVT_FLASH_OPERATION_ERROR       3
+
+uint32_t sd_flash_page_erase(uint32_t page_number);
+uint32_t sd_flash_write(uint32_t *p_dst, uint32_t const *p_src, uint32_t size);
+
+#endif
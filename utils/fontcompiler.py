@@ -0,0 +1,141 @@
+#!/usr/bin/env python
+"""
+Font compiler for MicroBitFont.
+
+Generates the glyph, metrics and kerning tables of a proportional MicroBitFont
+from a text description of the font, for inclusion in a C++ source file.
+
+The description contains one block per character, and optional kerning pairs:
+
+    ; Anything after a semicolon is a comment.
+    char A
+    .##.
+    #..#
+    ####
+    #..#
+    #..#
+
+    char 0x20 2        ; a character may be given as a code, and an explicit width
+
+    kern A V -1        ; adjust the space between A and V by -1 columns
+
+Glyph rows are up to five columns wide, with '#' for a lit pixel. Each glyph's
+metrics are taken from the columns it uses, unless a width is given explicitly.
+Characters that are not described are left blank.
+
+Usage: fontcompiler.py <description> <name> [output]
+"""
+
+import sys
+
+FONT_WIDTH = 5
+FONT_HEIGHT = 5
+ASCII_START = 32
+ASCII_END = 126
+
+
+def parse_char(token):
+    if len(token) == 1:
+        return ord(token)
+    return int(token, 0)
+
+
+def parse(lines):
+    glyphs = {}
+    widths = {}
+    kerning = []
+    current = None
+
+    for number, line in enumerate(lines, 1):
+        line = line.split(';', 1)[0].rstrip()
+        if not line.strip():
+            continue
+
+        words = line.split()
+
+        if words[0] == 'char':
+            current = parse_char(words[1])
+            if current < ASCII_START or current > ASCII_END:
+                raise ValueError('line %d: character %d is out of range' % (number, current))
+            glyphs[current] = []
+            if len(words) > 2:
+                widths[current] = int(words[2])
+        elif words[0] == 'kern':
+            kerning.append((parse_char(words[1]), parse_char(words[2]), int(words[3])))
+        elif current is not None:
+            row = line.strip()
+            if len(row) > FONT_WIDTH or len(glyphs[current]) == FONT_HEIGHT:
+                raise ValueError('line %d: glyph is larger than %dx%d' % (number, FONT_WIDTH, FONT_HEIGHT))
+            glyphs[current].append(row)
+        else:
+            raise ValueError('line %d: unexpected "%s"' % (number, line.strip()))
+
+    return glyphs, widths, kerning
+
+
+def compile_font(glyphs, widths, kerning, end):
+    characters = []
+    metrics = []
+
+    for c in range(ASCII_START, end + 1):
+        rows = glyphs.get(c, [])
+        used = 0
+
+        for y in range(FONT_HEIGHT):
+            row = rows[y] if y < len(rows) else ''
+            bits = 0
+            for x, pixel in enumerate(row):
+                if pixel == '#':
+                    bits |= 0x10 >> x
+            used |= bits
+            characters.append(bits)
+
+        columns = [x for x in range(FONT_WIDTH) if used & (0x10 >> x)]
+        offset = columns[0] if columns else 0
+        width = widths.get(c, columns[-1] - offset + 1 if columns else 2)
+        metrics.append((offset << 4) | width)
+
+    pairs = []
+    for left, right, adjust in kerning:
+        pairs += [left, right, adjust & 0xFF]
+    pairs.append(0)
+
+    return characters, metrics, pairs
+
+
+def table(name, values, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join('0x%02x' % v for v in values[i:i + per_line]))
+    return 'const unsigned char %s[%d] = {\n%s\n};\n' % (name, len(values), ',\n'.join(lines))
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write(__doc__)
+        return 1
+
+    with open(argv[1]) as f:
+        glyphs, widths, kerning = parse(f.readlines())
+
+    end = max(glyphs) if glyphs else ASCII_START
+    characters, metrics, pairs = compile_font(glyphs, widths, kerning, end)
+    name = argv[2]
+
+    source = '// Generated by utils/fontcompiler.py from %s. Do not edit.\n\n' % argv[1]
+    source += table(name, characters, FONT_HEIGHT) + '\n'
+    source += table(name + 'Metrics', metrics, 16) + '\n'
+    source += table(name + 'Kerning', pairs, 3) + '\n'
+    source += '// MicroBitFont(%s, %sMetrics, %sKerning, %d)\n' % (name, name, name, end)
+
+    if len(argv) > 3:
+        with open(argv[3], 'w') as f:
+            f.write(source)
+    else:
+        sys.stdout.write(source)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))